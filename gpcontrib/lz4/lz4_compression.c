@@ -0,0 +1,190 @@
+/*---------------------------------------------------------------------
+ *
+ * lz4_compression.c
+ *	  LZ4 compression for append-optimized tables.
+ *
+ * Compression levels 1 and 2 use the fast LZ4 compressor, levels 3 to 12
+ * the slower LZ4-HC compressor, like the lz4 command line tool does.  Both
+ * produce the same format, so decompression is equally fast whatever level
+ * the data was written with.
+ *
+ * Portions Copyright (c) 2023-Present, Cloudberry inc
+ *
+ *
+ * IDENTIFICATION
+ *	    gpcontrib/lz4/lz4_compression.c
+ *
+ *---------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "catalog/pg_compression.h"
+#include "fmgr.h"
+#include "storage/gp_compress.h"
+#include "utils/builtins.h"
+
+#include <lz4.h>
+#include <lz4hc.h>
+
+/* Lowest compression level that uses LZ4-HC */
+#define LZ4_HC_MIN_LEVEL	3
+
+Datum		lz4_constructor(PG_FUNCTION_ARGS);
+Datum		lz4_destructor(PG_FUNCTION_ARGS);
+Datum		lz4_compress(PG_FUNCTION_ARGS);
+Datum		lz4_decompress(PG_FUNCTION_ARGS);
+Datum		lz4_validator(PG_FUNCTION_ARGS);
+
+PG_FUNCTION_INFO_V1(lz4_constructor);
+PG_FUNCTION_INFO_V1(lz4_destructor);
+PG_FUNCTION_INFO_V1(lz4_compress);
+PG_FUNCTION_INFO_V1(lz4_decompress);
+PG_FUNCTION_INFO_V1(lz4_validator);
+
+#ifndef UNIT_TESTING
+PG_MODULE_MAGIC;
+#endif
+
+/* Internal state for lz4 */
+typedef struct lz4_state
+{
+	int			level;			/* Compression level */
+	bool		compress;		/* Compress if true, decompress otherwise */
+
+	/*
+	 * LZ4 or LZ4-HC compression state.  It is allocated with palloc, rather
+	 * than by the library, so that it is not leaked on abort.  Decompression
+	 * needs no state.
+	 */
+	void	   *workspace;
+} lz4_state;
+
+Datum
+lz4_constructor(PG_FUNCTION_ARGS)
+{
+	/* PG_GETARG_POINTER(0) is TupleDesc that is currently unused. */
+
+	StorageAttributes *sa = (StorageAttributes *) PG_GETARG_POINTER(1);
+	CompressionState *cs = palloc0(sizeof(CompressionState));
+	lz4_state  *state = palloc0(sizeof(lz4_state));
+	bool		compress = PG_GETARG_BOOL(2);
+
+	if (!PointerIsValid(sa->comptype))
+		elog(ERROR, "lz4_constructor called with no compression type");
+
+	cs->opaque = (void *) state;
+	cs->desired_sz = NULL;
+
+	if (sa->complevel == 0)
+		sa->complevel = 1;
+
+	state->level = sa->complevel;
+	state->compress = compress;
+
+	if (compress)
+	{
+		if (state->level >= LZ4_HC_MIN_LEVEL)
+			state->workspace = palloc(LZ4_sizeofStateHC());
+		else
+			state->workspace = palloc(LZ4_sizeofState());
+	}
+
+	PG_RETURN_POINTER(cs);
+}
+
+Datum
+lz4_destructor(PG_FUNCTION_ARGS)
+{
+	CompressionState *cs = (CompressionState *) PG_GETARG_POINTER(0);
+
+	if (cs != NULL && cs->opaque != NULL)
+	{
+		lz4_state  *state = (lz4_state *) cs->opaque;
+
+		if (state->workspace)
+			pfree(state->workspace);
+		pfree(state);
+	}
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * lz4 compression implementation
+ *
+ * Note that when compression fails due to algorithm inefficiency,
+ * dst_used is set so src_sz, but the output buffer contents are left unchanged
+ */
+Datum
+lz4_compress(PG_FUNCTION_ARGS)
+{
+	const void *src = PG_GETARG_POINTER(0);
+	int32		src_sz = PG_GETARG_INT32(1);
+	void	   *dst = PG_GETARG_POINTER(2);
+	int32		dst_sz = PG_GETARG_INT32(3);
+	int32	   *dst_used = (int32 *) PG_GETARG_POINTER(4);
+	CompressionState *cs = (CompressionState *) PG_GETARG_POINTER(5);
+	lz4_state  *state = (lz4_state *) cs->opaque;
+
+	int			dst_length_used;
+
+	Assert(state->compress);
+
+	if (state->level >= LZ4_HC_MIN_LEVEL)
+		dst_length_used = LZ4_compress_HC_extStateHC(state->workspace,
+													 src, dst,
+													 src_sz, dst_sz,
+													 state->level);
+	else
+		dst_length_used = LZ4_compress_fast_extState(state->workspace,
+													 src, dst,
+													 src_sz, dst_sz,
+													 1);
+
+	if (dst_length_used <= 0)
+	{
+		/*
+		 * LZ4 returns 0 when the output doesn't fit in dst, i.e. when the
+		 * "compressed" output would be bigger than the uncompressed input.
+		 * The caller detects this by checking dst_used >= src_size.
+		 */
+		dst_length_used = src_sz;
+	}
+
+	*dst_used = (int32) dst_length_used;
+
+	PG_RETURN_VOID();
+}
+
+Datum
+lz4_decompress(PG_FUNCTION_ARGS)
+{
+	const void *src = PG_GETARG_POINTER(0);
+	int32		src_sz = PG_GETARG_INT32(1);
+	void	   *dst = PG_GETARG_POINTER(2);
+	int32		dst_sz = PG_GETARG_INT32(3);
+	int32	   *dst_used = (int32 *) PG_GETARG_POINTER(4);
+
+	int			dst_length_used;
+
+	if (src_sz <= 0)
+		elog(ERROR, "invalid source buffer size %d", src_sz);
+	if (dst_sz <= 0)
+		elog(ERROR, "invalid destination buffer size %d", dst_sz);
+
+	dst_length_used = LZ4_decompress_safe(src, dst, src_sz, dst_sz);
+
+	if (dst_length_used < 0)
+		elog(ERROR, "lz4 decompression failed: compressed data is corrupt");
+
+	*dst_used = (int32) dst_length_used;
+
+	PG_RETURN_VOID();
+}
+
+Datum
+lz4_validator(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_VOID();
+}
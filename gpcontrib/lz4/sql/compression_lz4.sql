@@ -0,0 +1,62 @@
+-- Tests for lz4 compression.
+
+-- Check that callbacks are registered
+SELECT * FROM pg_compression WHERE compname = 'lz4';
+
+CREATE TABLE lz4test (id int4, t text) WITH (appendonly=true, compresstype=lz4, orientation=column);
+
+-- Check that the reloptions on the table shows compression type
+SELECT reloptions FROM pg_class WHERE relname = 'lz4test';
+
+INSERT INTO lz4test SELECT g, 'foo' || g FROM generate_series(1, 100000) g;
+INSERT INTO lz4test SELECT g, 'bar' || g FROM generate_series(1, 100000) g;
+
+-- Check that we actually compressed data. The exact ratio depends on the
+-- version of liblz4.
+SELECT get_ao_compression_ratio('lz4test') > 1;
+
+-- Check contents, at the beginning of the table and at the end.
+SELECT * FROM lz4test ORDER BY (id, t) LIMIT 5;
+SELECT * FROM lz4test ORDER BY (id, t) DESC LIMIT 5;
+
+
+-- Test the fast compressor (levels 1 and 2) and the LZ4-HC one (levels 3 to
+-- 12), on row-oriented tables:
+CREATE TABLE lz4test_1 (id int4, t text) WITH (appendonly=true, compresstype=lz4, compresslevel=1);
+CREATE TABLE lz4test_12 (id int4, t text) WITH (appendonly=true, compresstype=lz4, compresslevel=12);
+
+INSERT INTO lz4test_1 SELECT g, 'foo' || g FROM generate_series(1, 10000) g;
+INSERT INTO lz4test_1 SELECT g, 'bar' || g FROM generate_series(1, 10000) g;
+SELECT * FROM lz4test_1 ORDER BY (id, t) LIMIT 5;
+SELECT * FROM lz4test_1 ORDER BY (id, t) DESC LIMIT 5;
+
+INSERT INTO lz4test_12 SELECT g, 'foo' || g FROM generate_series(1, 10000) g;
+INSERT INTO lz4test_12 SELECT g, 'bar' || g FROM generate_series(1, 10000) g;
+SELECT * FROM lz4test_12 ORDER BY (id, t) LIMIT 5;
+SELECT * FROM lz4test_12 ORDER BY (id, t) DESC LIMIT 5;
+
+-- LZ4-HC compresses at least as well as the fast compressor.
+SELECT get_ao_compression_ratio('lz4test_12') >= get_ao_compression_ratio('lz4test_1');
+
+
+-- Column level compression
+CREATE TABLE lz4test_col (a int4 ENCODING (compresstype=lz4, compresslevel=9), b text ENCODING (compresstype=none)) WITH (appendonly=true, orientation=column);
+INSERT INTO lz4test_col SELECT g % 1000, repeat('x', g % 100) FROM generate_series(1, 100000) g;
+SELECT count(*), sum(a), sum(length(b)) FROM lz4test_col;
+
+
+-- Test the bounds of compresslevel. None of these are allowed.
+CREATE TABLE lz4test_invalid (id int4) WITH (appendonly=true, compresstype=lz4, compresslevel=0);
+CREATE TABLE lz4test_invalid (id int4) WITH (appendonly=true, compresstype=lz4, compresslevel=13);
+
+
+-- Compression of temporary files. The hash join spills with this little
+-- memory.
+SET gp_workfile_compression = on;
+SET gp_workfile_compression_method = lz4;
+SET statement_mem = '2MB';
+CREATE TABLE lz4test_join AS SELECT g AS a, g AS b FROM generate_series(1, 200000) g DISTRIBUTED BY (a);
+SELECT count(*), sum(t1.a) FROM lz4test_join t1 JOIN lz4test_join t2 ON t1.a = t2.b;
+RESET statement_mem;
+RESET gp_workfile_compression_method;
+RESET gp_workfile_compression;
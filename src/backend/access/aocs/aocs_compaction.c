@@ -245,7 +245,7 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 	compact_segno = fsinfo->segno;
 	if (fsinfo->varblockcount > 0)
 	{
-		tuplePerPage = fsinfo->total_tupcount / fsinfo->varblockcount;
+		tuplePerPage = Max(fsinfo->total_tupcount / fsinfo->varblockcount, 1);
 	}
 	relname = RelationGetRelationName(aorel);
 
@@ -311,6 +311,12 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 		tupleCount++;
 		if (VacuumCostActive && tupleCount % tuplePerPage == 0)
 		{
+			/*
+			 * Segment files bypass the buffer manager, so charge the block
+			 * read and the block written here, for vacuum_cost_delay to
+			 * throttle the compaction.
+			 */
+			VacuumCostBalance += VacuumCostPageMiss + VacuumCostPageDirty;
 			vacuum_delay_point();
 		}
 	}
@@ -359,8 +365,10 @@ AOCSSegmentFileFullCompaction(Relation aorel,
  *
  * The caller is required to hold either an AccessExclusiveLock (vacuum full)
  * or a ShareLock on the relation.
+ *
+ * Returns true if the segment file was compacted.
  */
-void
+bool
 AOCSCompact(Relation aorel,
 			int compaction_segno,
 			int *insert_segno,
@@ -371,6 +379,7 @@ AOCSCompact(Relation aorel,
 	AOCSInsertDesc insertDesc = NULL;
 	AOCSFileSegInfo *fsinfo;
 	Snapshot	appendOnlyMetaDataSnapshot = RegisterSnapshot(GetCatalogSnapshot(InvalidOid));
+	bool		compacted = false;
 
 	Assert(RelationIsAoCols(aorel));
 	Assert(Gp_role == GP_ROLE_EXECUTE || Gp_role == GP_ROLE_UTILITY);
@@ -403,6 +412,7 @@ AOCSCompact(Relation aorel,
 
 			insertDesc->skipModCountIncrement = true;
 			aocs_insert_finish(insertDesc, NULL);
+			compacted = true;
 		}
 		else
 		{
@@ -413,4 +423,6 @@ AOCSCompact(Relation aorel,
 	pfree(fsinfo);
 
 	UnregisterSnapshot(appendOnlyMetaDataSnapshot);
+
+	return compacted;
 }
@@ -23,6 +23,7 @@
 #include "access/appendonlywriter.h"
 #include "access/heapam.h"
 #include "access/hio.h"
+#include "access/tupdesc_details.h"
 #include "catalog/catalog.h"
 #include "catalog/gp_fastsequence.h"
 #include "catalog/namespace.h"
@@ -36,11 +37,14 @@
 #include "cdb/cdbappendonlystoragewrite.h"
 #include "cdb/cdbvars.h"
 #include "executor/executor.h"
+#include "executor/nodeRuntimeFilter.h"
 #include "fmgr.h"
 #include "miscadmin.h"
+#include "optimizer/optimizer.h"
 #include "pgstat.h"
 #include "storage/procarray.h"
 #include "storage/smgr.h"
+#include "utils/datum.h"
 #include "utils/datumstream.h"
 #include "utils/faultinjector.h"
 #include "utils/guc.h"
@@ -68,6 +72,9 @@ static void aocs_insert_finish_guts(AOCSInsertDesc aoInsertDesc);
 /* Hook for plugins to get control in aocs_delete() */
 aocs_delete_hook_type aocs_delete_hook = NULL;
 
+/* Number of rows aoco_getnextslot() decodes at a time, 0 to disable */
+int			gp_aocs_scan_batch_size = 1024;
+
 /*
  * Open the segment file for a specified column associated with the datum
  * stream.
@@ -101,6 +108,10 @@ open_datumstreamread_segfile(
  *
  * If blockDirectory is not NULL, the first block info is written to
  * the block directory.
+ *
+ * An added column that has no data in the segment file at all may have no
+ * file either, it isn't opened.  The first row with data of each added
+ * column is noted in added.
  */
 static void
 open_all_datumstreamread_segfiles(Relation rel,
@@ -108,7 +119,8 @@ open_all_datumstreamread_segfiles(Relation rel,
 								  DatumStreamRead **ds,
 								  AttrNumber *proj_atts,
 								  AttrNumber num_proj_atts,
-								  AppendOnlyBlockDirectory *blockDirectory)
+								  AppendOnlyBlockDirectory *blockDirectory,
+								  AOCSAddedColumn *added)
 {
 	char	   *basepath = relpathbackend(rel->rd_node, rel->rd_backend, MAIN_FORKNUM);
 
@@ -116,14 +128,139 @@ open_all_datumstreamread_segfiles(Relation rel,
 	for (AttrNumber i = 0; i < num_proj_atts; i++)
 	{
 		AttrNumber	attno = proj_atts[i];
+		bool		lacksRows = (added != NULL && added[attno].lacksRows);
+
+		if (lacksRows && getAOCSVPEntry(segInfo, attno)->eof == 0)
+		{
+			added[attno].firstRowNum = PG_INT64_MAX;
+			continue;
+		}
 
 		open_datumstreamread_segfile(basepath, rel->rd_node, segInfo, ds[attno], attno);
 		datumstreamread_block(ds[attno], blockDirectory, attno);
+
+		if (lacksRows)
+			added[attno].firstRowNum = ds[attno]->blockFirstRowNum;
 	}
 
 	pfree(basepath);
 }
 
+/*
+ * Can the column lack rows in some segment files?  See AOCSAddedColumn.
+ *
+ * A column that ALTER TABLE added with a non-null default has atthasmissing
+ * set, whether or not it wrote the default for the rows already there.
+ */
+static bool
+aocs_column_may_lack_rows(TupleDesc tupdesc, AttrNumber attno)
+{
+	return tupdesc->constr != NULL &&
+		tupdesc->constr->missing != NULL &&
+		tupdesc->constr->missing[attno].am_present &&
+		TupleDescAttr(tupdesc, attno)->atthasmissing;
+}
+
+/*
+ * Returns an array by attno, allocated in the current memory context, that
+ * marks the given columns that may lack rows, with their missing values.
+ * Returns NULL if none of them may.  All columns of tupdesc are given if
+ * proj_atts is NULL.
+ */
+static AOCSAddedColumn *
+aocs_added_columns(TupleDesc tupdesc, AttrNumber *proj_atts,
+				   AttrNumber num_proj_atts)
+{
+	AOCSAddedColumn *added = NULL;
+
+	if (proj_atts == NULL)
+		num_proj_atts = tupdesc->natts;
+
+	for (AttrNumber i = 0; i < num_proj_atts; i++)
+	{
+		AttrNumber	attno = (proj_atts ? proj_atts[i] : i);
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, attno);
+
+		if (!aocs_column_may_lack_rows(tupdesc, attno))
+			continue;
+
+		if (added == NULL)
+			added = palloc0(tupdesc->natts * sizeof(AOCSAddedColumn));
+		added[attno].lacksRows = true;
+		added[attno].missingValue = datumCopy(tupdesc->constr->missing[attno].am_value,
+											  attr->attbyval, attr->attlen);
+	}
+
+	return added;
+}
+
+/*
+ * Chooses the column that tells which rows exist while reading the given
+ * columns, some of which may lack rows: a projected column that has all
+ * rows if there is one, else the first such column of the table.
+ *
+ * The first column always has all rows.  ALTER TABLE only leaves the rows
+ * out of a column that it adds to a table with other columns, and a column
+ * added to a table without columns has a default for each row, if any.
+ */
+static AttrNumber
+aocs_choose_row_column(TupleDesc tupdesc, AOCSAddedColumn *added,
+					   AttrNumber *proj_atts, AttrNumber num_proj_atts)
+{
+	for (AttrNumber i = 0; i < num_proj_atts; i++)
+	{
+		if (!added[proj_atts[i]].lacksRows)
+			return proj_atts[i];
+	}
+
+	for (AttrNumber attno = 0; attno < tupdesc->natts; attno++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, attno);
+
+		if (!attr->attisdropped && !attr->atthasmissing)
+			return attno;
+	}
+
+	added[0].lacksRows = false;
+	return 0;
+}
+
+/*
+ * Sets up reading the columns of a scan that may lack rows: the column that
+ * tells the row numbers is read first, added to the projection if needed.
+ */
+static void
+setup_scan_added_columns(AOCSScanDesc scan)
+{
+	AttrNumber *proj_atts = scan->columnScanInfo.proj_atts;
+	AttrNumber	num_proj_atts = scan->columnScanInfo.num_proj_atts;
+	AttrNumber	row_attno;
+	AttrNumber	i;
+
+	row_attno = aocs_choose_row_column(scan->columnScanInfo.relationTupleDesc,
+									   scan->columnScanInfo.added,
+									   proj_atts, num_proj_atts);
+
+	for (i = 0; i < num_proj_atts; i++)
+	{
+		if (proj_atts[i] == row_attno)
+			break;
+	}
+
+	if (i < num_proj_atts)
+	{
+		proj_atts[i] = proj_atts[0];
+		proj_atts[0] = row_attno;
+	}
+	else
+	{
+		/* There is room, the column isn't projected */
+		memmove(&proj_atts[1], &proj_atts[0], num_proj_atts * sizeof(AttrNumber));
+		proj_atts[0] = row_attno;
+		scan->columnScanInfo.num_proj_atts++;
+	}
+}
+
 /*
  * Initialise data streams for every column used in this query. For writes, this
  * means all columns.
@@ -326,6 +463,17 @@ initscan_with_colinfo(AOCSScanDesc scan)
 			scan->columnScanInfo.proj_atts[attno] = attno;
 	}
 
+	/* Nothing to do on a rescan, the projection is set up already */
+	if (scan->columnScanInfo.added == NULL)
+	{
+		scan->columnScanInfo.added =
+			aocs_added_columns(scan->columnScanInfo.relationTupleDesc,
+							   scan->columnScanInfo.proj_atts,
+							   scan->columnScanInfo.num_proj_atts);
+		if (scan->columnScanInfo.added != NULL)
+			setup_scan_added_columns(scan);
+	}
+
 	open_ds_read(scan->rs_base.rs_rd, scan->columnScanInfo.ds,
 				 scan->columnScanInfo.relationTupleDesc,
 				 scan->columnScanInfo.proj_atts, scan->columnScanInfo.num_proj_atts,
@@ -341,6 +489,155 @@ initscan_with_colinfo(AOCSScanDesc scan)
 	pgstat_count_heap_scan(scan->rs_base.rs_rd);
 }
 
+/*
+ * Split the segment files into the parts that the participants of a parallel
+ * scan take turns at.  The participants all see the block directory through
+ * the same snapshot, so they agree on the parts without talking to each
+ * other.
+ *
+ * The parts are split at the minipages of the first projected column.  A
+ * segment file in an old format, whose blocks do not carry their first row
+ * number, is always a single part.
+ */
+static void
+setup_parallel_scan_parts(AOCSScanDesc scan)
+{
+	Relation	rel = scan->rs_base.rs_rd;
+	MemoryContext oldCtx = MemoryContextSwitchTo(scan->columnScanInfo.scanCtx);
+	int			maxparts = Max(scan->total_seg, 1);
+
+	scan->part_attno = scan->columnScanInfo.proj_atts[0];
+	scan->parts = palloc(sizeof(AppendOnlyScanPart) * maxparts);
+	scan->nparts = 0;
+
+	for (int i = 0; i < scan->total_seg; i++)
+	{
+		AOCSFileSegInfo *seginfo = scan->seginfo[i];
+		AppendOnlyScanPart *parts;
+		int			nparts;
+
+		if (seginfo->total_tupcount > 0 &&
+			seginfo->state != AOSEG_STATE_AWAITING_DROP &&
+			seginfo->formatversion >= AORelationVersion_GetLatest())
+		{
+			parts = AppendOnlyBlockDirectory_SplitSegmentFile(rel,
+															  scan->appendOnlyMetaDataSnapshot,
+															  seginfo->segno,
+															  scan->part_attno,
+															  getAOCSVPEntry(seginfo, scan->part_attno)->eof,
+															  i,
+															  &nparts);
+		}
+		else
+		{
+			parts = palloc(sizeof(AppendOnlyScanPart));
+			parts[0].segfileIndex = i;
+			parts[0].firstRowNum = 0;
+			parts[0].fileOffset = 0;
+			parts[0].afterRowNum = -1;
+			parts[0].afterFileOffset = -1;
+			nparts = 1;
+		}
+
+		if (scan->nparts + nparts > maxparts)
+		{
+			maxparts = Max(maxparts * 2, scan->nparts + nparts);
+			scan->parts = repalloc(scan->parts,
+								   sizeof(AppendOnlyScanPart) * maxparts);
+		}
+		memcpy(&scan->parts[scan->nparts], parts,
+			   sizeof(AppendOnlyScanPart) * nparts);
+		scan->nparts += nparts;
+		pfree(parts);
+	}
+
+	if (scan->nparts > scan->total_seg && scan->columnScanInfo.num_proj_atts > 1)
+	{
+		AttrNumber	natts = RelationGetNumberOfAttributes(rel);
+		bool	   *proj = palloc0(natts * sizeof(bool));
+
+		for (AttrNumber i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
+			proj[scan->columnScanInfo.proj_atts[i]] = true;
+
+		scan->partBlockDirectory = palloc0(sizeof(AppendOnlyBlockDirectory));
+		AppendOnlyBlockDirectory_Init_forSearch(scan->partBlockDirectory,
+												scan->appendOnlyMetaDataSnapshot,
+												(FileSegInfo **) scan->seginfo,
+												scan->total_seg,
+												rel,
+												natts,
+												true,
+												proj);
+		pfree(proj);
+	}
+
+	MemoryContextSwitchTo(oldCtx);
+}
+
+/*
+ * Position the projected columns of a newly opened segment file at the part
+ * of it that a parallel scan took.
+ *
+ * The column that the parts were split by reads just the blocks of the part.
+ * The other columns start at the block holding the first row of the part,
+ * as found in the block directory, and the readers stop at the first row of
+ * the next part, see past_cur_part().
+ */
+static void
+position_scan_part(AOCSScanDesc scan, AOCSFileSegInfo *seginfo,
+				   AppendOnlyScanPart *part)
+{
+	scan->cur_part_after_row = part->afterRowNum;
+
+	if (part->firstRowNum == 0 && part->afterRowNum == -1)
+		return;
+
+	for (AttrNumber i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
+	{
+		AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+		DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+		int64		beginFileOffset = 0;
+		int64		afterFileOffset = ds->eof;
+
+		if (attno == scan->part_attno)
+		{
+			beginFileOffset = part->fileOffset;
+			afterFileOffset = part->afterFileOffset;
+		}
+		else if (part->firstRowNum > 0 && scan->partBlockDirectory)
+		{
+			AOTupleId	aoTupleId;
+			AppendOnlyBlockDirectoryEntry entry;
+
+			AOTupleIdInit(&aoTupleId, seginfo->segno, part->firstRowNum);
+			if (AppendOnlyBlockDirectory_GetEntry(scan->partBlockDirectory,
+												  &aoTupleId, attno, &entry))
+				beginFileOffset = entry.range.fileOffset;
+		}
+
+		AppendOnlyStorageRead_SetTemporaryRange(&ds->ao_read,
+												beginFileOffset,
+												afterFileOffset);
+
+		if (part->firstRowNum > 0 &&
+			!datumstreamread_skip_to_row(ds, part->firstRowNum))
+			elog(ERROR, "could not find row " INT64_FORMAT " of column %d in segment file %d of relation %s",
+				 part->firstRowNum, attno + 1, seginfo->segno,
+				 RelationGetRelationName(scan->rs_base.rs_rd));
+	}
+}
+
+/*
+ * Has a parallel scan reached the first row of the next part of the segment
+ * file?  The rest of the file belongs to the other participants.
+ */
+static inline bool
+past_cur_part(AOCSScanDesc scan, int64 rowNum)
+{
+	return scan->cur_part_after_row != INT64CONST(-1) &&
+		rowNum >= scan->cur_part_after_row;
+}
+
 static int
 open_next_scan_seg(AOCSScanDesc scan)
 {
@@ -353,13 +650,37 @@ open_next_scan_seg(AOCSScanDesc scan)
 		pbscan = (ParallelBlockTableScanDesc) scan->rs_base.rs_parallel;
 	}
 
-	while (scan->cur_seg < scan->total_seg)
+	/*
+	 * A parallel scan hands out parts of the segment files rather than whole
+	 * files when the block directory allows to split them.  The parts of
+	 * columns that lack rows are not known, though.
+	 */
+	if (isParallel && scan->parts == NULL && scan->blockDirectory == NULL &&
+		scan->columnScanInfo.added == NULL)
+		setup_parallel_scan_parts(scan);
+
+	scan->cur_part_after_row = INT64CONST(-1);
+	while (scan->parts != NULL || scan->cur_seg < scan->total_seg)
 	{
+		AppendOnlyScanPart *part = NULL;
+
 		if (isParallel)
 		{
-			scan->cur_seg = pg_atomic_fetch_add_u64(&pbscan->phs_nallocated, 1);
-			if (scan->cur_seg >= pbscan->phs_nblocks)
-				break;
+			int			idx = pg_atomic_fetch_add_u64(&pbscan->phs_nallocated, 1);
+
+			if (scan->parts != NULL)
+			{
+				if (idx >= scan->nparts)
+					break;
+				part = &scan->parts[idx];
+				scan->cur_seg = part->segfileIndex;
+			}
+			else
+			{
+				scan->cur_seg = idx;
+				if (scan->cur_seg >= pbscan->phs_nblocks)
+					break;
+			}
 		}
 		else
 		{
@@ -379,7 +700,7 @@ open_next_scan_seg(AOCSScanDesc scan)
 			 *
 			 * We assume the corresponding segments for every column to be in
 			 * the same state. So somewhat arbitrarily, we check the state of
-			 * the first column we'll be accessing.
+			 * the first column we'll be accessing, which has all rows.
 			 */
 
 			/*
@@ -451,7 +772,11 @@ open_next_scan_seg(AOCSScanDesc scan)
 												  scan->columnScanInfo.ds,
 												  scan->columnScanInfo.proj_atts,
 												  scan->columnScanInfo.num_proj_atts,
-												  scan->blockDirectory);
+												  scan->blockDirectory,
+												  scan->columnScanInfo.added);
+
+				if (part != NULL)
+					position_scan_part(scan, curSegInfo, part);
 
 				return scan->cur_seg;
 			}
@@ -461,6 +786,25 @@ open_next_scan_seg(AOCSScanDesc scan)
 	return -1;
 }
 
+/*
+ * Position all projected columns of the current segment file so that the
+ * next row read is rowNum, or the first row after it.  Returns false if the
+ * segment file ends before that.
+ */
+static bool
+skip_to_row(AOCSScanDesc scan, int64 rowNum)
+{
+	for (AttrNumber i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
+	{
+		AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+
+		if (!datumstreamread_skip_to_row(scan->columnScanInfo.ds[attno], rowNum))
+			return false;
+	}
+
+	return true;
+}
+
 static void
 close_cur_scan_seg(AOCSScanDesc scan)
 {
@@ -634,6 +978,9 @@ aocs_beginscan_internal(Relation relation,
 void
 aocs_rescan(AOCSScanDesc scan)
 {
+	if (scan->batch)
+		scan->batch->nrows = scan->batch->next = 0;
+
 	close_cur_scan_seg(scan);
 	if (scan->columnScanInfo.ds)
 		close_ds_read(scan->columnScanInfo.ds, scan->columnScanInfo.relationTupleDesc->natts);
@@ -664,6 +1011,9 @@ aocs_endscan(AOCSScanDesc scan)
 	if (scan->columnScanInfo.proj_atts)
 		pfree(scan->columnScanInfo.proj_atts);
 
+	if (scan->columnScanInfo.added)
+		pfree(scan->columnScanInfo.added);
+
 	for (int i = 0; i < scan->total_seg; ++i)
 	{
 		if (scan->seginfo[i])
@@ -679,6 +1029,31 @@ aocs_endscan(AOCSScanDesc scan)
 	if (scan->total_seg != 0)
 		AppendOnlyVisimap_Finish(&scan->visibilityMap, AccessShareLock);
 
+	if (scan->aos_zonemap)
+	{
+		AOZoneMap_EndScan(scan->aos_zonemap);
+		scan->aos_zonemap = NULL;
+	}
+
+	if (scan->batch)
+	{
+		aocs_free_batch(scan->batch);
+		scan->batch = NULL;
+	}
+
+	if (scan->partBlockDirectory)
+	{
+		AppendOnlyBlockDirectory_End_forSearch(scan->partBlockDirectory);
+		pfree(scan->partBlockDirectory);
+		scan->partBlockDirectory = NULL;
+	}
+
+	if (scan->parts)
+	{
+		pfree(scan->parts);
+		scan->parts = NULL;
+	}
+
 	/* GPDB should backport this to upstream */
 	if (scan->rs_base.rs_flags & SO_TEMP_SNAPSHOT)
 		UnregisterSnapshot(scan->rs_base.rs_snapshot);
@@ -790,6 +1165,7 @@ aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
 	int			err = 0;
 	bool		isSnapshotAny = (scan->rs_base.rs_snapshot == SnapshotAny);
 	AttrNumber	natts;
+	AOCSAddedColumn *added;
 
 	Assert(ScanDirectionIsForward(direction));
 
@@ -803,12 +1179,15 @@ aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
 
 	natts = slot->tts_tupleDescriptor->natts;
 	Assert(natts <= scan->columnScanInfo.relationTupleDesc->natts);
+	added = scan->columnScanInfo.added;
 
 	while (1)
 	{
 		AOCSFileSegInfo *curseginfo;
 		bool visible_pass;
 		bool predicate_pass;
+		int64 skipToRowNum;
+		int64 curRowNum = INT64CONST(-1);
 
 ReadNext:
 		/* If necessary, open next seg */
@@ -830,10 +1209,27 @@ ReadNext:
 
 		/* Read from cur_seg */
 		visible_pass = predicate_pass = true;
+		skipToRowNum = INT64CONST(-1);
 		for (AttrNumber i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
 		{
 			AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
 
+			/*
+			 * A column added after the row was inserted has no data for it,
+			 * the row has the column's missing value.
+			 */
+			if (added != NULL && added[attno].lacksRows &&
+				curRowNum < added[attno].firstRowNum)
+			{
+				Assert(i > 0);
+				if (visible_pass && predicate_pass)
+				{
+					d[attno] = added[attno].missingValue;
+					null[attno] = false;
+				}
+				continue;
+			}
+
 			err = datumstreamread_advance(scan->columnScanInfo.ds[attno]);
 			Assert(err >= 0);
 			if (err == 0)
@@ -878,6 +1274,15 @@ ReadNext:
 					rowNum = scan->columnScanInfo.ds[attno]->blockFirstRowNum +
 						datumstreamread_nth(scan->columnScanInfo.ds[attno]);
 				}
+				curRowNum = rowNum;
+				if (rowNum != INT64CONST(-1) && past_cur_part(scan, rowNum))
+				{
+					/* Done with the part, go to the next one */
+					close_cur_scan_seg(scan);
+					rowNum = INT64CONST(-1);
+					err = -1;
+					goto ReadNext;
+				}
 				scan->cur_seg_row++;
 				if (rowNum == INT64CONST(-1))
 				{
@@ -888,6 +1293,28 @@ ReadNext:
 					AOTupleIdInit(&aoTupleId, curseginfo->segno, rowNum);
 				}
 
+				/*
+				 * If the zone maps show that the rest of the block can not
+				 * satisfy the qual, skip it once all columns are on this row.
+				 * Never do that while building the block directory, which
+				 * needs to see every block.
+				 */
+				if (scan->aos_zonemap && rowNum != INT64CONST(-1) &&
+					scan->blockDirectory == NULL)
+				{
+					int64		nextRowNum;
+
+					nextRowNum = AOZoneMap_NextCandidateRow(scan->aos_zonemap,
+															curseginfo->segno,
+															rowNum);
+					if (nextRowNum > rowNum)
+					{
+						skipToRowNum = nextRowNum;
+						predicate_pass = false;
+						continue; /* not break, need advance for other cols */
+					}
+				}
+
 				if (!isSnapshotAny && !AppendOnlyVisimap_IsVisible(&scan->visibilityMap, &aoTupleId))
 				{
 					/*
@@ -905,6 +1332,15 @@ ReadNext:
 			if (scan->aos_pushdown_qual && scan->aos_pushdown_qual[i])
 				predicate_pass &= aocs_col_predicate_test(scan, slot, i, true);
 		}
+		if (skipToRowNum != INT64CONST(-1) &&
+			!skip_to_row(scan, skipToRowNum))
+		{
+			/* The segment file ends before the next candidate row */
+			close_cur_scan_seg(scan);
+			err = -1;
+			rowNum = INT64CONST(-1);
+			goto ReadNext;
+		}
 		if (!visible_pass || !predicate_pass)
 		{
 			rowNum = INT64CONST(-1);
@@ -922,6 +1358,446 @@ ReadNext:
 }
 
 
+/*
+ * aocs_create_batch
+ *
+ * Allocates an empty batch of up to maxrows rows of tupdesc in the current
+ * memory context.
+ */
+AOCSBatch
+aocs_create_batch(TupleDesc tupdesc, int maxrows)
+{
+	AOCSBatch	batch;
+
+	Assert(maxrows > 0);
+
+	batch = (AOCSBatch) palloc0(sizeof(AOCSBatchData));
+	batch->mcxt = CurrentMemoryContext;
+	batch->copycxt = AllocSetContextCreate(CurrentMemoryContext,
+										   "AOCS batch copies",
+										   ALLOCSET_SMALL_SIZES);
+	batch->tupdesc = tupdesc;
+	batch->maxrows = maxrows;
+	batch->values = (Datum **) palloc0(tupdesc->natts * sizeof(Datum *));
+	batch->isnull = (bool **) palloc0(tupdesc->natts * sizeof(bool *));
+	batch->tids = (AOTupleId *) palloc(maxrows * sizeof(AOTupleId));
+	batch->visible = (bool *) palloc(maxrows * sizeof(bool));
+	batch->selected = (bool *) palloc(maxrows * sizeof(bool));
+
+	return batch;
+}
+
+void
+aocs_free_batch(AOCSBatch batch)
+{
+	for (AttrNumber attno = 0; attno < batch->tupdesc->natts; attno++)
+	{
+		if (batch->values[attno])
+		{
+			pfree(batch->values[attno]);
+			pfree(batch->isnull[attno]);
+		}
+	}
+	MemoryContextDelete(batch->copycxt);
+	pfree(batch->values);
+	pfree(batch->isnull);
+	pfree(batch->tids);
+	pfree(batch->visible);
+	pfree(batch->selected);
+	pfree(batch);
+}
+
+/*
+ * aocs_can_getnextbatch
+ *
+ * Can the scan be read with aocs_getnextbatch()?  Scans that build the block
+ * directory or sample for ANALYZE need to look at every row as it is read,
+ * and must use aocs_getnext().  So do scans of columns that may lack rows,
+ * which are only read along with the row numbers.  tupdesc is the
+ * descriptor the scan is going to be set up with, see initscan_with_colinfo().
+ */
+bool
+aocs_can_getnextbatch(AOCSScanDesc scan, TupleDesc tupdesc)
+{
+	AttrNumber *proj_atts = scan->columnScanInfo.proj_atts;
+	AttrNumber	num_proj_atts = scan->columnScanInfo.num_proj_atts;
+
+	if (scan->blockDirectory != NULL ||
+		(scan->rs_base.rs_flags & SO_TYPE_ANALYZE) != 0)
+		return false;
+
+	if (scan->columnScanInfo.relationTupleDesc != NULL)
+		return scan->columnScanInfo.added == NULL;
+
+	if (proj_atts == NULL)
+		num_proj_atts = tupdesc->natts;
+	for (AttrNumber i = 0; i < num_proj_atts; i++)
+	{
+		if (aocs_column_may_lack_rows(tupdesc, proj_atts ? proj_atts[i] : i))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Read the values of the pushed down qual column i for the next nread rows,
+ * and evaluate the column's qual for the rows that are still selected.
+ * Rows that have failed an earlier column's qual are only advanced over.
+ * While sampling the selectivity of the quals, see aocs_getnext_sample(),
+ * every visible row is evaluated.
+ */
+static void
+aocs_batch_qual_column(AOCSScanDesc scan, int i, AOCSBatch batch, int nread,
+					   bool sample_phase, int formatversion,
+					   TupleTableSlot *slot)
+{
+	AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+	DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+	Datum	   *values = batch->values[attno];
+	bool	   *isnull = batch->isnull[attno];
+
+	for (int j = 0; j < nread; j++)
+	{
+		int			err PG_USED_FOR_ASSERTS_ONLY;
+
+		err = datumstreamread_advance(ds);
+		Assert(err > 0);
+
+		if (!batch->selected[j] && !(sample_phase && batch->visible[j]))
+			continue;
+
+		datumstreamread_get(ds, &values[j], &isnull[j]);
+		if (formatversion < AORelationVersion_GetLatest())
+			upgrade_datum_impl(ds, j, values, isnull, formatversion);
+
+		slot->tts_values[attno] = values[j];
+		slot->tts_isnull[attno] = isnull[j];
+		if (!aocs_col_predicate_test(scan, slot, i, sample_phase))
+			batch->selected[j] = false;
+	}
+}
+
+/*
+ * Read the values of column attno for the rows of the batch, all of which
+ * have passed the pushed down quals.  The column's stream is moved straight
+ * to each of these rows, so that blocks without any of them are skipped
+ * without being decompressed or decoded.
+ *
+ * The rows may span blocks of the column.  Values passed by reference are
+ * copied out of a block before the next one replaces it in the read buffer.
+ */
+static void
+aocs_batch_late_column(AOCSScanDesc scan, AttrNumber attno, AOCSBatch batch)
+{
+	DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+	Form_pg_attribute attr = TupleDescAttr(batch->tupdesc, attno);
+	Datum	   *values = batch->values[attno];
+	bool	   *isnull = batch->isnull[attno];
+	int			blockStart = 0;
+
+	for (int j = 0; j < batch->nrows; j++)
+	{
+		int64		rowNum = AOTupleIdGet_rowNum(&batch->tids[j]);
+		int			err PG_USED_FOR_ASSERTS_ONLY;
+
+		if (!attr->attbyval && j > blockStart &&
+			(rowNum < ds->blockFirstRowNum ||
+			 rowNum >= ds->blockFirstRowNum + ds->blockRowCount))
+		{
+			MemoryContext oldcxt;
+
+			oldcxt = MemoryContextSwitchTo(batch->copycxt);
+			for (int k = blockStart; k < j; k++)
+			{
+				if (!isnull[k])
+					values[k] = datumCopy(values[k], false, attr->attlen);
+			}
+			MemoryContextSwitchTo(oldcxt);
+			blockStart = j;
+		}
+
+		if (!datumstreamread_skip_to_row(ds, rowNum))
+			elog(ERROR, "row " INT64_FORMAT " not found in column %d of append-only column segment file",
+				 rowNum, attno + 1);
+
+		err = datumstreamread_advance(ds);
+		Assert(err > 0);
+		datumstreamread_get(ds, &values[j], &isnull[j]);
+	}
+}
+
+/*
+ * aocs_getnextbatch
+ *
+ * Reads the next visible rows of the scan into batch, decoding a whole run
+ * of rows of one column before moving to the next column, in bulk where the
+ * block format allows (see DatumStreamBlockRead_GetBatch).  That keeps the
+ * decoder state and the block of a single column hot in the CPU caches,
+ * instead of cycling through all the projected columns for every row the
+ * way aocs_getnext() does.
+ *
+ * With pushed down quals, only the columns of the quals are read for every
+ * row, one column after the other, each only getting the values of the rows
+ * that passed the columns before it.  The other projected columns are read
+ * last, for just the rows that passed all of them (late materialization).
+ * Blocks of these columns that hold none of the rows are never decompressed,
+ * so a selective qual on a wide table reads little of its data.  slot is
+ * used to evaluate the quals.
+ *
+ * A batch never crosses a block boundary of a column read for every row, so
+ * that pass-by-reference values can keep pointing into the read buffers.
+ * The values stay valid until the next call.
+ *
+ * Returns the number of rows in the batch, 0 at the end of the scan.
+ */
+int
+aocs_getnextbatch(AOCSScanDesc scan, ScanDirection direction, AOCSBatch batch,
+				  TupleTableSlot *slot)
+{
+	bool		isSnapshotAny = (scan->rs_base.rs_snapshot == SnapshotAny);
+	bool		needNextSeg;
+
+	Assert(ScanDirectionIsForward(direction));
+	Assert(aocs_can_getnextbatch(scan, batch->tupdesc));
+
+	if (scan->columnScanInfo.relationTupleDesc == NULL)
+	{
+		scan->columnScanInfo.relationTupleDesc = batch->tupdesc;
+		/* Pin it! ... and of course release it upon destruction / rescan */
+		PinTupleDesc(scan->columnScanInfo.relationTupleDesc);
+		initscan_with_colinfo(scan);
+	}
+	Assert(batch->tupdesc->natts <= scan->columnScanInfo.relationTupleDesc->natts);
+	Assert(scan->columnScanInfo.num_proj_atts > 0);
+
+	for (AttrNumber i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
+	{
+		AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+
+		if (batch->values[attno] == NULL)
+		{
+			batch->values[attno] = (Datum *)
+				MemoryContextAlloc(batch->mcxt, batch->maxrows * sizeof(Datum));
+			batch->isnull[attno] = (bool *)
+				MemoryContextAlloc(batch->mcxt, batch->maxrows * sizeof(bool));
+		}
+	}
+
+	batch->nrows = 0;
+	batch->next = 0;
+	MemoryContextReset(batch->copycxt);
+
+	needNextSeg = (scan->cur_seg < 0);
+	while (batch->nrows == 0)
+	{
+		AOCSFileSegInfo *curseginfo;
+		DatumStreamRead *firstds;
+		bool		needUpgrade;
+		bool		sample_phase;
+		int64		firstRowNum = INT64CONST(-1);
+		int			neager;
+		int			nread;
+		int			nvisible;
+		AttrNumber	i;
+
+		/* If necessary, open next seg */
+		if (needNextSeg)
+		{
+			if (open_next_scan_seg(scan) < 0)
+			{
+				/* No more seg, we are at the end */
+				scan->cur_seg = -1;
+				return 0;
+			}
+			scan->cur_seg_row = 0;
+			needNextSeg = false;
+		}
+
+		Assert(scan->cur_seg >= 0);
+		curseginfo = scan->seginfo[scan->cur_seg];
+
+		/*
+		 * The upgrade space of a datum stream holds only one value at a time,
+		 * so segment files in an old format are read row by row, with all
+		 * columns read for every row.
+		 */
+		needUpgrade = (curseginfo->formatversion < AORelationVersion_GetLatest());
+		nread = needUpgrade ? 1 : batch->maxrows;
+
+		if (scan->aos_qual_col_num > 0 && !needUpgrade)
+			neager = scan->aos_qual_col_num;
+		else
+			neager = scan->columnScanInfo.num_proj_atts;
+
+		/*
+		 * Make sure that every column read for every row is positioned in a
+		 * block with values left, and read no further than the first of
+		 * these blocks ends.
+		 */
+		for (i = 0; i < neager; i++)
+		{
+			AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+			DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+			int			remaining;
+
+			while ((remaining = datumstreamread_remaining(ds)) == 0)
+			{
+				if (datumstreamread_block(ds, NULL, attno) < 0)
+					break;
+			}
+			if (remaining == 0)
+				break;
+
+			nread = Min(nread, remaining);
+		}
+		if (i < neager)
+		{
+			/*
+			 * Ha, cannot read next block, we need to go to next seg.  All
+			 * columns hold the same rows, so they all end together.
+			 */
+			close_cur_scan_seg(scan);
+			needNextSeg = true;
+			continue;
+		}
+
+		firstds = scan->columnScanInfo.ds[scan->columnScanInfo.proj_atts[0]];
+		if (firstds->blockFirstRowNum != INT64CONST(-1))
+		{
+			Assert(firstds->blockFirstRowNum > 0);
+			firstRowNum = firstds->blockFirstRowNum + firstds->blockRead.nth + 1;
+
+			/* Read no further than the part of a parallel scan */
+			if (past_cur_part(scan, firstRowNum))
+			{
+				close_cur_scan_seg(scan);
+				needNextSeg = true;
+				continue;
+			}
+			if (scan->cur_part_after_row != INT64CONST(-1))
+				nread = Min(nread, scan->cur_part_after_row - firstRowNum);
+		}
+
+		/*
+		 * If the zone maps show that the next rows can not satisfy the qual,
+		 * skip to the next candidate row.  Columns read late catch up by
+		 * themselves.
+		 */
+		if (scan->aos_zonemap && firstRowNum != INT64CONST(-1))
+		{
+			int64		nextRowNum;
+
+			nextRowNum = AOZoneMap_NextCandidateRow(scan->aos_zonemap,
+													curseginfo->segno,
+													firstRowNum);
+			if (nextRowNum > firstRowNum)
+			{
+				for (i = 0; i < neager; i++)
+				{
+					AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+
+					if (!datumstreamread_skip_to_row(scan->columnScanInfo.ds[attno],
+													 nextRowNum))
+						break;
+				}
+				if (i < neager)
+				{
+					/* The segment file ends before the next candidate row */
+					close_cur_scan_seg(scan);
+					needNextSeg = true;
+				}
+				continue;
+			}
+		}
+
+		/* Work out which of the rows are visible */
+		nvisible = 0;
+		for (int j = 0; j < nread; j++)
+		{
+			AOTupleId  *aoTupleId = &batch->tids[j];
+
+			scan->cur_seg_row++;
+			if (firstRowNum == INT64CONST(-1))
+				AOTupleIdInit(aoTupleId, curseginfo->segno, scan->cur_seg_row);
+			else
+				AOTupleIdInit(aoTupleId, curseginfo->segno, firstRowNum + j);
+
+			batch->visible[j] = isSnapshotAny ||
+				AppendOnlyVisimap_IsVisible(&scan->visibilityMap, aoTupleId);
+			if (batch->visible[j])
+				nvisible++;
+		}
+		memcpy(batch->selected, batch->visible, nread * sizeof(bool));
+
+		sample_phase = (scan->aos_qual_col_num > 0 &&
+						scan->aos_scaned_rows < scan->aos_sample_rows);
+
+		for (i = 0; i < neager; i++)
+		{
+			AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+			DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+
+			if (i < scan->aos_qual_col_num)
+			{
+				aocs_batch_qual_column(scan, i, batch, nread, sample_phase,
+									   curseginfo->formatversion, slot);
+				continue;
+			}
+
+			datumstreamread_get_batch(ds, batch->values[attno],
+									  batch->isnull[attno], nread);
+
+			/*
+			 * Perform any required upgrades on the Datum we just fetched.
+			 */
+			if (needUpgrade && batch->selected[0])
+			{
+				Assert(nread == 1);
+				upgrade_datum_impl(ds, 0, batch->values[attno],
+								   batch->isnull[attno], curseginfo->formatversion);
+			}
+		}
+
+		if (sample_phase)
+		{
+			scan->aos_scaned_rows += nvisible;
+
+			/* adjust the order of the qual col with selective */
+			if (scan->aos_scaned_rows >= scan->aos_sample_rows)
+				reorder_qual_col(scan);
+		}
+
+		/* Keep only the selected rows */
+		for (int j = 0; j < nread; j++)
+		{
+			if (!batch->selected[j])
+				continue;
+
+			if (batch->nrows < j)
+			{
+				batch->tids[batch->nrows] = batch->tids[j];
+				for (i = 0; i < neager; i++)
+				{
+					AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+
+					batch->values[attno][batch->nrows] = batch->values[attno][j];
+					batch->isnull[attno][batch->nrows] = batch->isnull[attno][j];
+				}
+			}
+			batch->nrows++;
+		}
+
+		if (batch->nrows == 0)
+			continue;
+
+		for (i = neager; i < scan->columnScanInfo.num_proj_atts; i++)
+			aocs_batch_late_column(scan, scan->columnScanInfo.proj_atts[i], batch);
+	}
+
+	return batch->nrows;
+}
+
 /* Open next file segment for write.  See SetCurrentFileSegForWrite */
 /* XXX Right now, we put each column to different files */
 static void
@@ -1320,6 +2196,20 @@ fetchFromCurrentBlock(AOCSFetchDesc aocsFetchDesc,
 	}
 }
 
+/*
+ * The row has the column's missing value, the column was added without
+ * writing it for the rows already in the table.
+ */
+static void
+fetchMissingValue(AOCSFetchDesc aocsFetchDesc, TupleTableSlot *slot, int colno)
+{
+	if (slot != NULL)
+	{
+		slot->tts_values[colno] = aocsFetchDesc->added[colno].missingValue;
+		slot->tts_isnull[colno] = false;
+	}
+}
+
 static bool
 scanToFetchValue(AOCSFetchDesc aocsFetchDesc,
 				 int64 rowNum,
@@ -1457,6 +2347,39 @@ aocs_fetch_init(Relation relation,
 
 	Assert(proj);
 
+	/*
+	 * Columns that may lack rows are fetched after a column that has all
+	 * rows, which tells whether the row exists.
+	 */
+	if (tupleDesc->constr != NULL && tupleDesc->constr->missing != NULL)
+	{
+		AttrNumber *proj_atts = palloc(tupleDesc->natts * sizeof(AttrNumber));
+		AttrNumber	num_proj_atts = 0;
+
+		for (colno = 0; colno < tupleDesc->natts; colno++)
+		{
+			if (proj[colno])
+				proj_atts[num_proj_atts++] = colno;
+		}
+
+		aocsFetchDesc->added = aocs_added_columns(tupleDesc, proj_atts,
+												  num_proj_atts);
+		if (aocsFetchDesc->added != NULL)
+		{
+			AttrNumber	row_attno;
+
+			row_attno = aocs_choose_row_column(tupleDesc, aocsFetchDesc->added,
+											   proj_atts, num_proj_atts);
+			if (!proj[row_attno])
+			{
+				proj = memcpy(palloc(tupleDesc->natts * sizeof(bool)), proj,
+							  tupleDesc->natts * sizeof(bool));
+				proj[row_attno] = true;
+			}
+		}
+		pfree(proj_atts);
+	}
+
     bool checksum;
     Oid visimaprelid;
     Oid visimapidxid;
@@ -1548,6 +2471,8 @@ aocs_fetch_init(Relation relation,
 									   relation->rd_rel->relname.data,
 									    /* title */ titleBuf.data,
 									   &relation->rd_node);
+			AppendOnlyStorageRead_EnableBlockCache(
+				&aocsFetchDesc->datumStreamFetchDesc[colno]->datumStream->ao_read);
 
 		}
 		if (opts[colno])
@@ -1555,6 +2480,20 @@ aocs_fetch_init(Relation relation,
 	}
 	if (opts)
 		pfree(opts);
+
+	aocsFetchDesc->fetchAtts = palloc(relation->rd_att->natts * sizeof(AttrNumber));
+	aocsFetchDesc->numFetchAtts = 0;
+	for (int lacksRows = 0; lacksRows <= 1; lacksRows++)
+	{
+		for (colno = 0; colno < relation->rd_att->natts; colno++)
+		{
+			if (proj[colno] &&
+				(aocsFetchDesc->added != NULL &&
+				 aocsFetchDesc->added[colno].lacksRows) == lacksRows)
+				aocsFetchDesc->fetchAtts[aocsFetchDesc->numFetchAtts++] = colno;
+		}
+	}
+
 	AppendOnlyVisimap_Init(&aocsFetchDesc->visibilityMap,
 						   visimaprelid,
 						   visimapidxid,
@@ -1579,7 +2518,6 @@ aocs_fetch(AOCSFetchDesc aocsFetchDesc,
 	int			segmentFileNum = AOTupleIdGet_segmentFileNum(aoTupleId);
 	int64		rowNum = AOTupleIdGet_rowNum(aoTupleId);
 	int			numCols = aocsFetchDesc->relation->rd_att->natts;
-	int			colno;
 	bool		found = true;
 	bool		isSnapshotAny = (aocsFetchDesc->snapshot == SnapshotAny);
 
@@ -1608,13 +2546,12 @@ aocs_fetch(AOCSFetchDesc aocsFetchDesc,
 	 * requested tuple. If so, fetch it. Otherwise, read the block that
 	 * contains the requested tuple.
 	 */
-	for (colno = 0; colno < numCols; colno++)
+	for (AttrNumber i = 0; i < aocsFetchDesc->numFetchAtts; i++)
 	{
+		AttrNumber	colno = aocsFetchDesc->fetchAtts[i];
 		DatumStreamFetchDesc datumStreamFetchDesc = aocsFetchDesc->datumStreamFetchDesc[colno];
-
-		/* If this column does not need to be fetched, skip it. */
-		if (datumStreamFetchDesc == NULL)
-			continue;
+		bool		lacksRows = (aocsFetchDesc->added != NULL &&
+								 aocsFetchDesc->added[colno].lacksRows);
 
 		elogif(Debug_appendonly_print_datumstream, LOG,
 			   "aocs_fetch filePathName %s segno %u rowNum  " INT64_FORMAT
@@ -1711,6 +2648,16 @@ aocs_fetch(AOCSFetchDesc aocsFetchDesc,
 									  segmentFileNum,
 									  colno))
 			{
+				/*
+				 * A column that may lack rows has no data in the segment
+				 * file yet, while an earlier column found the row.
+				 */
+				if (lacksRows)
+				{
+					fetchMissingValue(aocsFetchDesc, slot, colno);
+					continue;
+				}
+
 				found = false;
 				/* Segment file not in aoseg table.. */
 				/* Must be aborted or deleted and reclaimed. */
@@ -1729,6 +2676,13 @@ aocs_fetch(AOCSFetchDesc aocsFetchDesc,
 											   colno,
 											   &datumStreamFetchDesc->currentBlock.blockDirectoryEntry))
 		{
+			/* The column was added after the row was inserted */
+			if (lacksRows)
+			{
+				fetchMissingValue(aocsFetchDesc, slot, colno);
+				continue;
+			}
+
 			found = false;		/* Row not represented in Block Directory. */
 			/* Must be aborted or deleted and reclaimed. */
 			break;
@@ -1758,7 +2712,7 @@ aocs_fetch(AOCSFetchDesc aocsFetchDesc,
 	{
 		if (slot != NULL)
 		{
-			slot->tts_nvalid = colno;
+			slot->tts_nvalid = numCols;
 			slot->tts_tid = *(ItemPointer)(aoTupleId);
 		}
 	}
@@ -1792,6 +2746,9 @@ aocs_fetch_finish(AOCSFetchDesc aocsFetchDesc)
 		}
 	}
 	pfree(aocsFetchDesc->datumStreamFetchDesc);
+	pfree(aocsFetchDesc->fetchAtts);
+	if (aocsFetchDesc->added)
+		pfree(aocsFetchDesc->added);
 
 	AppendOnlyBlockDirectory_End_forSearch(&aocsFetchDesc->blockDirectory);
 
@@ -2363,6 +3320,38 @@ aocs_col_predicate_test(AOCSScanDesc scan, TupleTableSlot *slot, int i, bool sam
 {
 	bool predicate_pass = true;
 	int attno = scan->columnScanInfo.proj_atts[i];
+	AOCSDictQualCache *cache = NULL;
+	int32 code = -1;
+
+	/*
+	 * If the column's block is dictionary encoded, the qual may already have
+	 * been evaluated for the same value.
+	 */
+	if (scan->aos_dict_qual && scan->aos_dict_qual[attno].results)
+	{
+		DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+
+		code = datumstreamread_dict_code(ds);
+		if (code >= MAXDICTIONARY_COUNT)
+			code = -1;
+		if (code >= 0)
+		{
+			cache = &scan->aos_dict_qual[attno];
+			if (cache->dict_generation != ds->blockRead.dict_generation)
+			{
+				memset(cache->results, 0,
+					   Min(ds->blockRead.dict_count, MAXDICTIONARY_COUNT));
+				cache->dict_generation = ds->blockRead.dict_generation;
+			}
+			else if (cache->results[code] != 0)
+			{
+				predicate_pass = (cache->results[code] == 2);
+				if (predicate_pass && sample_phase)
+					++scan->aos_qual_rows[i];
+				return predicate_pass;
+			}
+		}
+	}
 
 	/*
 	 * place the current tuple into the expr context
@@ -2384,9 +3373,29 @@ aocs_col_predicate_test(AOCSScanDesc scan, TupleTableSlot *slot, int i, bool sam
 	slot->tts_flags = orig_flag;
 	ResetExprContext(scan->aos_pushdown_econtext);
 
+	if (cache)
+		cache->results[code] = predicate_pass ? 2 : 1;
+
 	return predicate_pass;
 }
 
+/*
+ * Set up evaluating the pushed down qual of column attno once per value of
+ * dictionary encoded blocks, if its result only depends on the value.
+ */
+static void
+aocs_dict_qual_prepare(AOCSScanDesc scan, int attno, Node *qual)
+{
+	Form_pg_attribute attr = TupleDescAttr(RelationGetDescr(scan->rs_base.rs_rd), attno);
+
+	/* Only variable-length columns are dictionary encoded */
+	if (attr->attlen != -1 || contain_volatile_functions(qual))
+		return;
+
+	scan->aos_dict_qual[attno].dict_generation = 0;
+	scan->aos_dict_qual[attno].results = palloc0(MAXDICTIONARY_COUNT);
+}
+
 static void
 move_attr_forward(AOCSScanDesc scan, int attrno, int pos)
 {
@@ -2434,6 +3443,17 @@ aocs_predicate_pushdown_prepare(AOCSScanDesc scan,
 {
 	int  ncol  = scan->rs_base.rs_rd->rd_att->natts;
 
+	/*
+	 * Columns that may lack rows are only read along with the row numbers,
+	 * the quals can't be evaluated on them ahead of the other columns.
+	 */
+	for (int i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
+	{
+		if (aocs_column_may_lack_rows(scan->rs_base.rs_rd->rd_att,
+									  scan->columnScanInfo.proj_atts[i]))
+			return state;
+	}
+
 	List **qual_list = (List **)palloc0(sizeof(List *) * ncol);
 	/* alloc qual array */
 	scan->aos_qual_col_num      = 0;
@@ -2442,9 +3462,15 @@ aocs_predicate_pushdown_prepare(AOCSScanDesc scan,
 	scan->aos_sample_rows       = gp_predicate_pushdown_sample_rows;
 	scan->aos_scaned_rows       = 0;
 	scan->aos_qual_rows         = (int *)palloc0(sizeof(int) * ncol);
+	scan->aos_dict_qual         = (AOCSDictQualCache *)palloc0(sizeof(AOCSDictQualCache) * ncol);
 
 	if (!qual)
 		return state;
+
+	scan->aos_zonemap = AOZoneMap_BeginScan(scan->rs_base.rs_rd,
+											scan->appendOnlyMetaDataSnapshot,
+											qual);
+
 	bool *proj = palloc0(ncol * sizeof(bool));
 	int num_qual_atts = 0;
 	int *qual_atts    = palloc(ncol * sizeof(int));
@@ -2465,6 +3491,7 @@ aocs_predicate_pushdown_prepare(AOCSScanDesc scan,
 		Assert(scan->aos_pushdown_qual[0] == NULL);
 		scan->aos_pushdown_qual[0] = state;
 		scan->aos_qual_col_num = 1;
+		aocs_dict_qual_prepare(scan, qual_atts[0], (Node *) qual);
 
 		/* The whole qual can be pushed down, so no left qual with seqscan node. */
 		return NULL;
@@ -2537,11 +3564,79 @@ aocs_predicate_pushdown_prepare(AOCSScanDesc scan,
 	{
 		Assert(qual_list[i]);
 		scan->aos_pushdown_qual[i] = ExecInitQual(qual_list[i], ps);
+		aocs_dict_qual_prepare(scan, scan->columnScanInfo.proj_atts[i],
+							   (Node *) qual_list[i]);
 	}
 	scan->aos_qual_col_num = qual_attr_num;
 	return ExecInitQual(quals_in_scan, ps);
 }
 
+/*
+ * Apply the runtime filter of a hash join to the scan: skip the blocks whose
+ * zone maps are out of the range of the join's inner keys, and test the
+ * bloom filter as a pushed down qual of the join key column, ahead of the
+ * column's other quals.  Its place among the qual columns then follows its
+ * selectivity, like theirs.
+ *
+ * Once the scan has started, a column that is not read for every row can't
+ * become a qual column, since aocs_getnextbatch() only reads such columns
+ * for the rows that passed the quals.  The bloom filter is left to the
+ * RuntimeFilter node then, unless there are no quals yet and all columns
+ * are read for every row.  It is also left there without predicate
+ * pushdown.
+ */
+void
+aocs_runtime_filter_pushdown(AOCSScanDesc scan, ScanRuntimeFilter *filter,
+							 bool started)
+{
+	int			pos;
+
+	if (filter->has_range)
+		scan->aos_zonemap = AOZoneMap_AddRange(scan->aos_zonemap,
+											   scan->rs_base.rs_rd,
+											   scan->appendOnlyMetaDataSnapshot,
+											   filter->attno,
+											   filter->range_typid,
+											   filter->range_min,
+											   filter->range_max);
+
+	if (filter->bf == NULL || scan->aos_pushdown_qual == NULL)
+		return;
+
+	for (pos = 0; pos < scan->columnScanInfo.num_proj_atts; pos++)
+	{
+		if (scan->columnScanInfo.proj_atts[pos] == filter->attno)
+			break;
+	}
+	if (pos == scan->columnScanInfo.num_proj_atts)
+		return;
+
+	if (pos < scan->aos_qual_col_num)
+	{
+		AOCSDictQualCache *cache = &scan->aos_dict_qual[filter->attno];
+
+		scan->aos_pushdown_qual[pos] =
+			ExecInitRuntimeFilterScanQual(filter, scan->aos_pushdown_qual[pos]);
+
+		/* forget the results of the qual without the filter */
+		if (cache->results)
+			memset(cache->results, 0, MAXDICTIONARY_COUNT);
+	}
+	else if (!started || scan->aos_qual_col_num == 0)
+	{
+		pos = scan->aos_qual_col_num;
+		move_attr_forward(scan, filter->attno, pos);
+		scan->aos_pushdown_qual[pos] = ExecInitRuntimeFilterScanQual(filter, NULL);
+		scan->aos_qual_rows[pos] = 0;
+		aocs_dict_qual_prepare(scan, filter->attno, NULL);
+		scan->aos_qual_col_num++;
+	}
+	else
+		return;
+
+	filter->bloom_in_scan = true;
+}
+
 struct qual_sort_item {
 	int aos_qual_rows;
 	int proj_atts;
@@ -2687,6 +3782,14 @@ ReadNext:
 					rowNum = scan->columnScanInfo.ds[attno]->blockFirstRowNum +
 						datumstreamread_nth(scan->columnScanInfo.ds[attno]);
 				}
+				if (rowNum != INT64CONST(-1) && past_cur_part(scan, rowNum))
+				{
+					/* Done with the part, go to the next one */
+					close_cur_scan_seg(scan);
+					rowNum = INT64CONST(-1);
+					err = -1;
+					goto ReadNext;
+				}
 				scan->cur_seg_row++;
 				if (rowNum == INT64CONST(-1))
 				{
@@ -15,6 +15,7 @@
 #include "postgres.h"
 
 #include "access/aomd.h"
+#include "access/appendonly_sortkey.h"
 #include "access/appendonlywriter.h"
 #include "access/heapam.h"
 #include "access/multixact.h"
@@ -29,6 +30,7 @@
 #include "catalog/storage.h"
 #include "catalog/storage_xlog.h"
 #include "cdb/cdbaocsam.h"
+#include "cdb/cdbappendonlyblockcache.h"
 #include "cdb/cdbvars.h"
 #include "commands/progress.h"
 #include "commands/vacuum.h"
@@ -90,6 +92,8 @@ typedef struct AOCODMLState
 	AOCSInsertDesc	insertDesc;
 	dlist_head		head; // Head of multiple segment files insertion list.
 	AOCSDeleteDesc	deleteDesc;
+	AppendOnlySortKey *sortKey;	/* valid if sortKeyLoaded */
+	bool			sortKeyLoaded;
 } AOCODMLState;
 
 static void reset_state_cb(void *arg);
@@ -189,6 +193,8 @@ enter_dml_state(const Oid relationOid)
 
 	state->insertDesc = NULL;
 	state->deleteDesc = NULL;
+	state->sortKey = NULL;
+	state->sortKeyLoaded = false;
 	dlist_init(&state->head);
 
 	Assert(!found);
@@ -354,6 +360,30 @@ get_insert_descriptor(const Relation relation)
 }
 
 
+/*
+ * Retrieve the sort key of a relation, or NULL if it has none.  It is read
+ * once per DML state.
+ */
+static AppendOnlySortKey *
+get_sort_key(const Relation relation)
+{
+	AOCODMLState *state;
+
+	state = find_dml_state(RelationGetRelid(relation));
+
+	if (!state->sortKeyLoaded)
+	{
+		MemoryContext oldcxt;
+
+		oldcxt = MemoryContextSwitchTo(aocoLocal.stateCxt);
+		state->sortKey = appendonly_sortkey_create(relation);
+		MemoryContextSwitchTo(oldcxt);
+		state->sortKeyLoaded = true;
+	}
+
+	return state->sortKey;
+}
+
 /*
  * Retrieve the deleteDescriptor for a relation. Initialize it if needed.
  */
@@ -603,13 +633,69 @@ aoco_rescan(TableScanDesc scan, ScanKey key,
 		aocs_rescan(aoscan);
 }
 
+/*
+ * Return the next row of the batch read ahead by aocs_getnextbatch(), reading
+ * a new batch when the current one is used up.
+ */
+static bool
+aoco_getnextslot_batch(AOCSScanDesc aoscan, ScanDirection direction, TupleTableSlot *slot)
+{
+	AOCSBatch	batch = aoscan->batch;
+	int			row;
+
+	if (batch == NULL)
+	{
+		MemoryContext oldcxt;
+
+		oldcxt = MemoryContextSwitchTo(aoscan->columnScanInfo.scanCtx);
+		batch = aocs_create_batch(slot->tts_tupleDescriptor,
+								  gp_aocs_scan_batch_size);
+		MemoryContextSwitchTo(oldcxt);
+		aoscan->batch = batch;
+	}
+
+	if (batch->next >= batch->nrows &&
+		aocs_getnextbatch(aoscan, direction, batch, slot) == 0)
+		return false;
+
+	row = batch->next++;
+	for (AttrNumber i = 0; i < aoscan->columnScanInfo.num_proj_atts; i++)
+	{
+		AttrNumber	attno = aoscan->columnScanInfo.proj_atts[i];
+
+		slot->tts_values[attno] = batch->values[attno][row];
+		slot->tts_isnull[attno] = batch->isnull[attno][row];
+	}
+
+	aoscan->cdb_fake_ctid = *((ItemPointer) &batch->tids[row]);
+	slot->tts_nvalid = slot->tts_tupleDescriptor->natts;
+	slot->tts_tid = aoscan->cdb_fake_ctid;
+
+	return true;
+}
+
 static bool
 aoco_getnextslot(TableScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
 {
 	AOCSScanDesc  aoscan = (AOCSScanDesc)scan;
+	bool		found;
 
 	ExecClearTuple(slot);
-	if (aocs_getnext(aoscan, direction, slot))
+
+	/*
+	 * Decode the columns a batch of rows at a time when nothing needs to
+	 * look at the rows one by one while they are read.  Once a scan has
+	 * started reading batches it has to stay with them, the datum streams
+	 * are positioned past the rows of the current batch.
+	 */
+	if (aoscan->batch != NULL ||
+		(gp_aocs_scan_batch_size > 0 &&
+		 aocs_can_getnextbatch(aoscan, slot->tts_tupleDescriptor)))
+		found = aoco_getnextslot_batch(aoscan, direction, slot);
+	else
+		found = aocs_getnext(aoscan, direction, slot);
+
+	if (found)
 	{
 		ExecStoreVirtualTuple(slot);
 		pgstat_count_heap_getnext(aoscan->rs_base.rs_rd);
@@ -694,17 +780,19 @@ aoco_index_fetch_end(IndexFetchTableData *scan)
 		pfree(aocoscan->proj);
 		aocoscan->proj = NULL;
 	}
+
+	if (aocoscan->batchslot)
+	{
+		ExecDropSingleTupleTableSlot(aocoscan->batchslot);
+		aocoscan->batchslot = NULL;
+	}
 	pfree(aocoscan);
 }
 
-static bool
-aoco_index_fetch_tuple(struct IndexFetchTableData *scan,
-                             ItemPointer tid,
-                             Snapshot snapshot,
-                             TupleTableSlot *slot,
-                             bool *call_again, bool *all_dead)
+static void
+aoco_index_fetch_init(IndexFetchAOCOData *aocoscan, Snapshot snapshot)
 {
-	IndexFetchAOCOData *aocoscan = (IndexFetchAOCOData *) scan;
+	IndexFetchTableData *scan = &aocoscan->xs_base;
 
 	if (!aocoscan->aocofetch)
 	{
@@ -739,6 +827,18 @@ aoco_index_fetch_tuple(struct IndexFetchTableData *scan,
 	 * programming error in case of occurrence.
 	 */
 	Assert(aocoscan->aocofetch->snapshot == snapshot);
+}
+
+static bool
+aoco_index_fetch_tuple(struct IndexFetchTableData *scan,
+                             ItemPointer tid,
+                             Snapshot snapshot,
+                             TupleTableSlot *slot,
+                             bool *call_again, bool *all_dead)
+{
+	IndexFetchAOCOData *aocoscan = (IndexFetchAOCOData *) scan;
+
+	aoco_index_fetch_init(aocoscan, snapshot);
 
 	ExecClearTuple(slot);
 
@@ -751,6 +851,72 @@ aoco_index_fetch_tuple(struct IndexFetchTableData *scan,
 	return false;
 }
 
+static int
+aoco_index_fetch_batch_cmp(const void *a, const void *b, void *arg)
+{
+	ItemPointer tids = (ItemPointer) arg;
+
+	return ItemPointerCompare(&tids[*(const int *) a], &tids[*(const int *) b]);
+}
+
+/*
+ * Fetches the rows of a batch of index TIDs in (segno, row number) order,
+ * which is the order of their TIDs.  Rows of the same varblock then follow
+ * each other, so aocs_fetch() finds each column's block through the block
+ * directory and decompresses it only once, instead of once per visit in
+ * index order.
+ */
+static void
+aoco_index_fetch_batch(struct IndexFetchTableData *scan,
+					   ItemPointer tids, int ntids,
+					   Snapshot snapshot,
+					   MinimalTuple *tuples)
+{
+	IndexFetchAOCOData *aocoscan = (IndexFetchAOCOData *) scan;
+	MemoryContext tuplecxt = CurrentMemoryContext;
+	MemoryContext oldcxt;
+	int		   *order;
+
+	/*
+	 * The tuples go to the caller's context, which is reset for every
+	 * batch, but the fetch descriptor has to outlive it.
+	 */
+	oldcxt = MemoryContextSwitchTo(GetMemoryChunkContext(aocoscan));
+
+	aoco_index_fetch_init(aocoscan, snapshot);
+
+	if (!aocoscan->batchslot)
+		aocoscan->batchslot =
+			MakeSingleTupleTableSlot(RelationGetDescr(scan->rel),
+									 &TTSOpsVirtual);
+
+	order = palloc(ntids * sizeof(int));
+	for (int i = 0; i < ntids; i++)
+		order[i] = i;
+	qsort_arg(order, ntids, sizeof(int), aoco_index_fetch_batch_cmp, tids);
+
+	for (int i = 0; i < ntids; i++)
+	{
+		int			j = order[i];
+		TupleTableSlot *slot = aocoscan->batchslot;
+
+		ExecClearTuple(slot);
+		if (aocs_fetch(aocoscan->aocofetch, (AOTupleId *) &tids[j], slot))
+		{
+			ExecStoreVirtualTuple(slot);
+			MemoryContextSwitchTo(tuplecxt);
+			tuples[j] = ExecCopySlotMinimalTuple(slot);
+			MemoryContextSwitchTo(GetMemoryChunkContext(aocoscan));
+		}
+		else
+			tuples[j] = NULL;
+	}
+
+	pfree(order);
+
+	MemoryContextSwitchTo(oldcxt);
+}
+
 static void
 aoco_tuple_insert(Relation relation, TupleTableSlot *slot, CommandId cid,
                         int options, BulkInsertState bistate)
@@ -787,21 +953,37 @@ aoco_tuple_complete_speculative(Relation relation, TupleTableSlot *slot,
  * This is like aoco_tuple_insert(), but inserts multiple tuples in one
  * operation. Typicaly used by COPY. This is preferrable than calling
  * aoco_tuple_insert() in a loop because ... WAL??
+ *
+ * If the relation has a sort key, the tuples are written in its order.
  */
 static void
 aoco_multi_insert(Relation relation, TupleTableSlot **slots, int ntuples,
                         CommandId cid, int options, BulkInsertState bistate)
 {
 	AOCSInsertDesc insertDesc;
+	AppendOnlySortKey *sortKey;
+	int		   *order = NULL;
+
 	insertDesc = get_insert_descriptor(relation);
+	sortKey = get_sort_key(relation);
+	if (sortKey)
+	{
+		order = palloc(ntuples * sizeof(int));
+		appendonly_sortkey_order(sortKey, slots, ntuples, order);
+	}
 
 	for (int i = 0; i < ntuples; i++)
 	{
-		slot_getallattrs(slots[i]);
-		aocs_insert_values(insertDesc, slots[i]->tts_values, slots[i]->tts_isnull, (AOTupleId *) &slots[i]->tts_tid);
+		TupleTableSlot *slot = slots[order ? order[i] : i];
+
+		slot_getallattrs(slot);
+		aocs_insert_values(insertDesc, slot->tts_values, slot->tts_isnull, (AOTupleId *) &slot->tts_tid);
 	}
 
 	pgstat_count_heap_insert(relation, ntuples);
+
+	if (order)
+		pfree(order);
 }
 
 static TM_Result
@@ -1039,6 +1221,7 @@ aoco_relation_nontransactional_truncate(Relation rel)
 	Oid			aoblkdir_relid = InvalidOid;
 	Oid			aovisimap_relid = InvalidOid;
 
+	AppendOnlyBlockCache_ForgetRelFileNode(&rel->rd_node);
 	ao_truncate_one_rel(rel);
 
 	/* Also truncate the aux tables */
@@ -1964,6 +2147,7 @@ static TableAmRoutine ao_column_methods = {
 	.index_fetch_reset = aoco_index_fetch_reset,
 	.index_fetch_end = aoco_index_fetch_end,
 	.index_fetch_tuple = aoco_index_fetch_tuple,
+	.index_fetch_batch = aoco_index_fetch_batch,
 
 	.tuple_insert = aoco_tuple_insert,
 	.tuple_insert_speculative = aoco_tuple_insert_speculative,
@@ -408,7 +408,7 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 	compact_segno = fsinfo->segno;
 	if (fsinfo->varblockcount > 0)
 	{
-		tuplePerPage = fsinfo->total_tupcount / fsinfo->varblockcount;
+		tuplePerPage = Max(fsinfo->total_tupcount / fsinfo->varblockcount, 1);
 	}
 	relname = RelationGetRelationName(aorel);
 
@@ -488,6 +488,12 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 		tupleCount++;
 		if (VacuumCostActive && tupleCount % tuplePerPage == 0)
 		{
+			/*
+			 * Segment files bypass the buffer manager, so charge the block
+			 * read and the block written here, for vacuum_cost_delay to
+			 * throttle the compaction.
+			 */
+			VacuumCostBalance += VacuumCostPageMiss + VacuumCostPageDirty;
 			vacuum_delay_point();
 		}
 	}
@@ -759,8 +765,10 @@ AppendOptimizedTruncateToEOF(Relation aorel)
  *
  * The caller is required to hold either an AccessExclusiveLock (vacuum full)
  * or a ShareLock on the relation.
+ *
+ * Returns true if the segment file was compacted.
  */
-void
+bool
 AppendOnlyCompact(Relation aorel,
 				  int compaction_segno,
 				  int *insert_segno,
@@ -771,6 +779,7 @@ AppendOnlyCompact(Relation aorel,
 	AppendOnlyInsertDesc insertDesc = NULL;
 	FileSegInfo *fsinfo;
 	Snapshot	appendOnlyMetaDataSnapshot = RegisterSnapshot(GetCatalogSnapshot(InvalidOid));
+	bool		compacted = false;
 
 	Assert(RelationIsAoRows(aorel));
 	Assert(Gp_role == GP_ROLE_EXECUTE || Gp_role == GP_ROLE_UTILITY);
@@ -799,6 +808,7 @@ AppendOnlyCompact(Relation aorel,
 
 			insertDesc->skipModCountIncrement = true;
 			appendonly_insert_finish(insertDesc, NULL);
+			compacted = true;
 		}
 		else
 		{
@@ -812,4 +822,6 @@ AppendOnlyCompact(Relation aorel,
 	pfree(fsinfo);
 
 	UnregisterSnapshot(appendOnlyMetaDataSnapshot);
+
+	return compacted;
 }
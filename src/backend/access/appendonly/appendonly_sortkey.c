@@ -0,0 +1,451 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_sortkey.c
+ *   ordering of the rows of a bulk load by a declared sort key.
+ *
+ * The sort key is read from the table's "sortkey" and "sortmethod" storage
+ * options once per statement, by the first multi_insert call of a DML
+ * state.  Each batch is then sorted on its own, in memory: the rows are
+ * already formed in the caller's slots, and the caller needs every slot's
+ * tuple id back to insert index entries and fire triggers, so rows can not
+ * be held back for a later batch.  COPY buffers at most 1000 rows or 64kB
+ * per batch, so a load is ordered only within each such window, not as a
+ * whole.
+ *
+ * Z-order values are computed from ranks within the batch rather than from
+ * the values themselves.  That works for every type with a btree ordering
+ * operator, and spreads the bits evenly over the key columns no matter how
+ * skewed their values are.
+ *
+ * Portions Copyright (c) 2023-Present, Cloudberry inc
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/access/appendonly/appendonly_sortkey.c
+ *
+ *------------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/appendonly_sortkey.h"
+#include "access/reloptions.h"
+#include "access/table.h"
+#include "catalog/indexing.h"
+#include "catalog/pg_class.h"
+#include "nodes/makefuncs.h"
+#include "parser/parse_oper.h"
+#include "port/pg_bitutils.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
+#include "utils/guc.h"
+#include "utils/rel.h"
+#include "utils/syscache.h"
+#include "utils/varlena.h"
+
+/* Z-order values are 64 bits wide, so at most 64 key columns. */
+#define AO_SORTKEY_MAX_KEYS		64
+
+typedef struct AOSortState
+{
+	AppendOnlySortKey *sortkey;
+	TupleTableSlot **slots;
+	int			key;			/* the key compared by compare_one_key() */
+	uint64	   *zvalues;		/* per slot, for compare_zorder() */
+} AOSortState;
+
+static List *
+split_sortkey_columns(const char *value)
+{
+	char	   *rawstring = pstrdup(value);
+	List	   *names;
+
+	if (!SplitIdentifierString(rawstring, ',', &names) || names == NIL)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid value for \"sortkey\" option: \"%s\"", value),
+				 errdetail("Valid values are comma separated lists of column names.")));
+
+	if (list_length(names) > AO_SORTKEY_MAX_KEYS)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("\"sortkey\" option can name at most %d columns",
+						AO_SORTKEY_MAX_KEYS)));
+
+	return names;
+}
+
+/*
+ * Validation callbacks of the "sortkey" and "sortmethod" reloptions.  The
+ * column names can only be checked against the table when it is loaded;
+ * renaming and dropping the columns of a sort key is handled by
+ * appendonly_sortkey_rename_column() and appendonly_sortkey_has_column().
+ */
+void
+appendonly_sortkey_validate_columns(const char *value)
+{
+	if (value)
+		(void) split_sortkey_columns(value);
+}
+
+void
+appendonly_sortkey_validate_method(const char *value)
+{
+	if (value &&
+		pg_strcasecmp(value, AO_SORTMETHOD_LINEAR) != 0 &&
+		pg_strcasecmp(value, AO_SORTMETHOD_ZORDER) != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid value for \"sortmethod\" option: \"%s\"", value),
+				 errdetail("Valid values are \"%s\" and \"%s\".",
+						   AO_SORTMETHOD_LINEAR, AO_SORTMETHOD_ZORDER)));
+}
+
+/*
+ * Read the "sortkey" and "sortmethod" options of a relation from pg_class.
+ *
+ * The relcache parses the reloptions of every table as a heap's, which
+ * leaves out the options only append-optimized tables have, so they are
+ * parsed here again.  Returns NULL if the relation has no sort key.
+ */
+static char *
+get_sortkey_option(Relation rel, char **method)
+{
+	HeapTuple	tuple;
+	Datum		datum;
+	bool		isnull;
+	StdRdOptions *opts = NULL;
+	char	   *columns = NULL;
+
+	if (method)
+		*method = NULL;
+
+	tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(RelationGetRelid(rel)));
+	if (!HeapTupleIsValid(tuple))
+		elog(ERROR, "cache lookup failed for relation %u",
+			 RelationGetRelid(rel));
+
+	datum = SysCacheGetAttr(RELOID, tuple, Anum_pg_class_reloptions, &isnull);
+	if (!isnull)
+		opts = (StdRdOptions *) default_reloptions(datum, false,
+												   RELOPT_KIND_APPENDOPTIMIZED);
+	if (opts && opts->sortkey != 0)
+	{
+		columns = pstrdup((char *) opts + opts->sortkey);
+		if (method && opts->sortmethod != 0)
+			*method = pstrdup((char *) opts + opts->sortmethod);
+	}
+	ReleaseSysCache(tuple);
+
+	return columns;
+}
+
+/*
+ * Build the sort key of a relation, or return NULL if it has none.
+ *
+ * The result is allocated in the current memory context, which must last
+ * as long as the caller uses it.
+ */
+AppendOnlySortKey *
+appendonly_sortkey_create(Relation rel)
+{
+	char	   *columns;
+	char	   *method;
+	AppendOnlySortKey *sortkey;
+	List	   *names;
+	ListCell   *lc;
+	int			i;
+
+	columns = get_sortkey_option(rel, &method);
+	if (columns == NULL)
+		return NULL;
+
+	names = split_sortkey_columns(columns);
+
+	sortkey = palloc0(sizeof(AppendOnlySortKey));
+	sortkey->method = (method && pg_strcasecmp(method, AO_SORTMETHOD_ZORDER) == 0) ?
+		AOSortMethodZOrder : AOSortMethodLinear;
+	sortkey->nkeys = list_length(names);
+	sortkey->attnums = palloc(sortkey->nkeys * sizeof(AttrNumber));
+	sortkey->ssup = palloc0(sortkey->nkeys * sizeof(SortSupportData));
+
+	i = 0;
+	foreach(lc, names)
+	{
+		char	   *name = (char *) lfirst(lc);
+		AttrNumber	attnum = get_attnum(RelationGetRelid(rel), name);
+		Form_pg_attribute attr;
+		Oid			ltOpr;
+		SortSupport ssup = &sortkey->ssup[i];
+
+		if (attnum <= 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_COLUMN),
+					 errmsg("column \"%s\" named in \"sortkey\" option of relation \"%s\" does not exist",
+							name, RelationGetRelationName(rel))));
+
+		attr = TupleDescAttr(RelationGetDescr(rel), attnum - 1);
+		get_sort_group_operators(attr->atttypid, true, false, false,
+								 &ltOpr, NULL, NULL, NULL);
+
+		ssup->ssup_cxt = CurrentMemoryContext;
+		ssup->ssup_collation = attr->attcollation;
+		ssup->ssup_nulls_first = false;
+		ssup->ssup_attno = attnum;
+		PrepareSortSupportFromOrderingOp(ltOpr, ssup);
+
+		sortkey->attnums[i] = attnum;
+		sortkey->maxattnum = Max(sortkey->maxattnum, attnum);
+		i++;
+	}
+
+	return sortkey;
+}
+
+/*
+ * Is the column named in the sort key of a relation?
+ *
+ * The sort key names its columns, so ALTER TABLE DROP COLUMN uses this to
+ * refuse to drop one, rather than leave a sort key that fails every load.
+ */
+bool
+appendonly_sortkey_has_column(Relation rel, const char *colname)
+{
+	char	   *columns = get_sortkey_option(rel, NULL);
+	ListCell   *lc;
+
+	if (columns == NULL)
+		return false;
+
+	foreach(lc, split_sortkey_columns(columns))
+	{
+		if (strcmp((char *) lfirst(lc), colname) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Follow ALTER TABLE RENAME COLUMN in the "sortkey" option of a relation.
+ *
+ * If the renamed column is part of the sort key, the option is written back
+ * to pg_class with the new name, each name quoted as needed.
+ */
+void
+appendonly_sortkey_rename_column(Relation rel, const char *oldname,
+								 const char *newname)
+{
+	char	   *columns = get_sortkey_option(rel, NULL);
+	StringInfoData buf;
+	ListCell   *lc;
+	bool		found = false;
+	Relation	pgclass;
+	HeapTuple	tuple;
+	HeapTuple	newtuple;
+	Datum		datum;
+	bool		isnull;
+	Datum		repl_val[Natts_pg_class];
+	bool		repl_null[Natts_pg_class];
+	bool		repl_repl[Natts_pg_class];
+
+	if (columns == NULL)
+		return;
+
+	initStringInfo(&buf);
+	foreach(lc, split_sortkey_columns(columns))
+	{
+		char	   *name = (char *) lfirst(lc);
+
+		if (strcmp(name, oldname) == 0)
+		{
+			name = (char *) newname;
+			found = true;
+		}
+		if (buf.len > 0)
+			appendStringInfoChar(&buf, ',');
+		appendStringInfoString(&buf, quote_identifier(name));
+	}
+
+	if (!found)
+		return;
+
+	pgclass = table_open(RelationRelationId, RowExclusiveLock);
+
+	tuple = SearchSysCacheCopy1(RELOID, ObjectIdGetDatum(RelationGetRelid(rel)));
+	if (!HeapTupleIsValid(tuple))
+		elog(ERROR, "cache lookup failed for relation %u",
+			 RelationGetRelid(rel));
+
+	datum = SysCacheGetAttr(RELOID, tuple, Anum_pg_class_reloptions, &isnull);
+	datum = transformRelOptions(isnull ? (Datum) 0 : datum,
+								list_make1(makeDefElem(SOPT_SORTKEY,
+													   (Node *) makeString(buf.data),
+													   -1)),
+								NULL, NULL, false, false);
+
+	memset(repl_val, 0, sizeof(repl_val));
+	memset(repl_null, false, sizeof(repl_null));
+	memset(repl_repl, false, sizeof(repl_repl));
+	repl_val[Anum_pg_class_reloptions - 1] = datum;
+	repl_repl[Anum_pg_class_reloptions - 1] = true;
+
+	newtuple = heap_modify_tuple(tuple, RelationGetDescr(pgclass),
+								 repl_val, repl_null, repl_repl);
+	CatalogTupleUpdate(pgclass, &newtuple->t_self, newtuple);
+
+	heap_freetuple(newtuple);
+	heap_freetuple(tuple);
+	table_close(pgclass, RowExclusiveLock);
+}
+
+static inline int
+compare_key(AOSortState *state, int key, int a, int b)
+{
+	TupleTableSlot *sa = state->slots[a];
+	TupleTableSlot *sb = state->slots[b];
+	int			off = state->sortkey->attnums[key] - 1;
+
+	return ApplySortComparator(sa->tts_values[off], sa->tts_isnull[off],
+							   sb->tts_values[off], sb->tts_isnull[off],
+							   &state->sortkey->ssup[key]);
+}
+
+/*
+ * Ties keep the order the rows arrived in, which keeps the sort stable.
+ */
+static int
+compare_one_key(const void *a, const void *b, void *arg)
+{
+	AOSortState *state = (AOSortState *) arg;
+	int			ia = *(const int *) a;
+	int			ib = *(const int *) b;
+	int			cmp;
+
+	cmp = compare_key(state, state->key, ia, ib);
+	if (cmp != 0)
+		return cmp;
+
+	return (ia > ib) - (ia < ib);
+}
+
+static int
+compare_linear(const void *a, const void *b, void *arg)
+{
+	AOSortState *state = (AOSortState *) arg;
+	int			ia = *(const int *) a;
+	int			ib = *(const int *) b;
+
+	for (int key = 0; key < state->sortkey->nkeys; key++)
+	{
+		int			cmp = compare_key(state, key, ia, ib);
+
+		if (cmp != 0)
+			return cmp;
+	}
+
+	return (ia > ib) - (ia < ib);
+}
+
+static int
+compare_zorder(const void *a, const void *b, void *arg)
+{
+	AOSortState *state = (AOSortState *) arg;
+	uint64		za = state->zvalues[*(const int *) a];
+	uint64		zb = state->zvalues[*(const int *) b];
+
+	if (za != zb)
+		return (za > zb) ? 1 : -1;
+
+	return compare_linear(a, b, arg);
+}
+
+/*
+ * Compute the Z-order value of every row of the batch.
+ *
+ * A row's rank in a key column is the number of rows with a smaller value,
+ * so equal values have equal ranks and NULLs rank last.  Ranks need as many
+ * bits as it takes to count the batch; when the key columns together need
+ * more than 64 bits, only the high bits of each rank are used.  The bits
+ * are interleaved from the most significant down, the first key column's
+ * bit first.
+ */
+static void
+compute_zvalues(AOSortState *state, int nslots)
+{
+	AppendOnlySortKey *sortkey = state->sortkey;
+	int			nkeys = sortkey->nkeys;
+	int			rankbits = pg_leftmost_one_pos32(nslots - 1) + 1;
+	int			keybits = Min(rankbits, 64 / nkeys);
+	uint32	   *ranks = palloc(nkeys * nslots * sizeof(uint32));
+	int		   *sorted = palloc(nslots * sizeof(int));
+
+	for (int key = 0; key < nkeys; key++)
+	{
+		uint32	   *keyranks = &ranks[key * nslots];
+
+		for (int i = 0; i < nslots; i++)
+			sorted[i] = i;
+		state->key = key;
+		qsort_arg(sorted, nslots, sizeof(int), compare_one_key, state);
+
+		keyranks[sorted[0]] = 0;
+		for (int i = 1; i < nslots; i++)
+		{
+			if (compare_key(state, key, sorted[i - 1], sorted[i]) == 0)
+				keyranks[sorted[i]] = keyranks[sorted[i - 1]];
+			else
+				keyranks[sorted[i]] = i;
+		}
+	}
+
+	for (int i = 0; i < nslots; i++)
+	{
+		uint64		z = 0;
+
+		for (int bit = rankbits - 1; bit >= rankbits - keybits; bit--)
+		{
+			for (int key = 0; key < nkeys; key++)
+				z = (z << 1) | ((ranks[key * nslots + i] >> bit) & 1);
+		}
+		state->zvalues[i] = z;
+	}
+
+	pfree(sorted);
+	pfree(ranks);
+}
+
+/*
+ * Fill order[] with the indexes of slots[] in the order the rows are to be
+ * written.  The slots themselves are left in place, since the caller keeps
+ * per slot information by index.
+ */
+void
+appendonly_sortkey_order(AppendOnlySortKey *sortkey, TupleTableSlot **slots,
+						 int nslots, int *order)
+{
+	AOSortState state;
+
+	for (int i = 0; i < nslots; i++)
+	{
+		order[i] = i;
+		slot_getsomeattrs(slots[i], sortkey->maxattnum);
+	}
+
+	if (nslots < 2)
+		return;
+
+	state.sortkey = sortkey;
+	state.slots = slots;
+	state.key = 0;
+	state.zvalues = NULL;
+
+	if (sortkey->method == AOSortMethodZOrder && sortkey->nkeys > 1)
+	{
+		state.zvalues = palloc(nslots * sizeof(uint64));
+		compute_zvalues(&state, nslots);
+		qsort_arg(order, nslots, sizeof(int), compare_zorder, &state);
+		pfree(state.zvalues);
+	}
+	else
+		qsort_arg(order, nslots, sizeof(int), compare_linear, &state);
+}
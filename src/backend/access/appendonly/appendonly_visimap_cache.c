@@ -0,0 +1,402 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_visimap_cache.c
+ *   shared memory cache of decoded visimap entries.
+ *
+ * Every scan of an append-optimized table looks up the visimap entry of each
+ * range of rows it reads, which costs an index scan on the visimap relation
+ * and the decompression of the bitmap.  Concurrent scans of a table that has
+ * seen large deletes redo that work over and over, so the decoded bitmaps
+ * are kept in a fixed number of shared memory slots, replaced with the clock
+ * algorithm, and keyed by the visimap relation's relfilenode, the segment
+ * file and the first row number of the entry.
+ *
+ * A cached entry has to be right for every snapshot that looks it up, so
+ * only a visimap tuple version that is visible to all transactions, and has
+ * not been updated or deleted, is cached.  Every write of a visimap entry
+ * removes it from the cache and bumps the cache generation; an entry read
+ * from the visimap relation is only added if the generation has not changed
+ * since the lookup began, so that a version about to be replaced does not
+ * slip back in.
+ *
+ * Portions Copyright (c) 2023-Present, Cloudberry inc
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/access/appendonly/appendonly_visimap_cache.c
+ *
+ *------------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/appendonly_visimap.h"
+#include "access/appendonly_visimap_cache.h"
+#include "access/htup_details.h"
+#include "access/transam.h"
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+#include "storage/procarray.h"
+#include "storage/shmem.h"
+#include "utils/hsearch.h"
+
+/* GUC: number of visimap entries kept in shared memory, 0 disables caching */
+int			gp_appendonly_visimap_cache_size = 1024;
+
+#define VISIMAP_CACHE_MAX_WORDS \
+	(APPENDONLY_VISIMAP_MAX_BITMAP_SIZE / sizeof(bitmapword))
+
+typedef struct VisimapCacheKey
+{
+	RelFileNode node;			/* of the visimap relation */
+	int32		segmentFileNum;
+	int64		firstRowNum;
+} VisimapCacheKey;
+
+typedef struct VisimapCacheLookupEnt
+{
+	VisimapCacheKey key;
+	int			slot;			/* index into VisimapCacheCtl.slots */
+} VisimapCacheLookupEnt;
+
+typedef struct VisimapCacheSlot
+{
+	VisimapCacheKey key;
+	bool		inUse;
+	pg_atomic_uint32 usage;		/* set by lookups, cleared by the clock hand */
+	ItemPointerData tupleTid;	/* of the cached visimap tuple */
+	int			nwords;
+	bitmapword	words[VISIMAP_CACHE_MAX_WORDS];
+} VisimapCacheSlot;
+
+typedef struct VisimapCacheCtl
+{
+	uint64		generation;		/* bumped by every invalidation */
+	int			clockHand;		/* next slot to consider for replacement */
+	VisimapCacheSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} VisimapCacheCtl;
+
+/*
+ * Both are protected by AOVisimapCacheLock.  Lookups take it in shared mode,
+ * anything that changes the cache in exclusive mode.
+ */
+static VisimapCacheCtl *visimapCache = NULL;
+static HTAB *visimapCacheHash = NULL;
+
+static void
+VisimapCache_InitKey(VisimapCacheKey *key, Relation visimapRelation,
+					 int32 segmentFileNum, int64 firstRowNum)
+{
+	memset(key, 0, sizeof(VisimapCacheKey));
+	key->node = visimapRelation->rd_node;
+	key->segmentFileNum = segmentFileNum;
+	key->firstRowNum = firstRowNum;
+}
+
+static void
+VisimapCache_RemoveSlot(int slot)
+{
+	VisimapCacheSlot *s = &visimapCache->slots[slot];
+
+	Assert(s->inUse);
+	hash_search(visimapCacheHash, &s->key, HASH_REMOVE, NULL);
+	s->inUse = false;
+}
+
+Size
+AppendOnlyVisimapCache_ShmemSize(void)
+{
+	Size		size;
+
+	if (gp_appendonly_visimap_cache_size == 0)
+		return 0;
+
+	size = offsetof(VisimapCacheCtl, slots);
+	size = add_size(size, mul_size(gp_appendonly_visimap_cache_size,
+								   sizeof(VisimapCacheSlot)));
+	size = add_size(size, hash_estimate_size(gp_appendonly_visimap_cache_size,
+											 sizeof(VisimapCacheLookupEnt)));
+
+	return size;
+}
+
+void
+AppendOnlyVisimapCache_ShmemInit(void)
+{
+	HASHCTL		info;
+	bool		found;
+
+	if (gp_appendonly_visimap_cache_size == 0)
+		return;
+
+	visimapCache = ShmemInitStruct("AO visimap cache",
+								   add_size(offsetof(VisimapCacheCtl, slots),
+											mul_size(gp_appendonly_visimap_cache_size,
+													 sizeof(VisimapCacheSlot))),
+								   &found);
+	if (!found)
+	{
+		visimapCache->generation = 0;
+		visimapCache->clockHand = 0;
+		for (int i = 0; i < gp_appendonly_visimap_cache_size; i++)
+		{
+			visimapCache->slots[i].inUse = false;
+			pg_atomic_init_u32(&visimapCache->slots[i].usage, 0);
+		}
+	}
+
+	info.keysize = sizeof(VisimapCacheKey);
+	info.entrysize = sizeof(VisimapCacheLookupEnt);
+	visimapCacheHash = ShmemInitHash("AO visimap cache lookup",
+									 gp_appendonly_visimap_cache_size,
+									 gp_appendonly_visimap_cache_size,
+									 &info,
+									 HASH_ELEM | HASH_BLOBS);
+}
+
+/*
+ * Positions the visimap entry at the cached entry for the given segment file
+ * and first row number, if there is one.  Returns false otherwise.
+ */
+bool
+AppendOnlyVisimapCache_Lookup(Relation visimapRelation,
+							  int32 segmentFileNum,
+							  int64 firstRowNum,
+							  AppendOnlyVisimapEntry *visiMapEntry)
+{
+	VisimapCacheKey key;
+	VisimapCacheLookupEnt *ent;
+	VisimapCacheSlot *s;
+	Bitmapset  *bitmap = NULL;
+
+	if (visimapCache == NULL)
+		return false;
+
+	VisimapCache_InitKey(&key, visimapRelation, segmentFileNum, firstRowNum);
+
+	LWLockAcquire(AOVisimapCacheLock, LW_SHARED);
+
+	ent = hash_search(visimapCacheHash, &key, HASH_FIND, NULL);
+	if (ent == NULL)
+	{
+		LWLockRelease(AOVisimapCacheLock);
+		return false;
+	}
+
+	s = &visimapCache->slots[ent->slot];
+	pg_atomic_write_u32(&s->usage, 1);
+
+	/* Allocate while holding the lock is fine, an error releases it */
+	if (s->nwords > 0)
+	{
+		bitmap = MemoryContextAlloc(visiMapEntry->memoryContext,
+									offsetof(Bitmapset, words) +
+									s->nwords * sizeof(bitmapword));
+		bitmap->nwords = s->nwords;
+		memcpy(bitmap->words, s->words, s->nwords * sizeof(bitmapword));
+	}
+	ItemPointerCopy(&s->tupleTid, &visiMapEntry->tupleTid);
+
+	LWLockRelease(AOVisimapCacheLock);
+
+	bms_free(visiMapEntry->bitmap);
+	visiMapEntry->bitmap = bitmap;
+	visiMapEntry->segmentFileNum = segmentFileNum;
+	visiMapEntry->firstRowNum = firstRowNum;
+	visiMapEntry->dirty = false;
+
+	return true;
+}
+
+/*
+ * Returns the current cache generation.  Take it before reading a visimap
+ * entry that is to be added to the cache.
+ */
+uint64
+AppendOnlyVisimapCache_GetGeneration(void)
+{
+	uint64		generation;
+
+	if (visimapCache == NULL)
+		return 0;
+
+	LWLockAcquire(AOVisimapCacheLock, LW_SHARED);
+	generation = visimapCache->generation;
+	LWLockRelease(AOVisimapCacheLock);
+
+	return generation;
+}
+
+/*
+ * May the given visimap tuple be cached?  It must be visible to every
+ * transaction, now and later: inserted by a transaction older than any
+ * snapshot still in use, including distributed ones, and neither updated nor
+ * deleted since.
+ */
+bool
+AppendOnlyVisimapCache_IsCacheable(Relation visimapRelation, HeapTuple tuple)
+{
+	HeapTupleHeader htup = tuple->t_data;
+
+	if (visimapCache == NULL || RelationUsesLocalBuffers(visimapRelation))
+		return false;
+
+	if (!(htup->t_infomask & HEAP_XMAX_INVALID) &&
+		!HEAP_XMAX_IS_LOCKED_ONLY(htup->t_infomask))
+		return false;
+
+	return TransactionIdPrecedes(HeapTupleHeaderGetXmin(htup),
+								 GetOldestNonRemovableTransactionId(visimapRelation));
+}
+
+/*
+ * Adds the visimap entry, just read from the visimap relation, to the cache,
+ * unless the cache has been invalidated since 'generation' was taken.
+ */
+void
+AppendOnlyVisimapCache_Insert(Relation visimapRelation,
+							  uint64 generation,
+							  AppendOnlyVisimapEntry *visiMapEntry)
+{
+	VisimapCacheKey key;
+	VisimapCacheLookupEnt *ent;
+	VisimapCacheSlot *s;
+	Bitmapset  *bitmap = visiMapEntry->bitmap;
+	int			nwords = bitmap ? bitmap->nwords : 0;
+	bool		found;
+
+	if (visimapCache == NULL || nwords > VISIMAP_CACHE_MAX_WORDS)
+		return;
+
+	VisimapCache_InitKey(&key, visimapRelation,
+						 visiMapEntry->segmentFileNum, visiMapEntry->firstRowNum);
+
+	LWLockAcquire(AOVisimapCacheLock, LW_EXCLUSIVE);
+
+	if (visimapCache->generation != generation)
+	{
+		LWLockRelease(AOVisimapCacheLock);
+		return;
+	}
+
+	ent = hash_search(visimapCacheHash, &key, HASH_FIND, NULL);
+	if (ent == NULL)
+	{
+		int			slot;
+
+		/* Find a slot to replace with the clock algorithm */
+		for (;;)
+		{
+			slot = visimapCache->clockHand;
+			visimapCache->clockHand = (slot + 1) % gp_appendonly_visimap_cache_size;
+			s = &visimapCache->slots[slot];
+
+			if (!s->inUse)
+				break;
+			if (pg_atomic_read_u32(&s->usage) == 0)
+			{
+				VisimapCache_RemoveSlot(slot);
+				break;
+			}
+			pg_atomic_write_u32(&s->usage, 0);
+		}
+
+		ent = hash_search(visimapCacheHash, &key, HASH_ENTER_NULL, &found);
+		if (ent == NULL)
+		{
+			LWLockRelease(AOVisimapCacheLock);
+			return;
+		}
+		Assert(!found);
+		ent->slot = slot;
+	}
+
+	s = &visimapCache->slots[ent->slot];
+	s->key = key;
+	s->inUse = true;
+	pg_atomic_write_u32(&s->usage, 1);
+	ItemPointerCopy(&visiMapEntry->tupleTid, &s->tupleTid);
+	s->nwords = nwords;
+	if (nwords > 0)
+		memcpy(s->words, bitmap->words, nwords * sizeof(bitmapword));
+
+	LWLockRelease(AOVisimapCacheLock);
+}
+
+/*
+ * Removes the entry of the given segment file and first row number from the
+ * cache, or all entries of the segment file if firstRowNum is -1.  Called
+ * for every write to the visimap relation, before it is committed.
+ */
+void
+AppendOnlyVisimapCache_Invalidate(Relation visimapRelation,
+								  int32 segmentFileNum,
+								  int64 firstRowNum)
+{
+	if (visimapCache == NULL)
+		return;
+
+	LWLockAcquire(AOVisimapCacheLock, LW_EXCLUSIVE);
+
+	visimapCache->generation++;
+
+	if (firstRowNum >= 0)
+	{
+		VisimapCacheKey key;
+		VisimapCacheLookupEnt *ent;
+
+		VisimapCache_InitKey(&key, visimapRelation, segmentFileNum, firstRowNum);
+		ent = hash_search(visimapCacheHash, &key, HASH_FIND, NULL);
+		if (ent != NULL)
+			VisimapCache_RemoveSlot(ent->slot);
+	}
+	else
+	{
+		for (int i = 0; i < gp_appendonly_visimap_cache_size; i++)
+		{
+			VisimapCacheSlot *s = &visimapCache->slots[i];
+
+			if (s->inUse &&
+				RelFileNodeEquals(s->key.node, visimapRelation->rd_node) &&
+				s->key.segmentFileNum == segmentFileNum)
+				VisimapCache_RemoveSlot(i);
+		}
+	}
+
+	LWLockRelease(AOVisimapCacheLock);
+}
+
+/*
+ * Forgets all entries of the given relation files, which are being dropped.
+ * Otherwise a later relation that happens to get the same relfilenode could
+ * find them.
+ */
+void
+AppendOnlyVisimapCache_ForgetRelFileNodes(RelFileNodeBackend *rnodes,
+										  int nnodes)
+{
+	if (visimapCache == NULL)
+		return;
+
+	LWLockAcquire(AOVisimapCacheLock, LW_EXCLUSIVE);
+
+	visimapCache->generation++;
+
+	for (int i = 0; i < gp_appendonly_visimap_cache_size; i++)
+	{
+		VisimapCacheSlot *s = &visimapCache->slots[i];
+
+		if (!s->inUse)
+			continue;
+
+		for (int j = 0; j < nnodes; j++)
+		{
+			if (RelFileNodeEquals(s->key.node, rnodes[j].node))
+			{
+				VisimapCache_RemoveSlot(i);
+				break;
+			}
+		}
+	}
+
+	LWLockRelease(AOVisimapCacheLock);
+}
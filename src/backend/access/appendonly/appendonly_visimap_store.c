@@ -14,6 +14,7 @@
 */
 #include "postgres.h"
 
+#include "access/appendonly_visimap_cache.h"
 #include "access/genam.h"
 #include "access/table.h"
 #include "catalog/aovisimap.h"
@@ -27,6 +28,10 @@
 
 #define APPENDONLY_VISIMAP_INDEX_SCAN_KEY_NUM 2
 
+static HeapTuple AppendOnlyVisimapStore_GetNextTuple(AppendOnlyVisimapStore *visiMapStore,
+													 SysScanDesc indexScan,
+													 ScanDirection scanDirection);
+
 /*
  * Frees the data allocated by the visimap store
  *
@@ -160,6 +165,10 @@ AppendOnlyVisimapStore_Store(
 
 	MemoryContextSwitchTo(oldContext);
 
+	AppendOnlyVisimapCache_Invalidate(visimapRelation,
+									  visiMapEntry->segmentFileNum,
+									  visiMapEntry->firstRowNum);
+
 	/* Invalidate the data after storing it. */
 	ItemPointerSetInvalid(&visiMapEntry->tupleTid);
 }
@@ -186,6 +195,9 @@ AppendOnlyVisimapStore_Find(AppendOnlyVisimapStore *visiMapStore,
 {
 	ScanKey		scanKeys;
 	SysScanDesc indexScan;
+	HeapTuple	tuple;
+	bool		useCache;
+	uint64		cacheGeneration = 0;
 
 	Assert(visiMapStore);
 	Assert(visiMapEntry);
@@ -197,6 +209,19 @@ AppendOnlyVisimapStore_Find(AppendOnlyVisimapStore *visiMapStore,
 		   "(segFileNum, firstRowNum) = (%u, " INT64_FORMAT ")",
 		   segmentFileNum, firstRowNum);
 
+	/*
+	 * Entries in the shared cache are visible to every MVCC snapshot, see
+	 * appendonly_visimap_cache.c.
+	 */
+	useCache = IsMVCCSnapshot(visiMapStore->snapshot);
+	if (useCache &&
+		AppendOnlyVisimapCache_Lookup(visiMapStore->visimapRelation,
+									  segmentFileNum, firstRowNum,
+									  visiMapEntry))
+		return true;
+	if (useCache)
+		cacheGeneration = AppendOnlyVisimapCache_GetGeneration();
+
 	scanKeys = visiMapStore->scanKeys;
 	scanKeys[0].sk_argument = Int32GetDatum(segmentFileNum);
 	scanKeys[1].sk_argument = Int64GetDatum(firstRowNum);
@@ -205,12 +230,9 @@ AppendOnlyVisimapStore_Find(AppendOnlyVisimapStore *visiMapStore,
 												 APPENDONLY_VISIMAP_INDEX_SCAN_KEY_NUM,
 												 scanKeys);
 
-	if (!AppendOnlyVisimapStore_GetNext(
-										visiMapStore,
-										indexScan,
-										BackwardScanDirection,
-										visiMapEntry,
-										&visiMapEntry->tupleTid))
+	tuple = AppendOnlyVisimapStore_GetNextTuple(visiMapStore, indexScan,
+												BackwardScanDirection);
+	if (tuple == NULL)
 	{
 		elogif(Debug_appendonly_print_visimap, LOG,
 			   "Append-only visi map store: Visimap entry does not exist: "
@@ -221,6 +243,16 @@ AppendOnlyVisimapStore_Find(AppendOnlyVisimapStore *visiMapStore,
 		AppendOnlyVisimapStore_EndScan(visiMapStore, indexScan);
 		return false;
 	}
+
+	AppendOnlyVisimapEntry_Copyout(visiMapEntry, tuple,
+								   RelationGetDescr(visiMapStore->visimapRelation));
+	ItemPointerCopy(&tuple->t_self, &visiMapEntry->tupleTid);
+
+	if (useCache &&
+		AppendOnlyVisimapCache_IsCacheable(visiMapStore->visimapRelation, tuple))
+		AppendOnlyVisimapCache_Insert(visiMapStore->visimapRelation,
+									  cacheGeneration, visiMapEntry);
+
 	AppendOnlyVisimapStore_EndScan(visiMapStore, indexScan);
 	return true;
 }
@@ -328,6 +360,9 @@ AppendOnlyVisimapStore_DeleteSegmentFile(AppendOnlyVisimapStore *visiMapStore,
 		CatalogTupleDelete(visiMapStore->visimapRelation, &tid);
 	}
 	AppendOnlyVisimapStore_EndScan(visiMapStore, indexScan);
+
+	AppendOnlyVisimapCache_Invalidate(visiMapStore->visimapRelation,
+									  segmentFileNum, -1);
 }
 
 /*
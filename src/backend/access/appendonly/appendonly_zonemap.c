@@ -0,0 +1,849 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_zonemap.c
+ *   per-block min/max summaries ("zone maps") for append-optimized tables.
+ *
+ * The write side is driven by the inserting code: it feeds every value of
+ * a summarized column into an AOZoneMapBuildState, and hands the state to
+ * the block directory when the block is finished (see
+ * AppendOnlyBlockDirectory_InsertZoneMapEntry()).
+ *
+ * The read side turns the simple predicates of a scan qual into per-column
+ * ranges, loads the zone map entries of each segment file it scans, and
+ * tells the scan which rows can be skipped because the block they are in
+ * can not contain a qualifying row.  Blocks without a zone map entry, e.g.
+ * blocks written before the block directory existed, are never skipped.
+ *
+ * Portions Copyright (c) 2023-Present, Cloudberry inc
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/access/appendonly/appendonly_zonemap.c
+ *
+ *------------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/appendonly_zonemap.h"
+#include "access/genam.h"
+#include "access/nbtree.h"
+#include "access/table.h"
+#include "catalog/aoblkdir.h"
+#include "catalog/pg_am.h"
+#include "catalog/pg_appendonly.h"
+#include "catalog/pg_type.h"
+#include "commands/defrem.h"
+#include "nodes/nodeFuncs.h"
+#include "utils/array.h"
+#include "utils/date.h"
+#include "utils/fmgroids.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/timestamp.h"
+
+bool		gp_appendonly_enable_zonemap = true;
+
+/*
+ * The range a column's values must fall in for a row to qualify, combined
+ * from all the simple clauses on that column, plus the zone map entries of
+ * the segment file currently being scanned.
+ */
+typedef struct AOZoneMapScanKey
+{
+	AttrNumber	attno;			/* zero based */
+	Oid			typid;
+
+	bool		wantNull;		/* IS NULL */
+	bool		wantNotNull;	/* IS NOT NULL, or any comparison */
+
+	bool		hasLower;
+	bool		lowerStrict;
+	int64		lower;
+
+	bool		hasUpper;
+	bool		upperStrict;
+	int64		upper;
+
+	AOZoneMapEntry *entries;
+	int			numEntries;
+	int			cursor;
+} AOZoneMapScanKey;
+
+typedef struct AOZoneMapScanData
+{
+	Relation	rel;
+	Snapshot	snapshot;
+
+	Oid			blkdirrelid;
+	Oid			blkdiridxid;
+
+	/* holds the entries of the current segment file, reset for each one */
+	MemoryContext segmentContext;
+	int			segno;
+
+	/* rows in [validFrom, validUntil) are known not to be skippable */
+	int64		validFrom;
+	int64		validUntil;
+
+	int			numKeys;
+	AOZoneMapScanKey *keys;
+} AOZoneMapScanData;
+
+/*
+ * The zone maps store values of the different types in one int64 domain
+ * each; only constants of the same domain can be compared against them.
+ */
+static int
+zonemap_domain(Oid typid)
+{
+	switch (typid)
+	{
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+			return INT8OID;
+		case DATEOID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			return typid;
+		default:
+			return InvalidOid;
+	}
+}
+
+bool
+AOZoneMap_TypeIsSupported(Oid typid)
+{
+	return OidIsValid(zonemap_domain(getBaseType(typid)));
+}
+
+int64
+AOZoneMap_DatumToInt64(Oid typid, Datum value)
+{
+	switch (typid)
+	{
+		case INT2OID:
+			return (int64) DatumGetInt16(value);
+		case INT4OID:
+			return (int64) DatumGetInt32(value);
+		case INT8OID:
+			return DatumGetInt64(value);
+		case DATEOID:
+			return (int64) DatumGetDateADT(value);
+		case TIMESTAMPOID:
+			return (int64) DatumGetTimestamp(value);
+		case TIMESTAMPTZOID:
+			return (int64) DatumGetTimestampTz(value);
+		default:
+			elog(ERROR, "type %u is not supported by zone maps", typid);
+			return 0;			/* keep compiler quiet */
+	}
+}
+
+/*
+ * AOZoneMap_CreateBuildStates
+ *
+ * Allocate one build state per attribute of tupdesc.  Attributes that are
+ * not summarized get an InvalidOid typid.  Returns NULL, and sets
+ * *nsummarized to 0, if no attribute is summarized at all.
+ */
+AOZoneMapBuildState *
+AOZoneMap_CreateBuildStates(TupleDesc tupdesc, int *nsummarized)
+{
+	AOZoneMapBuildState *states;
+	int			i;
+
+	*nsummarized = 0;
+
+	if (!gp_appendonly_enable_zonemap)
+		return NULL;
+
+	states = palloc0(sizeof(AOZoneMapBuildState) * tupdesc->natts);
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+		Oid			typid = InvalidOid;
+
+		if (!attr->attisdropped && AOZoneMap_TypeIsSupported(attr->atttypid))
+		{
+			typid = getBaseType(attr->atttypid);
+			(*nsummarized)++;
+		}
+		AOZoneMap_InitBuildState(&states[i], typid);
+	}
+
+	if (*nsummarized == 0)
+	{
+		pfree(states);
+		return NULL;
+	}
+
+	return states;
+}
+
+void
+AOZoneMap_InitBuildState(AOZoneMapBuildState *state, Oid typid)
+{
+	state->typid = typid;
+	AOZoneMap_ResetBuildState(state);
+}
+
+void
+AOZoneMap_ResetBuildState(AOZoneMapBuildState *state)
+{
+	state->rowCount = 0;
+	state->nullCount = 0;
+	state->minValue = 0;
+	state->maxValue = 0;
+}
+
+/*
+ * Strip the binary-compatible relabeling that the planner puts on top of
+ * Vars of domain types.
+ */
+static Node *
+strip_relabel(Node *node)
+{
+	while (node && IsA(node, RelabelType))
+		node = (Node *) ((RelabelType *) node)->arg;
+	return node;
+}
+
+/*
+ * Find the key for the column referenced by var, creating it if needed.
+ * Returns NULL if the column can not be used with zone maps.
+ */
+static AOZoneMapScanKey *
+get_scan_key(AOZoneMapScanData *zmscan, TupleDesc tupdesc, Node *node)
+{
+	Var		   *var;
+	Form_pg_attribute attr;
+	AOZoneMapScanKey *key;
+	int			i;
+
+	node = strip_relabel(node);
+	if (node == NULL || !IsA(node, Var))
+		return NULL;
+
+	var = (Var *) node;
+	if (var->varattno <= 0 || var->varattno > tupdesc->natts ||
+		var->varlevelsup != 0)
+		return NULL;
+
+	attr = TupleDescAttr(tupdesc, var->varattno - 1);
+	if (attr->attisdropped || !AOZoneMap_TypeIsSupported(attr->atttypid))
+		return NULL;
+
+	for (i = 0; i < zmscan->numKeys; i++)
+	{
+		if (zmscan->keys[i].attno == var->varattno - 1)
+			return &zmscan->keys[i];
+	}
+
+	key = &zmscan->keys[zmscan->numKeys++];
+	MemSet(key, 0, sizeof(AOZoneMapScanKey));
+	key->attno = var->varattno - 1;
+	key->typid = getBaseType(attr->atttypid);
+
+	return key;
+}
+
+static void
+key_add_lower(AOZoneMapScanKey *key, int64 value, bool strict)
+{
+	key->wantNotNull = true;
+	if (!key->hasLower || value > key->lower ||
+		(value == key->lower && strict))
+	{
+		key->hasLower = true;
+		key->lower = value;
+		key->lowerStrict = strict;
+	}
+}
+
+static void
+key_add_upper(AOZoneMapScanKey *key, int64 value, bool strict)
+{
+	key->wantNotNull = true;
+	if (!key->hasUpper || value < key->upper ||
+		(value == key->upper && strict))
+	{
+		key->hasUpper = true;
+		key->upper = value;
+		key->upperStrict = strict;
+	}
+}
+
+/*
+ * Look up the btree strategy of opno in the default btree operator family
+ * of the column's type, so that only operators with the usual ordering
+ * semantics are used.
+ */
+static int
+key_op_strategy(AOZoneMapScanKey *key, Oid opno)
+{
+	Oid			opclass = GetDefaultOpClass(key->typid, BTREE_AM_OID);
+
+	if (!OidIsValid(opclass))
+		return InvalidStrategy;
+
+	return get_op_opfamily_strategy(opno, get_opclass_family(opclass));
+}
+
+static void
+add_opexpr(AOZoneMapScanData *zmscan, TupleDesc tupdesc, OpExpr *opexpr)
+{
+	AOZoneMapScanKey *key;
+	Node	   *leftop;
+	Node	   *rightop;
+	Const	   *con;
+	bool		commuted = false;
+	int			strategy;
+	int64		value;
+
+	if (list_length(opexpr->args) != 2)
+		return;
+
+	leftop = strip_relabel(linitial(opexpr->args));
+	rightop = strip_relabel(lsecond(opexpr->args));
+
+	if (rightop && IsA(rightop, Const))
+		key = get_scan_key(zmscan, tupdesc, leftop);
+	else if (leftop && IsA(leftop, Const))
+	{
+		key = get_scan_key(zmscan, tupdesc, rightop);
+		rightop = leftop;
+		commuted = true;
+	}
+	else
+		return;
+
+	if (key == NULL)
+		return;
+
+	con = (Const *) rightop;
+	if (con->constisnull ||
+		zonemap_domain(getBaseType(con->consttype)) != zonemap_domain(key->typid))
+		return;
+
+	strategy = key_op_strategy(key, opexpr->opno);
+	if (strategy == InvalidStrategy)
+		return;
+
+	if (commuted)
+	{
+		/* c < x is x > c, and so on */
+		switch (strategy)
+		{
+			case BTLessStrategyNumber:
+				strategy = BTGreaterStrategyNumber;
+				break;
+			case BTLessEqualStrategyNumber:
+				strategy = BTGreaterEqualStrategyNumber;
+				break;
+			case BTGreaterEqualStrategyNumber:
+				strategy = BTLessEqualStrategyNumber;
+				break;
+			case BTGreaterStrategyNumber:
+				strategy = BTLessStrategyNumber;
+				break;
+		}
+	}
+
+	value = AOZoneMap_DatumToInt64(getBaseType(con->consttype), con->constvalue);
+
+	switch (strategy)
+	{
+		case BTLessStrategyNumber:
+			key_add_upper(key, value, true);
+			break;
+		case BTLessEqualStrategyNumber:
+			key_add_upper(key, value, false);
+			break;
+		case BTEqualStrategyNumber:
+			key_add_lower(key, value, false);
+			key_add_upper(key, value, false);
+			break;
+		case BTGreaterEqualStrategyNumber:
+			key_add_lower(key, value, false);
+			break;
+		case BTGreaterStrategyNumber:
+			key_add_lower(key, value, true);
+			break;
+	}
+}
+
+/*
+ * x IN (c1, c2, ...) qualifies only rows between the smallest and the
+ * largest element.
+ */
+static void
+add_saopexpr(AOZoneMapScanData *zmscan, TupleDesc tupdesc,
+			 ScalarArrayOpExpr *saop)
+{
+	AOZoneMapScanKey *key;
+	Const	   *con;
+	ArrayType  *arr;
+	Oid			elemtype;
+	int16		elmlen;
+	bool		elmbyval;
+	char		elmalign;
+	Datum	   *elems;
+	bool	   *nulls;
+	int			nelems;
+	bool		found = false;
+	int64		minValue = 0;
+	int64		maxValue = 0;
+	int			i;
+
+	if (!saop->useOr || list_length(saop->args) != 2)
+		return;
+
+	con = (Const *) strip_relabel(lsecond(saop->args));
+	if (con == NULL || !IsA(con, Const) || con->constisnull)
+		return;
+
+	key = get_scan_key(zmscan, tupdesc, linitial(saop->args));
+	if (key == NULL)
+		return;
+
+	elemtype = get_element_type(con->consttype);
+	if (!OidIsValid(elemtype) ||
+		zonemap_domain(getBaseType(elemtype)) != zonemap_domain(key->typid))
+		return;
+
+	if (key_op_strategy(key, saop->opno) != BTEqualStrategyNumber)
+		return;
+
+	arr = DatumGetArrayTypeP(con->constvalue);
+	get_typlenbyvalalign(elemtype, &elmlen, &elmbyval, &elmalign);
+	deconstruct_array(arr, elemtype, elmlen, elmbyval, elmalign,
+					  &elems, &nulls, &nelems);
+
+	for (i = 0; i < nelems; i++)
+	{
+		int64		value;
+
+		if (nulls[i])
+			continue;
+
+		value = AOZoneMap_DatumToInt64(getBaseType(elemtype), elems[i]);
+		if (!found || value < minValue)
+			minValue = value;
+		if (!found || value > maxValue)
+			maxValue = value;
+		found = true;
+	}
+
+	if (!found)
+		return;
+
+	key_add_lower(key, minValue, false);
+	key_add_upper(key, maxValue, false);
+}
+
+static void
+add_nulltest(AOZoneMapScanData *zmscan, TupleDesc tupdesc, NullTest *ntest)
+{
+	AOZoneMapScanKey *key;
+
+	if (ntest->argisrow)
+		return;
+
+	key = get_scan_key(zmscan, tupdesc, (Node *) ntest->arg);
+	if (key == NULL)
+		return;
+
+	if (ntest->nulltesttype == IS_NULL)
+		key->wantNull = true;
+	else
+		key->wantNotNull = true;
+}
+
+static void
+add_clause(AOZoneMapScanData *zmscan, TupleDesc tupdesc, Node *clause)
+{
+	if (clause == NULL)
+		return;
+
+	switch (nodeTag(clause))
+	{
+		case T_List:
+			{
+				ListCell   *lc;
+
+				foreach(lc, (List *) clause)
+					add_clause(zmscan, tupdesc, lfirst(lc));
+			}
+			break;
+		case T_BoolExpr:
+			if (((BoolExpr *) clause)->boolop == AND_EXPR)
+				add_clause(zmscan, tupdesc, (Node *) ((BoolExpr *) clause)->args);
+			break;
+		case T_OpExpr:
+			add_opexpr(zmscan, tupdesc, (OpExpr *) clause);
+			break;
+		case T_ScalarArrayOpExpr:
+			add_saopexpr(zmscan, tupdesc, (ScalarArrayOpExpr *) clause);
+			break;
+		case T_NullTest:
+			add_nulltest(zmscan, tupdesc, (NullTest *) clause);
+			break;
+		default:
+			/* Anything else can not be used to skip blocks */
+			break;
+	}
+}
+
+/*
+ * Allocate the state of a zone map scan without any keys.  Returns NULL if
+ * zone maps are disabled or the relation has no block directory.
+ */
+static AOZoneMapScanData *
+create_scan(Relation rel, Snapshot snapshot)
+{
+	AOZoneMapScanData *zmscan;
+	Oid			blkdirrelid;
+	Oid			blkdiridxid;
+
+	if (!gp_appendonly_enable_zonemap)
+		return NULL;
+
+	GetAppendOnlyEntryAuxOids(RelationGetRelid(rel), snapshot,
+							  NULL, &blkdirrelid, &blkdiridxid, NULL, NULL);
+	if (!OidIsValid(blkdirrelid))
+		return NULL;
+
+	zmscan = palloc0(sizeof(AOZoneMapScanData));
+	zmscan->keys = palloc0(sizeof(AOZoneMapScanKey) * RelationGetDescr(rel)->natts);
+	zmscan->rel = rel;
+	zmscan->snapshot = snapshot;
+	zmscan->blkdirrelid = blkdirrelid;
+	zmscan->blkdiridxid = blkdiridxid;
+	zmscan->segno = -1;
+	zmscan->validFrom = 0;
+	zmscan->validUntil = 0;
+	zmscan->segmentContext = AllocSetContextCreate(CurrentMemoryContext,
+												   "AOZoneMapSegmentContext",
+												   ALLOCSET_SMALL_SIZES);
+
+	return zmscan;
+}
+
+/*
+ * AOZoneMap_BeginScan
+ *
+ * Prepare to skip blocks of rel that can not satisfy qual, an implicitly
+ * AND-ed list of clauses as found in Plan.qual.
+ *
+ * Returns NULL if zone maps are disabled, if the relation has no block
+ * directory, or if no clause of the qual can be checked against them.  The
+ * returned state is allocated in the current memory context.
+ */
+AOZoneMapScan
+AOZoneMap_BeginScan(Relation rel, Snapshot snapshot, List *qual)
+{
+	AOZoneMapScanData *zmscan;
+
+	if (qual == NIL)
+		return NULL;
+
+	zmscan = create_scan(rel, snapshot);
+	if (zmscan == NULL)
+		return NULL;
+
+	add_clause(zmscan, RelationGetDescr(rel), (Node *) qual);
+
+	if (zmscan->numKeys == 0)
+	{
+		AOZoneMap_EndScan(zmscan);
+		return NULL;
+	}
+
+	return zmscan;
+}
+
+/*
+ * AOZoneMap_AddRange
+ *
+ * Narrow a scan, which may already be under way, to the rows whose column
+ * attno (zero based) is not NULL and lies in [lower, upper].  The bounds are
+ * values of type typid mapped with AOZoneMap_DatumToInt64().  This is how
+ * the range of a hash join's inner keys, known only once its hash table is
+ * built, is applied to the scan of its outer side.
+ *
+ * zmscan may be NULL, in which case a new scan is begun.  Returns the scan
+ * to use from now on, which is NULL if there is none, or zmscan unchanged
+ * if the range can not be checked against the column's zone maps.
+ */
+AOZoneMapScan
+AOZoneMap_AddRange(AOZoneMapScan zmscan, Relation rel, Snapshot snapshot,
+				   AttrNumber attno, Oid typid, int64 lower, int64 upper)
+{
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	Form_pg_attribute attr;
+	AOZoneMapScanKey *key = NULL;
+	int			i;
+
+	if (attno < 0 || attno >= tupdesc->natts)
+		return zmscan;
+
+	attr = TupleDescAttr(tupdesc, attno);
+	if (attr->attisdropped ||
+		!OidIsValid(zonemap_domain(typid)) ||
+		zonemap_domain(getBaseType(attr->atttypid)) != zonemap_domain(typid))
+		return zmscan;
+
+	if (zmscan == NULL)
+	{
+		zmscan = create_scan(rel, snapshot);
+		if (zmscan == NULL)
+			return NULL;
+	}
+
+	for (i = 0; i < zmscan->numKeys; i++)
+	{
+		if (zmscan->keys[i].attno == attno)
+		{
+			key = &zmscan->keys[i];
+			break;
+		}
+	}
+	if (key == NULL)
+	{
+		key = &zmscan->keys[zmscan->numKeys++];
+		MemSet(key, 0, sizeof(AOZoneMapScanKey));
+		key->attno = attno;
+		key->typid = getBaseType(attr->atttypid);
+	}
+
+	key_add_lower(key, lower, false);
+	key_add_upper(key, upper, false);
+
+	/* Load the entries of the new key, and forget what was found skippable */
+	zmscan->segno = -1;
+	zmscan->validFrom = 0;
+	zmscan->validUntil = 0;
+
+	return zmscan;
+}
+
+/*
+ * Load the zone map entries of all keyed columns of one segment file.
+ */
+static void
+load_segment(AOZoneMapScanData *zmscan, int segno)
+{
+	Relation	blkdirRel;
+	Relation	blkdirIdx;
+	TupleDesc	tupdesc;
+	MemoryContext oldcxt;
+	int			i;
+
+	MemoryContextReset(zmscan->segmentContext);
+	zmscan->segno = segno;
+	zmscan->validFrom = 0;
+	zmscan->validUntil = 0;
+
+	blkdirRel = table_open(zmscan->blkdirrelid, AccessShareLock);
+	blkdirIdx = index_open(zmscan->blkdiridxid, AccessShareLock);
+	tupdesc = RelationGetDescr(blkdirRel);
+
+	oldcxt = MemoryContextSwitchTo(zmscan->segmentContext);
+
+	for (i = 0; i < zmscan->numKeys; i++)
+	{
+		AOZoneMapScanKey *key = &zmscan->keys[i];
+		ScanKeyData scanKeys[2];
+		SysScanDesc indexScan;
+		HeapTuple	tuple;
+		int			maxEntries = 0;
+
+		key->entries = NULL;
+		key->numEntries = 0;
+		key->cursor = 0;
+
+		ScanKeyInit(&scanKeys[0],
+					1,			/* segno */
+					BTEqualStrategyNumber,
+					F_INT4EQ,
+					Int32GetDatum(segno));
+		ScanKeyInit(&scanKeys[1],
+					2,			/* columngroup_no */
+					BTEqualStrategyNumber,
+					F_INT4EQ,
+					Int32GetDatum(AOZoneMapColumnGroupNo(key->attno)));
+
+		indexScan = systable_beginscan_ordered(blkdirRel, blkdirIdx,
+											   zmscan->snapshot,
+											   2, scanKeys);
+
+		while ((tuple = systable_getnext_ordered(indexScan, ForwardScanDirection)) != NULL)
+		{
+			bool		isnull;
+			Datum		d;
+			AOZoneMapPage *page;
+
+			d = heap_getattr(tuple, Anum_pg_aoblkdir_minipage, tupdesc, &isnull);
+			Assert(!isnull);
+			page = (AOZoneMapPage *) DatumGetPointer(d);
+
+			/* Pages of an unknown format are not used */
+			if (page->version != AOZoneMapPage_CurrentVersion ||
+				page->nEntry == 0)
+				continue;
+
+			if (key->numEntries + page->nEntry > maxEntries)
+			{
+				maxEntries = Max(maxEntries * 2, key->numEntries + page->nEntry);
+				if (key->entries == NULL)
+					key->entries = palloc(sizeof(AOZoneMapEntry) * maxEntries);
+				else
+					key->entries = repalloc(key->entries,
+											sizeof(AOZoneMapEntry) * maxEntries);
+			}
+
+			memcpy(&key->entries[key->numEntries], page->entry,
+				   sizeof(AOZoneMapEntry) * page->nEntry);
+			key->numEntries += page->nEntry;
+		}
+
+		systable_endscan_ordered(indexScan);
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+
+	index_close(blkdirIdx, AccessShareLock);
+	table_close(blkdirRel, AccessShareLock);
+}
+
+/*
+ * Find the entry of key that covers rowNum.  If there is none, return NULL
+ * and set *nextRowNum to the first row of the next entry.
+ */
+static AOZoneMapEntry *
+find_entry(AOZoneMapScanKey *key, int64 rowNum, int64 *nextRowNum)
+{
+	AOZoneMapEntry *entry;
+
+	/* Scans move forward, except after a rescan */
+	if (key->cursor > 0 && key->cursor < key->numEntries &&
+		key->entries[key->cursor].firstRowNum > rowNum)
+		key->cursor = 0;
+
+	while (key->cursor < key->numEntries)
+	{
+		entry = &key->entries[key->cursor];
+		if (entry->firstRowNum + entry->rowCount > rowNum)
+			break;
+		key->cursor++;
+	}
+
+	if (key->cursor >= key->numEntries)
+	{
+		*nextRowNum = PG_INT64_MAX;
+		return NULL;
+	}
+
+	entry = &key->entries[key->cursor];
+	if (entry->firstRowNum > rowNum)
+	{
+		*nextRowNum = entry->firstRowNum;
+		return NULL;
+	}
+
+	return entry;
+}
+
+/*
+ * Can any row of the block summarized by entry satisfy key?
+ */
+static bool
+entry_may_match(AOZoneMapScanKey *key, AOZoneMapEntry *entry)
+{
+	bool		allNull = (entry->nullCount >= entry->rowCount);
+
+	if (key->wantNull && entry->nullCount == 0)
+		return false;
+
+	if (key->wantNotNull && allNull)
+		return false;
+
+	if (allNull)
+		return true;
+
+	if (key->hasLower &&
+		(key->lowerStrict ? entry->maxValue <= key->lower
+		 : entry->maxValue < key->lower))
+		return false;
+
+	if (key->hasUpper &&
+		(key->upperStrict ? entry->minValue >= key->upper
+		 : entry->minValue > key->upper))
+		return false;
+
+	return true;
+}
+
+/*
+ * AOZoneMap_NextCandidateRow
+ *
+ * Return the first row number >= rowNum in segment file segno that may
+ * satisfy the qual.  When it is larger than rowNum, all rows in between
+ * are known to fail the qual and need not be read.  The result may lie
+ * beyond the end of the segment file.
+ */
+int64
+AOZoneMap_NextCandidateRow(AOZoneMapScan zmscan, int segno, int64 rowNum)
+{
+	int64		candidate = rowNum;
+	int64		validUntil;
+	int			i;
+
+	if (segno != zmscan->segno)
+		load_segment(zmscan, segno);
+
+	if (rowNum >= zmscan->validFrom && rowNum < zmscan->validUntil)
+		return rowNum;
+
+retry:
+	validUntil = PG_INT64_MAX;
+	for (i = 0; i < zmscan->numKeys; i++)
+	{
+		AOZoneMapScanKey *key = &zmscan->keys[i];
+		AOZoneMapEntry *entry;
+		int64		nextRowNum;
+
+		entry = find_entry(key, candidate, &nextRowNum);
+		if (entry == NULL)
+		{
+			validUntil = Min(validUntil, nextRowNum);
+			continue;
+		}
+
+		if (!entry_may_match(key, entry))
+		{
+			candidate = entry->firstRowNum + entry->rowCount;
+			goto retry;
+		}
+
+		validUntil = Min(validUntil, entry->firstRowNum + entry->rowCount);
+	}
+
+	zmscan->validFrom = candidate;
+	zmscan->validUntil = validUntil;
+
+	return candidate;
+}
+
+void
+AOZoneMap_EndScan(AOZoneMapScan zmscan)
+{
+	if (zmscan == NULL)
+		return;
+
+	MemoryContextDelete(zmscan->segmentContext);
+	pfree(zmscan->keys);
+	pfree(zmscan);
+}
@@ -58,6 +58,7 @@
 #include "cdb/cdbvars.h"
 #include "crypto/bufenc.h"
 #include "executor/executor.h"
+#include "executor/nodeRuntimeFilter.h"
 #include "fmgr.h"
 #include "miscadmin.h"
 #include "pgstat.h"
@@ -181,6 +182,49 @@ initscan(AppendOnlyScanDesc scan, ScanKey key)
 	pgstat_count_heap_scan(scan->aos_rd);
 }
 
+/*
+ * Split the segment files into the parts that the participants of a parallel
+ * scan take turns at.  The participants all see the block directory through
+ * the same snapshot, so they agree on the parts without talking to each
+ * other.
+ */
+static void
+SetupParallelScanParts(AppendOnlyScanDesc scan)
+{
+	MemoryContext oldcxt = MemoryContextSwitchTo(scan->aoScanInitContext);
+	int			maxparts = Max(scan->aos_total_segfiles, 1);
+
+	scan->aos_parts = palloc(sizeof(AppendOnlyScanPart) * maxparts);
+	scan->aos_nparts = 0;
+
+	for (int i = 0; i < scan->aos_total_segfiles; i++)
+	{
+		FileSegInfo *fsinfo = scan->aos_segfile_arr[i];
+		AppendOnlyScanPart *parts;
+		int			nparts;
+
+		parts = AppendOnlyBlockDirectory_SplitSegmentFile(scan->aos_rd,
+														  scan->appendOnlyMetaDataSnapshot,
+														  fsinfo->segno,
+														  0,
+														  fsinfo->eof,
+														  i,
+														  &nparts);
+		if (scan->aos_nparts + nparts > maxparts)
+		{
+			maxparts = Max(maxparts * 2, scan->aos_nparts + nparts);
+			scan->aos_parts = repalloc(scan->aos_parts,
+									   sizeof(AppendOnlyScanPart) * maxparts);
+		}
+		memcpy(&scan->aos_parts[scan->aos_nparts], parts,
+			   sizeof(AppendOnlyScanPart) * nparts);
+		scan->aos_nparts += nparts;
+		pfree(parts);
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+}
+
 /*
  * Open the next file segment to scan and allocate all resources needed for it.
  */
@@ -195,6 +239,7 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 	int32		fileSegNo;
 	bool 		isParallel = false;
 	ParallelBlockTableScanDesc pbscan = NULL;
+	AppendOnlyScanPart *part = NULL;
 
 	if (scan->rs_base.rs_parallel != NULL)
 	{
@@ -271,16 +316,32 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 		scan->initedStorageRoutines = true;
 	}
 
+	/*
+	 * A parallel scan hands out parts of the segment files rather than whole
+	 * files when the block directory allows to split them.
+	 */
+	if (isParallel && scan->aos_parts == NULL && scan->blockDirectory == NULL)
+		SetupParallelScanParts(scan);
+
 	/*
 	 * Do we have more segment files to read or are we done?
 	 */
 	int idx; /* fetch segfile idx */
-	while (scan->aos_segfiles_processed < scan->aos_total_segfiles)
+	while (scan->aos_parts != NULL ||
+		   scan->aos_segfiles_processed < scan->aos_total_segfiles)
 	{
+		part = NULL;
 		if (isParallel)
 		{
 			idx = pg_atomic_fetch_add_u64(&pbscan->phs_nallocated, 1);
-			if (idx >= pbscan->phs_nblocks)
+			if (scan->aos_parts != NULL)
+			{
+				if (idx >= scan->aos_nparts)
+					break;
+				part = &scan->aos_parts[idx];
+				idx = part->segfileIndex;
+			}
+			else if (idx >= pbscan->phs_nblocks)
 				break;
 		}
 		else
@@ -369,9 +430,18 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 												   &scan->executorReadBlock,
 												   segno);
 
-	AppendOnlyExecutionReadBlock_SetPositionInfo(
-												 &scan->executorReadBlock,
-												  /* blockFirstRowNum */ 1);
+	if (part != NULL && (part->fileOffset > 0 || part->afterFileOffset < eof))
+	{
+		AppendOnlyStorageRead_SetTemporaryRange(&scan->storageRead,
+												part->fileOffset,
+												part->afterFileOffset);
+		AppendOnlyExecutionReadBlock_SetPositionInfo(&scan->executorReadBlock,
+													 Max(part->firstRowNum, 1));
+	}
+	else
+		AppendOnlyExecutionReadBlock_SetPositionInfo(
+													 &scan->executorReadBlock,
+													  /* blockFirstRowNum */ 1);
 
 	/* ready to go! */
 	scan->aos_need_new_segfile = false;
@@ -1292,19 +1362,51 @@ getNextBlock(AppendOnlyScanDesc scan)
 			return false;
 	}
 
-	if (!AppendOnlyExecutorReadBlock_GetBlockInfo(
-												  &scan->storageRead,
-												  &scan->executorReadBlock))
+	while (true)
 	{
-		if (scan->blockDirectory)
+		AppendOnlyExecutorReadBlock *executorReadBlock = &scan->executorReadBlock;
+		int64		nextRowNum;
+
+		if (!AppendOnlyExecutorReadBlock_GetBlockInfo(
+													  &scan->storageRead,
+													  executorReadBlock))
 		{
-			AppendOnlyBlockDirectory_End_forInsert(scan->blockDirectory);
+			if (scan->blockDirectory)
+			{
+				AppendOnlyBlockDirectory_End_forInsert(scan->blockDirectory);
+			}
+
+			/* done reading the file */
+			CloseScannedFileSeg(scan);
+
+			return false;
 		}
 
-		/* done reading the file */
-		CloseScannedFileSeg(scan);
+		/*
+		 * Skip the block without reading its contents if its zone maps show
+		 * that none of its rows can satisfy the qual.  Never do that while
+		 * building the block directory, which needs to see every block.
+		 */
+		if (scan->aos_zonemap == NULL || scan->blockDirectory != NULL)
+			break;
+
+		nextRowNum = AOZoneMap_NextCandidateRow(scan->aos_zonemap,
+												executorReadBlock->segmentFileNum,
+												executorReadBlock->blockFirstRowNum);
+		if (nextRowNum < executorReadBlock->blockFirstRowNum +
+			executorReadBlock->rowCount)
+			break;
 
-		return false;
+		elogif(Debug_appendonly_print_scan, LOG,
+			   "Append-only scan skipped block by zone map for table '%s' "
+			   "(segment file %d, firstRowNum " INT64_FORMAT ", rowCount %d)",
+			   NameStr(scan->aos_rd->rd_rel->relname),
+			   executorReadBlock->segmentFileNum,
+			   executorReadBlock->blockFirstRowNum,
+			   executorReadBlock->rowCount);
+
+		AppendOnlyStorageRead_SkipCurrentBlock(&scan->storageRead);
+		AppendOnlyExecutionReadBlock_FinishedScanBlock(executorReadBlock);
 	}
 
 	if (scan->blockDirectory)
@@ -1511,6 +1613,23 @@ finishWriteBlock(AppendOnlyInsertDesc aoInsertDesc)
 										 itemCount,
 										 false);
 
+	if (aoInsertDesc->zonemapBuild)
+	{
+		int			natts = RelationGetDescr(aoInsertDesc->aoi_rel)->natts;
+
+		for (int i = 0; i < natts; i++)
+		{
+			if (!OidIsValid(aoInsertDesc->zonemapBuild[i].typid))
+				continue;
+
+			Assert(aoInsertDesc->zonemapBuild[i].rowCount == itemCount);
+			AppendOnlyBlockDirectory_InsertZoneMapEntry(&aoInsertDesc->blockDirectory,
+														i,
+														aoInsertDesc->blockFirstRowNum,
+														&aoInsertDesc->zonemapBuild[i]);
+		}
+	}
+
 	Assert(aoInsertDesc->nonCompressedData == NULL);
 	Assert(!AppendOnlyStorageWrite_IsBufferAllocated(&aoInsertDesc->storageWrite));
 }
@@ -1793,6 +1912,9 @@ appendonly_endscan(TableScanDesc scan)
 		pfree(aoscan->aos_segfile_arr);
 	}
 
+	if (aoscan->aos_parts)
+		pfree(aoscan->aos_parts);
+
 	CloseScannedFileSeg(aoscan);
 
 	AppendOnlyStorageRead_FinishSession(&aoscan->storageRead);
@@ -1811,6 +1933,12 @@ appendonly_endscan(TableScanDesc scan)
 		aoscan->aofetch = NULL;
 	}
 
+	if (aoscan->aos_zonemap)
+	{
+		AOZoneMap_EndScan(aoscan->aos_zonemap);
+		aoscan->aos_zonemap = NULL;
+	}
+
 	/* GPDB should backport this to upstream */
 	if (aoscan->rs_base.rs_flags & SO_TEMP_SNAPSHOT)
 		UnregisterSnapshot(aoscan->rs_base.rs_snapshot);
@@ -1930,6 +2058,8 @@ openFetchSegmentFile(AppendOnlyFetchDesc aoFetchDesc,
 										   logicalEof))
 		return false;
 
+	AppendOnlyStorageRead_SetSegmentFileNum(&aoFetchDesc->storageRead, fileSegNo);
+
 	aoFetchDesc->currentSegmentFile.num = openSegmentFileNum;
 	aoFetchDesc->currentSegmentFile.logicalEof = logicalEof;
 
@@ -2238,6 +2368,7 @@ appendonly_fetch_init(Relation relation,
 							   aoFetchDesc->title,
 							   &aoFetchDesc->storageAttributes,
 							   &relation->rd_node);
+	AppendOnlyStorageRead_EnableBlockCache(&aoFetchDesc->storageRead);
 
 
 	fns = get_funcs_for_compression(NameStr(aoFormData.compresstype));
@@ -2851,6 +2982,15 @@ aoInsertDesc->appendOnlyMetaDataSnapshot, //CONCERN:Safe to assume all block dir
 											aoInsertDesc->fsInfo, aoInsertDesc->lastSequence,
 											rel, segno, 1, false);
 
+	/* Zone maps are kept in the block directory, if the table has one. */
+	if (aoInsertDesc->blockDirectory.blkdirRel != NULL)
+	{
+		int			nsummarized;
+
+		aoInsertDesc->zonemapBuild =
+			AOZoneMap_CreateBuildStates(RelationGetDescr(rel), &nsummarized);
+	}
+
 	/* should not enable insertMultiFiles if the table is created by own transaction */
 	aoInsertDesc->insertMultiFiles = enable_parallel &&
 									gp_appendonly_insert_files > 1 &&
@@ -2859,6 +2999,29 @@ aoInsertDesc->appendOnlyMetaDataSnapshot, //CONCERN:Safe to assume all block dir
 }
 
 
+/*
+ * Add the summarized attributes of a tuple just placed in the current
+ * varblock to the zone map accumulators of that block.
+ */
+static void
+zonemap_add_tuple(AppendOnlyInsertDesc aoInsertDesc, MemTuple tup)
+{
+	int			natts = RelationGetDescr(aoInsertDesc->aoi_rel)->natts;
+
+	for (int i = 0; i < natts; i++)
+	{
+		AOZoneMapBuildState *state = &aoInsertDesc->zonemapBuild[i];
+		Datum		value;
+		bool		isnull;
+
+		if (!OidIsValid(state->typid))
+			continue;
+
+		value = memtuple_getattr(tup, aoInsertDesc->mt_bind, i + 1, &isnull);
+		AOZoneMap_AddValue(state, value, isnull);
+	}
+}
+
 /*
  *	appendonly_insert		- insert tuple into a varblock
  *
@@ -3019,6 +3182,9 @@ appendonly_insert(AppendOnlyInsertDesc aoInsertDesc,
 
 		if (itemLen > 0)
 			memcpy(itemPtr, tup, itemLen);
+
+		if (aoInsertDesc->zonemapBuild)
+			zonemap_add_tuple(aoInsertDesc, instup);
 	}
 	else
 	{
@@ -3097,6 +3263,103 @@ appendonly_insert(AppendOnlyInsertDesc aoInsertDesc,
 		pfree(tup);
 }
 
+/*
+ * appendonly_insert_multi
+ *
+ * Insert a batch of tuples, with the same result as calling
+ * appendonly_insert() for each of them.  The row numbers of the whole batch
+ * are reserved from gp_fastsequence at once, and the tuples that fit the
+ * current VarBlock are copied straight into it.  The block directory is
+ * still updated once per finished block.  Tuples that need toasting, or that
+ * start a new VarBlock, go through appendonly_insert().
+ */
+void
+appendonly_insert_multi(AppendOnlyInsertDesc aoInsertDesc,
+						MemTuple *tuples,
+						AOTupleId *aoTupleIds,
+						int ntuples)
+{
+	Assert(ntuples > 0);
+
+#ifdef FAULT_INJECTOR
+	FaultInjector_InjectFaultIfSet(
+								   "appendonly_insert",
+								   DDLNotSpecified,
+								   "", //databaseName
+								   RelationGetRelationName(aoInsertDesc->aoi_rel));
+	/* tableName */
+#endif
+
+	/*
+	 * Reserve the row numbers of the batch, keeping at least one in hand
+	 * afterwards like appendonly_insert() does, so that it never needs to
+	 * request more in the middle of the batch.
+	 */
+	if (aoInsertDesc->numSequences <= ntuples)
+	{
+		int64		numSequences = Max(NUM_FAST_SEQUENCES, ntuples);
+		int64		firstSequence;
+		Oid			segrelid;
+
+		GetAppendOnlyEntryAuxOids(aoInsertDesc->aoi_rel->rd_id, NULL,
+				&segrelid, NULL, NULL, NULL, NULL);
+
+		firstSequence =
+			GetFastSequences(segrelid,
+							 aoInsertDesc->cur_segno,
+							 aoInsertDesc->lastSequence + aoInsertDesc->numSequences + 1,
+							 numSequences);
+
+		/* fast sequence could be inconsecutive when insert multiple segfiles */
+		AssertImply(gp_appendonly_insert_files <= 1,
+					firstSequence == aoInsertDesc->lastSequence + aoInsertDesc->numSequences + 1);
+		aoInsertDesc->numSequences += numSequences;
+	}
+
+	for (int i = 0; i < ntuples; i++)
+	{
+		MemTuple	tup = tuples[i];
+		VarBlockByteLen itemLen = memtuple_get_size(tup);
+		uint8	   *itemPtr = NULL;
+
+		if (!aoInsertDesc->useNoToast &&
+			(MemTupleHasExternal(tup, aoInsertDesc->mt_bind) ||
+			 itemLen > aoInsertDesc->toast_tuple_threshold))
+			itemPtr = NULL;
+		else if (VarBlockMakerItemCount(&aoInsertDesc->varBlockMaker) < AOSmallContentHeader_MaxRowCount)
+			itemPtr = VarBlockMakerGetNextItemPtr(&aoInsertDesc->varBlockMaker, itemLen);
+
+		if (itemPtr == NULL)
+		{
+			appendonly_insert(aoInsertDesc, tup, &aoTupleIds[i]);
+			continue;
+		}
+
+		if (itemLen > 0)
+			memcpy(itemPtr, tup, itemLen);
+
+		if (aoInsertDesc->zonemapBuild)
+			zonemap_add_tuple(aoInsertDesc, tup);
+
+		aoInsertDesc->insertCount++;
+		aoInsertDesc->lastSequence++;
+		aoInsertDesc->range++;
+		aoInsertDesc->numSequences--;
+		Assert(aoInsertDesc->numSequences > 0);
+
+		AOTupleIdInit(&aoTupleIds[i], aoInsertDesc->cur_segno, aoInsertDesc->lastSequence);
+
+		elogif(Debug_appendonly_print_insert_tuple, LOG,
+			   "Append-only insert tuple for table '%s' "
+			   "(AOTupleId %s, memtuple length %d, isLargeRow %s, block count " INT64_FORMAT ")",
+			   NameStr(aoInsertDesc->aoi_rel->rd_rel->relname),
+			   AOTupleIdToString(&aoTupleIds[i]),
+			   itemLen,
+			   "false",
+			   aoInsertDesc->bufferCount);
+	}
+}
+
 /*
  * appendonly_insert_finish
  *
@@ -3148,6 +3411,9 @@ appendonly_insert_finish_guts(AppendOnlyInsertDesc aoInsertDesc)
 
 	AppendOnlyBlockDirectory_End_forInsert(&(aoInsertDesc->blockDirectory));
 
+	if (aoInsertDesc->zonemapBuild)
+		pfree(aoInsertDesc->zonemapBuild);
+
 	AppendOnlyStorageWrite_FinishSession(&aoInsertDesc->storageWrite);
 
 	UnregisterSnapshot(aoInsertDesc->appendOnlyMetaDataSnapshot);
@@ -3165,6 +3431,12 @@ appendonly_predicate_pushdown_prepare(AppendOnlyScanDesc aoscan,
 	aoscan->aos_pushdown_qual = qual;
 	aoscan->aos_pushdown_econtext = ecxt;
 
+	/* qual was initialized from the plan's implicitly AND-ed qual list */
+	if (qual)
+		aoscan->aos_zonemap = AOZoneMap_BeginScan(aoscan->aos_rd,
+												  aoscan->appendOnlyMetaDataSnapshot,
+												  (List *) qual->expr);
+
 	/*
 	 * For appendonly table, the whole qual can be push down, so no left qual
 	 * with seqscan node.
@@ -3172,4 +3444,31 @@ appendonly_predicate_pushdown_prepare(AppendOnlyScanDesc aoscan,
 	return NULL;
 }
 
+/*
+ * Apply the runtime filter of a hash join to a scan that may be under way:
+ * skip the blocks whose zone maps are out of the range of the join's inner
+ * keys, and test the bloom filter ahead of the pushed down qual.  The bloom
+ * filter is only tested here with predicate pushdown enabled.
+ */
+void
+appendonly_runtime_filter_pushdown(AppendOnlyScanDesc aoscan,
+								   ScanRuntimeFilter *filter)
+{
+	if (filter->has_range)
+		aoscan->aos_zonemap = AOZoneMap_AddRange(aoscan->aos_zonemap,
+												 aoscan->aos_rd,
+												 aoscan->appendOnlyMetaDataSnapshot,
+												 filter->attno,
+												 filter->range_typid,
+												 filter->range_min,
+												 filter->range_max);
+
+	if (filter->bf != NULL && aoscan->aos_pushdown_econtext != NULL)
+	{
+		aoscan->aos_pushdown_qual =
+			ExecInitRuntimeFilterScanQual(filter, aoscan->aos_pushdown_qual);
+		filter->bloom_in_scan = true;
+	}
+}
+
 /* end of file */
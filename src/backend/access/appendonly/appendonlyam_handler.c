@@ -17,6 +17,7 @@
 #include "postgres.h"
 
 #include "access/aomd.h"
+#include "access/appendonly_sortkey.h"
 #include "access/appendonlywriter.h"
 #include "access/heapam.h"
 #include "access/heaptoast.h"
@@ -33,6 +34,7 @@
 #include "catalog/storage.h"
 #include "catalog/storage_xlog.h"
 #include "cdb/cdbappendonlyam.h"
+#include "cdb/cdbappendonlyblockcache.h"
 #include "cdb/cdbvars.h"
 #include "commands/vacuum.h"
 #include "commands/progress.h"
@@ -61,6 +63,8 @@ typedef struct AppendOnlyDMLState
 	AppendOnlyInsertDesc	insertDesc;
 	dlist_head				head; // Head of multiple segment files insertion list.
 	AppendOnlyDeleteDesc	deleteDesc;
+	AppendOnlySortKey	   *sortKey;		/* valid if sortKeyLoaded */
+	bool					sortKeyLoaded;
 } AppendOnlyDMLState;
 
 
@@ -160,6 +164,8 @@ enter_dml_state(const Oid relationOid)
 
 	state->insertDesc = NULL;
 	state->deleteDesc = NULL;
+	state->sortKey = NULL;
+	state->sortKeyLoaded = false;
 	dlist_init(&state->head);
 
 	Assert(!found);
@@ -338,6 +344,30 @@ get_insert_descriptor(const Relation relation)
 	return state->insertDesc;
 }
 
+/*
+ * Retrieve the sort key of a relation, or NULL if it has none.  It is read
+ * once per DML state.
+ */
+static AppendOnlySortKey *
+get_sort_key(const Relation relation)
+{
+	AppendOnlyDMLState *state;
+
+	state = find_dml_state(RelationGetRelid(relation));
+
+	if (!state->sortKeyLoaded)
+	{
+		MemoryContext oldcxt;
+
+		oldcxt = MemoryContextSwitchTo(appendOnlyLocal.stateCxt);
+		state->sortKey = appendonly_sortkey_create(relation);
+		MemoryContextSwitchTo(oldcxt);
+		state->sortKeyLoaded = true;
+	}
+
+	return state->sortKey;
+}
+
 /*
  * Retrieve the deleteDescriptor for a relation. Initialize it if needed.
  */
@@ -679,94 +709,74 @@ appendonly_tuple_complete_speculative(Relation relation, TupleTableSlot *slot,
  *	appendonly_multi_insert	- insert multiple tuples into an ao relation
  *
  * This is like appendonly_tuple_insert(), but inserts multiple tuples in one
- * operation. Typicaly used by COPY. This is preferrable than calling
- * appendonly_tuple_insert() in a loop because ... WAL??
+ * operation. Used by COPY; INSERT ... SELECT still inserts one tuple at a
+ * time.  This is preferrable than calling appendonly_tuple_insert() in a loop
+ * because the memtuples are formed together, and appendonly_insert_multi()
+ * reserves their row numbers once and copies them into the VarBlock without
+ * the per tuple overhead.
+ *
+ * If the relation has a sort key, the tuples are written in its order.
  */
 static void
 appendonly_multi_insert(Relation relation, TupleTableSlot **slots, int ntuples,
 						CommandId cid, int options, BulkInsertState bistate)
 {
 	AppendOnlyInsertDesc insertDesc;
-	MemTuple *mtuple;
-	int ndone = 0;
-	int nthisBlock = 0;
+	AppendOnlySortKey *sortKey;
+	MemTuple   *mtuple;
+	AOTupleId  *aoTupleIds;
+	int		   *order = NULL;
+	Oid			tableOid = RelationGetRelid(relation);
+	int			ndone = 0;
+
 	insertDesc = get_insert_descriptor(relation);
-	Oid tableOid = RelationGetRelid(relation);
+	sortKey = get_sort_key(relation);
+	if (sortKey)
+	{
+		order = palloc(ntuples * sizeof(int));
+		appendonly_sortkey_order(sortKey, slots, ntuples, order);
+	}
+
+	/* mtuple[] and aoTupleIds[] are in write order */
 	mtuple = palloc(ntuples * sizeof(MemTuple));
+	aoTupleIds = palloc(ntuples * sizeof(AOTupleId));
 	for (int i = 0; i < ntuples; i++)
 	{
-		mtuple[i] = appendonly_form_memtuple(slots[i], insertDesc->mt_bind);
-		slots[i]->tts_tableOid = tableOid;
+		TupleTableSlot *slot = slots[order ? order[i] : i];
+
+		mtuple[i] = appendonly_form_memtuple(slot, insertDesc->mt_bind);
+		slot->tts_tableOid = tableOid;
 	}
+
 	while (ndone < ntuples)
 	{
-		appendonly_insert(insertDesc, mtuple[ndone], (AOTupleId *) &slots[ndone]->tts_tid);
-		for (nthisBlock = 1; ndone + nthisBlock < ntuples; nthisBlock++)
-		{
-			if (insertDesc->useNoToast)
-			{
-				MemTuple tup = mtuple[ndone + nthisBlock] ;
-				uint8 *itemPtr = NULL;
-				VarBlockByteLen itemLen;
-				itemLen = memtuple_get_size(tup);
-				if (VarBlockMakerItemCount(&insertDesc->varBlockMaker) >= AOSmallContentHeader_MaxRowCount)
-				{
-					// Need Write out the current VarBlock to make room.
-					finishWriteBlock(insertDesc);
-					Assert(insertDesc->nonCompressedData == NULL);
-					Assert(!AppendOnlyStorageWrite_IsBufferAllocated(&insertDesc->storageWrite));
-					setupNextWriteBlock(insertDesc);
-					itemPtr = VarBlockMakerGetNextItemPtr(&insertDesc->varBlockMaker, itemLen);
-					break;
-				}
-				else
-					itemPtr = VarBlockMakerGetNextItemPtr(&insertDesc->varBlockMaker, itemLen);
-				if (itemLen > 0 && itemPtr != NULL )
-				{
-					memcpy(itemPtr, tup, itemLen);
-					insertDesc->insertCount++;
-					insertDesc->lastSequence++;
-					if (insertDesc->numSequences > 0)
-						(insertDesc->numSequences)--;
-					Assert(insertDesc->numSequences >= 0);
-					AOTupleId *aoTupleId = (AOTupleId *)&slots[ndone + nthisBlock]->tts_tid;
-					AOTupleIdInit(aoTupleId, insertDesc->cur_segno, insertDesc->lastSequence);
-					if (insertDesc->numSequences == 0)
-					{
-						int64 firstSequence;
-						Oid segrelid;
-						GetAppendOnlyEntryAuxOids(insertDesc->aoi_rel->rd_id, NULL, &segrelid, NULL, NULL, NULL, NULL);
-						firstSequence = GetFastSequences(segrelid, insertDesc->cur_segno, insertDesc->lastSequence + 1, NUM_FAST_SEQUENCES);
-						Assert(firstSequence == insertDesc->lastSequence + 1);
-						insertDesc->numSequences = NUM_FAST_SEQUENCES;
-					}
-					elogif(Debug_appendonly_print_insert_tuple, LOG,
-						   "Append-only insert tuple for table '%s' "
-						   "(AOTupleId %s, memtuple length %d, isLargeRow %s, block count " INT64_FORMAT ")",
-						   NameStr(insertDesc->aoi_rel->rd_rel->relname),
-						   AOTupleIdToString(aoTupleId),
-						   itemLen,
-						   "false",
-						   insertDesc->bufferCount);
-				}
-				else
-				{
-					break;
-				}
-			}
-			else
-			{
-				break;
-			}
-		}
-		ndone += nthisBlock;
+		int			nthis = ntuples - ndone;
+
+		/*
+		 * When inserting into multiple segment files, do not go past the
+		 * range of the current one, so that get_insert_descriptor() switches
+		 * to the next one in time.
+		 */
+		insertDesc = get_insert_descriptor(relation);
+		if (insertDesc->insertMultiFiles)
+			nthis = Min(nthis, Max(gp_appendonly_insert_files_tuples_range - insertDesc->range, 1));
+
+		appendonly_insert_multi(insertDesc, &mtuple[ndone], &aoTupleIds[ndone], nthis);
+		ndone += nthis;
 	}
-	pgstat_count_heap_insert(relation, ntuples);
 
 	for (int i = 0; i < ntuples; i++)
+	{
+		slots[order ? order[i] : i]->tts_tid = *(ItemPointer) &aoTupleIds[i];
 		appendonly_free_memtuple(mtuple[i]);
+	}
+
+	pgstat_count_heap_insert(relation, ntuples);
 
+	pfree(aoTupleIds);
 	pfree(mtuple);
+	if (order)
+		pfree(order);
 }
 
 static TM_Result
@@ -929,6 +939,7 @@ appendonly_relation_nontransactional_truncate(Relation rel)
 	Oid			aoblkdir_relid = InvalidOid;
 	Oid			aovisimap_relid = InvalidOid;
 
+	AppendOnlyBlockCache_ForgetRelFileNode(&rel->rd_node);
 	ao_truncate_one_rel(rel);
 
 	/* Also truncate the aux tables */
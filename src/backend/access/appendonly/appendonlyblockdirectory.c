@@ -36,6 +36,23 @@ minipage_size(uint32 nEntry)
 		sizeof(MinipageEntry) * nEntry;
 }
 
+/*
+ * Number of minipages per column group kept by a block directory for search,
+ * besides the last one.  Lookups in TID order, as the batched index fetches
+ * make them, rarely need more than one, but lookups in index order of a
+ * table loaded by several concurrent inserters jump between the minipages
+ * of several segment files.
+ */
+#define MINIPAGE_CACHE_WAYS 4
+
+typedef struct MinipageCacheEntry
+{
+	int			segmentFileNum;	/* -1 if unused */
+	uint32		numMinipageEntries;
+	uint64		lastUsed;
+	Minipage   *minipage;		/* allocated on first use */
+} MinipageCacheEntry;
+
 static void load_last_minipage(
 				   AppendOnlyBlockDirectory *blockDirectory,
 				   int64 lastSequence,
@@ -53,9 +70,20 @@ static void extract_minipage(
 				 HeapTuple tuple,
 				 TupleDesc tupleDesc,
 				 int columnGroupNo);
+static void minipage_cache_remember(AppendOnlyBlockDirectory *blockDirectory,
+									int columnGroupNo);
+static int	minipage_cache_lookup(AppendOnlyBlockDirectory *blockDirectory,
+								  FileSegInfo *fsInfo,
+								  int segmentFileNum,
+								  int columnGroupNo,
+								  int64 rowNum);
 static void write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 			   int columnGroupNo,
 			   MinipagePerColumnGroup *minipageInfo);
+static void write_zonemap_page(AppendOnlyBlockDirectory *blockDirectory,
+							   AttrNumber attno,
+							   AOZoneMapPage *page);
+static void flush_zonemap_pages(AppendOnlyBlockDirectory *blockDirectory);
 static bool insert_new_entry(AppendOnlyBlockDirectory *blockDirectory,
 				 int columnGroupNo,
 				 int64 firstRowNum,
@@ -154,6 +182,14 @@ init_internal(AppendOnlyBlockDirectory *blockDirectory)
 		minipageInfo->numMinipageEntries = 0;
 	}
 
+	/* Zone map pages are allocated when the first entry is added */
+	blockDirectory->zonemapPages = NULL;
+	blockDirectory->numZonemapPages = 0;
+
+	/* Only set up by AppendOnlyBlockDirectory_Init_forSearch() */
+	blockDirectory->minipageCache = NULL;
+	blockDirectory->minipageCacheClock = 0;
+
 	MemoryContextSwitchTo(oldcxt);
 }
 
@@ -218,6 +254,13 @@ AppendOnlyBlockDirectory_Init_forSearch(
 		index_open(blkdiridxid, AccessShareLock);
 
 	init_internal(blockDirectory);
+
+	blockDirectory->minipageCache =
+		MemoryContextAllocZero(blockDirectory->memoryContext,
+							   sizeof(MinipageCacheEntry) *
+							   MINIPAGE_CACHE_WAYS * numColumnGroups);
+	for (int i = 0; i < MINIPAGE_CACHE_WAYS * numColumnGroups; i++)
+		blockDirectory->minipageCache[i].segmentFileNum = -1;
 }
 
 /*
@@ -569,6 +612,22 @@ AppendOnlyBlockDirectory_GetEntry(
 
 	Assert(fsInfo != NULL);
 
+	/*
+	 * The row may be covered by one of the minipages read before, which
+	 * saves the index scans.
+	 */
+	if (blockDirectory->minipageCache != NULL)
+	{
+		entry_no = minipage_cache_lookup(blockDirectory, fsInfo,
+										 segmentFileNum, columnGroupNo,
+										 rowNum);
+		if (entry_no != -1)
+			return set_directoryentry_range(blockDirectory,
+											columnGroupNo,
+											entry_no,
+											directoryEntry);
+	}
+
 	/*
 	 * Search the btree index to find the minipage that contains the rowNum.
 	 * We find the minipages for all column groups, since currently we will
@@ -615,6 +674,9 @@ AppendOnlyBlockDirectory_GetEntry(
 							 tuple,
 							 heapTupleDesc,
 							 tmpGroupNo);
+
+			if (blockDirectory->minipageCache != NULL)
+				minipage_cache_remember(blockDirectory, tmpGroupNo);
 		}
 		else
 		{
@@ -802,6 +864,287 @@ insert_new_entry(
 	return true;
 }
 
+/*
+ * AppendOnlyBlockDirectory_InsertZoneMapEntry
+ *
+ * Add the zone map entry accumulated in buildState for the block of the
+ * given attribute (zero based) that starts at firstRowNum, and reset
+ * buildState for the next block.  Full zone map pages are written out to
+ * the block directory relation; the rest at the end of the insert.
+ *
+ * If the block directory for the appendonly relation does not exist,
+ * the entry is simply discarded.
+ */
+void
+AppendOnlyBlockDirectory_InsertZoneMapEntry(
+											AppendOnlyBlockDirectory *blockDirectory,
+											AttrNumber attno,
+											int64 firstRowNum,
+											AOZoneMapBuildState *buildState)
+{
+	AOZoneMapPage *page;
+	AOZoneMapEntry *entry;
+
+	if (buildState->rowCount == 0)
+		return;
+
+	if (blockDirectory->blkdirRel == NULL ||
+		blockDirectory->blkdirIdx == NULL)
+	{
+		AOZoneMap_ResetBuildState(buildState);
+		return;
+	}
+
+	if (blockDirectory->zonemapPages == NULL)
+	{
+		blockDirectory->numZonemapPages =
+			RelationGetDescr(blockDirectory->aoRel)->natts;
+		blockDirectory->zonemapPages = (AOZoneMapPage **)
+			MemoryContextAllocZero(blockDirectory->memoryContext,
+								   sizeof(AOZoneMapPage *) *
+								   blockDirectory->numZonemapPages);
+	}
+
+	Assert(attno >= 0 && attno < blockDirectory->numZonemapPages);
+
+	page = blockDirectory->zonemapPages[attno];
+	if (page == NULL)
+	{
+		page = (AOZoneMapPage *)
+			MemoryContextAllocZero(blockDirectory->memoryContext,
+								   AOZoneMapPage_Size(NUM_ZONEMAP_ENTRIES));
+		page->version = AOZoneMapPage_CurrentVersion;
+		blockDirectory->zonemapPages[attno] = page;
+	}
+	else if (page->nEntry >= NUM_ZONEMAP_ENTRIES)
+	{
+		write_zonemap_page(blockDirectory, attno, page);
+		page->nEntry = 0;
+	}
+
+	Assert(page->nEntry == 0 ||
+		   page->entry[page->nEntry - 1].firstRowNum < firstRowNum);
+
+	entry = &page->entry[page->nEntry++];
+	entry->firstRowNum = firstRowNum;
+	entry->rowCount = buildState->rowCount;
+	entry->nullCount = buildState->nullCount;
+	entry->minValue = buildState->minValue;
+	entry->maxValue = buildState->maxValue;
+
+	AOZoneMap_ResetBuildState(buildState);
+}
+
+/*
+ * AppendOnlyBlockDirectory_SplitSegmentFile
+ *
+ * Split a segment file into parts for a parallel scan, at the first row of
+ * each minipage of the given column group.  A minipage covers a few hundred
+ * blocks, so that the parts are big enough to be worth handing out, yet a
+ * large segment file still gives plenty of them.
+ *
+ * The parts cover the whole file: the first one begins at its start, and the
+ * last one ends at eof, even if the directory does not describe all blocks.
+ * Without a block directory, the whole file is one part.  Returns a palloc'd
+ * array of *nparts parts, in file order.
+ */
+AppendOnlyScanPart *
+AppendOnlyBlockDirectory_SplitSegmentFile(Relation aoRel,
+										  Snapshot snapshot,
+										  int segno,
+										  int columnGroupNo,
+										  int64 eof,
+										  int segfileIndex,
+										  int *nparts)
+{
+	AppendOnlyScanPart *parts;
+	int			maxparts = 1;
+	int			n;
+	Oid			blkdirrelid;
+	Oid			blkdiridxid;
+
+	parts = palloc(sizeof(AppendOnlyScanPart) * maxparts);
+	parts[0].segfileIndex = segfileIndex;
+	parts[0].firstRowNum = 0;
+	parts[0].fileOffset = 0;
+	n = 1;
+
+	GetAppendOnlyEntryAuxOids(RelationGetRelid(aoRel), snapshot,
+							  NULL, &blkdirrelid, &blkdiridxid, NULL, NULL);
+
+	if (OidIsValid(blkdirrelid) && OidIsValid(blkdiridxid))
+	{
+		Relation	blkdirRel = table_open(blkdirrelid, AccessShareLock);
+		Relation	blkdirIdx = index_open(blkdiridxid, AccessShareLock);
+		TupleDesc	tupdesc = RelationGetDescr(blkdirRel);
+		ScanKeyData scanKeys[2];
+		SysScanDesc indexScan;
+		HeapTuple	tuple;
+
+		ScanKeyInit(&scanKeys[0],
+					Anum_pg_aoblkdir_segno,
+					BTEqualStrategyNumber,
+					F_INT4EQ,
+					Int32GetDatum(segno));
+		ScanKeyInit(&scanKeys[1],
+					Anum_pg_aoblkdir_columngroupno,
+					BTEqualStrategyNumber,
+					F_INT4EQ,
+					Int32GetDatum(columnGroupNo));
+
+		indexScan = systable_beginscan_ordered(blkdirRel, blkdirIdx,
+											   snapshot, 2, scanKeys);
+
+		while ((tuple = systable_getnext_ordered(indexScan, ForwardScanDirection)) != NULL)
+		{
+			bool		isnull;
+			Datum		d;
+			Minipage   *minipage;
+			MinipageEntry *entry;
+			AppendOnlyScanPart *last = &parts[n - 1];
+
+			d = heap_getattr(tuple, Anum_pg_aoblkdir_minipage, tupdesc, &isnull);
+			Assert(!isnull);
+			minipage = (Minipage *) PG_DETOAST_DATUM(d);
+			entry = &minipage->entry[0];
+
+			/*
+			 * Ignore entries of blocks beyond eof, left behind by aborted
+			 * inserts, and anything that would not move forward.
+			 */
+			if (minipage->nEntry > 0 &&
+				entry->fileOffset < eof &&
+				entry->fileOffset > last->fileOffset &&
+				entry->firstRowNum > last->firstRowNum)
+			{
+				if (n == maxparts)
+				{
+					maxparts *= 2;
+					parts = repalloc(parts, sizeof(AppendOnlyScanPart) * maxparts);
+				}
+				parts[n].segfileIndex = segfileIndex;
+				parts[n].firstRowNum = entry->firstRowNum;
+				parts[n].fileOffset = entry->fileOffset;
+				n++;
+			}
+
+			if ((Pointer) minipage != DatumGetPointer(d))
+				pfree(minipage);
+		}
+
+		systable_endscan_ordered(indexScan);
+		index_close(blkdirIdx, AccessShareLock);
+		table_close(blkdirRel, AccessShareLock);
+	}
+
+	for (int i = 0; i < n; i++)
+	{
+		if (i + 1 < n)
+		{
+			parts[i].afterRowNum = parts[i + 1].firstRowNum;
+			parts[i].afterFileOffset = parts[i + 1].fileOffset;
+		}
+		else
+		{
+			parts[i].afterRowNum = -1;
+			parts[i].afterFileOffset = eof;
+		}
+	}
+
+	*nparts = n;
+	return parts;
+}
+
+/*
+ * AppendOnlyBlockDirectory_GetSegmentFileEntries
+ *
+ * Returns the entries of all minipages of the given segment file and column
+ * group, in row order, for a caller that would otherwise look up many rows
+ * one by one with AppendOnlyBlockDirectory_GetEntry().  Like that, entries of
+ * blocks at or beyond eof, left behind by aborted inserts, are left out.
+ * Returns a palloc'd array of *nentries entries, NULL if there are none or
+ * the relation has no block directory.
+ */
+MinipageEntry *
+AppendOnlyBlockDirectory_GetSegmentFileEntries(Relation aoRel,
+											   Snapshot snapshot,
+											   int segno,
+											   int columnGroupNo,
+											   int64 eof,
+											   int *nentries)
+{
+	MinipageEntry *entries = NULL;
+	int			maxentries = 0;
+	int			n = 0;
+	Oid			blkdirrelid;
+	Oid			blkdiridxid;
+
+	GetAppendOnlyEntryAuxOids(RelationGetRelid(aoRel), snapshot,
+							  NULL, &blkdirrelid, &blkdiridxid, NULL, NULL);
+
+	if (OidIsValid(blkdirrelid) && OidIsValid(blkdiridxid))
+	{
+		Relation	blkdirRel = table_open(blkdirrelid, AccessShareLock);
+		Relation	blkdirIdx = index_open(blkdiridxid, AccessShareLock);
+		TupleDesc	tupdesc = RelationGetDescr(blkdirRel);
+		ScanKeyData scanKeys[2];
+		SysScanDesc indexScan;
+		HeapTuple	tuple;
+
+		ScanKeyInit(&scanKeys[0],
+					Anum_pg_aoblkdir_segno,
+					BTEqualStrategyNumber,
+					F_INT4EQ,
+					Int32GetDatum(segno));
+		ScanKeyInit(&scanKeys[1],
+					Anum_pg_aoblkdir_columngroupno,
+					BTEqualStrategyNumber,
+					F_INT4EQ,
+					Int32GetDatum(columnGroupNo));
+
+		indexScan = systable_beginscan_ordered(blkdirRel, blkdirIdx,
+											   snapshot, 2, scanKeys);
+
+		while ((tuple = systable_getnext_ordered(indexScan, ForwardScanDirection)) != NULL)
+		{
+			bool		isnull;
+			Datum		d;
+			Minipage   *minipage;
+
+			d = heap_getattr(tuple, Anum_pg_aoblkdir_minipage, tupdesc, &isnull);
+			Assert(!isnull);
+			minipage = (Minipage *) PG_DETOAST_DATUM(d);
+
+			/* The entries are in file order, see extract_minipage() */
+			for (uint32 i = 0; i < minipage->nEntry; i++)
+			{
+				if (minipage->entry[i].fileOffset >= eof)
+					break;
+
+				if (n == maxentries)
+				{
+					maxentries = Max(maxentries * 2, minipage->nEntry);
+					if (entries == NULL)
+						entries = palloc(sizeof(MinipageEntry) * maxentries);
+					else
+						entries = repalloc(entries, sizeof(MinipageEntry) * maxentries);
+				}
+				entries[n++] = minipage->entry[i];
+			}
+
+			if ((Pointer) minipage != DatumGetPointer(d))
+				pfree(minipage);
+		}
+
+		systable_endscan_ordered(indexScan);
+		index_close(blkdirIdx, AccessShareLock);
+		table_close(blkdirRel, AccessShareLock);
+	}
+
+	*nentries = n;
+	return entries;
+}
+
 /*
  * AppendOnlyBlockDirectory_DeleteSegmentFile
  *
@@ -1145,6 +1488,111 @@ find_minipage_entry(Minipage *minipage,
 		return -1;
 }
 
+/*
+ * minipage_cache_remember
+ *
+ * Keep a copy of the minipage just read for the given column group, in
+ * place of the least recently used copy of that column group.
+ */
+static void
+minipage_cache_remember(AppendOnlyBlockDirectory *blockDirectory,
+						int columnGroupNo)
+{
+	MinipagePerColumnGroup *minipageInfo =
+	&blockDirectory->minipages[columnGroupNo];
+	MinipageCacheEntry *ways =
+	&blockDirectory->minipageCache[columnGroupNo * MINIPAGE_CACHE_WAYS];
+	MinipageCacheEntry *victim = NULL;
+	uint32		numEntries = minipageInfo->numMinipageEntries;
+
+	if (numEntries == 0)
+		return;
+
+	for (int i = 0; i < MINIPAGE_CACHE_WAYS; i++)
+	{
+		MinipageCacheEntry *way = &ways[i];
+
+		/* The same minipage may be read again after an eviction */
+		if (way->segmentFileNum == blockDirectory->currentSegmentFileNum &&
+			way->minipage->entry[0].firstRowNum ==
+			minipageInfo->minipage->entry[0].firstRowNum)
+		{
+			victim = way;
+			break;
+		}
+		if (victim == NULL || way->lastUsed < victim->lastUsed)
+			victim = way;
+	}
+
+	if (victim->minipage == NULL)
+		victim->minipage =
+			MemoryContextAlloc(blockDirectory->memoryContext,
+							   minipage_size(NUM_MINIPAGE_ENTRIES));
+
+	memcpy(victim->minipage, minipageInfo->minipage, minipage_size(numEntries));
+	victim->segmentFileNum = blockDirectory->currentSegmentFileNum;
+	victim->numMinipageEntries = numEntries;
+	victim->lastUsed = ++blockDirectory->minipageCacheClock;
+}
+
+/*
+ * minipage_cache_lookup
+ *
+ * Look for a cached minipage of the given column group that covers rowNum.
+ * If there is one, it becomes the last minipage of the column group, and the
+ * index of the entry that covers rowNum is returned.  Otherwise -1.
+ */
+static int
+minipage_cache_lookup(AppendOnlyBlockDirectory *blockDirectory,
+					  FileSegInfo *fsInfo,
+					  int segmentFileNum,
+					  int columnGroupNo,
+					  int64 rowNum)
+{
+	MinipageCacheEntry *ways =
+	&blockDirectory->minipageCache[columnGroupNo * MINIPAGE_CACHE_WAYS];
+
+	for (int i = 0; i < MINIPAGE_CACHE_WAYS; i++)
+	{
+		MinipageCacheEntry *way = &ways[i];
+		MinipagePerColumnGroup *minipageInfo;
+		int			entry_no;
+
+		if (way->segmentFileNum != segmentFileNum)
+			continue;
+
+		entry_no = find_minipage_entry(way->minipage,
+									   way->numMinipageEntries,
+									   rowNum);
+		if (entry_no == -1)
+			continue;
+
+		/*
+		 * The last minipages of all column groups must belong to the current
+		 * segment file, see MPP-17061.  Forget those of the other column
+		 * groups when switching to another one.
+		 */
+		if (segmentFileNum != blockDirectory->currentSegmentFileNum)
+		{
+			for (int groupNo = 0; groupNo < blockDirectory->numColumnGroups; groupNo++)
+				blockDirectory->minipages[groupNo].numMinipageEntries = 0;
+
+			blockDirectory->currentSegmentFileNum = segmentFileNum;
+			blockDirectory->currentSegmentFileInfo = fsInfo;
+		}
+
+		minipageInfo = &blockDirectory->minipages[columnGroupNo];
+		memcpy(minipageInfo->minipage, way->minipage,
+			   minipage_size(way->numMinipageEntries));
+		minipageInfo->numMinipageEntries = way->numMinipageEntries;
+		way->lastUsed = ++blockDirectory->minipageCacheClock;
+
+		return entry_no;
+	}
+
+	return -1;
+}
+
 /*
  * write_minipage
  *
@@ -1230,6 +1678,96 @@ write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 }
 
 
+/*
+ * write_zonemap_page
+ *
+ * Insert a zone map page as a new row of the block directory relation.
+ *
+ * Unlike minipages, zone map pages are never updated in place: every page
+ * starts with a row number that has not been used before in the segment
+ * file, so each insert session simply adds its own pages.
+ */
+static void
+write_zonemap_page(AppendOnlyBlockDirectory *blockDirectory,
+				   AttrNumber attno, AOZoneMapPage *page)
+{
+	HeapTuple	tuple;
+	MemoryContext oldcxt;
+	Datum	   *values = blockDirectory->values;
+	bool	   *nulls = blockDirectory->nulls;
+	Relation	blkdirRel = blockDirectory->blkdirRel;
+	TupleDesc	heapTupleDesc = RelationGetDescr(blkdirRel);
+
+	Assert(page->nEntry > 0);
+
+	oldcxt = MemoryContextSwitchTo(blockDirectory->memoryContext);
+
+	values[Anum_pg_aoblkdir_segno - 1] =
+		Int32GetDatum(blockDirectory->currentSegmentFileNum);
+	nulls[Anum_pg_aoblkdir_segno - 1] = false;
+
+	values[Anum_pg_aoblkdir_columngroupno - 1] =
+		Int32GetDatum(AOZoneMapColumnGroupNo(attno));
+	nulls[Anum_pg_aoblkdir_columngroupno - 1] = false;
+
+	values[Anum_pg_aoblkdir_firstrownum - 1] =
+		Int64GetDatum(page->entry[0].firstRowNum);
+	nulls[Anum_pg_aoblkdir_firstrownum - 1] = false;
+
+	SET_VARSIZE(page, AOZoneMapPage_Size(page->nEntry));
+	values[Anum_pg_aoblkdir_minipage - 1] = PointerGetDatum(page);
+	nulls[Anum_pg_aoblkdir_minipage - 1] = false;
+
+	tuple = heaptuple_form_to(heapTupleDesc,
+							  values,
+							  nulls,
+							  NULL,
+							  NULL);
+
+	ereportif(Debug_appendonly_print_blockdirectory, LOG,
+			  (errmsg("Append-only block directory insert a zone map page: "
+					  "(segno, attno, nEntries, firstRowNum) = "
+					  "(%d, %d, %u, " INT64_FORMAT ")",
+					  blockDirectory->currentSegmentFileNum,
+					  attno, page->nEntry,
+					  page->entry[0].firstRowNum)));
+
+	CatalogTupleInsertWithInfo(blkdirRel, tuple, blockDirectory->indinfo);
+
+	heap_freetuple(tuple);
+
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * flush_zonemap_pages
+ *
+ * Write out the partially filled zone map pages at the end of an insert.
+ */
+static void
+flush_zonemap_pages(AppendOnlyBlockDirectory *blockDirectory)
+{
+	AttrNumber	attno;
+
+	if (blockDirectory->zonemapPages == NULL)
+		return;
+
+	for (attno = 0; attno < blockDirectory->numZonemapPages; attno++)
+	{
+		AOZoneMapPage *page = blockDirectory->zonemapPages[attno];
+
+		if (page == NULL)
+			continue;
+
+		if (page->nEntry > 0)
+			write_zonemap_page(blockDirectory, attno, page);
+		pfree(page);
+	}
+
+	pfree(blockDirectory->zonemapPages);
+	blockDirectory->zonemapPages = NULL;
+	blockDirectory->numZonemapPages = 0;
+}
 
 void
 AppendOnlyBlockDirectory_End_forInsert(
@@ -1257,6 +1795,8 @@ AppendOnlyBlockDirectory_End_forInsert(
 		pfree(minipageInfo->minipage);
 	}
 
+	flush_zonemap_pages(blockDirectory);
+
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
 			  (errmsg("Append-only block directory end for insert: "
 					  "(segno, numColumnGroups, isAOCol)="
@@ -1343,6 +1883,8 @@ AppendOnlyBlockDirectory_End_addCol(
 		pfree(minipageInfo->minipage);
 	}
 
+	flush_zonemap_pages(blockDirectory);
+
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
 			  (errmsg("Append-only block directory end for insert: "
 					  "(segno, numColumnGroups, isAOCol)="
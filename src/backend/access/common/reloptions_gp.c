@@ -20,6 +20,7 @@
 
 #include "postgres.h"
 
+#include "access/appendonly_sortkey.h"
 #include "access/bitmap.h"
 #include "access/reloptions.h"
 #include "catalog/pg_type.h"
@@ -110,6 +111,26 @@ static relopt_string stringRelOpts_gp[] =
 		},
 		0, true, NULL, NULL, ""
 	},
+	{
+		{
+			SOPT_SORTKEY,
+			"AO tables columns to sort each multi-insert batch (up to 1000 rows of a COPY) by",
+			RELOPT_KIND_APPENDOPTIMIZED,
+			ShareUpdateExclusiveLock	/* since it applies only to later
+										 * inserts */
+		},
+		0, true, appendonly_sortkey_validate_columns, NULL, ""
+	},
+	{
+		{
+			SOPT_SORTMETHOD,
+			"AO tables sort key order, linear or zorder",
+			RELOPT_KIND_APPENDOPTIMIZED,
+			ShareUpdateExclusiveLock	/* since it applies only to later
+										 * inserts */
+		},
+		0, true, appendonly_sortkey_validate_method, NULL, ""
+	},
 	/* list terminator */
 	{{NULL}}
 };
@@ -630,6 +651,33 @@ transformAOStdRdOptions(StdRdOptions *opts, Datum withOpts)
 				astate = accumArrayResult(astate, d, false, TEXTOID,
 										  CurrentMemoryContext);
 			}
+
+			/*
+			 * The sort key options have no defaults, and are only recorded
+			 * if they are specified in WITH clause.
+			 */
+			soptLen = strlen(SOPT_SORTKEY);
+			if (withLen > soptLen &&
+				pg_strncasecmp(strval, SOPT_SORTKEY, soptLen) == 0 &&
+				opts->sortkey != 0)
+			{
+				d = CStringGetTextDatum(psprintf("%s=%s",
+												 SOPT_SORTKEY,
+												 (char *) opts + opts->sortkey));
+				astate = accumArrayResult(astate, d, false, TEXTOID,
+										  CurrentMemoryContext);
+			}
+			soptLen = strlen(SOPT_SORTMETHOD);
+			if (withLen > soptLen &&
+				pg_strncasecmp(strval, SOPT_SORTMETHOD, soptLen) == 0 &&
+				opts->sortmethod != 0)
+			{
+				d = CStringGetTextDatum(psprintf("%s=%s",
+												 SOPT_SORTMETHOD,
+												 (char *) opts + opts->sortmethod));
+				astate = accumArrayResult(astate, d, false, TEXTOID,
+										  CurrentMemoryContext);
+			}
 		}
 	}
 
@@ -832,6 +880,27 @@ validate_and_adjust_options(StdRdOptions *result,
 			}
 		}
 
+		if (result->compresstype[0] &&
+			(pg_strcasecmp(result->compresstype, "lz4") == 0))
+		{
+#ifndef USE_LZ4
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("LZ4 library is not supported by this build"),
+					 errhint("Compile with --with-lz4 to use LZ4 compression.")));
+#endif
+			if (result->compresslevel > 12)
+			{
+				if (validate)
+					ereport(ERROR,
+							(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+							 errmsg("compresslevel=%d is out of range for lz4 (should be in the range 1 to 12)",
+									result->compresslevel)));
+
+				result->compresslevel = setDefaultCompressionLevel(result->compresstype);
+			}
+		}
+
 		if (result->compresstype[0] &&
 			(pg_strcasecmp(result->compresstype, "quicklz") == 0))
 		{
@@ -865,6 +934,19 @@ validate_and_adjust_options(StdRdOptions *result,
 
 			result->compresslevel = setDefaultCompressionLevel(result->compresstype);
 		}
+
+		if (result->compresstype[0] &&
+			(pg_strcasecmp(result->compresstype, "auto") == 0) &&
+			(result->compresslevel != 1))
+		{
+			if (validate)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("compresslevel=%d is out of range for auto (should be 1)",
+								result->compresslevel)));
+
+			result->compresslevel = setDefaultCompressionLevel(result->compresstype);
+		}
 	}
 
 	/* checksum */
@@ -946,10 +1028,13 @@ validateAppendOnlyRelOptions(int blocksize,
 		(pg_strcasecmp(comptype, "quicklz") == 0 ||
 		 pg_strcasecmp(comptype, "zlib") == 0 ||
 		 pg_strcasecmp(comptype, "rle_type") == 0 ||
-		 pg_strcasecmp(comptype, "zstd") == 0))
+		 pg_strcasecmp(comptype, "zstd") == 0 ||
+		 pg_strcasecmp(comptype, "lz4") == 0 ||
+		 pg_strcasecmp(comptype, "auto") == 0))
 	{
 		if (!co &&
-			pg_strcasecmp(comptype, "rle_type") == 0)
+			(pg_strcasecmp(comptype, "rle_type") == 0 ||
+			 pg_strcasecmp(comptype, "auto") == 0))
 		{
 			ereport(ERROR,
 					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
@@ -994,6 +1079,21 @@ validateAppendOnlyRelOptions(int blocksize,
 								complevel)));
 		}
 
+		if (comptype && (pg_strcasecmp(comptype, "lz4") == 0))
+		{
+#ifndef USE_LZ4
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("LZ4 library is not supported by this build"),
+					 errhint("Compile with --with-lz4 to use LZ4 compression.")));
+#endif
+			if (complevel < 0 || complevel > 12)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("compresslevel=%d is out of range for lz4 (should be in the range 1 to 12)",
+								complevel)));
+		}
+
 		if (comptype && (pg_strcasecmp(comptype, "quicklz") == 0))
 		{
 #ifndef HAVE_LIBQUICKLZ
@@ -1016,6 +1116,14 @@ validateAppendOnlyRelOptions(int blocksize,
 					 errmsg("compresslevel=%d is out of range for rle_type (should be in the range 1 to 4)",
 							complevel)));
 		}
+		if (comptype && (pg_strcasecmp(comptype, "auto") == 0) &&
+			complevel != 1)
+		{
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("compresslevel=%d is out of range for auto (should be 1)",
+							complevel)));
+		}
 	}
 
 	if (blocksize < MIN_APPENDONLY_BLOCK_SIZE ||
@@ -1040,7 +1148,7 @@ validateAppendOnlyRelOptions(int blocksize,
 
 /*
  * if no compressor type was specified, we set to no compression (level 0)
- * otherwise default for both zlib, quicklz, zstd and RLE to level 1.
+ * otherwise default for zlib, quicklz, zstd, lz4 and RLE to level 1.
  */
 static int
 setDefaultCompressionLevel(char *compresstype)
@@ -27,6 +27,7 @@
  *		index_getnext_tid	- get the next TID from a scan
  *		index_fetch_heap		- get the scan's next heap tuple
  *		index_getnext_slot	- get the next tuple from a scan
+ *		index_batch_fetch_begin - fetch table tuples in batches
  *		index_getbitmap - get all tuples from a scan
  *		index_bulk_delete	- bulk deletion of index tuples
  *		index_vacuum_cleanup	- post-deletion cleanup of an index
@@ -54,11 +55,14 @@
 #include "catalog/pg_amproc.h"
 #include "catalog/pg_type.h"
 #include "commands/defrem.h"
+#include "executor/tuptable.h"
 #include "nodes/makefuncs.h"
 #include "pgstat.h"
 #include "storage/bufmgr.h"
 #include "storage/lmgr.h"
 #include "storage/predicate.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
 #include "utils/ruleutils.h"
 #include "utils/snapmgr.h"
 #include "utils/syscache.h"
@@ -104,9 +108,29 @@ do { \
 			 CppAsString(pname), RelationGetRelationName(scan->indexRelation)); \
 } while(0)
 
+/*
+ * TIDs read ahead from the index, and their table tuples, for a scan that
+ * fetches in batches.  See index_batch_fetch_begin.
+ */
+typedef struct IndexFetchBatch
+{
+	MemoryContext context;		/* holds the tuples of the current batch */
+	int			maxSize;
+	int			size;			/* number of TIDs to read for the next batch */
+	int			ntids;			/* number of TIDs in the current batch */
+	int			next;			/* next entry to return */
+	bool		exhausted;		/* has the index run out of TIDs? */
+	ItemPointerData *tids;
+	bool	   *recheck;		/* xs_recheck of each TID */
+	MinimalTuple *tuples;		/* NULL if the TID has no visible tuple */
+} IndexFetchBatch;
+
 static IndexScanDesc index_beginscan_internal(Relation indexRelation,
 											  int nkeys, int norderbys, Snapshot snapshot,
 											  ParallelIndexScanDesc pscan, bool temp_snap);
+static void index_batch_fetch_reset(IndexFetchBatch *batch);
+static bool index_getnext_slot_batch(IndexScanDesc scan, ScanDirection direction,
+									 TupleTableSlot *slot);
 
 
 /* ----------------------------------------------------------------
@@ -311,6 +335,9 @@ index_rescan(IndexScanDesc scan,
 	scan->kill_prior_tuple = false; /* for safety */
 	scan->xs_heap_continue = false;
 
+	if (scan->xs_fetch_batch)
+		index_batch_fetch_reset(scan->xs_fetch_batch);
+
 	scan->indexRelation->rd_indam->amrescan(scan, keys, nkeys,
 											orderbys, norderbys);
 }
@@ -332,6 +359,13 @@ index_endscan(IndexScanDesc scan)
 		scan->xs_heapfetch = NULL;
 	}
 
+	if (scan->xs_fetch_batch)
+	{
+		MemoryContextDelete(scan->xs_fetch_batch->context);
+		pfree(scan->xs_fetch_batch);
+		scan->xs_fetch_batch = NULL;
+	}
+
 	/* End the AM's scan */
 	scan->indexRelation->rd_indam->amendscan(scan);
 
@@ -355,6 +389,9 @@ index_markpos(IndexScanDesc scan)
 	SCAN_CHECKS;
 	CHECK_SCAN_PROCEDURE(ammarkpos);
 
+	/* The index position is ahead of the returned tuple when batching */
+	Assert(scan->xs_fetch_batch == NULL);
+
 	scan->indexRelation->rd_indam->ammarkpos(scan);
 }
 
@@ -615,6 +652,9 @@ index_fetch_heap(IndexScanDesc scan, TupleTableSlot *slot)
 bool
 index_getnext_slot(IndexScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
 {
+	if (scan->xs_fetch_batch)
+		return index_getnext_slot_batch(scan, direction, slot);
+
 	for (;;)
 	{
 		if (!scan->xs_heap_continue)
@@ -644,6 +684,128 @@ index_getnext_slot(IndexScanDesc scan, ScanDirection direction, TupleTableSlot *
 	return false;
 }
 
+/* ----------------
+ *		index_batch_fetch_begin - fetch table tuples in batches
+ *
+ * Makes index_getnext_slot() read a batch of TIDs from the index ahead, and
+ * fetch their table tuples at once, which lets the table AM visit them in
+ * storage order, before returning them in index order.  Only table AMs with
+ * the index_fetch_batch callback support this; for others, and if
+ * gp_index_fetch_batch_size is less than two, it does nothing.
+ *
+ * The caller must not use the scan for mark/restore, and must not change
+ * the scan direction.  The batch starts with a single TID and doubles each
+ * time up to gp_index_fetch_batch_size, so that a scan stopped early, like
+ * under a LIMIT, does not fetch many tuples in vain.
+ * ----------------
+ */
+void
+index_batch_fetch_begin(IndexScanDesc scan)
+{
+	IndexFetchBatch *batch;
+
+	SCAN_CHECKS;
+
+	if (gp_index_fetch_batch_size < 2 ||
+		scan->xs_fetch_batch != NULL ||
+		scan->heapRelation->rd_tableam->index_fetch_batch == NULL)
+		return;
+
+	/* An ordered scan must be fetched one tuple at a time */
+	if (scan->numberOfOrderBys > 0)
+		return;
+
+	batch = palloc(sizeof(IndexFetchBatch));
+	batch->context = AllocSetContextCreate(CurrentMemoryContext,
+										   "IndexFetchBatch",
+										   ALLOCSET_DEFAULT_SIZES);
+	batch->maxSize = gp_index_fetch_batch_size;
+	batch->tids = palloc(batch->maxSize * sizeof(ItemPointerData));
+	batch->recheck = palloc(batch->maxSize * sizeof(bool));
+	batch->tuples = palloc(batch->maxSize * sizeof(MinimalTuple));
+	index_batch_fetch_reset(batch);
+
+	scan->xs_fetch_batch = batch;
+}
+
+static void
+index_batch_fetch_reset(IndexFetchBatch *batch)
+{
+	MemoryContextReset(batch->context);
+	batch->size = 1;
+	batch->ntids = 0;
+	batch->next = 0;
+	batch->exhausted = false;
+}
+
+/*
+ * index_getnext_slot() of a scan that fetches in batches.
+ */
+static bool
+index_getnext_slot_batch(IndexScanDesc scan, ScanDirection direction,
+						 TupleTableSlot *slot)
+{
+	IndexFetchBatch *batch = scan->xs_fetch_batch;
+
+	for (;;)
+	{
+		MemoryContext oldcxt;
+
+		while (batch->next < batch->ntids)
+		{
+			int			i = batch->next++;
+
+			if (batch->tuples[i] == NULL)
+				continue;
+
+			scan->xs_heaptid = batch->tids[i];
+			scan->xs_recheck = batch->recheck[i];
+
+			ExecForceStoreMinimalTuple(batch->tuples[i], slot, false);
+			slot->tts_tid = batch->tids[i];
+			slot->tts_tableOid = RelationGetRelid(scan->heapRelation);
+
+			pgstat_count_heap_fetch(scan->indexRelation);
+
+			return true;
+		}
+
+		if (batch->exhausted)
+			return false;
+
+		/* Read the next batch of TIDs from the index */
+		MemoryContextReset(batch->context);
+		batch->ntids = 0;
+		batch->next = 0;
+		while (batch->ntids < batch->size)
+		{
+			ItemPointer tid = index_getnext_tid(scan, direction);
+
+			if (tid == NULL)
+			{
+				batch->exhausted = true;
+				break;
+			}
+
+			batch->tids[batch->ntids] = *tid;
+			batch->recheck[batch->ntids] = scan->xs_recheck;
+			batch->ntids++;
+		}
+
+		if (batch->ntids > 0)
+		{
+			oldcxt = MemoryContextSwitchTo(batch->context);
+			table_index_fetch_batch(scan->xs_heapfetch,
+									batch->tids, batch->ntids,
+									scan->xs_snapshot,
+									batch->tuples);
+			MemoryContextSwitchTo(oldcxt);
+		}
+
+		batch->size = Min(batch->size * 2, batch->maxSize);
+	}
+}
+
 /* ----------------
  *		index_getbitmap - get all tuples at once from an index scan
  *
@@ -32,6 +32,7 @@
 #include "access/xloginsert.h"
 #include "access/xact_storage_tablespace.h"
 #include "access/xlogutils.h"
+#include "catalog/gp_fastsequence.h"
 #include "catalog/index.h"
 #include "catalog/namespace.h"
 #include "catalog/pg_enum.h"
@@ -2845,6 +2846,7 @@ CommitTransaction(void)
 
 	/* close large objects before lower-level cleanup */
 	AtEOXact_LargeObject(true);
+	AtEOXact_FastSequence(true, false);
 
 	/*
 	 * Insert notifications sent by NOTIFY commands into the queue.  This
@@ -3174,6 +3176,7 @@ PrepareTransaction(void)
 
 	/* close large objects before lower-level cleanup */
 	AtEOXact_LargeObject(true);
+	AtEOXact_FastSequence(true, true);
 
 	/* NOTIFY requires no work at this point */
 
@@ -3562,6 +3565,7 @@ AbortTransaction(void)
 
 	smgrDoPendingSyncs(false, is_parallel_worker);
 	AtEOXact_LargeObject(false);
+	AtEOXact_FastSequence(false, false);
 	AtAbort_Notify();
 	AtEOXact_RelationMap(false, is_parallel_worker);
 	AtAbort_Twophase();
@@ -6230,6 +6234,7 @@ AbortSubTransaction(void)
 		AtEOXact_DispatchOids(false);
 		AtEOSubXact_LargeObject(false, s->subTransactionId,
 								s->parent->subTransactionId);
+		AtSubAbort_FastSequence();
 		AtSubAbort_Notify();
 
 		/* Advertise the fact that we aborted in pg_xact. */
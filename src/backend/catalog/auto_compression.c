@@ -0,0 +1,479 @@
+/*---------------------------------------------------------------------
+ *
+ * auto_compression.c
+ *	  Adaptive block compression for append-optimized columns.
+ *
+ * compresstype=auto picks the bulk compression for each column by itself.
+ * Every candidate codec built into the server is tried on a few sample
+ * blocks: the one that decompresses fastest, among those whose output is
+ * within AUTO_SIZE_SLACK_PCT of the smallest, is then used for the
+ * following blocks, until the next sample is taken.  If no codec saves at
+ * least AUTO_MIN_SAVING_PCT, the blocks are stored uncompressed.
+ *
+ * Candidates are LZ4 and Zstandard at their fastest levels.  zlib level 1
+ * is only tried when the server is built without Zstandard, as Zstandard
+ * beats it on both size and speed.  The codec a block was compressed with is recorded in the
+ * first byte of the compressed block, so that a column may mix codecs, and
+ * data stays readable whatever the next sample decides.
+ *
+ * Portions Copyright (c) 2023-Present, Cloudberry inc
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/catalog/auto_compression.c
+ *
+ *---------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#include <zstd_errors.h>
+#endif
+
+#include "catalog/pg_compression.h"
+#include "fmgr.h"
+#include "portability/instr_time.h"
+#include "storage/gp_compress.h"
+#include "utils/builtins.h"
+
+/*
+ * Codec identifiers, stored as the first byte of every compressed block.
+ * These are on-disk values: never renumber them.
+ */
+#define AUTO_CODEC_LZ4		1
+#define AUTO_CODEC_ZSTD		2
+#define AUTO_CODEC_ZLIB		3
+
+#define AUTO_MAX_CANDIDATES	3
+
+/* Number of blocks compressed with every candidate in each sample */
+#define AUTO_SAMPLE_BLOCKS		4
+/* A new sample is taken every this many blocks */
+#define AUTO_RESAMPLE_INTERVAL	128
+/* Compression must save at least this much to be worth decompressing */
+#define AUTO_MIN_SAVING_PCT		10
+/* Slower decompression is accepted only for output smaller than this */
+#define AUTO_SIZE_SLACK_PCT		10
+
+typedef struct auto_candidate
+{
+	int			codec;			/* AUTO_CODEC_* */
+	int64		sample_bytes;	/* compressed size in the current sample */
+	instr_time	sample_time;	/* decompression time in the current sample */
+} auto_candidate;
+
+/* Internal state for auto */
+typedef struct auto_state
+{
+	bool		compress;		/* compress or decompress? */
+
+	int			ncandidates;
+	auto_candidate candidates[AUTO_MAX_CANDIDATES];
+
+	int64		nblocks;		/* blocks compressed so far */
+	int64		sample_raw_bytes;	/* input size in the current sample */
+	int			chosen;			/* index into candidates, -1 for none */
+
+	/* Scratch space for trial compressions, allocated on first use */
+	MemoryContext mcxt;
+	char	   *trial_buf;
+	char	   *check_buf;
+	int32		trial_buf_sz;
+
+#ifdef USE_LZ4
+	void	   *lz4_workspace;
+#endif
+#ifdef USE_ZSTD
+	zstd_context *zstd_ctx;
+#endif
+} auto_state;
+
+/*
+ * Compress with one codec.  Returns the compressed size, or -1 if the output
+ * didn't fit in dst.
+ */
+static int32
+auto_codec_compress(auto_state *state, int codec,
+					const char *src, int32 src_sz, char *dst, int32 dst_sz)
+{
+	switch (codec)
+	{
+#ifdef USE_LZ4
+		case AUTO_CODEC_LZ4:
+			{
+				int			len;
+
+				len = LZ4_compress_fast_extState(state->lz4_workspace,
+												 src, dst, src_sz, dst_sz, 1);
+				return len > 0 ? len : -1;
+			}
+#endif
+#ifdef USE_ZSTD
+		case AUTO_CODEC_ZSTD:
+			{
+				size_t		len;
+
+				len = ZSTD_compressCCtx(state->zstd_ctx->cctx,
+										dst, dst_sz, src, src_sz, 1);
+				if (ZSTD_isError(len))
+				{
+					if (ZSTD_getErrorCode(len) == ZSTD_error_dstSize_tooSmall)
+						return -1;
+					elog(ERROR, "%s", ZSTD_getErrorName(len));
+				}
+				return (int32) len;
+			}
+#endif
+#ifdef HAVE_LIBZ
+		case AUTO_CODEC_ZLIB:
+			{
+				unsigned long len = dst_sz;
+				int			last_error;
+
+				last_error = compress2((Bytef *) dst, &len,
+									   (const Bytef *) src, src_sz, 1);
+				if (last_error == Z_BUF_ERROR)
+					return -1;
+				if (last_error != Z_OK)
+					elog(ERROR, "zlib compression failed with error %d", last_error);
+				return (int32) len;
+			}
+#endif
+		default:
+			elog(ERROR, "unrecognized auto compression codec %d", codec);
+	}
+
+	return -1;					/* keep compiler quiet */
+}
+
+/*
+ * Decompress with one codec.  Returns the decompressed size.
+ */
+static int32
+auto_codec_decompress(auto_state *state, int codec,
+					  const char *src, int32 src_sz, char *dst, int32 dst_sz)
+{
+	switch (codec)
+	{
+#ifdef USE_LZ4
+		case AUTO_CODEC_LZ4:
+			{
+				int			len;
+
+				len = LZ4_decompress_safe(src, dst, src_sz, dst_sz);
+				if (len < 0)
+					elog(ERROR, "lz4 decompression failed: compressed data is corrupt");
+				return len;
+			}
+#endif
+#ifdef USE_ZSTD
+		case AUTO_CODEC_ZSTD:
+			{
+				size_t		len;
+
+				len = ZSTD_decompressDCtx(state->zstd_ctx->dctx,
+										  dst, dst_sz, src, src_sz);
+				if (ZSTD_isError(len))
+					elog(ERROR, "%s", ZSTD_getErrorName(len));
+				return (int32) len;
+			}
+#endif
+#ifdef HAVE_LIBZ
+		case AUTO_CODEC_ZLIB:
+			{
+				unsigned long len = dst_sz;
+				int			last_error;
+
+				last_error = uncompress((Bytef *) dst, &len,
+										(const Bytef *) src, src_sz);
+				if (last_error != Z_OK)
+					elog(ERROR, "zlib decompression failed with error %d", last_error);
+				return (int32) len;
+			}
+#endif
+		default:
+			if (codec == AUTO_CODEC_LZ4 || codec == AUTO_CODEC_ZSTD ||
+				codec == AUTO_CODEC_ZLIB)
+				ereport(ERROR,
+						(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+						 errmsg("block was compressed with %s, which is not supported by this build",
+								codec == AUTO_CODEC_LZ4 ? "lz4" :
+								codec == AUTO_CODEC_ZSTD ? "zstd" : "zlib")));
+			elog(ERROR, "auto compression encountered unknown codec %d", codec);
+	}
+
+	return -1;					/* keep compiler quiet */
+}
+
+/*
+ * Choose among the candidates, given their compressed sizes and decompression
+ * times for raw_bytes of input.  Returns the index of the chosen candidate, or
+ * -1 if the data is better left uncompressed.
+ */
+static int
+auto_pick(int ncandidates, int64 raw_bytes, const int64 *bytes,
+		  const instr_time *times)
+{
+	int			smallest = -1;
+	int			best;
+	int64		limit;
+
+	for (int i = 0; i < ncandidates; i++)
+	{
+		if (smallest < 0 || bytes[i] < bytes[smallest])
+			smallest = i;
+	}
+	if (smallest < 0 ||
+		bytes[smallest] > raw_bytes - raw_bytes * AUTO_MIN_SAVING_PCT / 100)
+		return -1;
+
+	limit = bytes[smallest] + bytes[smallest] * AUTO_SIZE_SLACK_PCT / 100;
+	best = smallest;
+	for (int i = 0; i < ncandidates; i++)
+	{
+		if (bytes[i] <= limit &&
+			INSTR_TIME_GET_DOUBLE(times[i]) < INSTR_TIME_GET_DOUBLE(times[best]))
+			best = i;
+	}
+
+	return best;
+}
+
+/*
+ * Compress one sample block with every candidate, and add the results to the
+ * sample totals.  Returns the index of the candidate this block is best
+ * compressed with, or -1.
+ */
+static int
+auto_sample_block(auto_state *state, const char *src, int32 src_sz)
+{
+	int64		bytes[AUTO_MAX_CANDIDATES] = {0};
+	instr_time	times[AUTO_MAX_CANDIDATES] = {{0}};
+
+	if (state->trial_buf_sz < src_sz)
+	{
+		if (state->trial_buf)
+		{
+			pfree(state->trial_buf);
+			pfree(state->check_buf);
+		}
+		state->trial_buf = MemoryContextAlloc(state->mcxt, src_sz);
+		state->check_buf = MemoryContextAlloc(state->mcxt, src_sz);
+		state->trial_buf_sz = src_sz;
+	}
+
+	for (int i = 0; i < state->ncandidates; i++)
+	{
+		auto_candidate *c = &state->candidates[i];
+		int32		len;
+
+		INSTR_TIME_SET_ZERO(times[i]);
+
+		/* Leave room for the codec byte, like the real thing */
+		len = auto_codec_compress(state, c->codec, src, src_sz,
+								  state->trial_buf, src_sz - 1);
+		if (len < 0)
+			bytes[i] = src_sz;
+		else
+		{
+			instr_time	start;
+			instr_time	end;
+
+			bytes[i] = len + 1;
+
+			INSTR_TIME_SET_CURRENT(start);
+			(void) auto_codec_decompress(state, c->codec, state->trial_buf, len,
+										 state->check_buf, src_sz);
+			INSTR_TIME_SET_CURRENT(end);
+			INSTR_TIME_ACCUM_DIFF(times[i], end, start);
+		}
+
+		c->sample_bytes += bytes[i];
+		INSTR_TIME_ADD(c->sample_time, times[i]);
+	}
+	state->sample_raw_bytes += src_sz;
+
+	return auto_pick(state->ncandidates, src_sz, bytes, times);
+}
+
+/*
+ * At the end of a sample, choose the codec for the blocks up to the next one.
+ */
+static void
+auto_finish_sample(auto_state *state)
+{
+	int64		bytes[AUTO_MAX_CANDIDATES] = {0};
+	instr_time	times[AUTO_MAX_CANDIDATES] = {{0}};
+
+	for (int i = 0; i < state->ncandidates; i++)
+	{
+		bytes[i] = state->candidates[i].sample_bytes;
+		times[i] = state->candidates[i].sample_time;
+
+		state->candidates[i].sample_bytes = 0;
+		INSTR_TIME_SET_ZERO(state->candidates[i].sample_time);
+	}
+
+	state->chosen = auto_pick(state->ncandidates, state->sample_raw_bytes,
+							  bytes, times);
+	state->sample_raw_bytes = 0;
+}
+
+Datum
+auto_constructor(PG_FUNCTION_ARGS)
+{
+	/* PG_GETARG_POINTER(0) is TupleDesc that is currently unused. */
+
+	StorageAttributes *sa = (StorageAttributes *) PG_GETARG_POINTER(1);
+	CompressionState *cs = palloc0(sizeof(CompressionState));
+	auto_state *state = palloc0(sizeof(auto_state));
+	bool		compress = PG_GETARG_BOOL(2);
+
+	if (!PointerIsValid(sa->comptype))
+		elog(ERROR, "auto_constructor called with no compression type");
+
+	cs->opaque = (void *) state;
+	cs->desired_sz = NULL;
+
+	if (sa->complevel == 0)
+		sa->complevel = 1;
+
+	state->compress = compress;
+	state->chosen = -1;
+	state->mcxt = CurrentMemoryContext;
+
+#ifdef USE_LZ4
+	state->candidates[state->ncandidates++].codec = AUTO_CODEC_LZ4;
+	if (compress)
+		state->lz4_workspace = palloc(LZ4_sizeofState());
+#endif
+#ifdef USE_ZSTD
+	state->candidates[state->ncandidates++].codec = AUTO_CODEC_ZSTD;
+	state->zstd_ctx = zstd_alloc_context();
+	state->zstd_ctx->dctx = ZSTD_createDCtx();
+	if (!state->zstd_ctx->dctx)
+		elog(ERROR, "out of memory");
+	if (compress)
+	{
+		state->zstd_ctx->cctx = ZSTD_createCCtx();
+		if (!state->zstd_ctx->cctx)
+			elog(ERROR, "out of memory");
+	}
+#elif defined(HAVE_LIBZ)
+	state->candidates[state->ncandidates++].codec = AUTO_CODEC_ZLIB;
+#endif
+
+	PG_RETURN_POINTER(cs);
+}
+
+Datum
+auto_destructor(PG_FUNCTION_ARGS)
+{
+	CompressionState *cs = (CompressionState *) PG_GETARG_POINTER(0);
+
+	if (cs != NULL && cs->opaque != NULL)
+	{
+		auto_state *state = (auto_state *) cs->opaque;
+
+		if (state->trial_buf)
+		{
+			pfree(state->trial_buf);
+			pfree(state->check_buf);
+		}
+#ifdef USE_LZ4
+		if (state->lz4_workspace)
+			pfree(state->lz4_workspace);
+#endif
+#ifdef USE_ZSTD
+		zstd_free_context(state->zstd_ctx);
+#endif
+		pfree(state);
+	}
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * auto compression implementation
+ *
+ * Like the other compressors, dst_used is set to src_sz when the block is
+ * not worth compressing; the caller then stores it uncompressed.
+ */
+Datum
+auto_compress(PG_FUNCTION_ARGS)
+{
+	const char *src = PG_GETARG_POINTER(0);
+	int32		src_sz = PG_GETARG_INT32(1);
+	char	   *dst = PG_GETARG_POINTER(2);
+	int32		dst_sz = PG_GETARG_INT32(3);
+	int32	   *dst_used = (int32 *) PG_GETARG_POINTER(4);
+	CompressionState *cs = (CompressionState *) PG_GETARG_POINTER(5);
+	auto_state *state = (auto_state *) cs->opaque;
+	int			use;
+	int32		len;
+
+	Assert(state->compress);
+
+	*dst_used = src_sz;
+	if (state->ncandidates == 0 || src_sz < 2 || dst_sz < 2)
+		PG_RETURN_VOID();
+
+	if (state->nblocks++ % AUTO_RESAMPLE_INTERVAL < AUTO_SAMPLE_BLOCKS)
+	{
+		use = auto_sample_block(state, src, src_sz);
+
+		if (state->nblocks % AUTO_RESAMPLE_INTERVAL == AUTO_SAMPLE_BLOCKS)
+			auto_finish_sample(state);
+	}
+	else
+		use = state->chosen;
+
+	if (use < 0)
+		PG_RETURN_VOID();
+
+	len = auto_codec_compress(state, state->candidates[use].codec,
+							  src, src_sz, dst + 1, Min(dst_sz, src_sz) - 1);
+	if (len >= 0 && len + 1 < src_sz)
+	{
+		dst[0] = (char) state->candidates[use].codec;
+		*dst_used = len + 1;
+	}
+
+	PG_RETURN_VOID();
+}
+
+Datum
+auto_decompress(PG_FUNCTION_ARGS)
+{
+	const char *src = PG_GETARG_POINTER(0);
+	int32		src_sz = PG_GETARG_INT32(1);
+	char	   *dst = PG_GETARG_POINTER(2);
+	int32		dst_sz = PG_GETARG_INT32(3);
+	int32	   *dst_used = (int32 *) PG_GETARG_POINTER(4);
+	CompressionState *cs = (CompressionState *) PG_GETARG_POINTER(5);
+	auto_state *state = (auto_state *) cs->opaque;
+
+	if (src_sz <= 1)
+		elog(ERROR, "invalid source buffer size %d", src_sz);
+	if (dst_sz <= 0)
+		elog(ERROR, "invalid destination buffer size %d", dst_sz);
+
+	*dst_used = auto_codec_decompress(state, (uint8) src[0],
+									  src + 1, src_sz - 1, dst, dst_sz);
+
+	PG_RETURN_VOID();
+}
+
+Datum
+auto_validator(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_VOID();
+}
@@ -14,6 +14,7 @@
  */
 #include "postgres.h"
 
+#include "access/appendonly_visimap.h"
 #include "access/appendonlywriter.h"
 #include "access/htup_details.h"
 #include "catalog/gp_fastsequence.h"
@@ -24,9 +25,85 @@
 #include "access/htup.h"
 #include "access/heapam.h"
 #include "utils/syscache.h"
+#include "utils/timestamp.h"
+#include "miscadmin.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/hsearch.h"
 
 #include "catalog/gp_indexing.h"
 
+/* GUC: number of sequences cached in shared memory, 0 disables caching */
+int			gp_fastsequence_cache_size = 1024;
+
+/* GUC: upper bound of the range reserved for a cached sequence at once */
+int			gp_fastsequence_cache_max_range = 32768;
+
+/*
+ * A cached sequence reserves twice as many extra numbers as last time when it
+ * runs out within FASTSEQ_CACHE_GROW_MS of the previous reservation, and half
+ * as many when they lasted longer than FASTSEQ_CACHE_SHRINK_MS.  The first
+ * reservation of a sequence takes no extra numbers.
+ */
+#define FASTSEQ_CACHE_GROW_MS		1000
+#define FASTSEQ_CACHE_SHRINK_MS		10000
+
+typedef struct FastSequenceCacheKey
+{
+	Oid			dbid;
+	Oid			objid;
+	int64		objmod;
+} FastSequenceCacheKey;
+
+typedef struct FastSequenceCacheLookupEnt
+{
+	FastSequenceCacheKey key;
+	int			slot;			/* index into FastSequenceCacheCtl.slots */
+} FastSequenceCacheLookupEnt;
+
+typedef struct FastSequenceCacheSlot
+{
+	FastSequenceCacheKey key;
+	bool		inUse;
+	bool		usage;			/* set by lookups, cleared by the clock hand */
+	int64		next;			/* first sequence number not handed out yet */
+	int64		limit;			/* last_sequence stored in gp_fastsequence */
+	int64		rangeSize;		/* extra numbers taken by the last reservation */
+	TimestampTz lastReserved;	/* time of the last reservation */
+} FastSequenceCacheSlot;
+
+typedef struct FastSequenceCacheCtl
+{
+	uint64		generation;		/* bumped by every invalidation */
+	int			clockHand;		/* next slot to consider for replacement */
+	FastSequenceCacheSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} FastSequenceCacheCtl;
+
+/*
+ * What GetFastSequences() needs to reserve a new range after a cache miss.
+ * The numbers left in the cached range, if any, are claimed by the caller
+ * and handed out first so that the result stays consecutive.
+ */
+typedef struct FastSequenceCacheMiss
+{
+	uint64		generation;
+	int64		rangeSize;
+	int64		claimedStart;
+	int64		claimedCount;
+} FastSequenceCacheMiss;
+
+/* Both are protected by FastSequenceCacheLock */
+static FastSequenceCacheCtl *fastSequenceCache = NULL;
+static HTAB *fastSequenceCacheHash = NULL;
+
+/*
+ * Set once the current transaction removed gp_fastsequence entries.  If it
+ * aborts, or the subtransaction that removed them does, the old entries come
+ * back, while the cache may hold ranges reserved from the new ones since,
+ * e.g. after a TRUNCATE rolled back to a savepoint.
+ */
+static bool fastSequenceEntriesRemoved = false;
+
 static void insert_or_update_fastsequence(
 	Relation gp_fastsequence_rel,
 	HeapTuple oldTuple,
@@ -34,6 +111,321 @@ static void insert_or_update_fastsequence(
 	Oid objid,
 	int64 objmod,
 	int64 newLastSequence);
+static int64 reserve_fast_sequences(Oid objid, int64 objmod,
+									int64 minSequence, int64 numSequences,
+									int64 extraSequences, int64 *lastSequence);
+
+/*
+ * Every call of GetFastSequences() updates the gp_fastsequence row of the
+ * segment file in place, which WAL-logs the update and exclusive-locks the
+ * catalog buffer.  Frequent small inserts into AO tables pay that for every
+ * statement, so the numbers are instead reserved from the catalog in larger
+ * ranges, and the part of a range not handed out yet is kept in a fixed
+ * number of shared memory slots, replaced with the clock algorithm.  The
+ * catalog always holds the high-water mark of the reserved numbers, so a
+ * crash or an evicted slot only leaves a gap in the sequence.  The size of
+ * the next range follows how fast the previous one was used up, and a range
+ * never extends into the next APPENDONLY_VISIMAP_MAX_RANGE rows, so that
+ * the row count readers derive from last_sequence, like BRIN's, grows by
+ * less than one such range.
+ *
+ * Every change to gp_fastsequence other than a reservation removes the
+ * affected slots and bumps the cache generation.  A range reserved after a
+ * cache miss is only cached if the generation has not changed in between, so
+ * that a range reserved from an old catalog value does not slip back in.
+ */
+static void
+FastSequenceCache_InitKey(FastSequenceCacheKey *key, Oid objid, int64 objmod)
+{
+	memset(key, 0, sizeof(FastSequenceCacheKey));
+	key->dbid = MyDatabaseId;
+	key->objid = objid;
+	key->objmod = objmod;
+}
+
+static void
+FastSequenceCache_RemoveSlot(int slot)
+{
+	FastSequenceCacheSlot *s = &fastSequenceCache->slots[slot];
+
+	Assert(s->inUse);
+	hash_search(fastSequenceCacheHash, &s->key, HASH_REMOVE, NULL);
+	s->inUse = false;
+}
+
+Size
+FastSequenceCache_ShmemSize(void)
+{
+	Size		size;
+
+	if (gp_fastsequence_cache_size == 0)
+		return 0;
+
+	size = offsetof(FastSequenceCacheCtl, slots);
+	size = add_size(size, mul_size(gp_fastsequence_cache_size,
+								   sizeof(FastSequenceCacheSlot)));
+	size = add_size(size, hash_estimate_size(gp_fastsequence_cache_size,
+											 sizeof(FastSequenceCacheLookupEnt)));
+
+	return size;
+}
+
+void
+FastSequenceCache_ShmemInit(void)
+{
+	HASHCTL		info;
+	bool		found;
+
+	if (gp_fastsequence_cache_size == 0)
+		return;
+
+	fastSequenceCache = ShmemInitStruct("gp_fastsequence cache",
+										add_size(offsetof(FastSequenceCacheCtl, slots),
+												 mul_size(gp_fastsequence_cache_size,
+														  sizeof(FastSequenceCacheSlot))),
+										&found);
+	if (!found)
+	{
+		fastSequenceCache->generation = 0;
+		fastSequenceCache->clockHand = 0;
+		for (int i = 0; i < gp_fastsequence_cache_size; i++)
+			fastSequenceCache->slots[i].inUse = false;
+	}
+
+	info.keysize = sizeof(FastSequenceCacheKey);
+	info.entrysize = sizeof(FastSequenceCacheLookupEnt);
+	fastSequenceCacheHash = ShmemInitHash("gp_fastsequence cache lookup",
+										  gp_fastsequence_cache_size,
+										  gp_fastsequence_cache_size,
+										  &info,
+										  HASH_ELEM | HASH_BLOBS);
+}
+
+/*
+ * Hands out numSequences numbers, starting at minSequence or later, from the
+ * cached range of (objid, objmod).  Returns false if the range has not got
+ * enough of them left; 'miss' then tells how much to reserve from the
+ * catalog, and which numbers of the old range were claimed by the caller.
+ */
+static bool
+FastSequenceCache_Take(Oid objid, int64 objmod,
+					   int64 minSequence, int64 numSequences,
+					   int64 *firstSequence, FastSequenceCacheMiss *miss)
+{
+	FastSequenceCacheKey key;
+	FastSequenceCacheLookupEnt *ent;
+	int64		rangeSize = 0;
+
+	FastSequenceCache_InitKey(&key, objid, objmod);
+
+	LWLockAcquire(FastSequenceCacheLock, LW_EXCLUSIVE);
+
+	miss->generation = fastSequenceCache->generation;
+	miss->claimedStart = 0;
+	miss->claimedCount = 0;
+
+	ent = hash_search(fastSequenceCacheHash, &key, HASH_FIND, NULL);
+	if (ent != NULL)
+	{
+		FastSequenceCacheSlot *s = &fastSequenceCache->slots[ent->slot];
+		int64		start = Max(s->next, minSequence);
+		TimestampTz now;
+
+		s->usage = true;
+
+		if (start + numSequences - 1 <= s->limit)
+		{
+			s->next = start + numSequences;
+			LWLockRelease(FastSequenceCacheLock);
+
+			*firstSequence = start;
+			return true;
+		}
+
+		/* Claim what is left, the caller reserves the rest right after it */
+		if (start <= s->limit)
+		{
+			miss->claimedStart = start;
+			miss->claimedCount = s->limit - start + 1;
+			s->next = s->limit + 1;
+		}
+
+		now = GetCurrentTimestamp();
+		rangeSize = s->rangeSize;
+		if (!TimestampDifferenceExceeds(s->lastReserved, now, FASTSEQ_CACHE_GROW_MS))
+			rangeSize = Max(rangeSize * 2, NUM_FAST_SEQUENCES);
+		else if (TimestampDifferenceExceeds(s->lastReserved, now, FASTSEQ_CACHE_SHRINK_MS))
+			rangeSize /= 2;
+	}
+
+	LWLockRelease(FastSequenceCacheLock);
+
+	miss->rangeSize = Min(rangeSize, gp_fastsequence_cache_max_range);
+	return false;
+}
+
+/*
+ * Caches the numbers next..limit of (objid, objmod), just reserved from the
+ * catalog, unless the cache has been invalidated since 'generation' was
+ * taken, or holds a later range already.
+ */
+static void
+FastSequenceCache_Put(Oid objid, int64 objmod, uint64 generation,
+					  int64 next, int64 limit, int64 rangeSize)
+{
+	FastSequenceCacheKey key;
+	FastSequenceCacheLookupEnt *ent;
+	FastSequenceCacheSlot *s;
+	bool		found;
+
+	FastSequenceCache_InitKey(&key, objid, objmod);
+
+	LWLockAcquire(FastSequenceCacheLock, LW_EXCLUSIVE);
+
+	if (fastSequenceCache->generation != generation)
+	{
+		LWLockRelease(FastSequenceCacheLock);
+		return;
+	}
+
+	ent = hash_search(fastSequenceCacheHash, &key, HASH_FIND, NULL);
+	if (ent == NULL)
+	{
+		int			slot;
+
+		/* Find a slot to replace with the clock algorithm */
+		for (;;)
+		{
+			slot = fastSequenceCache->clockHand;
+			fastSequenceCache->clockHand = (slot + 1) % gp_fastsequence_cache_size;
+			s = &fastSequenceCache->slots[slot];
+
+			if (!s->inUse)
+				break;
+			if (!s->usage)
+			{
+				FastSequenceCache_RemoveSlot(slot);
+				break;
+			}
+			s->usage = false;
+		}
+
+		ent = hash_search(fastSequenceCacheHash, &key, HASH_ENTER_NULL, &found);
+		if (ent == NULL)
+		{
+			LWLockRelease(FastSequenceCacheLock);
+			return;
+		}
+		Assert(!found);
+		ent->slot = slot;
+	}
+	else if (fastSequenceCache->slots[ent->slot].limit >= limit)
+	{
+		/* Someone else reserved a later range meanwhile, keep that one */
+		LWLockRelease(FastSequenceCacheLock);
+		return;
+	}
+
+	s = &fastSequenceCache->slots[ent->slot];
+	s->key = key;
+	s->inUse = true;
+	s->usage = true;
+	s->next = next;
+	s->limit = limit;
+	s->rangeSize = rangeSize;
+	s->lastReserved = GetCurrentTimestamp();
+
+	LWLockRelease(FastSequenceCacheLock);
+}
+
+/*
+ * Removes the cached range of (objid, objmod), or of all objmods of objid if
+ * objmod is -1.  Called for every change to gp_fastsequence other than a
+ * reservation.
+ */
+static void
+FastSequenceCache_Invalidate(Oid objid, int64 objmod)
+{
+	if (fastSequenceCache == NULL)
+		return;
+
+	LWLockAcquire(FastSequenceCacheLock, LW_EXCLUSIVE);
+
+	fastSequenceCache->generation++;
+
+	if (objmod >= 0)
+	{
+		FastSequenceCacheKey key;
+		FastSequenceCacheLookupEnt *ent;
+
+		FastSequenceCache_InitKey(&key, objid, objmod);
+		ent = hash_search(fastSequenceCacheHash, &key, HASH_FIND, NULL);
+		if (ent != NULL)
+			FastSequenceCache_RemoveSlot(ent->slot);
+	}
+	else
+	{
+		for (int i = 0; i < gp_fastsequence_cache_size; i++)
+		{
+			FastSequenceCacheSlot *s = &fastSequenceCache->slots[i];
+
+			if (s->inUse && s->key.dbid == MyDatabaseId && s->key.objid == objid)
+				FastSequenceCache_RemoveSlot(i);
+		}
+	}
+
+	LWLockRelease(FastSequenceCacheLock);
+}
+
+/*
+ * Forgets all cached ranges of the given database, which is being dropped.
+ * Otherwise a later database that happens to get the same OID could find
+ * them.
+ */
+void
+FastSequenceCache_ForgetDatabase(Oid dbid)
+{
+	if (fastSequenceCache == NULL)
+		return;
+
+	LWLockAcquire(FastSequenceCacheLock, LW_EXCLUSIVE);
+
+	fastSequenceCache->generation++;
+
+	for (int i = 0; i < gp_fastsequence_cache_size; i++)
+	{
+		FastSequenceCacheSlot *s = &fastSequenceCache->slots[i];
+
+		if (s->inUse && s->key.dbid == dbid)
+			FastSequenceCache_RemoveSlot(i);
+	}
+
+	LWLockRelease(FastSequenceCacheLock);
+}
+
+/*
+ * Forgets the cached ranges of the current database at the end of a
+ * transaction that removed gp_fastsequence entries, unless it commits.  A
+ * prepared transaction may still be rolled back, so it forgets them too.
+ */
+void
+AtEOXact_FastSequence(bool isCommit, bool isPrepare)
+{
+	if (fastSequenceEntriesRemoved && (!isCommit || isPrepare))
+		FastSequenceCache_ForgetDatabase(MyDatabaseId);
+	fastSequenceEntriesRemoved = false;
+}
+
+/*
+ * Same, at the abort of a subtransaction.  The flag stays set, as the
+ * entries may have been removed by the parent, which can still abort.
+ */
+void
+AtSubAbort_FastSequence(void)
+{
+	if (fastSequenceEntriesRemoved)
+		FastSequenceCache_ForgetDatabase(MyDatabaseId);
+}
 
 /*
  * gp_fastsequence is used to generate and keep track of row numbers for AO
@@ -82,6 +474,9 @@ InsertInitialFastSequenceEntries(Oid objid)
 	CatalogTupleInsert(gp_fastsequence_rel, tuple);
 	heap_freetuple(tuple);
 
+	/* A relation that happens to reuse the OID must not find old ranges */
+	FastSequenceCache_Invalidate(objid, -1);
+
 	table_close(gp_fastsequence_rel, RowExclusiveLock);
 }
 
@@ -128,6 +523,8 @@ InsertFastSequenceEntry(Oid objid, int64 objmod, int64 lastSequence)
 						lastSequence);
 	systable_endscan(scan);
 
+	FastSequenceCache_Invalidate(objid, objmod);
+
 	/*
 	 * gp_fastsequence table locking for AO inserts uses bottom up approach
 	 * meaning the locks are first acquired on the segments and later on the
@@ -216,14 +613,68 @@ insert_or_update_fastsequence(Relation gp_fastsequence_rel,
  * number is the maximal value between 'lastsequence' + 1 and minSequence.
  * The length of the list is given.
  *
+ * The numbers come from the range cached in shared memory for (objid,
+ * objmod) if it has enough of them left. Otherwise a new range is reserved
+ * from gp_fastsequence and the rest of it is cached.
+ */
+int64 GetFastSequences(Oid objid, int64 objmod,
+					   int64 minSequence, int64 numSequences)
+{
+	FastSequenceCacheMiss miss;
+	int64		firstSequence;
+	int64		lastSequence;
+	int64		result;
+
+	if (fastSequenceCache == NULL || gp_fastsequence_cache_max_range == 0)
+		return reserve_fast_sequences(objid, objmod, minSequence,
+									  numSequences, 0, NULL);
+
+	if (FastSequenceCache_Take(objid, objmod, minSequence, numSequences,
+							   &firstSequence, &miss))
+		return firstSequence;
+
+	/*
+	 * The claimed numbers are used only if the new range follows them, which
+	 * it does unless someone else reserved from the catalog meanwhile.  The
+	 * whole request is reserved regardless, to be enough in that case too.
+	 */
+	if (miss.claimedCount > 0)
+		minSequence = miss.claimedStart + miss.claimedCount;
+	firstSequence = reserve_fast_sequences(objid, objmod, minSequence,
+										   numSequences, miss.rangeSize,
+										   &lastSequence);
+
+	if (miss.claimedCount > 0 && firstSequence == minSequence)
+		result = miss.claimedStart;
+	else
+		result = firstSequence;
+
+	FastSequenceCache_Put(objid, objmod, miss.generation,
+						  result + numSequences, lastSequence,
+						  miss.rangeSize);
+
+	return result;
+}
+
+/*
+ * reserve_fast_sequences
+ *
+ * Reserve numSequences consecutive numbers from gp_fastsequence, starting
+ * at the maximal value between 'lastsequence' + 1 and minSequence, and up
+ * to extraSequences more that stay within the APPENDONLY_VISIMAP_MAX_RANGE
+ * rows of the last requested one. The new lastsequence value is returned in
+ * *lastSequence, if given.
+ *
  * If there is not such an entry for objid in the table, create
  * one here.
  *
  * The existing entry for objid in the table is updated with a new
  * lastsequence value.
  */
-int64 GetFastSequences(Oid objid, int64 objmod,
-					   int64 minSequence, int64 numSequences)
+static int64
+reserve_fast_sequences(Oid objid, int64 objmod,
+					   int64 minSequence, int64 numSequences,
+					   int64 extraSequences, int64 *lastSequence)
 {
 	Relation gp_fastsequence_rel;
 	ScanKeyData scankey[2];
@@ -275,9 +726,21 @@ int64 GetFastSequences(Oid objid, int64 objmod,
 		newLastSequence = firstSequence + numSequences - 1;
 	}
 
+	if (extraSequences > 0)
+	{
+		int64		rangeEnd;
+
+		rangeEnd = (newLastSequence / APPENDONLY_VISIMAP_MAX_RANGE + 1) *
+			APPENDONLY_VISIMAP_MAX_RANGE - 1;
+		newLastSequence = Min(newLastSequence + extraSequences, rangeEnd);
+	}
+
 	insert_or_update_fastsequence(gp_fastsequence_rel, tuple, tupleDesc,
 						objid, objmod, newLastSequence);
 
+	if (lastSequence)
+		*lastSequence = newLastSequence;
+
 	systable_endscan(scan);
 		
 	/* Refer to the comment at the end of InsertFastSequenceEntry. */
@@ -386,5 +849,9 @@ RemoveFastSequenceEntry(Oid objid)
 	}
 
 	systable_endscan(sscan);
+
+	FastSequenceCache_Invalidate(objid, -1);
+	fastSequenceEntriesRemoved = true;
+
 	table_close(rel, RowExclusiveLock);
 }
@@ -527,7 +527,10 @@ compresstype_is_valid(char *comptype)
 #ifdef USE_ZSTD
 			"zstd",
 #endif
-			"rle_type", "none"};
+#ifdef USE_LZ4
+			"lz4",
+#endif
+			"rle_type", "auto", "none"};
 
 	for (int i = 0; i < ARRAY_SIZE(valid_comptypes); ++i)
 	{
@@ -0,0 +1,246 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbappendonlyblockcache.c
+ *	  backend-local cache of decompressed append-only storage blocks.
+ *
+ * Random access into an append-optimized table, by an index scan or a
+ * nested loop join on the inner side, fetches rows one at a time, and the
+ * fetch descriptors only keep the block they have just read.  Rows spread
+ * over a few blocks decompress the same blocks again and again, which can
+ * cost far more than the read itself.  The storage read layer therefore
+ * keeps the most recently decompressed blocks of fetch descriptors here,
+ * keyed by the relation file, the physical segment file number and the
+ * offset of the block header, and evicts the least recently used blocks
+ * once gp_appendonly_block_cache_size is exceeded.
+ *
+ * The cache is private to the backend and only lives until the end of the
+ * transaction, or the abort of a subtransaction.  The locks a transaction
+ * holds on the relations it reads keep the blocks it has read from being
+ * rewritten meanwhile, except by a non-transactional truncate in the same
+ * transaction, which forgets the relation's blocks.
+ *
+ * Portions Copyright (c) 2023-Present, Cloudberry inc
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/cdb/cdbappendonlyblockcache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/xact.h"
+#include "cdb/cdbappendonlyblockcache.h"
+#include "lib/ilist.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+
+/* GUC: size of the cache in kilobytes, 0 disables it */
+int			gp_appendonly_block_cache_size = 8192;
+
+typedef struct BlockCacheKey
+{
+	RelFileNode node;
+	int32		segmentFileNum;	/* physical, i.e. includes the column */
+	int64		headerOffsetInFile;
+} BlockCacheKey;
+
+typedef struct BlockCacheEnt
+{
+	BlockCacheKey key;
+	dlist_node	lruNode;		/* most recently used at the head */
+	int32		compressedLen;
+	int32		uncompressedLen;
+	uint8	   *content;
+} BlockCacheEnt;
+
+static MemoryContext blockCacheContext = NULL;
+static HTAB *blockCacheHash = NULL;
+static dlist_head blockCacheLru;
+static Size blockCacheBytes = 0;
+static bool blockCacheCallbacksRegistered = false;
+
+static void
+BlockCache_Reset(void)
+{
+	if (blockCacheHash == NULL)
+		return;
+
+	/* The hash table and the contents all live in blockCacheContext */
+	MemoryContextReset(blockCacheContext);
+	blockCacheHash = NULL;
+	dlist_init(&blockCacheLru);
+	blockCacheBytes = 0;
+}
+
+static void
+BlockCache_XactCallback(XactEvent event, void *arg)
+{
+	switch (event)
+	{
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PARALLEL_ABORT:
+		case XACT_EVENT_PREPARE:
+			BlockCache_Reset();
+			break;
+		default:
+			break;
+	}
+}
+
+static void
+BlockCache_SubXactCallback(SubXactEvent event, SubTransactionId mySubid,
+						   SubTransactionId parentSubid, void *arg)
+{
+	if (event == SUBXACT_EVENT_ABORT_SUB)
+		BlockCache_Reset();
+}
+
+static void
+BlockCache_InitKey(BlockCacheKey *key, RelFileNode *relFileNode,
+				   int32 segmentFileNum, int64 headerOffsetInFile)
+{
+	memset(key, 0, sizeof(BlockCacheKey));
+	key->node = *relFileNode;
+	key->segmentFileNum = segmentFileNum;
+	key->headerOffsetInFile = headerOffsetInFile;
+}
+
+static void
+BlockCache_Remove(BlockCacheEnt *ent)
+{
+	dlist_delete(&ent->lruNode);
+	blockCacheBytes -= ent->uncompressedLen;
+	pfree(ent->content);
+	hash_search(blockCacheHash, &ent->key, HASH_REMOVE, NULL);
+}
+
+/*
+ * Copies the decompressed content of the given block into contentOut, if it
+ * is cached.  Returns false otherwise.  The lengths from the block header
+ * must match those of the cached block.
+ */
+bool
+AppendOnlyBlockCache_Lookup(RelFileNode *relFileNode,
+							int32 segmentFileNum,
+							int64 headerOffsetInFile,
+							int32 compressedLen,
+							int32 uncompressedLen,
+							uint8 *contentOut)
+{
+	BlockCacheKey key;
+	BlockCacheEnt *ent;
+
+	if (blockCacheHash == NULL)
+		return false;
+
+	BlockCache_InitKey(&key, relFileNode, segmentFileNum, headerOffsetInFile);
+	ent = hash_search(blockCacheHash, &key, HASH_FIND, NULL);
+	if (ent == NULL)
+		return false;
+
+	if (ent->compressedLen != compressedLen ||
+		ent->uncompressedLen != uncompressedLen)
+	{
+		BlockCache_Remove(ent);
+		return false;
+	}
+
+	dlist_move_head(&blockCacheLru, &ent->lruNode);
+	memcpy(contentOut, ent->content, uncompressedLen);
+
+	return true;
+}
+
+/*
+ * Adds the decompressed content of the given block to the cache, evicting
+ * the least recently used blocks to make room.
+ */
+void
+AppendOnlyBlockCache_Insert(RelFileNode *relFileNode,
+							int32 segmentFileNum,
+							int64 headerOffsetInFile,
+							int32 compressedLen,
+							int32 uncompressedLen,
+							uint8 *content)
+{
+	Size		limit = (Size) gp_appendonly_block_cache_size * 1024;
+	BlockCacheKey key;
+	BlockCacheEnt *ent;
+	bool		found;
+
+	if (uncompressedLen > limit)
+		return;
+
+	if (blockCacheContext == NULL)
+		blockCacheContext = AllocSetContextCreate(TopMemoryContext,
+												  "AppendOnlyBlockCache",
+												  ALLOCSET_DEFAULT_SIZES);
+
+	if (!blockCacheCallbacksRegistered)
+	{
+		RegisterXactCallback(BlockCache_XactCallback, NULL);
+		RegisterSubXactCallback(BlockCache_SubXactCallback, NULL);
+		blockCacheCallbacksRegistered = true;
+	}
+
+	if (blockCacheHash == NULL)
+	{
+		HASHCTL		info;
+
+		info.keysize = sizeof(BlockCacheKey);
+		info.entrysize = sizeof(BlockCacheEnt);
+		info.hcxt = blockCacheContext;
+		blockCacheHash = hash_create("AppendOnlyBlockCache hash", 256, &info,
+									 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+		dlist_init(&blockCacheLru);
+		blockCacheBytes = 0;
+	}
+
+	BlockCache_InitKey(&key, relFileNode, segmentFileNum, headerOffsetInFile);
+	ent = hash_search(blockCacheHash, &key, HASH_FIND, NULL);
+	if (ent != NULL)
+		BlockCache_Remove(ent);
+
+	while (blockCacheBytes + uncompressedLen > limit)
+	{
+		Assert(!dlist_is_empty(&blockCacheLru));
+		BlockCache_Remove(dlist_tail_element(BlockCacheEnt, lruNode,
+											 &blockCacheLru));
+	}
+
+	/* Allocate the content first, so that an error leaves no entry behind */
+	content = memcpy(MemoryContextAlloc(blockCacheContext, uncompressedLen),
+					 content, uncompressedLen);
+
+	ent = hash_search(blockCacheHash, &key, HASH_ENTER, &found);
+	Assert(!found);
+	ent->compressedLen = compressedLen;
+	ent->uncompressedLen = uncompressedLen;
+	ent->content = content;
+	dlist_push_head(&blockCacheLru, &ent->lruNode);
+	blockCacheBytes += uncompressedLen;
+}
+
+/*
+ * Forgets all cached blocks of the given relation file, whose segment files
+ * are about to be truncated and written again in the same transaction.
+ */
+void
+AppendOnlyBlockCache_ForgetRelFileNode(RelFileNode *relFileNode)
+{
+	HASH_SEQ_STATUS status;
+	BlockCacheEnt *ent;
+
+	if (blockCacheHash == NULL)
+		return;
+
+	hash_seq_init(&status, blockCacheHash);
+	while ((ent = hash_seq_search(&status)) != NULL)
+	{
+		if (RelFileNodeEquals(ent->key.node, *relFileNode))
+			BlockCache_Remove(ent);
+	}
+}
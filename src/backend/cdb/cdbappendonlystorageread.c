@@ -22,6 +22,7 @@
 #include <unistd.h>
 
 #include "catalog/pg_compression.h"
+#include "cdb/cdbappendonlyblockcache.h"
 #include "cdb/cdbappendonlystorage.h"
 #include "cdb/cdbappendonlystoragelayer.h"
 #include "cdb/cdbappendonlystorageformat.h"
@@ -131,6 +132,7 @@ AppendOnlyStorageRead_Init(AppendOnlyStorageRead *storageRead,
 	storageRead->file = -1;
 	storageRead->formatVersion = -1;
 	storageRead->relFileNode = *relFileNode;
+	storageRead->segmentFileNum = -1;
 	
 	MemoryContextSwitchTo(oldMemoryContext);
 
@@ -288,6 +290,9 @@ AppendOnlyStorageRead_FinishOpenFile(AppendOnlyStorageRead *storageRead,
 
 	storageRead->logicalEof = logicalEof;
 
+	/* Until the caller tells, the blocks of this file are not cached */
+	storageRead->segmentFileNum = -1;
+
 	BufferedReadSetFile(&storageRead->bufferedRead,
 						storageRead->file,
 						storageRead->segmentFileName,
@@ -415,6 +420,33 @@ AppendOnlyStorageRead_SetTemporaryRange(AppendOnlyStorageRead *storageRead,
 								  afterFileOffset);
 }
 
+/*
+ * Keep the decompressed blocks read by this session in the backend's block
+ * cache, and look them up there before decompressing.  Meant for fetch
+ * descriptors, which go back and forth between the blocks of a file.
+ */
+void
+AppendOnlyStorageRead_EnableBlockCache(AppendOnlyStorageRead *storageRead)
+{
+	Assert(storageRead->isActive);
+
+	storageRead->useBlockCache = true;
+}
+
+/*
+ * Tell the physical segment file number of the file just opened, which is
+ * part of the block cache key.  Blocks are not cached without it.
+ */
+void
+AppendOnlyStorageRead_SetSegmentFileNum(AppendOnlyStorageRead *storageRead,
+										int32 segmentFileNum)
+{
+	Assert(storageRead->isActive);
+	Assert(storageRead->file != -1);
+
+	storageRead->segmentFileNum = segmentFileNum;
+}
+
 /*
  * Close the current segment file.
  *
@@ -1375,6 +1407,7 @@ AppendOnlyStorageRead_Content(AppendOnlyStorageRead *storageRead,
 			 */
 			PGFunction	decompressor;
 			PGFunction *cfns = storageRead->compression_functions;
+			bool		useBlockCache;
 
 			if (cfns == NULL)
 				ereport(ERROR,
@@ -1383,6 +1416,19 @@ AppendOnlyStorageRead_Content(AppendOnlyStorageRead *storageRead,
 
 			decompressor = cfns[COMPRESSION_DECOMPRESS];
 
+			useBlockCache = (storageRead->useBlockCache &&
+							 storageRead->segmentFileNum >= 0 &&
+							 gp_appendonly_block_cache_size > 0);
+
+			if (useBlockCache &&
+				AppendOnlyBlockCache_Lookup(&storageRead->relFileNode,
+											storageRead->segmentFileNum,
+											storageRead->current.headerOffsetInFile,
+											storageRead->current.compressedLen,
+											storageRead->current.uncompressedLen,
+											contentOut))
+				return;
+
 			gp_decompress(content,    /* Compressed data in block. */
 						  storageRead->current.compressedLen,
 						  contentOut,
@@ -1391,6 +1437,14 @@ AppendOnlyStorageRead_Content(AppendOnlyStorageRead *storageRead,
 						  storageRead->compressionState,
 						  storageRead->bufferCount);
 
+			if (useBlockCache)
+				AppendOnlyBlockCache_Insert(&storageRead->relFileNode,
+											storageRead->segmentFileNum,
+											storageRead->current.headerOffsetInFile,
+											storageRead->current.compressedLen,
+											storageRead->current.uncompressedLen,
+											contentOut);
+
 			if (Debug_appendonly_print_scan)
 				elog(LOG,
 					 "Append-only Storage Read decompressed block for table '%s' "
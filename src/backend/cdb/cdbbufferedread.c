@@ -23,8 +23,17 @@
 #include "pgstat.h"
 #include "utils/guc.h"
 
+/* GUC */
+#ifdef USE_PREFETCH
+int			gp_appendonly_read_ahead_distance = 4;
+#else
+int			gp_appendonly_read_ahead_distance = 0;
+#endif
+
 static void BufferedReadIo(
 			   BufferedRead *bufferedRead);
+static void BufferedReadPrefetch(
+			   BufferedRead *bufferedRead);
 static uint8 *BufferedReadUseBeforeBuffer(
 							BufferedRead *bufferedRead,
 							int32 maxReadAheadLen,
@@ -92,6 +101,7 @@ BufferedReadInit(
 
 	bufferedRead->largeReadPosition = 0;
 	bufferedRead->largeReadLen = 0;
+	bufferedRead->prefetchPosition = 0;
 
 	/*
 	 * Buffer level members.
@@ -146,6 +156,7 @@ BufferedReadSetFile(
 	bufferedRead->haveTemporaryLimitInEffect = false;
 	bufferedRead->temporaryLimitFileLen = 0;
 	bufferedRead->fileOff =0;
+	bufferedRead->prefetchPosition = 0;
 
 	if (fileLen > 0)
 	{
@@ -226,6 +237,78 @@ BufferedReadIo(
 
 	if (VacuumCostActive)
 		VacuumCostBalance += VacuumCostPageMiss;
+
+	BufferedReadPrefetch(bufferedRead);
+}
+
+/*
+ * Ask the kernel to start reading the next gp_appendonly_read_ahead_distance
+ * large reads into the OS cache, so that the disk is busy with them while
+ * the caller decompresses and processes the current one.  Only whole large
+ * reads not requested before are advised, so there is at most one
+ * posix_fadvise call per large read in a sequential scan.
+ *
+ * The read-ahead stops at the temporary limit when one is in effect, as a
+ * random read of a block directory range doesn't continue past it.
+ */
+static void
+BufferedReadPrefetch(
+					 BufferedRead *bufferedRead)
+{
+#ifdef USE_PREFETCH
+	int64		inEffectFileLen;
+	int64		largeReadAfterPos;
+	int64		prefetchLimit;
+
+	if (gp_appendonly_read_ahead_distance <= 0)
+		return;
+
+	if (bufferedRead->haveTemporaryLimitInEffect)
+		inEffectFileLen = bufferedRead->temporaryLimitFileLen;
+	else
+		inEffectFileLen = bufferedRead->fileLen;
+
+	largeReadAfterPos = bufferedRead->largeReadPosition +
+		bufferedRead->largeReadLen;
+	prefetchLimit = largeReadAfterPos +
+		(int64) gp_appendonly_read_ahead_distance * bufferedRead->maxLargeReadLen;
+	if (prefetchLimit > inEffectFileLen)
+		prefetchLimit = inEffectFileLen;
+
+	/*
+	 * Start over after a seek, in either direction.
+	 */
+	if (bufferedRead->prefetchPosition < largeReadAfterPos ||
+		bufferedRead->prefetchPosition > prefetchLimit)
+		bufferedRead->prefetchPosition = largeReadAfterPos;
+
+	while (bufferedRead->prefetchPosition < prefetchLimit)
+	{
+		int32		amount;
+
+		if (prefetchLimit - bufferedRead->prefetchPosition >= bufferedRead->maxLargeReadLen)
+			amount = bufferedRead->maxLargeReadLen;
+		else if (prefetchLimit == inEffectFileLen)
+			amount = (int32) (prefetchLimit - bufferedRead->prefetchPosition);
+		else
+			break;				/* advise the rest with the next large read */
+
+		(void) FilePrefetch(bufferedRead->file,
+							bufferedRead->prefetchPosition,
+							amount,
+							WAIT_EVENT_DATA_FILE_PREFETCH);
+
+		elogif(Debug_appendonly_print_read_block, LOG,
+			   "Append-Only storage read-ahead: table \"%s\", segment file \"%s\", "
+			   "position " INT64_FORMAT ", length %d",
+			   bufferedRead->relationName,
+			   bufferedRead->filePathName,
+			   bufferedRead->prefetchPosition,
+			   amount);
+
+		bufferedRead->prefetchPosition += amount;
+	}
+#endif							/* USE_PREFETCH */
 }
 
 static uint8 *
@@ -418,14 +501,14 @@ BufferedReadSetTemporaryRange(
 			bufferedRead->largeReadLen = (int32) remainingFileLen;
 
 		bufferedRead->largeReadPosition = beginFileOffset;
-
-		if (bufferedRead->largeReadLen > 0)
-			BufferedReadIo(bufferedRead);
 	}
 
+	/* Set before reading, so the read-ahead stops at the limit */
 	bufferedRead->haveTemporaryLimitInEffect = true;
 	bufferedRead->temporaryLimitFileLen = afterFileOffset;
 
+	if (newReadNeeded && bufferedRead->largeReadLen > 0)
+		BufferedReadIo(bufferedRead);
 }
 
 /*
@@ -654,6 +737,7 @@ BufferedReadCompleteFile(
 
 	bufferedRead->largeReadPosition = 0;
 	bufferedRead->largeReadLen = 0;
+	bufferedRead->prefetchPosition = 0;
 }
 
 
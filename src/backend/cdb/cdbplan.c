@@ -686,6 +686,7 @@ plan_tree_mutator(Node *node,
 
 				FLATCOPY(newfilter, filter, RuntimeFilter);
 				PLANMUTATE(newfilter, filter);
+				MUTATE(newfilter->hashkeys, filter->hashkeys, List *);
 				return (Node *) newfilter;
 			}
 			break;
@@ -258,15 +258,18 @@ double		gp_motion_cost_per_row = 0;
 int			gp_segments_for_planner = 0;
 
 int			gp_hashagg_default_nbatches = 32;
+int			gp_hashagg_batch_size = 32;
 
 bool		gp_adjust_selectivity_for_outerjoins = true;
 bool		gp_selectivity_damping_for_scans = false;
 bool		gp_selectivity_damping_for_joins = false;
 double		gp_selectivity_damping_factor = 1;
 bool		gp_enable_runtime_filter = false;
+bool		gp_enable_runtime_filter_pushdown = true;
 bool		gp_selectivity_damping_sigsort = true;
 
 int			gp_hashjoin_tuples_per_bucket = 5;
+int			gp_hashjoin_radix_partition_size = 0;
 int			gp_hashagg_groups_per_bucket = 5;
 
 /* Analyzing aid */
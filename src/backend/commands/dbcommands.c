@@ -37,6 +37,7 @@
 #include "access/xlogutils.h"
 #include "catalog/catalog.h"
 #include "catalog/dependency.h"
+#include "catalog/gp_fastsequence.h"
 #include "catalog/heap.h"
 #include "catalog/indexing.h"
 #include "catalog/objectaccess.h"
@@ -1090,6 +1091,9 @@ dropdb(const char *dbname, bool missing_ok, bool force)
 	 */
 	DropDatabaseBuffers(db_id);
 
+	/* Likewise for the AO row numbers cached for it */
+	FastSequenceCache_ForgetDatabase(db_id);
+
 	/*
 	 * Tell the stats collector to forget it immediately, too.
 	 */
@@ -132,7 +132,7 @@ static void show_incremental_sort_info(IncrementalSortState *incrsortstate,
 									   ExplainState *es);
 static void show_hash_info(HashState *hashstate, ExplainState *es);
 static void show_runtime_filter_info(RuntimeFilterState *rfstate,
-									 ExplainState *es);
+									 List *ancestors, ExplainState *es);
 static void show_memoize_info(MemoizeState *mstate, List *ancestors,
 							  ExplainState *es);
 static void show_hashagg_info(AggState *hashstate, ExplainState *es);
@@ -2557,7 +2557,7 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			break;
 		case T_RuntimeFilter:
 			show_runtime_filter_info(castNode(RuntimeFilterState, planstate),
-									 es);
+									 ancestors, es);
 			break;
 		case T_Motion:
 			{
@@ -3800,8 +3800,30 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 }
 
 static void
-show_runtime_filter_info(RuntimeFilterState *rfstate, ExplainState *es)
+show_runtime_filter_info(RuntimeFilterState *rfstate, List *ancestors,
+						 ExplainState *es)
 {
+	RuntimeFilter *plan = (RuntimeFilter *) rfstate->ps.plan;
+
+	/* A filter pushed down from a hash join shows the join's outer keys */
+	if (plan->hashkeys != NIL)
+	{
+		List	   *context;
+		List	   *result = NIL;
+		bool		useprefix;
+		ListCell   *lc;
+
+		useprefix = list_length(es->rtable) > 1 || es->verbose;
+		context = set_deparse_context_plan(es->deparse_cxt,
+										   (Plan *) plan,
+										   ancestors);
+		foreach(lc, plan->hashkeys)
+			result = lappend(result,
+							 deparse_expression((Node *) lfirst(lc), context,
+												useprefix, false));
+		ExplainPropertyList("Filter Keys", result, es);
+	}
+
 	if (es->analyze)
 	{
 		if (rfstate->bf != NULL)
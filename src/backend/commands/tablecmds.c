@@ -16,6 +16,7 @@
  */
 #include "postgres.h"
 
+#include "access/appendonly_sortkey.h"
 #include "access/attmap.h"
 #include "access/genam.h"
 #include "access/heapam.h"
@@ -3961,6 +3962,10 @@ renameatt_internal(Oid myrelid,
 
 	table_close(attrelation, RowExclusiveLock);
 
+	/* the "sortkey" option of an AO table names its columns */
+	if (RelationIsAppendOptimized(targetrelation))
+		appendonly_sortkey_rename_column(targetrelation, oldattname, newattname);
+
 	/* MPP-6929, MPP-7600: metadata tracking */
 	if ((Gp_role == GP_ROLE_DISPATCH)
 		&& MetaTrackValidKindNsp(targetrelation->rd_rel))
@@ -6698,6 +6703,9 @@ ATAocsWriteSegFileNewColumns(
  * the smallest eof to return, we continue the loop but skip over all
  * segfiles except for those in AOSEG_STATE_AWAITING_DROP state which
  * we need to append to our drop list.
+ *
+ * Columns with a missing value are not considered, they may have been
+ * added without writing them for the rows already in the table.
  */
 static int
 column_to_scan(AOCSFileSegInfo **segInfos, int nseg, int natts, Relation aocsrel)
@@ -6726,6 +6734,9 @@ column_to_scan(AOCSFileSegInfo **segInfos, int nseg, int natts, Relation aocsrel
 		{
 			for (i = 0; i < natts; ++i)
 			{
+				if (TupleDescAttr(RelationGetDescr(aocsrel), i)->atthasmissing)
+					continue;
+
 				vpe = getAOCSVPEntry(segInfos[segi], i);
 				if (vpe->eof > 0 && (!min_eof || vpe->eof < min_eof))
 				{
@@ -6739,6 +6750,45 @@ column_to_scan(AOCSFileSegInfo **segInfos, int nseg, int natts, Relation aocsrel
 	return scancol;
 }
 
+/*
+ * Can the new columns be added without writing them for the rows already in
+ * the table?  A new column whose constant default ADD COLUMN stored as its
+ * missing value reads as that value for the rows inserted before it was
+ * added, see AOCSAddedColumn.  The readers tell those rows by the row
+ * numbers of the blocks, which segfiles in old formats may not store.
+ */
+static bool
+ATAocsNewColumnsHaveMissingValues(AlteredTableInfo *tab, Relation rel,
+								  AOCSFileSegInfo **segInfos, int32 nseg)
+{
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	ListCell   *l;
+
+	if (tab->constraints != NIL || tab->oldDesc->natts == 0 ||
+		list_length(tab->newvals) != tupdesc->natts - tab->oldDesc->natts)
+		return false;
+
+	foreach(l, tab->newvals)
+	{
+		NewColumnValue *newval = lfirst(l);
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, newval->attnum - 1);
+
+		if (newval->is_generated || !attr->atthasmissing ||
+			DomainHasConstraints(attr->atttypid))
+			return false;
+	}
+
+	for (int32 segi = 0; segi < nseg; segi++)
+	{
+		if (segInfos[segi]->total_tupcount > 0 &&
+			segInfos[segi]->state != AOSEG_STATE_AWAITING_DROP &&
+			segInfos[segi]->formatversion < AORelationVersion_GetLatest())
+			return false;
+	}
+
+	return true;
+}
+
 static void
 ATAocsWriteNewColumns(AlteredTableInfo *tab)
 {
@@ -6799,7 +6849,14 @@ ATAocsWriteNewColumns(AlteredTableInfo *tab)
 							 list_length(tab->newvals));
 	}
 
-	scancol = column_to_scan(segInfos, nseg, tab->oldDesc->natts, rel);
+	/*
+	 * Only the new columns' entries in pg_aocsseg are needed if they read as
+	 * their missing values.  Rows inserted from now on write the columns.
+	 */
+	if (ATAocsNewColumnsHaveMissingValues(tab, rel, segInfos, nseg))
+		scancol = -1;
+	else
+		scancol = column_to_scan(segInfos, nseg, tab->oldDesc->natts, rel);
 	elogif(Debug_appendonly_print_storage_headers, LOG,
 		   "using column %d of relation %s for alter table scan",
 		   scancol, RelationGetRelationName(rel));
@@ -9903,6 +9960,15 @@ ATExecDropColumn(List **wqueue, Relation rel, const char *colName,
 				 errmsg("cannot drop column \"%s\" because it is part of the partition key of relation \"%s\"",
 						colName, RelationGetRelationName(rel))));
 
+	/* Nor columns named in the sort key of an AO table */
+	if (RelationIsAppendOptimized(rel) &&
+		appendonly_sortkey_has_column(rel, colName))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_TABLE_DEFINITION),
+				 errmsg("cannot drop column \"%s\" because it is part of the sort key of relation \"%s\"",
+						colName, RelationGetRelationName(rel)),
+				 errhint("Remove the column from the \"sortkey\" storage option first.")));
+
 	ReleaseSysCache(tuple);
 
 	/*
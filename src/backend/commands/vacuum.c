@@ -122,6 +122,8 @@ static List *vacuum_params_to_options_list(VacuumParams *params);
 static void vacuum_combine_stats(VacuumStatsContext *stats_context,
 								 CdbPgResults *cdb_pgresults);
 static void vac_update_relstats_from_list(List *updated_stats);
+static bool vac_ao_compaction_incomplete(List *updated_stats);
+static void vac_report_ao_vacuum(Oid relid, List *updated_stats);
 
 /*
  * Primary entry point for manual VACUUM and ANALYZE commands
@@ -153,6 +155,12 @@ ExecVacuum(ParseState *pstate, VacuumStmt *vacstmt, bool isTopLevel, bool auto_s
 	/* By default parallel vacuum is enabled */
 	params.nworkers = 0;
 
+	/* Only set by the QD, see vacuum_params_to_options_list() */
+	params.ao_compact_segfiles = 0;
+	params.ao_compaction_incomplete = false;
+	params.cost_delay = -1;
+	params.cost_limit = -1;
+
 	/* Parse options list */
 	foreach(lc, vacstmt->options)
 	{
@@ -207,6 +215,12 @@ ExecVacuum(ParseState *pstate, VacuumStmt *vacstmt, bool isTopLevel, bool auto_s
 			ao_phase = defGetInt32(opt);
 			Assert((ao_phase & VACUUM_AO_PHASE_MASK) == ao_phase);
 		}
+		else if (Gp_role == GP_ROLE_EXECUTE && strcmp(opt->defname, "ao_compact_segfiles") == 0)
+			params.ao_compact_segfiles = defGetInt32(opt);
+		else if (Gp_role == GP_ROLE_EXECUTE && strcmp(opt->defname, "cost_delay") == 0)
+			params.cost_delay = defGetNumeric(opt);
+		else if (Gp_role == GP_ROLE_EXECUTE && strcmp(opt->defname, "cost_limit") == 0)
+			params.cost_limit = Max(defGetInt32(opt), 1);
 		else if (strcmp(opt->defname, "parallel") == 0)
 		{
 			if (opt->arg == NULL)
@@ -354,6 +368,8 @@ vacuum(List *relations, VacuumParams *params,
 	const char *stmttype;
 	volatile bool in_outer_xact,
 				use_own_xacts;
+	double		save_cost_delay;
+	int			save_cost_limit;
 
 	Assert(params != NULL);
 
@@ -520,11 +536,19 @@ vacuum(List *relations, VacuumParams *params,
 	}
 
 	/* Turn vacuum cost accounting on or off, and set/clear in_vacuum */
+	save_cost_delay = VacuumCostDelay;
+	save_cost_limit = VacuumCostLimit;
 	PG_TRY();
 	{
 		ListCell   *cur;
 
 		in_vacuum = true;
+		if (params->cost_delay >= 0)
+		{
+			/* Dispatched by autovacuum on the coordinator */
+			VacuumCostDelay = params->cost_delay;
+			VacuumCostLimit = params->cost_limit;
+		}
 		VacuumCostActive = (VacuumCostDelay > 0);
 		VacuumCostBalance = 0;
 		VacuumPageHit = 0;
@@ -593,6 +617,11 @@ vacuum(List *relations, VacuumParams *params,
 	{
 		in_vacuum = false;
 		VacuumCostActive = false;
+		if (params->cost_delay >= 0)
+		{
+			VacuumCostDelay = save_cost_delay;
+			VacuumCostLimit = save_cost_limit;
+		}
 	}
 	PG_END_TRY();
 
@@ -2622,9 +2651,22 @@ vacuum_rel(Oid relid, RangeVar *relation, VacuumParams *params,
 		params->options = orig_options | VACOPT_AO_PRE_CLEANUP_PHASE;
 		vacuum_rel(relid, this_rangevar, params, false);
 
-		/* Compact. This runs in a distributed transaction.  */
+		/*
+		 * Compact. This runs in a distributed transaction. With
+		 * gp_appendonly_compaction_segfiles_per_xact set, each transaction
+		 * compacts a bounded number of segment files, and we repeat until
+		 * none are left. That spreads the work, and the extra disk space
+		 * the compacted segment files hold until they are dropped, over
+		 * several transactions.
+		 */
 		params->options = orig_options | VACOPT_AO_COMPACT_PHASE;
-		vacuum_rel(relid, this_rangevar, params, false);
+		params->ao_compact_segfiles = gp_appendonly_compaction_segfiles_per_xact;
+		do
+		{
+			params->ao_compaction_incomplete = false;
+			vacuum_rel(relid, this_rangevar, params, false);
+		} while (params->ao_compaction_incomplete);
+		params->ao_compact_segfiles = 0;
 
 		/* Do a final round of cleanup. Hopefully, this can drop the segments
 		 * that were compacted in the previous phase.
@@ -2684,10 +2726,13 @@ vacuum_rel(Oid relid, RangeVar *relation, VacuumParams *params,
 
 	/*
 	 * Don't dispatch auto-vacuum. Each segment performs auto-vacuum as per
-	 * its own need.
+	 * its own need. The exception are append-optimized tables with
+	 * gp_autovacuum_appendonly on, whose compaction needs a distributed
+	 * transaction.
 	 */
 	if (Gp_role == GP_ROLE_DISPATCH && !recursing &&
-		!IsAutoVacuumWorkerProcess() &&
+		(!IsAutoVacuumWorkerProcess() ||
+		 (gp_autovacuum_appendonly && is_appendoptimized)) &&
 		(!is_appendoptimized || ao_vacuum_phase))
 	{
 		VacuumStatsContext stats_context;
@@ -2702,7 +2747,19 @@ vacuum_rel(Oid relid, RangeVar *relation, VacuumParams *params,
 
 		stats_context.updated_stats = NIL;
 		dispatchVacuum(params, relid, &stats_context);
-		vac_update_relstats_from_list(stats_context.updated_stats);
+		if (ao_vacuum_phase == VACOPT_AO_COMPACT_PHASE)
+			params->ao_compaction_incomplete =
+				vac_ao_compaction_incomplete(stats_context.updated_stats);
+		else
+			vac_update_relstats_from_list(stats_context.updated_stats);
+
+		/*
+		 * The QEs have counted the rows deleted from the table into our
+		 * statistics, see pgstat_combine_from_qe(). Report the dead ones
+		 * gone, for autovacuum not to pick the table again.
+		 */
+		if (ao_vacuum_phase == VACOPT_AO_POST_CLEANUP_PHASE)
+			vac_report_ao_vacuum(relid, stats_context.updated_stats);
 
 		/* Also update pg_stat_last_operation */
 		if (IsAutoVacuumWorkerProcess())
@@ -3033,10 +3090,39 @@ vacuum_params_to_options_list(VacuumParams *params)
 											   (Node *) makeInteger(optmask & VACUUM_AO_PHASE_MASK),
 											   -1));
 		optmask &= ~VACUUM_AO_PHASE_MASK;
+
+		/*
+		 * The segments vacuum the indexes of append-optimized tables in
+		 * parallel, if asked to. Parallel vacuum of heap tables isn't
+		 * supported.
+		 */
+		if (params->nworkers > 0)
+			options = lappend(options, makeDefElem("parallel",
+												   (Node *) makeInteger(params->nworkers),
+												   -1));
 	}
 	if (optmask != 0)
 		elog(ERROR, "unrecognized vacuum option %x", optmask);
 
+	if (params->ao_compact_segfiles > 0)
+		options = lappend(options, makeDefElem("ao_compact_segfiles",
+											   (Node *) makeInteger(params->ao_compact_segfiles),
+											   -1));
+
+	/*
+	 * Autovacuum balances the cost-based delay among its workers; have the
+	 * segments use the share of this one, rather than their own settings.
+	 */
+	if (IsAutoVacuumWorkerProcess())
+	{
+		options = lappend(options, makeDefElem("cost_delay",
+											   (Node *) makeFloat(psprintf("%g", VacuumCostDelay)),
+											   -1));
+		options = lappend(options, makeDefElem("cost_limit",
+											   (Node *) makeInteger(VacuumCostLimit),
+											   -1));
+	}
+
 	/*
 	 * NOTE:
 	 *
@@ -3132,6 +3218,7 @@ vacuum_combine_stats(VacuumStatsContext *stats_context, CdbPgResults *cdb_pgresu
 				tmp_stats->rel_pages += pgclass_stats->rel_pages;
 				tmp_stats->rel_tuples += pgclass_stats->rel_tuples;
 				tmp_stats->relallvisible += pgclass_stats->relallvisible;
+				tmp_stats->ao_compaction_incomplete |= pgclass_stats->ao_compaction_incomplete;
 				break;
 			}
 		}
@@ -3250,6 +3337,7 @@ vac_send_relstats_to_qd(Relation relation,
 
 	pq_beginmessage(&buf, 'y');
 	pq_sendstring(&buf, "VACUUM");
+	memset(&stats, 0, sizeof(VPgClassStats));
 	stats.relid = relid;
 	stats.rel_pages = num_pages;
 	stats.rel_tuples = num_tuples;
@@ -3261,6 +3349,70 @@ vac_send_relstats_to_qd(Relation relation,
 	pq_endmessage(&buf);
 }
 
+/*
+ * Tell the QD that the AO compaction phase left segment files to compact in
+ * another transaction. See ao_vacuum_rel_compact().
+ */
+void
+vac_send_ao_compaction_incomplete_to_qd(Relation relation)
+{
+	StringInfoData buf;
+	VPgClassStats stats;
+
+	Assert(Gp_role == GP_ROLE_EXECUTE);
+
+	memset(&stats, 0, sizeof(VPgClassStats));
+	stats.relid = RelationGetRelid(relation);
+	stats.ao_compaction_incomplete = true;
+
+	pq_beginmessage(&buf, 'y');
+	pq_sendstring(&buf, "VACUUM");
+	pq_sendbyte(&buf, true); /* Mark the result ready when receive this message */
+	pq_sendint(&buf, PGExtraTypeVacuumStats, sizeof(PGExtraType));
+	pq_sendint(&buf, sizeof(VPgClassStats), sizeof(int));
+	pq_sendbytes(&buf, (char *) &stats, sizeof(VPgClassStats));
+	pq_endmessage(&buf);
+}
+
+/*
+ * Did any QE leave segment files to compact in another transaction?
+ */
+static bool
+vac_ao_compaction_incomplete(List *updated_stats)
+{
+	ListCell   *lc;
+
+	foreach (lc, updated_stats)
+	{
+		VPgClassStats *stats = (VPgClassStats *) lfirst(lc);
+
+		if (stats->ao_compaction_incomplete)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Report the vacuum of an append-optimized table to the statistics
+ * collector, with the row count the QEs sent back.
+ */
+static void
+vac_report_ao_vacuum(Oid relid, List *updated_stats)
+{
+	ListCell   *lc;
+
+	foreach (lc, updated_stats)
+	{
+		VPgClassStats *stats = (VPgClassStats *) lfirst(lc);
+
+		if (stats->relid == relid)
+		{
+			pgstat_report_vacuum(relid, false, (PgStat_Counter) stats->rel_tuples, 0);
+			break;
+		}
+	}
+}
+
 bool
 vacuumStatement_IsTemporary(Relation onerel)
 {
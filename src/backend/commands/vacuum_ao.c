@@ -114,11 +114,14 @@
  */
 #include "postgres.h"
 
+#include "access/amapi.h"
 #include "access/aocs_compaction.h"
 #include "access/appendonlywriter.h"
 #include "access/appendonly_compaction.h"
 #include "access/genam.h"
 #include "access/multixact.h"
+#include "access/parallel.h"
+#include "access/table.h"
 #include "access/visibilitymap.h"
 #include "access/xact.h"
 #include "catalog/pg_appendonly.h"
@@ -133,11 +136,15 @@
 #include "storage/procarray.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
+#include "optimizer/paths.h"
+#include "storage/bufmgr.h"
+#include "tcop/tcopprot.h"
 #include "utils/faultinjector.h"
 #include "utils/guc.h"
 #include "utils/rel.h"
 #include "utils/relcache.h"
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
 #include "utils/pg_rusage.h"
 #include "cdb/cdbappendonlyblockdirectory.h"
 
@@ -149,25 +156,119 @@ typedef struct AppendOnlyIndexVacuumState
 	AppendOnlyVisimap visiMap;
 	AppendOnlyBlockDirectory blockDirectory;
 	AppendOnlyBlockDirectoryEntry blockDirectoryEntry;
+	FileSegInfo **segmentFileInfo; /* Might be a casted AOCSFileSegInfo */
+	int			totalSegfiles;
+
+	/* Dead rows, see appendonly_dead_rows_build(); NULL if not built */
+	HTAB	   *deadRows;
+	MemoryContext deadRowsContext;
+	struct AODeadRowsChunk *lastChunk;	/* last chunk probed */
 } AppendOnlyIndexVacuumState;
 
-static void vacuum_appendonly_index(Relation indexRelation,
-									AppendOnlyIndexVacuumState *vacuumIndexState,
-									double rel_tuple_count,
-									int elevel,
-									BufferAccessStrategy bstrategy);
+/*
+ * The rows of an append-only table, as far as index vacuum is concerned, in
+ * chunks of the range of a visimap entry.  A row is dead if the block
+ * directory doesn't know it, or the visimap hides it.  The key combines the
+ * segment file number and the chunk number, see AO_DEAD_ROWS_KEY().  Chunks
+ * without any rows in the block directory are left out.
+ */
+#define AO_DEAD_ROWS_CHUNK_SIZE	APPENDONLY_VISIMAP_MAX_RANGE
+#define AO_DEAD_ROWS_KEY(segno, rowNum) \
+	(((uint64) (segno) << 48) | (uint64) ((rowNum) / AO_DEAD_ROWS_CHUNK_SIZE))
+
+typedef struct AODeadRowsChunk
+{
+	uint64		key;
+	bool		allPresent;		/* are all rows in the block directory? */
+	Bitmapset  *present;		/* if not, the offsets of those that are */
+	Bitmapset  *hidden;			/* offsets of the rows the visimap hides */
+} AODeadRowsChunk;
+
+/*
+ * DSM keys for parallel vacuum of the indexes of an append-only table.
+ */
+#define PARALLEL_AO_VACUUM_KEY_SHARED		1
+#define PARALLEL_AO_VACUUM_KEY_QUERY_TEXT	2
+
+/*
+ * Result of the vacuum of one index, in the DSM segment.
+ */
+typedef struct AOVacuumSharedIndStats
+{
+	bool		parallel_safe;	/* can a parallel worker vacuum the index? */
+	bool		updated;		/* is istat set? */
+	IndexBulkDeleteResult istat;
+} AOVacuumSharedIndStats;
+
+/*
+ * Information shared among the leader and the parallel workers vacuuming the
+ * indexes of an append-only table.  Each of them builds its own block
+ * directory and visimap lookups, and takes the next index to vacuum until
+ * none are left.
+ */
+typedef struct AOVacuumShared
+{
+	Oid			relid;
+	int			elevel;
+	double		rel_tuple_count;
+
+	/* maintenance_work_mem for each worker, see parallel_vacuum_appendonly_indexes() */
+	int			maintenance_work_mem_worker;
+
+	/* Shared vacuum cost balance and active workers, see compute_parallel_delay() */
+	pg_atomic_uint32 cost_balance;
+	pg_atomic_uint32 active_nworkers;
+
+	/* Counter for the next index to vacuum */
+	pg_atomic_uint32 idx;
 
+	int			nindexes;
+	AOVacuumSharedIndStats indstats[FLEXIBLE_ARRAY_MEMBER];
+} AOVacuumShared;
+
+static void vacuum_appendonly_index_state_init(Relation aoRelation,
+											   Snapshot snapshot,
+											   AppendOnlyIndexVacuumState *vacuumIndexState);
+static void vacuum_appendonly_index_state_finish(Relation aoRelation,
+												 AppendOnlyIndexVacuumState *vacuumIndexState);
+static IndexBulkDeleteResult *vacuum_appendonly_index(Relation indexRelation,
+													  AppendOnlyIndexVacuumState *vacuumIndexState,
+													  double rel_tuple_count,
+													  int elevel,
+													  BufferAccessStrategy bstrategy);
+static void vacuum_appendonly_index_report(Relation indexRelation,
+										   IndexBulkDeleteResult *stats,
+										   bool reaped,
+										   int elevel,
+										   PGRUsage *ru0);
+
+static void appendonly_dead_rows_build(Relation aoRelation, Snapshot snapshot,
+									   AppendOnlyIndexVacuumState *vacuumIndexState);
 static bool appendonly_tid_reaped(ItemPointer itemptr, void *state);
 
 static void vacuum_appendonly_fill_stats(Relation aorel, Snapshot snapshot, int elevel,
 										 BlockNumber *rel_pages, double *rel_tuples,
 										 bool *relhasindex, BlockNumber *total_file_segs);
-static int vacuum_appendonly_indexes(Relation aoRelation, int options,
+static int vacuum_appendonly_indexes(Relation aoRelation, int options, int nworkers,
 									 BufferAccessStrategy bstrategy);
-static void scan_index(Relation indrel,
-					   AppendOnlyIndexVacuumState *vacuumIndexState,
-					   double num_tuples,
-					   int elevel, BufferAccessStrategy vac_strategy);
+
+static int	compute_parallel_ao_vacuum_workers(Relation aoRelation,
+											   Relation *Irel, int nindexes,
+											   int nrequested,
+											   bool *will_parallel_vacuum);
+static void parallel_vacuum_appendonly_indexes(Relation aoRelation,
+											   Relation *Irel, int nindexes,
+											   int nworkers,
+											   bool *will_parallel_vacuum,
+											   AppendOnlyIndexVacuumState *vacuumIndexState,
+											   double rel_tuple_count,
+											   int elevel,
+											   BufferAccessStrategy bstrategy,
+											   IndexBulkDeleteResult **indstats);
+static void parallel_vacuum_appendonly_process(Relation *Irel,
+											   AOVacuumShared *shared,
+											   AppendOnlyIndexVacuumState *vacuumIndexState,
+											   BufferAccessStrategy bstrategy);
 
 void
 ao_vacuum_rel_pre_cleanup(Relation onerel, int options, VacuumParams *params,
@@ -252,7 +353,7 @@ ao_vacuum_rel_post_cleanup(Relation onerel, int options, VacuumParams *params,
 
 	AppendOptimizedRecycleDeadSegments(onerel);
 
-	vacuum_appendonly_indexes(onerel, options, bstrategy);
+	vacuum_appendonly_indexes(onerel, options, params->nworkers, bstrategy);
 
 	/* Update statistics in pg_class */
 	vacuum_appendonly_fill_stats(onerel, GetActiveSnapshot(),
@@ -295,6 +396,8 @@ ao_vacuum_rel_compact(Relation onerel, int options, VacuumParams *params,
 	Snapshot	appendOnlyMetaDataSnapshot = RegisterSnapshot(GetCatalogSnapshot(InvalidOid));
 	char	   *relname;
 	int			elevel;
+	int			ncompacted = 0;
+	bool		incomplete = false;
 
 	/*
 	 * This should run in a distributed transaction. But also allow utility
@@ -329,10 +432,25 @@ ao_vacuum_rel_compact(Relation onerel, int options, VacuumParams *params,
 	 * multiple transactions. The problem with that is that the updates to
 	 * pg_aoseg needs to happen in a distributed transaction (Problem 3), so
 	 * we would need to coordinate the transactions from the QD.
+	 *
+	 * The QD does that when gp_appendonly_compaction_segfiles_per_xact is
+	 * set: we stop after compacting that many segfiles, and tell the QD to
+	 * run the compaction phase again in a new transaction. See vacuum_rel().
 	 */
 	insert_segno = -1;
 	while ((compaction_segno = ChooseSegnoForCompaction(onerel, compacted_and_inserted_segments)) != -1)
 	{
+		if (params->ao_compact_segfiles > 0 &&
+			ncompacted >= params->ao_compact_segfiles)
+		{
+			/*
+			 * There is at least one more candidate; it may turn out not to
+			 * need compaction, in which case the next round is a no-op.
+			 */
+			incomplete = true;
+			break;
+		}
+
 		/*
 		 * Compact this segment. (If the segment doesn't need compaction,
 		 * AppendOnlyCompact() will fall through quickly).
@@ -346,19 +464,23 @@ ao_vacuum_rel_compact(Relation onerel, int options, VacuumParams *params,
 			elog(LOG, "compacting segno %d of %s", compaction_segno, relname);
 
 		if (RelationIsAoRows(onerel))
-			AppendOnlyCompact(onerel,
-							  compaction_segno,
-							  &insert_segno,
-							  (options & VACOPT_FULL) != 0,
-							  compacted_segments);
+		{
+			if (AppendOnlyCompact(onerel,
+								  compaction_segno,
+								  &insert_segno,
+								  (options & VACOPT_FULL) != 0,
+								  compacted_segments))
+				ncompacted++;
+		}
 		else
 		{
 			Assert(RelationIsAoCols(onerel));
-			AOCSCompact(onerel,
-						compaction_segno,
-						&insert_segno,
-						(options & VACOPT_FULL) != 0,
-						compacted_segments);
+			if (AOCSCompact(onerel,
+							compaction_segno,
+							&insert_segno,
+							(options & VACOPT_FULL) != 0,
+							compacted_segments))
+				ncompacted++;
 		}
 
 		if (insert_segno != -1)
@@ -372,6 +494,14 @@ ao_vacuum_rel_compact(Relation onerel, int options, VacuumParams *params,
 		CommandCounterIncrement();
 	}
 
+	if (incomplete)
+	{
+		if (Gp_role == GP_ROLE_EXECUTE)
+			vac_send_ao_compaction_incomplete_to_qd(onerel);
+		else
+			params->ao_compaction_incomplete = true;
+	}
+
 	UnregisterSnapshot(appendOnlyMetaDataSnapshot);
 }
 
@@ -450,18 +580,100 @@ vacuum_appendonly_index_should_vacuum(Relation aoRelation,
 	return false;
 }
 
+/*
+ * Sets up the block directory and visimap lookups, that tell whether an index
+ * entry points to a live tuple.
+ */
+static void
+vacuum_appendonly_index_state_init(Relation aoRelation, Snapshot snapshot,
+								   AppendOnlyIndexVacuumState *vacuumIndexState)
+{
+	Oid			visimaprelid;
+	Oid			visimapidxid;
+
+	memset(vacuumIndexState, 0, sizeof(AppendOnlyIndexVacuumState));
+
+	if (RelationIsAoRows(aoRelation))
+	{
+		vacuumIndexState->segmentFileInfo =
+			GetAllFileSegInfo(aoRelation,
+							  snapshot,
+							  &vacuumIndexState->totalSegfiles,
+							  NULL);
+	}
+	else
+	{
+		Assert(RelationIsAoCols(aoRelation));
+		vacuumIndexState->segmentFileInfo = (FileSegInfo **)
+			GetAllAOCSFileSegInfo(aoRelation,
+								  snapshot,
+								  &vacuumIndexState->totalSegfiles,
+								  NULL);
+	}
+
+	GetAppendOnlyEntryAuxOids(aoRelation->rd_id,
+							  snapshot,
+							  NULL, NULL, NULL,
+							  &visimaprelid, &visimapidxid);
+
+	AppendOnlyVisimap_Init(
+			&vacuumIndexState->visiMap,
+			visimaprelid,
+			visimapidxid,
+			AccessShareLock,
+			snapshot);
+
+	AppendOnlyBlockDirectory_Init_forSearch(&vacuumIndexState->blockDirectory,
+			snapshot,
+			vacuumIndexState->segmentFileInfo,
+			vacuumIndexState->totalSegfiles,
+			aoRelation,
+			1,
+			RelationIsAoCols(aoRelation),
+			NULL);
+
+	appendonly_dead_rows_build(aoRelation, snapshot, vacuumIndexState);
+}
+
+static void
+vacuum_appendonly_index_state_finish(Relation aoRelation,
+									 AppendOnlyIndexVacuumState *vacuumIndexState)
+{
+	AppendOnlyVisimap_Finish(&vacuumIndexState->visiMap, AccessShareLock);
+	AppendOnlyBlockDirectory_End_forSearch(&vacuumIndexState->blockDirectory);
+
+	if (vacuumIndexState->deadRowsContext)
+		MemoryContextDelete(vacuumIndexState->deadRowsContext);
+
+	if (vacuumIndexState->segmentFileInfo)
+	{
+		if (RelationIsAoRows(aoRelation))
+		{
+			FreeAllSegFileInfo(vacuumIndexState->segmentFileInfo,
+							   vacuumIndexState->totalSegfiles);
+		}
+		else
+		{
+			FreeAllAOCSSegFileInfo((AOCSFileSegInfo **) vacuumIndexState->segmentFileInfo,
+								   vacuumIndexState->totalSegfiles);
+		}
+		pfree(vacuumIndexState->segmentFileInfo);
+	}
+}
+
 /*
  * vacuum_appendonly_indexes()
  *
  * Perform a vacuum on all indexes of an append-only relation.
  *
- * The page and tuplecount information in vacrelstats are used, the
- * nindex value is set by this function.
+ * With nworkers > 0, that is VACUUM (PARALLEL n), the indexes are vacuumed
+ * by up to that many parallel workers, and the leader.  Unlike for heap
+ * tables in PostgreSQL, the degree isn't chosen automatically.
  *
  * It returns the number of indexes on the relation.
  */
 static int
-vacuum_appendonly_indexes(Relation aoRelation, int options,
+vacuum_appendonly_indexes(Relation aoRelation, int options, int nworkers,
 						  BufferAccessStrategy bstrategy)
 {
 	int			reindex_count = 1;
@@ -469,16 +681,10 @@ vacuum_appendonly_indexes(Relation aoRelation, int options,
 	Relation   *Irel;
 	int			nindexes;
 	AppendOnlyIndexVacuumState vacuumIndexState;
-	FileSegInfo **segmentFileInfo = NULL; /* Might be a casted AOCSFileSegInfo */
-	int			totalSegfiles;
 	Snapshot	appendOnlyMetaDataSnapshot;
-	Oid			visimaprelid;
-	Oid			visimapidxid;
 
 	Assert(RelationIsAppendOptimized(aoRelation));
 
-	memset(&vacuumIndexState, 0, sizeof(vacuumIndexState));
-
 	if (Debug_appendonly_print_compaction)
 		elog(LOG, "Vacuum indexes for append-only relation %s",
 			 RelationGetRelationName(aoRelation));
@@ -491,48 +697,18 @@ vacuum_appendonly_indexes(Relation aoRelation, int options,
 
 	appendOnlyMetaDataSnapshot = GetActiveSnapshot();
 
-	if (RelationIsAoRows(aoRelation))
-	{
-		segmentFileInfo = GetAllFileSegInfo(aoRelation,
-											appendOnlyMetaDataSnapshot,
-											&totalSegfiles,
-											NULL);
-	}
-	else
-	{
-		Assert(RelationIsAoCols(aoRelation));
-		segmentFileInfo = (FileSegInfo **) GetAllAOCSFileSegInfo(aoRelation,
-																appendOnlyMetaDataSnapshot,
-																&totalSegfiles,
-																NULL);
-	}
-
-	GetAppendOnlyEntryAuxOids(aoRelation->rd_id,
-							  appendOnlyMetaDataSnapshot, 
-							  NULL, NULL, NULL,
-							  &visimaprelid, &visimapidxid);
-
-	AppendOnlyVisimap_Init(
-			&vacuumIndexState.visiMap,
-			visimaprelid,
-			visimapidxid,
-			AccessShareLock,
-			appendOnlyMetaDataSnapshot);
-
-	AppendOnlyBlockDirectory_Init_forSearch(&vacuumIndexState.blockDirectory,
-			appendOnlyMetaDataSnapshot,
-			segmentFileInfo,
-			totalSegfiles,
-			aoRelation,
-			1,
-			RelationIsAoCols(aoRelation),
-			NULL);
+	vacuum_appendonly_index_state_init(aoRelation, appendOnlyMetaDataSnapshot,
+									   &vacuumIndexState);
 
 	/* Clean/scan index relation(s) */
 	if (Irel != NULL)
 	{
 		double rel_tuple_count = 0.0;
 		int			elevel;
+		bool		reaped;
+		bool	   *will_parallel_vacuum;
+		IndexBulkDeleteResult **indstats;
+		PGRUsage	ru0;
 
 		/* just scan indexes to update statistic */
 		if (options & VACOPT_VERBOSE)
@@ -540,45 +716,68 @@ vacuum_appendonly_indexes(Relation aoRelation, int options,
 		else
 			elevel = DEBUG2;
 
-		if (vacuum_appendonly_index_should_vacuum(aoRelation, options,
-												  appendOnlyMetaDataSnapshot,
-												  &vacuumIndexState,
-												  &rel_tuple_count))
+		/*
+		 * If nothing was deleted, the indexes are only scanned to update
+		 * their statistics.
+		 */
+		reaped = vacuum_appendonly_index_should_vacuum(aoRelation, options,
+													   appendOnlyMetaDataSnapshot,
+													   &vacuumIndexState,
+													   &rel_tuple_count);
+		if (reaped)
 		{
 			Assert(rel_tuple_count > -1.0);
+			reindex_count++;
+		}
 
+		will_parallel_vacuum = (bool *) palloc0(nindexes * sizeof(bool));
+		indstats = (IndexBulkDeleteResult **)
+			palloc0(nindexes * sizeof(IndexBulkDeleteResult *));
+
+		nworkers = compute_parallel_ao_vacuum_workers(aoRelation, Irel, nindexes,
+													  nworkers,
+													  will_parallel_vacuum);
+		if (nworkers > 0)
+		{
+			pg_rusage_init(&ru0);
+			parallel_vacuum_appendonly_indexes(aoRelation, Irel, nindexes,
+											   nworkers, will_parallel_vacuum,
+											   &vacuumIndexState,
+											   rel_tuple_count,
+											   elevel,
+											   bstrategy,
+											   indstats);
+
+			/* Now that we're out of parallel mode, update pg_class */
 			for (i = 0; i < nindexes; i++)
-			{
-				vacuum_appendonly_index(Irel[i], &vacuumIndexState,
-										rel_tuple_count,
-										elevel,
-										bstrategy);
-			}
-			reindex_count++;
+				vacuum_appendonly_index_report(Irel[i], indstats[i], reaped,
+											   elevel, &ru0);
 		}
 		else
 		{
 			for (i = 0; i < nindexes; i++)
-				scan_index(Irel[i], &vacuumIndexState, rel_tuple_count, elevel, bstrategy);
+			{
+				pg_rusage_init(&ru0);
+				indstats[i] = vacuum_appendonly_index(Irel[i], &vacuumIndexState,
+													  rel_tuple_count,
+													  elevel,
+													  bstrategy);
+				vacuum_appendonly_index_report(Irel[i], indstats[i], reaped,
+											   elevel, &ru0);
+			}
 		}
-	}
-
-	AppendOnlyVisimap_Finish(&vacuumIndexState.visiMap, AccessShareLock);
-	AppendOnlyBlockDirectory_End_forSearch(&vacuumIndexState.blockDirectory);
 
-	if (segmentFileInfo)
-	{
-		if (RelationIsAoRows(aoRelation))
-		{
-			FreeAllSegFileInfo(segmentFileInfo, totalSegfiles);
-		}
-		else
+		for (i = 0; i < nindexes; i++)
 		{
-			FreeAllAOCSSegFileInfo((AOCSFileSegInfo **)segmentFileInfo, totalSegfiles);
+			if (indstats[i])
+				pfree(indstats[i]);
 		}
-		pfree(segmentFileInfo);
+		pfree(indstats);
+		pfree(will_parallel_vacuum);
 	}
 
+	vacuum_appendonly_index_state_finish(aoRelation, &vacuumIndexState);
+
 	vac_close_indexes(nindexes, Irel, NoLock);
 	return nindexes;
 }
@@ -587,10 +786,12 @@ vacuum_appendonly_indexes(Relation aoRelation, int options,
  * Vacuums an index on an append-only table.
  *
  * This is called after an append-only segment file compaction to move
- * all tuples from the compacted segment files.
- * The segmentFileList is an
+ * all tuples from the compacted segment files.  It removes the index
+ * entries of tuples that are no longer in the block directory, or are
+ * hidden by the visimap.  If there are none, it merely scans the index
+ * to update its statistics.
  */
-static void
+static IndexBulkDeleteResult *
 vacuum_appendonly_index(Relation indexRelation,
 						AppendOnlyIndexVacuumState *vacuumIndexState,
 						double rel_tuple_count,
@@ -602,11 +803,11 @@ vacuum_appendonly_index(Relation indexRelation,
 
 	IndexBulkDeleteResult *stats;
 	IndexVacuumInfo ivinfo;
-	PGRUsage	ru0;
-
-	pg_rusage_init(&ru0);
 
 	ivinfo.index = indexRelation;
+	ivinfo.analyze_only = false;
+	ivinfo.report_progress = false;
+	ivinfo.estimated_count = false;
 	ivinfo.message_level = elevel;
 	ivinfo.num_heap_tuples = rel_tuple_count;
 	ivinfo.strategy = bstrategy;
@@ -618,6 +819,22 @@ vacuum_appendonly_index(Relation indexRelation,
 	/* Do post-VACUUM cleanup */
 	stats = index_vacuum_cleanup(&ivinfo, stats);
 
+	return stats;
+}
+
+/*
+ * Updates the statistics of an index in pg_class after its vacuum, and
+ * reports them.  This can't be done in parallel mode.
+ */
+static void
+vacuum_appendonly_index_report(Relation indexRelation,
+							   IndexBulkDeleteResult *stats,
+							   bool reaped,
+							   int elevel,
+							   PGRUsage *ru0)
+{
+	Assert(!IsInParallelMode());
+
 	if (!stats)
 		return;
 
@@ -628,26 +845,532 @@ vacuum_appendonly_index(Relation indexRelation,
 	if (!stats->estimated_count)
 		vac_update_relstats(indexRelation,
 							stats->num_pages, stats->num_index_tuples,
-							0, /* relallvisible */
+							0, /* relallvisible, don't bother for indexes */
 							false,
 							InvalidTransactionId,
 							InvalidMultiXactId,
 							false,
 							true /* isvacuum */);
 
+	if (reaped)
+		ereport(elevel,
+				(errmsg("index \"%s\" now contains %.0f row versions in %u pages",
+						RelationGetRelationName(indexRelation),
+						stats->num_index_tuples,
+						stats->num_pages),
+				 errdetail("%.0f index row versions were removed.\n"
+				 "%u index pages have been deleted, %u are currently reusable.\n"
+						   "%s.",
+						   stats->tuples_removed,
+						   stats->pages_deleted, stats->pages_free,
+						   pg_rusage_show(ru0))));
+	else
+		ereport(elevel,
+				(errmsg("index \"%s\" now contains %.0f row versions in %u pages",
+						RelationGetRelationName(indexRelation),
+						stats->num_index_tuples,
+						stats->num_pages),
+				 errdetail("%u index pages have been deleted, %u are currently reusable.\n"
+						   "%s.",
+						   stats->pages_deleted, stats->pages_free,
+						   pg_rusage_show(ru0))));
+}
+
+/*
+ * Compute the number of parallel workers to vacuum the indexes with, like
+ * compute_parallel_vacuum_workers() does for heap tables.  Each index is
+ * vacuumed and cleaned up in one go, so a worker can only take an index
+ * whose access method supports both in parallel.  The others, e.g. bitmap
+ * indexes, are left to the leader.
+ */
+static int
+compute_parallel_ao_vacuum_workers(Relation aoRelation,
+								   Relation *Irel, int nindexes,
+								   int nrequested,
+								   bool *will_parallel_vacuum)
+{
+	int			nindexes_parallel = 0;
+	int			parallel_workers;
+
+	/*
+	 * The indexes are empty on the QD.  Also don't use parallel workers in
+	 * a standalone backend, when parallelism is disabled, or for temporary
+	 * tables.
+	 */
+	if (nrequested <= 0 ||
+		Gp_role == GP_ROLE_DISPATCH ||
+		!IsUnderPostmaster ||
+		max_parallel_maintenance_workers == 0 ||
+		RelationUsesLocalBuffers(aoRelation))
+		return 0;
+
+	for (int i = 0; i < nindexes; i++)
+	{
+		uint8		vacoptions = Irel[i]->rd_indam->amparallelvacuumoptions;
+
+		if ((vacoptions & VACUUM_OPTION_PARALLEL_BULKDEL) == 0 ||
+			(vacoptions & (VACUUM_OPTION_PARALLEL_CLEANUP |
+						   VACUUM_OPTION_PARALLEL_COND_CLEANUP)) == 0 ||
+			RelationGetNumberOfBlocks(Irel[i]) < min_parallel_index_scan_size)
+			continue;
+
+		will_parallel_vacuum[i] = true;
+		nindexes_parallel++;
+	}
+
+	/* The leader process takes one index */
+	nindexes_parallel--;
+
+	/* No index supports parallel vacuum */
+	if (nindexes_parallel <= 0)
+		return 0;
+
+	parallel_workers = Min(nrequested, nindexes_parallel);
+
+	/* Cap by max_parallel_maintenance_workers */
+	return Min(parallel_workers, max_parallel_maintenance_workers);
+}
+
+/*
+ * Vacuum the indexes with parallel workers.  The leader vacuums the indexes
+ * the workers can't, then joins them.  The results are returned in indstats,
+ * for the caller to update pg_class once out of parallel mode.
+ */
+static void
+parallel_vacuum_appendonly_indexes(Relation aoRelation,
+								   Relation *Irel, int nindexes,
+								   int nworkers,
+								   bool *will_parallel_vacuum,
+								   AppendOnlyIndexVacuumState *vacuumIndexState,
+								   double rel_tuple_count,
+								   int elevel,
+								   BufferAccessStrategy bstrategy,
+								   IndexBulkDeleteResult **indstats)
+{
+	ParallelContext *pcxt;
+	AOVacuumShared *shared;
+	Size		est_shared;
+	Size		querylen;
+	char	   *sharedquery;
+	int			nindexes_mwm = 0;
+	int			i;
+
+	EnterParallelMode();
+	pcxt = CreateParallelContext("postgres", "parallel_vacuum_ao_main",
+								 nworkers);
+	Assert(pcxt->nworkers > 0);
+
+	est_shared = add_size(offsetof(AOVacuumShared, indstats),
+						  mul_size(nindexes, sizeof(AOVacuumSharedIndStats)));
+	shm_toc_estimate_chunk(&pcxt->estimator, est_shared);
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+
+	/* Estimate space for the query text, for the workers' pg_stat_activity */
+	if (debug_query_string)
+	{
+		querylen = strlen(debug_query_string);
+		shm_toc_estimate_chunk(&pcxt->estimator, querylen + 1);
+		shm_toc_estimate_keys(&pcxt->estimator, 1);
+	}
+	else
+		querylen = 0;			/* keep compiler quiet */
+
+	InitializeParallelDSM(pcxt);
+
+	shared = (AOVacuumShared *) shm_toc_allocate(pcxt->toc, est_shared);
+	MemSet(shared, 0, est_shared);
+	shared->relid = RelationGetRelid(aoRelation);
+	shared->elevel = elevel;
+	shared->rel_tuple_count = rel_tuple_count;
+	shared->nindexes = nindexes;
+	for (i = 0; i < nindexes; i++)
+	{
+		shared->indstats[i].parallel_safe = will_parallel_vacuum[i];
+		if (will_parallel_vacuum[i] &&
+			Irel[i]->rd_indam->amusemaintenanceworkmem)
+			nindexes_mwm++;
+	}
+
+	/*
+	 * Divide maintenance_work_mem among the workers that may vacuum indexes
+	 * which use it, so that they don't use more than one vacuum would.
+	 */
+	shared->maintenance_work_mem_worker =
+		(nindexes_mwm > 0) ?
+		maintenance_work_mem / Min(pcxt->nworkers, nindexes_mwm) :
+		maintenance_work_mem;
+
+	pg_atomic_init_u32(&shared->cost_balance, VacuumCostBalance);
+	pg_atomic_init_u32(&shared->active_nworkers, 0);
+	pg_atomic_init_u32(&shared->idx, 0);
+	shm_toc_insert(pcxt->toc, PARALLEL_AO_VACUUM_KEY_SHARED, shared);
+
+	if (debug_query_string)
+	{
+		sharedquery = (char *) shm_toc_allocate(pcxt->toc, querylen + 1);
+		memcpy(sharedquery, debug_query_string, querylen + 1);
+		sharedquery[querylen] = '\0';
+		shm_toc_insert(pcxt->toc, PARALLEL_AO_VACUUM_KEY_QUERY_TEXT, sharedquery);
+	}
+
+	LaunchParallelWorkers(pcxt);
+
+	if (pcxt->nworkers_launched > 0)
+	{
+		/* Enable shared cost balance for leader backend */
+		VacuumCostBalance = 0;
+		VacuumCostBalanceLocal = 0;
+		VacuumSharedCostBalance = &shared->cost_balance;
+		VacuumActiveNWorkers = &shared->active_nworkers;
+	}
+
 	ereport(elevel,
-			(errmsg("index \"%s\" now contains %.0f row versions in %u pages",
-					RelationGetRelationName(indexRelation),
-					stats->num_index_tuples,
-					stats->num_pages),
-			 errdetail("%.0f index row versions were removed.\n"
-			 "%u index pages have been deleted, %u are currently reusable.\n"
-					   "%s.",
-					   stats->tuples_removed,
-					   stats->pages_deleted, stats->pages_free,
-					   pg_rusage_show(&ru0))));
-
-	pfree(stats);
+			(errmsg(ngettext("launched %d parallel vacuum worker for index vacuuming (planned: %d)",
+							 "launched %d parallel vacuum workers for index vacuuming (planned: %d)",
+							 pcxt->nworkers_launched),
+					pcxt->nworkers_launched, nworkers)));
+
+	/* Vacuum the indexes that only the leader can */
+	if (VacuumActiveNWorkers)
+		pg_atomic_add_fetch_u32(VacuumActiveNWorkers, 1);
+	for (i = 0; i < nindexes; i++)
+	{
+		if (!will_parallel_vacuum[i])
+			indstats[i] = vacuum_appendonly_index(Irel[i], vacuumIndexState,
+												  rel_tuple_count,
+												  elevel,
+												  bstrategy);
+	}
+	if (VacuumActiveNWorkers)
+		pg_atomic_sub_fetch_u32(VacuumActiveNWorkers, 1);
+
+	/*
+	 * Join as a parallel worker.  The leader alone vacuums all the indexes if
+	 * no workers were launched.
+	 */
+	parallel_vacuum_appendonly_process(Irel, shared, vacuumIndexState,
+									   bstrategy);
+
+	WaitForParallelWorkersToFinish(pcxt);
+
+	for (i = 0; i < nindexes; i++)
+	{
+		AOVacuumSharedIndStats *shared_istat = &shared->indstats[i];
+
+		if (!shared_istat->parallel_safe || !shared_istat->updated)
+			continue;
+
+		indstats[i] = (IndexBulkDeleteResult *) palloc(sizeof(IndexBulkDeleteResult));
+		memcpy(indstats[i], &shared_istat->istat, sizeof(IndexBulkDeleteResult));
+	}
+
+	/* Carry the shared balance value over, and disable shared costing */
+	if (VacuumSharedCostBalance)
+	{
+		VacuumCostBalance = pg_atomic_read_u32(VacuumSharedCostBalance);
+		VacuumSharedCostBalance = NULL;
+		VacuumActiveNWorkers = NULL;
+	}
+
+	DestroyParallelContext(pcxt);
+	ExitParallelMode();
+}
+
+/*
+ * Vacuum the indexes that parallel workers can, one at a time, until none
+ * are left.  Runs in the leader and in each worker.
+ */
+static void
+parallel_vacuum_appendonly_process(Relation *Irel,
+								   AOVacuumShared *shared,
+								   AppendOnlyIndexVacuumState *vacuumIndexState,
+								   BufferAccessStrategy bstrategy)
+{
+	/* Increment the active worker count if we are able to launch any worker */
+	if (VacuumActiveNWorkers)
+		pg_atomic_add_fetch_u32(VacuumActiveNWorkers, 1);
+
+	for (;;)
+	{
+		int			idx;
+		AOVacuumSharedIndStats *shared_istat;
+		IndexBulkDeleteResult *istat;
+
+		/* Get an index number to process */
+		idx = pg_atomic_fetch_add_u32(&shared->idx, 1);
+		if (idx >= shared->nindexes)
+			break;
+
+		shared_istat = &shared->indstats[idx];
+		if (!shared_istat->parallel_safe)
+			continue;
+
+		istat = vacuum_appendonly_index(Irel[idx], vacuumIndexState,
+										shared->rel_tuple_count,
+										shared->elevel,
+										bstrategy);
+		if (istat)
+		{
+			memcpy(&shared_istat->istat, istat, sizeof(IndexBulkDeleteResult));
+			shared_istat->updated = true;
+			pfree(istat);
+		}
+	}
+
+	if (VacuumActiveNWorkers)
+		pg_atomic_sub_fetch_u32(VacuumActiveNWorkers, 1);
+}
+
+/*
+ * Perform work within a launched parallel process.
+ *
+ * The worker opens the table and its indexes with the same lock modes as
+ * heap's parallel_vacuum_main(); the lock group makes them compatible with
+ * the leader's locks.
+ */
+void
+parallel_vacuum_ao_main(dsm_segment *seg, shm_toc *toc)
+{
+	AOVacuumShared *shared;
+	Relation	aoRelation;
+	Relation   *Irel;
+	int			nindexes;
+	AppendOnlyIndexVacuumState vacuumIndexState;
+	BufferAccessStrategy bstrategy;
+	char	   *sharedquery;
+
+	shared = (AOVacuumShared *) shm_toc_lookup(toc, PARALLEL_AO_VACUUM_KEY_SHARED,
+											   false);
+
+	/* Set debug_query_string for individual workers */
+	sharedquery = shm_toc_lookup(toc, PARALLEL_AO_VACUUM_KEY_QUERY_TEXT, true);
+	debug_query_string = sharedquery;
+	pgstat_report_activity(STATE_RUNNING, debug_query_string);
+
+	aoRelation = table_open(shared->relid, ShareUpdateExclusiveLock);
+
+	/*
+	 * Open all indexes.  They are sorted by OID, which should match the
+	 * leader's.
+	 */
+	vac_open_indexes(aoRelation, RowExclusiveLock, &nindexes, &Irel);
+	Assert(nindexes == shared->nindexes);
+
+	/* Set cost-based vacuum delay */
+	VacuumCostActive = (VacuumCostDelay > 0);
+	VacuumCostBalance = 0;
+	VacuumPageHit = 0;
+	VacuumPageMiss = 0;
+	VacuumPageDirty = 0;
+	VacuumCostBalanceLocal = 0;
+	VacuumSharedCostBalance = &shared->cost_balance;
+	VacuumActiveNWorkers = &shared->active_nworkers;
+
+	if (shared->maintenance_work_mem_worker > 0)
+		maintenance_work_mem = shared->maintenance_work_mem_worker;
+
+	/* Each parallel worker gets its own access strategy */
+	bstrategy = GetAccessStrategy(BAS_VACUUM);
+
+	/* The leader's snapshot has been restored as our active snapshot */
+	vacuum_appendonly_index_state_init(aoRelation, GetActiveSnapshot(),
+									   &vacuumIndexState);
+
+	parallel_vacuum_appendonly_process(Irel, shared, &vacuumIndexState,
+									   bstrategy);
+
+	vacuum_appendonly_index_state_finish(aoRelation, &vacuumIndexState);
+
+	vac_close_indexes(nindexes, Irel, RowExclusiveLock);
+	table_close(aoRelation, ShareUpdateExclusiveLock);
+	FreeAccessStrategy(bstrategy);
+}
+
+/*
+ * Materializes the dead rows of the table, for appendonly_tid_reaped() to
+ * look up each index entry in a hash table and a bitmap, rather than in the
+ * block directory and the visimap.  Those lookups are cheap while the index
+ * entries come in table order, but an index is scanned in its own order, and
+ * every switch to another minipage or visimap entry costs an index scan of
+ * the auxiliary relation.
+ *
+ * Gives up, leaving those lookups to do, if the dead rows don't fit in
+ * maintenance_work_mem.  Also if gp_blockdirectory_entry_min_range is set,
+ * as the block directory entries then don't tell the rows exactly.
+ */
+static void
+appendonly_dead_rows_build(Relation aoRelation, Snapshot snapshot,
+						   AppendOnlyIndexVacuumState *vacuumIndexState)
+{
+	MemoryContext cxt;
+	MemoryContext oldcxt;
+	HASHCTL		ctl;
+	HTAB	   *chunks;
+	Size		limit = (Size) maintenance_work_mem * 1024L;
+	AppendOnlyVisimap *visiMap = &vacuumIndexState->visiMap;
+	SysScanDesc visimapScan;
+
+	if (gp_blockdirectory_entry_min_range != 0)
+		return;
+
+	cxt = AllocSetContextCreate(CurrentMemoryContext,
+								"AO vacuum dead rows",
+								ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(cxt);
+
+	ctl.keysize = sizeof(uint64);
+	ctl.entrysize = sizeof(AODeadRowsChunk);
+	ctl.hcxt = cxt;
+	chunks = hash_create("AO vacuum dead rows", 1024, &ctl,
+						 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	/* The rows in the block directory */
+	for (int i = 0; i < vacuumIndexState->totalSegfiles; i++)
+	{
+		int			segno;
+		int64		eof;
+		MinipageEntry *entries;
+		int			nentries;
+
+		if (RelationIsAoRows(aoRelation))
+		{
+			FileSegInfo *fsinfo = vacuumIndexState->segmentFileInfo[i];
+
+			segno = fsinfo->segno;
+			eof = fsinfo->eof;
+		}
+		else
+		{
+			AOCSFileSegInfo *fsinfo =
+				(AOCSFileSegInfo *) vacuumIndexState->segmentFileInfo[i];
+
+			segno = fsinfo->segno;
+			eof = fsinfo->vpinfo.entry[0].eof;
+		}
+
+		/* Column group 0 like the lookups, see appendonly_tid_reaped() */
+		entries = AppendOnlyBlockDirectory_GetSegmentFileEntries(aoRelation,
+																 snapshot,
+																 segno, 0,
+																 eof,
+																 &nentries);
+		for (int j = 0; j < nentries; j++)
+		{
+			int64		firstRowNum = entries[j].firstRowNum;
+			int64		lastRowNum = firstRowNum + entries[j].rowCount - 1;
+			int64		rowNum;
+
+			for (rowNum = firstRowNum; rowNum <= lastRowNum;)
+			{
+				int64		chunkStart = rowNum - rowNum % AO_DEAD_ROWS_CHUNK_SIZE;
+				int			lo = rowNum - chunkStart;
+				int			hi = Min(lastRowNum - chunkStart, AO_DEAD_ROWS_CHUNK_SIZE - 1);
+				uint64		key = AO_DEAD_ROWS_KEY(segno, rowNum);
+				AODeadRowsChunk *chunk;
+				bool		found;
+
+				chunk = hash_search(chunks, &key, HASH_ENTER, &found);
+				if (!found)
+				{
+					chunk->allPresent = false;
+					chunk->present = NULL;
+					chunk->hidden = NULL;
+				}
+
+				if (!chunk->allPresent)
+				{
+					chunk->present = bms_add_range(chunk->present, lo, hi);
+
+					/* Rows come in order, so the chunk can only be full now */
+					if (hi == AO_DEAD_ROWS_CHUNK_SIZE - 1 &&
+						bms_num_members(chunk->present) == AO_DEAD_ROWS_CHUNK_SIZE)
+					{
+						chunk->allPresent = true;
+						bms_free(chunk->present);
+						chunk->present = NULL;
+					}
+				}
+
+				rowNum = chunkStart + hi + 1;
+			}
+		}
+		if (entries)
+			pfree(entries);
+
+		if (MemoryContextMemAllocated(cxt, true) > limit)
+			goto give_up;
+	}
+
+	/* The rows hidden by the visimap */
+	visimapScan = AppendOnlyVisimapStore_BeginScan(&visiMap->visimapStore,
+												   0, NULL);
+	while (AppendOnlyVisimapStore_GetNext(&visiMap->visimapStore,
+										  visimapScan, ForwardScanDirection,
+										  &visiMap->visimapEntry, NULL))
+	{
+		AppendOnlyVisimapEntry *visiMapEntry = &visiMap->visimapEntry;
+		uint64		key;
+		AODeadRowsChunk *chunk;
+
+		if (bms_is_empty(visiMapEntry->bitmap))
+			continue;
+
+		/* Rows of a chunk left out are dead anyway */
+		key = AO_DEAD_ROWS_KEY(visiMapEntry->segmentFileNum,
+							   visiMapEntry->firstRowNum);
+		chunk = hash_search(chunks, &key, HASH_FIND, NULL);
+		if (chunk == NULL)
+			continue;
+
+		chunk->hidden = bms_union(chunk->hidden, visiMapEntry->bitmap);
+
+		if (MemoryContextMemAllocated(cxt, true) > limit)
+		{
+			AppendOnlyVisimapStore_EndScan(&visiMap->visimapStore, visimapScan);
+			goto give_up;
+		}
+	}
+	AppendOnlyVisimapStore_EndScan(&visiMap->visimapStore, visimapScan);
+
+	MemoryContextSwitchTo(oldcxt);
+	vacuumIndexState->deadRows = chunks;
+	vacuumIndexState->deadRowsContext = cxt;
+	vacuumIndexState->lastChunk = NULL;
+	return;
+
+give_up:
+	MemoryContextSwitchTo(oldcxt);
+	MemoryContextDelete(cxt);
+	elogif(Debug_appendonly_print_compaction, LOG,
+		   "dead rows of append-only relation %s don't fit in maintenance_work_mem",
+		   RelationGetRelationName(aoRelation));
+}
+
+/*
+ * Is the row dead, according to the materialized dead rows?
+ */
+static bool
+appendonly_tid_reaped_dead_rows(AppendOnlyIndexVacuumState *vacuumState,
+								AOTupleId *aoTupleId)
+{
+	int64		rowNum = AOTupleIdGet_rowNum(aoTupleId);
+	int			offset = rowNum % AO_DEAD_ROWS_CHUNK_SIZE;
+	uint64		key = AO_DEAD_ROWS_KEY(AOTupleIdGet_segmentFileNum(aoTupleId),
+									   rowNum);
+	AODeadRowsChunk *chunk = vacuumState->lastChunk;
+
+	if (chunk == NULL || chunk->key != key)
+	{
+		chunk = hash_search(vacuumState->deadRows, &key, HASH_FIND, NULL);
+		if (chunk == NULL)
+			return true;
+		vacuumState->lastChunk = chunk;
+	}
+
+	if (!chunk->allPresent && !bms_is_member(offset, chunk->present))
+		return true;
+
+	return bms_is_member(offset, chunk->hidden);
 }
 
 static bool
@@ -697,13 +1420,18 @@ appendonly_tid_reaped(ItemPointer itemptr, void *state)
 	aoTupleId = (AOTupleId *)itemptr;
 	vacuumState = (AppendOnlyIndexVacuumState *)state;
 
-	reaped = !appendonly_tid_reaped_check_block_directory(vacuumState,
-														  aoTupleId);
-	if (!reaped)
+	if (vacuumState->deadRows)
+		reaped = appendonly_tid_reaped_dead_rows(vacuumState, aoTupleId);
+	else
 	{
-		/* Also check visi map */
-		reaped = !AppendOnlyVisimap_IsVisible(&vacuumState->visiMap,
-		aoTupleId);
+		reaped = !appendonly_tid_reaped_check_block_directory(vacuumState,
+															  aoTupleId);
+		if (!reaped)
+		{
+			/* Also check visi map */
+			reaped = !AppendOnlyVisimap_IsVisible(&vacuumState->visiMap,
+			aoTupleId);
+		}
 	}
 
 	if (Debug_appendonly_print_compaction)
@@ -788,64 +1516,3 @@ vacuum_appendonly_fill_stats(Relation aorel, Snapshot snapshot, int elevel,
 					relname, num_tuples, nblocks)));
 	pfree(fstotal);
 }
-
-/*
- *	scan_index() -- scan one index relation to update pg_class statistics.
- *
- * We use this when we have no deletions to do.
- */
-static void
-scan_index(Relation indrel,
-		   AppendOnlyIndexVacuumState *vacuumIndexState,
-		   double num_tuples,
-		   int elevel, BufferAccessStrategy vac_strategy)
-{
-	IndexBulkDeleteResult *stats;
-	IndexVacuumInfo ivinfo;
-	PGRUsage	ru0;
-
-	pg_rusage_init(&ru0);
-
-	ivinfo.index = indrel;
-	ivinfo.analyze_only = false;
-	ivinfo.estimated_count = false;
-	ivinfo.message_level = elevel;
-	ivinfo.num_heap_tuples = num_tuples;
-	ivinfo.strategy = vac_strategy;
-
-	/* Do bulk deletion */
-	stats = index_bulk_delete(&ivinfo, NULL, appendonly_tid_reaped,
-							  (void *) vacuumIndexState);
-
-	/* Do post-VACUUM cleanup */
-	stats = index_vacuum_cleanup(&ivinfo, stats);
-
-	if (!stats)
-		return;
-
-	/*
-	 * Now update statistics in pg_class, but only if the index says the count
-	 * is accurate.
-	 */
-	if (!stats->estimated_count)
-		vac_update_relstats(indrel,
-							stats->num_pages, stats->num_index_tuples,
-							0, /* relallvisible, don't bother for indexes */
-							false,
-							InvalidTransactionId,
-							InvalidMultiXactId,
-							false,
-							true /* isvacuum */);
-
-	ereport(elevel,
-			(errmsg("index \"%s\" now contains %.0f row versions in %u pages",
-					RelationGetRelationName(indrel),
-					stats->num_index_tuples,
-					stats->num_pages),
-	errdetail("%u index pages have been deleted, %u are currently reusable.\n"
-			  "%s.",
-			  stats->pages_deleted, stats->pages_free,
-			  pg_rusage_show(&ru0))));
-
-	pfree(stats);
-}
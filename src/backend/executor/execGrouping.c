@@ -364,6 +364,22 @@ TupleHashTableHash(TupleHashTable hashtable, TupleTableSlot *slot)
 	return hash;
 }
 
+/*
+ * Prefetch the bucket where a lookup of a tuple with the given hash value
+ * starts.  Callers that hash a batch of tuples before looking any of them up
+ * use this to overlap the cache misses of the lookups.
+ *
+ * The bucket is only a hint: inserting entries in between may grow the
+ * table, in which case the lookup just starts somewhere else.
+ */
+void
+TupleHashTablePrefetch(TupleHashTable hashtable, uint32 hash)
+{
+	tuplehash_hash *tb = hashtable->hashtab;
+
+	pg_prefetch_mem(&tb->data[hash & tb->sizemask]);
+}
+
 /*
  * A variant of LookupTupleHashEntry for callers that have already computed
  * the hash value.
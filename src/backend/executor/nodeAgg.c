@@ -217,6 +217,18 @@
  *	  imposing a limit on the number of groups separately from the amount of
  *	  memory consumed.
  *
+ *	  Batched Input
+ *
+ *	  With a single hashed grouping set, the initial pass over the input
+ *	  reads it in batches of gp_hashagg_batch_size tuples (see
+ *	  agg_fill_hash_table_batch()).  All tuples of a batch are hashed, and
+ *	  their buckets prefetched, before any of them is looked up, so that the
+ *	  cache misses of the lookups overlap instead of being taken one at a time.
+ *	  The transition states found are prefetched the same way before the
+ *	  aggregates are advanced.  When every aggregate is a count, or a sum or
+ *	  avg of small integers or floats, the transitions are done by loops over
+ *	  the batch in nodeAgg.c rather than through the transition expression.
+ *
  *    Transition / Combine function invocation:
  *
  *    For performance reasons transition functions, including combine
@@ -260,6 +272,7 @@
 #include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
 #include "common/hashfn.h"
+#include "common/int.h"
 #include "executor/execExpr.h"
 #include "executor/executor.h"
 #include "executor/nodeAgg.h"
@@ -271,11 +284,14 @@
 #include "parser/parse_agg.h"
 #include "parser/parse_coerce.h"
 #include "utils/acl.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/datum.h"
 #include "utils/dynahash.h"
 #include "utils/expandeddatum.h"
 #include "utils/faultinjector.h"
+#include "utils/float.h"
+#include "utils/fmgroids.h"
 #include "utils/logtape.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
@@ -283,6 +299,7 @@
 #include "utils/tuplesort.h"
 
 #include "cdb/cdbexplain.h"
+#include "cdb/cdbvars.h"
 #include "lib/stringinfo.h"             /* StringInfo */
 #include "optimizer/walkers.h"
 
@@ -398,6 +415,61 @@ typedef struct FindColsContext
 	Bitmapset  *unaggregated;	/* other column references */
 } FindColsContext;
 
+/*
+ * Transitions that agg_fill_hash_table_batch() does itself, for aggregates
+ * whose transition function is one of these.
+ */
+typedef enum HashAggBatchTransKind
+{
+	HASHAGG_BATCH_COUNT,		/* int8inc, int8inc_any */
+	HASHAGG_BATCH_SUM_INT2,		/* int2_sum */
+	HASHAGG_BATCH_SUM_INT4,		/* int4_sum */
+	HASHAGG_BATCH_SUM_FLOAT4,	/* float4pl */
+	HASHAGG_BATCH_SUM_FLOAT8,	/* float8pl */
+	HASHAGG_BATCH_AVG_INT2,		/* int2_avg_accum */
+	HASHAGG_BATCH_AVG_INT4		/* int4_avg_accum */
+} HashAggBatchTransKind;
+
+typedef struct HashAggBatchTrans
+{
+	HashAggBatchTransKind kind;
+	int			transno;
+	int			inputcol;		/* zero based, or -1 for count(*) */
+} HashAggBatchTrans;
+
+/*
+ * Transition state of int2_avg_accum() and int4_avg_accum(), a two element
+ * int8 array.  Must match Int8TransTypeData in numeric.c.
+ */
+typedef struct HashAggBatchAvgState
+{
+	int64		count;
+	int64		sum;
+} HashAggBatchAvgState;
+
+/*
+ * A batch of input tuples of the initial pass of hash aggregation.
+ *
+ * The input tuples are copied into the batch's own virtual slots, since the
+ * outer plan's slot only holds one tuple at a time.  Only the columns that
+ * the aggregation needs are copied; the others stay NULL.
+ */
+typedef struct HashAggInputBatch
+{
+	int			maxtuples;
+	TupleTableSlot **slots;		/* maxtuples entries */
+	uint32	   *hashes;			/* hash values of the tuples' group keys */
+	AggStatePerGroup *pergroups;	/* tuples' groups, NULL if spilled */
+	MemoryContext tuplecxt;		/* by-reference values of the slots */
+
+	int			ncols;			/* needed input columns */
+	int		   *cols;			/* zero based */
+
+	/* transitions done by loops over the batch, or 0 to use evaltrans */
+	int			ntrans;
+	HashAggBatchTrans *trans;
+} HashAggInputBatch;
+
 static void select_current_set(AggState *aggstate, int setno, bool is_hash);
 static void initialize_phase(AggState *aggstate, int newphase);
 static TupleTableSlot *fetch_input_tuple(AggState *aggstate);
@@ -451,8 +523,16 @@ static void initialize_hash_entry(AggState *aggstate,
 								  TupleHashTable hashtable,
 								  TupleHashEntry entry);
 static void lookup_hash_entries(AggState *aggstate);
+static void spill_hash_input(AggState *aggstate, int setno,
+							 TupleTableSlot *inputslot, uint32 hash);
 static TupleTableSlot *agg_retrieve_direct(AggState *aggstate);
 static void agg_fill_hash_table(AggState *aggstate);
+static void agg_fill_hash_table_batch(AggState *aggstate);
+static void hashagg_batch_advance(HashAggInputBatch *batch, int ntuples);
+static void hashagg_batch_init(AggState *aggstate, EState *estate,
+							   TupleDesc scanDesc);
+static bool hashagg_batch_trans(AggStatePerTrans pertrans,
+								HashAggBatchTrans *batchtrans);
 static bool agg_refill_hash_table(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table_in_memory(AggState *aggstate);
@@ -2219,20 +2299,31 @@ lookup_hash_entries(AggState *aggstate)
 		}
 		else
 		{
-			HashAggSpill *spill = &aggstate->hash_spills[setno];
-			TupleTableSlot *slot = aggstate->tmpcontext->ecxt_outertuple;
-
-			if (spill->partitions == NULL)
-				hashagg_spill_init(aggstate, spill, aggstate->hash_tapeinfo, 0,
-								   perhash->aggnode->numGroups,
-								   aggstate->hashentrysize);
-
-			hashagg_spill_tuple(aggstate, spill, slot, hash);
+			spill_hash_input(aggstate, setno, outerslot, hash);
 			pergroup[setno] = NULL;
 		}
 	}
 }
 
+/*
+ * Spill an input tuple that belongs to a group not in the hash table of the
+ * given grouping set, during the initial pass over the input.
+ */
+static void
+spill_hash_input(AggState *aggstate, int setno, TupleTableSlot *inputslot,
+				 uint32 hash)
+{
+	AggStatePerHash perhash = &aggstate->perhash[setno];
+	HashAggSpill *spill = &aggstate->hash_spills[setno];
+
+	if (spill->partitions == NULL)
+		hashagg_spill_init(aggstate, spill, aggstate->hash_tapeinfo, 0,
+						   perhash->aggnode->numGroups,
+						   aggstate->hashentrysize);
+
+	hashagg_spill_tuple(aggstate, spill, inputslot, hash);
+}
+
 /*
  * ExecAgg -
  *
@@ -2646,26 +2737,31 @@ agg_fill_hash_table(AggState *aggstate)
 	 * Process each outer-plan tuple, and then fetch the next one, until we
 	 * exhaust the outer plan.
 	 */
-	for (;;)
+	if (aggstate->hash_input_batch != NULL)
+		agg_fill_hash_table_batch(aggstate);
+	else
 	{
-		outerslot = fetch_input_tuple(aggstate);
-		if (TupIsNull(outerslot))
-			break;
+		for (;;)
+		{
+			outerslot = fetch_input_tuple(aggstate);
+			if (TupIsNull(outerslot))
+				break;
 
-		/* set up for lookup_hash_entries and advance_aggregates */
-		tmpcontext->ecxt_outertuple = outerslot;
+			/* set up for lookup_hash_entries and advance_aggregates */
+			tmpcontext->ecxt_outertuple = outerslot;
 
-		/* Find or build hashtable entries */
-		lookup_hash_entries(aggstate);
+			/* Find or build hashtable entries */
+			lookup_hash_entries(aggstate);
 
-		/* Advance the aggregates (or combine functions) */
-		advance_aggregates(aggstate);
+			/* Advance the aggregates (or combine functions) */
+			advance_aggregates(aggstate);
 
-		/*
-		 * Reset per-input-tuple context after each tuple, but note that the
-		 * hash lookups do this too
-		 */
-		ResetExprContext(aggstate->tmpcontext);
+			/*
+			 * Reset per-input-tuple context after each tuple, but note that
+			 * the hash lookups do this too
+			 */
+			ResetExprContext(aggstate->tmpcontext);
+		}
 	}
 
 	/* finalize spills, if any */
@@ -2678,6 +2774,234 @@ agg_fill_hash_table(AggState *aggstate)
 						   &aggstate->perhash[0].hashiter);
 }
 
+/*
+ * Fill the hash table of the only hashed grouping set from the input, a batch
+ * of tuples at a time.
+ *
+ * Each pass over the batch touches memory that the previous pass prefetched:
+ * the group keys are hashed first and the buckets they hash to prefetched,
+ * then the groups are looked up and their transition states prefetched, and
+ * only then are the aggregates advanced.
+ */
+static void
+agg_fill_hash_table_batch(AggState *aggstate)
+{
+	HashAggInputBatch *batch = aggstate->hash_input_batch;
+	AggStatePerHash perhash = &aggstate->perhash[0];
+	TupleHashTable hashtable = perhash->hashtable;
+	TupleTableSlot *hashslot = perhash->hashslot;
+	ExprContext *tmpcontext = aggstate->tmpcontext;
+	bool		done = false;
+
+	Assert(aggstate->num_hashes == 1);
+
+	while (!done)
+	{
+		int			ntuples = 0;
+		int			i;
+
+		MemoryContextReset(batch->tuplecxt);
+
+		/* Read a batch of tuples, hashing their group keys */
+		while (ntuples < batch->maxtuples)
+		{
+			TupleTableSlot *outerslot = fetch_input_tuple(aggstate);
+			TupleTableSlot *slot = batch->slots[ntuples];
+			MemoryContext oldcxt;
+			uint32		hash;
+
+			if (TupIsNull(outerslot))
+			{
+				done = true;
+				break;
+			}
+
+			slot_getsomeattrs(outerslot, aggstate->max_colno_needed);
+
+			ExecClearTuple(slot);
+			oldcxt = MemoryContextSwitchTo(batch->tuplecxt);
+			for (int c = 0; c < batch->ncols; c++)
+			{
+				int			col = batch->cols[c];
+				Form_pg_attribute attr = TupleDescAttr(slot->tts_tupleDescriptor,
+													   col);
+
+				slot->tts_isnull[col] = outerslot->tts_isnull[col];
+				if (slot->tts_isnull[col] || attr->attbyval)
+					slot->tts_values[col] = outerslot->tts_values[col];
+				else
+					slot->tts_values[col] = datumCopy(outerslot->tts_values[col],
+													  false, attr->attlen);
+			}
+			MemoryContextSwitchTo(oldcxt);
+			ExecStoreVirtualTuple(slot);
+
+			prepare_hash_slot(perhash, slot, hashslot);
+			hash = TupleHashTableHash(hashtable, hashslot);
+			TupleHashTablePrefetch(hashtable, hash);
+			batch->hashes[ntuples] = hash;
+			ntuples++;
+		}
+
+		/* Find or build the hash table entries of the batch's groups */
+		select_current_set(aggstate, 0, true);
+		for (i = 0; i < ntuples; i++)
+		{
+			TupleTableSlot *slot = batch->slots[i];
+			TupleHashEntry entry;
+			bool		isnew = false;
+
+			prepare_hash_slot(perhash, slot, hashslot);
+			entry = LookupTupleHashEntryHash(hashtable, hashslot,
+											 aggstate->hash_spill_mode ? NULL : &isnew,
+											 batch->hashes[i]);
+			if (entry != NULL)
+			{
+				if (isnew)
+					initialize_hash_entry(aggstate, hashtable, entry);
+				batch->pergroups[i] = entry->additional;
+				if (entry->additional != NULL)
+					pg_prefetch_mem(entry->additional);
+			}
+			else
+			{
+				spill_hash_input(aggstate, 0, slot, batch->hashes[i]);
+				batch->pergroups[i] = NULL;
+			}
+		}
+
+		/* Advance the aggregates (or combine functions) */
+		if (batch->ntrans > 0)
+			hashagg_batch_advance(batch, ntuples);
+		else
+		{
+			for (i = 0; i < ntuples; i++)
+			{
+				if (batch->pergroups[i] == NULL)
+					continue;
+
+				tmpcontext->ecxt_outertuple = batch->slots[i];
+				aggstate->hash_pergroup[0] = batch->pergroups[i];
+				advance_aggregates(aggstate);
+				ResetExprContext(tmpcontext);
+			}
+		}
+		ResetExprContext(tmpcontext);
+	}
+
+	MemoryContextReset(batch->tuplecxt);
+}
+
+/*
+ * Advance the transition states of a batch's groups by the specialized
+ * transitions of the batch, one aggregate at a time.  Each loop does what the
+ * aggregate's transition function would do for each tuple.
+ */
+static void
+hashagg_batch_advance(HashAggInputBatch *batch, int ntuples)
+{
+	for (int t = 0; t < batch->ntrans; t++)
+	{
+		HashAggBatchTrans *batchtrans = &batch->trans[t];
+		int			transno = batchtrans->transno;
+		int			col = batchtrans->inputcol;
+
+		for (int i = 0; i < ntuples; i++)
+		{
+			AggStatePerGroup pergroupstate;
+			Datum		value = (Datum) 0;
+
+			if (batch->pergroups[i] == NULL)
+				continue;
+			pergroupstate = &batch->pergroups[i][transno];
+
+			/* all the functions ignore NULL inputs */
+			if (col >= 0)
+			{
+				if (batch->slots[i]->tts_isnull[col])
+					continue;
+				value = batch->slots[i]->tts_values[col];
+			}
+
+			switch (batchtrans->kind)
+			{
+				case HASHAGG_BATCH_COUNT:
+					{
+						int64		count;
+
+						if (unlikely(pg_add_s64_overflow(DatumGetInt64(pergroupstate->transValue),
+														 1, &count)))
+							ereport(ERROR,
+									(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+									 errmsg("bigint out of range")));
+						pergroupstate->transValue = Int64GetDatum(count);
+						break;
+					}
+				case HASHAGG_BATCH_SUM_INT2:
+				case HASHAGG_BATCH_SUM_INT4:
+					{
+						int64		newval;
+
+						/* no overflow check, just like int2_sum and int4_sum */
+						if (batchtrans->kind == HASHAGG_BATCH_SUM_INT2)
+							newval = (int64) DatumGetInt16(value);
+						else
+							newval = (int64) DatumGetInt32(value);
+						if (!pergroupstate->transValueIsNull)
+							newval += DatumGetInt64(pergroupstate->transValue);
+						pergroupstate->transValue = Int64GetDatum(newval);
+						pergroupstate->transValueIsNull = false;
+						break;
+					}
+				case HASHAGG_BATCH_SUM_FLOAT4:
+					if (pergroupstate->noTransValue)
+					{
+						pergroupstate->transValue = value;
+						pergroupstate->transValueIsNull = false;
+						pergroupstate->noTransValue = false;
+					}
+					else
+						pergroupstate->transValue =
+							Float4GetDatum(float4_pl(DatumGetFloat4(pergroupstate->transValue),
+													 DatumGetFloat4(value)));
+					break;
+				case HASHAGG_BATCH_SUM_FLOAT8:
+					if (pergroupstate->noTransValue)
+					{
+						pergroupstate->transValue = value;
+						pergroupstate->transValueIsNull = false;
+						pergroupstate->noTransValue = false;
+					}
+					else
+						pergroupstate->transValue =
+							Float8GetDatum(float8_pl(DatumGetFloat8(pergroupstate->transValue),
+													 DatumGetFloat8(value)));
+					break;
+				case HASHAGG_BATCH_AVG_INT2:
+				case HASHAGG_BATCH_AVG_INT4:
+					{
+						/*
+						 * The state is modified in place, as the transition
+						 * functions do when called as aggregates.
+						 */
+						ArrayType  *transarray = (ArrayType *) DatumGetPointer(pergroupstate->transValue);
+						HashAggBatchAvgState *avgstate;
+
+						Assert(!VARATT_IS_EXTENDED(transarray));
+						Assert(ARR_SIZE(transarray) == ARR_OVERHEAD_NONULLS(1) + sizeof(HashAggBatchAvgState));
+						avgstate = (HashAggBatchAvgState *) ARR_DATA_PTR(transarray);
+						avgstate->count++;
+						if (batchtrans->kind == HASHAGG_BATCH_AVG_INT2)
+							avgstate->sum += DatumGetInt16(value);
+						else
+							avgstate->sum += DatumGetInt32(value);
+						break;
+					}
+			}
+		}
+	}
+}
+
 /*
  * If any data was spilled during hash aggregation, reset the hash table and
  * reprocess one batch of spilled data. After reprocessing a batch, the hash
@@ -3345,6 +3669,170 @@ hashagg_reset_spill_state(AggState *aggstate)
 	}
 }
 
+/*
+ * Set up reading the input of hash aggregation in batches, if it applies.
+ *
+ * That needs a single hashed grouping set, and no multi-DQA aggregates,
+ * whose transitions depend on the AggExprId column too.
+ */
+static void
+hashagg_batch_init(AggState *aggstate, EState *estate, TupleDesc scanDesc)
+{
+	HashAggInputBatch *batch;
+	int			maxtuples = gp_hashagg_batch_size;
+	int			transno;
+	int			colno;
+	int			i;
+
+	if (maxtuples < 2 ||
+		aggstate->aggstrategy != AGG_HASHED ||
+		aggstate->num_hashes != 1 ||
+		aggstate->AggExprId_AttrNum > 0)
+		return;
+
+	batch = palloc0(sizeof(HashAggInputBatch));
+	batch->maxtuples = maxtuples;
+	batch->slots = palloc(sizeof(TupleTableSlot *) * maxtuples);
+	batch->hashes = palloc(sizeof(uint32) * maxtuples);
+	batch->pergroups = palloc(sizeof(AggStatePerGroup) * maxtuples);
+	batch->tuplecxt = AllocSetContextCreate(estate->es_query_cxt,
+											"HashAgg input batch",
+											ALLOCSET_DEFAULT_SIZES);
+
+	/* the columns that are never copied stay NULL */
+	for (i = 0; i < maxtuples; i++)
+	{
+		batch->slots[i] = ExecInitExtraTupleSlot(estate, scanDesc,
+												 &TTSOpsVirtual);
+		memset(batch->slots[i]->tts_isnull, true,
+			   sizeof(bool) * scanDesc->natts);
+	}
+
+	batch->cols = palloc(sizeof(int) * bms_num_members(aggstate->colnos_needed));
+	colno = -1;
+	while ((colno = bms_next_member(aggstate->colnos_needed, colno)) >= 0)
+		batch->cols[batch->ncols++] = colno - 1;
+
+	/* do the transitions ourselves if we can do all of them */
+	batch->trans = palloc(sizeof(HashAggBatchTrans) * Max(aggstate->numtrans, 1));
+	transno = -1;
+	while ((transno = bms_next_member(aggstate->aggs_used, transno)) >= 0)
+	{
+		HashAggBatchTrans *batchtrans = &batch->trans[batch->ntrans];
+
+		if (DO_AGGSPLIT_COMBINE(aggstate->aggsplit) ||
+			!hashagg_batch_trans(&aggstate->pertrans[transno], batchtrans))
+		{
+			batch->ntrans = 0;
+			break;
+		}
+		batchtrans->transno = transno;
+		batch->ntrans++;
+	}
+
+	/*
+	 * The transition expression reads the input from the batch's slots
+	 * rather than from the outer plan's, so it can't be compiled for the
+	 * outer plan's slot type.
+	 */
+	aggstate->ss.ps.outeropsfixed = false;
+
+	aggstate->hash_input_batch = batch;
+}
+
+/*
+ * Can the transition of the given aggregate be done by
+ * hashagg_batch_advance()?  If so, fill in the kind and input column of
+ * *batchtrans.
+ *
+ * The aggregate's transition function must be one of the functions that
+ * hashagg_batch_advance() knows, called on a plain input column, with no
+ * FILTER, DISTINCT or ORDER BY.  The strictness and the initial value of the
+ * transition state are checked too, since a user-defined aggregate could use
+ * the same function differently.
+ */
+static bool
+hashagg_batch_trans(AggStatePerTrans pertrans, HashAggBatchTrans *batchtrans)
+{
+	Aggref	   *aggref = pertrans->aggref;
+	bool		strict;
+	bool		nullinit;
+
+	if (aggref->aggfilter != NULL || pertrans->numSortCols > 0)
+		return false;
+
+	if (pertrans->numTransInputs == 0)
+		batchtrans->inputcol = -1;
+	else if (pertrans->numTransInputs == 1 && list_length(aggref->args) == 1)
+	{
+		TargetEntry *tle = linitial_node(TargetEntry, aggref->args);
+		Var		   *var = (Var *) tle->expr;
+
+		if (!IsA(var, Var) || var->varno != OUTER_VAR || var->varattno <= 0)
+			return false;
+		batchtrans->inputcol = var->varattno - 1;
+	}
+	else
+		return false;
+
+	switch (pertrans->transfn_oid)
+	{
+		case F_INT8INC:
+		case F_INT8INC_ANY:
+			batchtrans->kind = HASHAGG_BATCH_COUNT;
+			strict = true;
+			nullinit = false;
+			break;
+		case F_INT2_SUM:
+			batchtrans->kind = HASHAGG_BATCH_SUM_INT2;
+			strict = false;
+			nullinit = true;
+			break;
+		case F_INT4_SUM:
+			batchtrans->kind = HASHAGG_BATCH_SUM_INT4;
+			strict = false;
+			nullinit = true;
+			break;
+		case F_FLOAT4PL:
+			batchtrans->kind = HASHAGG_BATCH_SUM_FLOAT4;
+			strict = true;
+			nullinit = true;
+			break;
+		case F_FLOAT8PL:
+			batchtrans->kind = HASHAGG_BATCH_SUM_FLOAT8;
+			strict = true;
+			nullinit = true;
+			break;
+		case F_INT2_AVG_ACCUM:
+			batchtrans->kind = HASHAGG_BATCH_AVG_INT2;
+			strict = true;
+			nullinit = false;
+			break;
+		case F_INT4_AVG_ACCUM:
+			batchtrans->kind = HASHAGG_BATCH_AVG_INT4;
+			strict = true;
+			nullinit = false;
+			break;
+		default:
+			return false;
+	}
+
+	/* count(*) has no input, all the others exactly one */
+	if ((pertrans->transfn_oid == F_INT8INC) != (batchtrans->inputcol < 0))
+		return false;
+
+	if (pertrans->transfn.fn_strict != strict ||
+		pertrans->initValueIsNull != nullinit)
+		return false;
+
+	/* the averages' state is an int8 array, the others' passed by value */
+	if (batchtrans->kind == HASHAGG_BATCH_AVG_INT2 ||
+		batchtrans->kind == HASHAGG_BATCH_AVG_INT4)
+		return !pertrans->transtypeByVal;
+
+	return pertrans->transtypeByVal;
+}
+
 
 /* -----------------
  * ExecInitAgg
@@ -4123,6 +4611,8 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 	/* MPP */
 	aggstate->AggExprId_AttrNum = node->agg_expr_id;
 
+	hashagg_batch_init(aggstate, estate, scanDesc);
+
 	/*
 	 * Build expressions doing all the transition work at once. We build a
 	 * different one for each phase, as the number of transition function
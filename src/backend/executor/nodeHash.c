@@ -57,6 +57,9 @@
 
 #include "lib/bloomfilter.h"
 
+/* limits the memory wasted in partially filled chunks of radix partitions */
+#define HJ_RADIX_MAX_PARTITIONS		4096
+
 static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
 static void ExecHashIncreaseNumBuckets(HashJoinTable hashtable);
 static void ExecParallelHashIncreaseNumBatches(HashJoinTable hashtable);
@@ -69,6 +72,8 @@ static void ExecHashSkewTableInsert(HashState *hashState,
 									uint32 hashvalue,
 									int bucketNumber);
 static void ExecHashRemoveNextSkewBucket(HashState *hashState, HashJoinTable hashtable);
+static void ExecHashRadixInit(HashJoinTable hashtable, double ntuples,
+							  int tupwidth);
 
 static void ExecHashTableExplainEnd(PlanState *planstate, struct StringInfoData *buf);
 static void
@@ -78,6 +83,8 @@ ExecHashTableExplainBatches(HashJoinTable   hashtable,
                             int             ibatch_end,
                             const char     *title);
 static void *dense_alloc(HashJoinTable hashtable, Size size);
+static void *dense_alloc_radix(HashJoinTable hashtable, Size size,
+							   int partno);
 static HashJoinTuple ExecParallelHashTupleAlloc(HashJoinTable hashtable,
 												size_t size,
 												dsa_pointer *shared);
@@ -563,6 +570,10 @@ ExecHashTableCreate(HashState *state, HashJoinState *hjstate,
 	hashtable->work_set = NULL;
 
 	hashtable->chunks = NULL;
+	hashtable->nradix = 0;
+	hashtable->log2_nradix = 0;
+	hashtable->radix_chunks = NULL;
+	hashtable->radix_outer = NULL;
 	hashtable->current_chunk = NULL;
 	hashtable->parallel_state = state->parallel_state;
 	hashtable->area = state->ps.state->es_query_dsa;
@@ -713,11 +724,63 @@ ExecHashTableCreate(HashState *state, HashJoinState *hjstate,
 			ExecHashBuildSkewHash(hashtable, node, num_skew_mcvs);
 
 		MemoryContextSwitchTo(oldcxt);
+
+		/* A one-batch join may partition its table to fit the cache. */
+		if (nbatch == 1)
+			ExecHashRadixInit(hashtable, rows, outerNode->plan_width);
 	}
 
 	return hashtable;
 }
 
+/*
+ * Set up radix partitioning of a single-batch hash table, if it is expected
+ * to be much larger than gp_hashjoin_radix_partition_size.
+ *
+ * The table must also be expected to fit in half the memory allowed, so
+ * that the other half can hold outer tuples read ahead for probing it a
+ * partition at a time.  Partitioning pays off only if many of those probe
+ * each partition.
+ */
+static void
+ExecHashRadixInit(HashJoinTable hashtable, double ntuples, int tupwidth)
+{
+	double		partition_bytes = gp_hashjoin_radix_partition_size * 1024.0;
+	double		inner_bytes;
+	int			nradix;
+
+	if (partition_bytes <= 0)
+		return;
+
+	inner_bytes = ntuples * (HJTUPLE_OVERHEAD +
+							 MAXALIGN(SizeofMinimalTupleHeader) +
+							 MAXALIGN(tupwidth)) +
+		hashtable->nbuckets * sizeof(HashJoinTuple);
+	if (inner_bytes < 2 * partition_bytes ||
+		inner_bytes > hashtable->spaceAllowed / 2)
+		return;
+
+	/*
+	 * Each partition needs a bucket of its own, and wastes about half a
+	 * chunk of memory.
+	 */
+	nradix = pg_nextpower2_32((uint32) Min(inner_bytes / partition_bytes,
+										   HJ_RADIX_MAX_PARTITIONS));
+	nradix = Min(nradix, hashtable->nbuckets);
+	if (nradix < 2)
+		return;
+
+	hashtable->nradix = nradix;
+	hashtable->log2_nradix = my_log2(nradix);
+	hashtable->radix_chunks = (HashMemoryChunk *)
+		MemoryContextAllocZero(hashtable->hashCxt,
+							   nradix * sizeof(HashMemoryChunk));
+
+#ifdef HJDEBUG
+	printf("Hashjoin %p: %d radix partitions\n", hashtable, nradix);
+#endif
+}
+
 
 /*
  * Compute appropriate size for hashtable given the estimated size of the
@@ -1052,6 +1115,9 @@ ExecHashTableDestroy(HashState *hashState, HashJoinTable hashtable)
 
 	/* Release working memory (batchCxt is a child, so it goes away too) */
 	MemoryContextDelete(hashtable->hashCxt);
+	hashtable->nradix = 0;
+	hashtable->radix_chunks = NULL;
+	hashtable->radix_outer = NULL;
 
 	/*
 	 * If HashJoin find that the tuple it will return is NULL, it may squelch itself and its children.
@@ -1094,6 +1160,19 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 	nbatch = oldnbatch * 2;
 	Assert(nbatch > 1);
 
+	/*
+	 * The table doesn't fit in memory after all, so give up radix
+	 * partitioning.  The loop below moves every tuple to the bucket it
+	 * belongs in without it.
+	 */
+	if (hashtable->nradix > 0)
+	{
+		hashtable->nradix = 0;
+		hashtable->log2_nradix = 0;
+		pfree(hashtable->radix_chunks);
+		hashtable->radix_chunks = NULL;
+	}
+
 #ifdef HJDEBUG
 	printf("Hashjoin %p: increasing nbatch to %d because space = %zu\n",
 		   hashtable, nbatch, hashtable->spaceUsed);
@@ -1838,7 +1917,12 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 
 		/* Create the HashJoinTuple */
 		hashTupleSize = HJTUPLE_OVERHEAD + tuple->t_len;
-		hashTuple = (HashJoinTuple) dense_alloc(hashtable, hashTupleSize);
+		if (hashtable->nradix > 0)
+			hashTuple = (HashJoinTuple)
+				dense_alloc_radix(hashtable, hashTupleSize,
+								  HJ_RADIX_PARTITION(hashtable, hashvalue));
+		else
+			hashTuple = (HashJoinTuple) dense_alloc(hashtable, hashTupleSize);
 
 		hashTuple->hashvalue = hashvalue;
 		memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, tuple->t_len);
@@ -2154,6 +2238,10 @@ ExecHashGetHashValue(HashState *hashState, HashJoinTable hashtable,
  * value.  This causes batchno to steal bits from bucketno when the number of
  * virtual buckets exceeds 2^32.  It's better to have longer bucket chains
  * than to lose the ability to divide batches.
+ *
+ * A radix partitioned table has a single batch, and takes the top bits of
+ * its bucket numbers from the top bits of the hash value instead, see
+ * hashjoin.h.
  */
 void
 ExecHashGetBucketAndBatch(HashJoinTable hashtable,
@@ -2170,6 +2258,14 @@ ExecHashGetBucketAndBatch(HashJoinTable hashtable,
 		*batchno = pg_rotate_right32(hashvalue,
 									 hashtable->log2_nbuckets) & (nbatch - 1);
 	}
+	else if (hashtable->nradix > 0)
+	{
+		int			partbits = hashtable->log2_nbuckets - hashtable->log2_nradix;
+
+		*bucketno = (HJ_RADIX_PARTITION(hashtable, hashvalue) << partbits) |
+			(hashvalue & ((1U << partbits) - 1));
+		*batchno = 0;
+	}
 	else
 	{
 		*bucketno = hashvalue & (nbuckets - 1);
@@ -2420,6 +2516,9 @@ ExecHashTableReset(HashState *hashState, HashJoinTable hashtable)
 
 	/* Forget the chunks (the memory was freed by the context reset above). */
 	hashtable->chunks = NULL;
+	if (hashtable->nradix > 0)
+		memset(hashtable->radix_chunks, 0,
+			   hashtable->nradix * sizeof(HashMemoryChunk));
 }
 
 /*
@@ -2584,6 +2683,19 @@ ExecHashTableExplainEnd(PlanState *planstate, struct StringInfoData *buf)
 				"Secondary Overflow");
     }
 
+    /* Report radix partitioning. */
+    if (stats->nradix > 0 && stats->radixreadahead > 0)
+        appendStringInfo(buf,
+                         "Probed %d radix partitions,"
+                         " reading ahead up to %d outer tuples.\n",
+                         stats->nradix,
+                         stats->radixreadahead);
+    else if (stats->nradix > 0)
+        appendStringInfo(buf,
+                         "Radix partitioned into %d partitions,"
+                         " without memory to read ahead outer tuples.\n",
+                         stats->nradix);
+
     /* Report hash chain statistics. */
     total_buckets = stats->nonemptybatches * hashtable->nbuckets;
     if (total_buckets > 0)
@@ -3414,6 +3526,45 @@ dense_alloc(HashJoinTable hashtable, Size size)
 	return ptr;
 }
 
+/*
+ * Allocate 'size' bytes from the current HashMemoryChunk of a radix
+ * partition, so that the tuples of a partition are packed together.
+ *
+ * The partitions' chunks all go in the one list of the batch, which the
+ * code that scans through all the tuples relies on.
+ */
+static void *
+dense_alloc_radix(HashJoinTable hashtable, Size size, int partno)
+{
+	HashMemoryChunk chunk = hashtable->radix_chunks[partno];
+	char	   *ptr;
+
+	size = MAXALIGN(size);
+
+	/* large tuples get a chunk of their own anyway */
+	if (size > HASH_CHUNK_THRESHOLD)
+		return dense_alloc(hashtable, size);
+
+	if (chunk == NULL || (chunk->maxlen - chunk->used) < size)
+	{
+		chunk = (HashMemoryChunk) MemoryContextAlloc(hashtable->batchCxt,
+													 HASH_CHUNK_HEADER_SIZE + HASH_CHUNK_SIZE);
+		chunk->maxlen = HASH_CHUNK_SIZE;
+		chunk->used = 0;
+		chunk->ntuples = 0;
+
+		chunk->next.unshared = hashtable->chunks;
+		hashtable->chunks = chunk;
+		hashtable->radix_chunks[partno] = chunk;
+	}
+
+	ptr = HASH_CHUNK_DATA(chunk) + chunk->used;
+	chunk->used += size;
+	chunk->ntuples += 1;
+
+	return ptr;
+}
+
 /*
  * Allocate space for a tuple in shared dense storage.  This is equivalent to
  * dense_alloc but for Parallel Hash using shared memory.
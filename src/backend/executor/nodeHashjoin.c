@@ -143,6 +143,11 @@
 static TupleTableSlot *ExecHashJoinOuterGetTuple(PlanState *outerNode,
 												 HashJoinState *hjstate,
 												 uint32 *hashvalue);
+static TupleTableSlot *ExecHashJoinRadixOuterGetTuple(PlanState *outerNode,
+														HashJoinState *hjstate,
+														uint32 *hashvalue);
+static void ExecHashJoinRadixReadAhead(PlanState *outerNode,
+									   HashJoinState *hjstate);
 static TupleTableSlot *ExecParallelHashJoinOuterGetTuple(PlanState *outerNode,
 														 HashJoinState *hjstate,
 														 uint32 *hashvalue);
@@ -979,10 +984,14 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	hjstate->hj_OuterNotEmpty = false;
 	hjstate->worker_id = -1;
 
-	/* Setup the relationship of HashJoin, Hash and RuntimeFilter node. */
+	/*
+	 * Setup the relationship of HashJoin, Hash and RuntimeFilter node.  A
+	 * filter pushed down from a join in an upper slice belongs to that join.
+	 */
 	hstate = (HashState *) innerPlanState(hjstate);
 	outerState = outerPlanState(hjstate);
-	if (IsA(outerState, RuntimeFilterState))
+	if (IsA(outerState, RuntimeFilterState) &&
+		((RuntimeFilter *) outerState->plan)->hashkeys == NIL)
 	{
 		RuntimeFilterState *rfstate = (RuntimeFilterState *) outerState;
 		rfstate->hjstate = hjstate;
@@ -1060,7 +1069,11 @@ ExecHashJoinOuterGetTuple(PlanState *outerNode,
 	HashState  *hashState = (HashState *) innerPlanState(hjstate);
 
 	/* Read tuples from outer relation only if it's the first batch */
-	if (curbatch == 0)
+	if (curbatch == 0 && hashtable->nradix > 0 &&
+		(hashtable->radix_outer == NULL ||
+		 hashtable->radix_outer->maxtuples > 0))
+		return ExecHashJoinRadixOuterGetTuple(outerNode, hjstate, hashvalue);
+	else if (curbatch == 0)
 	{
 		/*
 		 * Check to see if first outer tuple was already fetched by
@@ -1145,6 +1158,206 @@ ExecHashJoinOuterGetTuple(PlanState *outerNode,
 	return NULL;
 }
 
+/*
+ * ExecHashJoinOuterGetTuple variant for a radix partitioned hash table.
+ *
+ * Outer tuples are returned in the order of the table's partitions, a
+ * read-ahead batch at a time, rather than in the order the outer plan
+ * returns them.  If there is no memory left to read ahead, they are returned
+ * as usual.
+ */
+static TupleTableSlot *
+ExecHashJoinRadixOuterGetTuple(PlanState *outerNode,
+							   HashJoinState *hjstate,
+							   uint32 *hashvalue)
+{
+	HashJoinTable hashtable = hjstate->hj_HashTable;
+	HashJoinRadixOuter *radix = hashtable->radix_outer;
+	TupleTableSlot *slot = hjstate->hj_OuterTupleSlot;
+
+	if (radix == NULL || radix->next >= radix->ntuples)
+	{
+		if (radix != NULL && radix->done)
+			return NULL;
+
+		ExecHashJoinRadixReadAhead(outerNode, hjstate);
+		radix = hashtable->radix_outer;
+		if (radix->maxtuples == 0)
+			return ExecHashJoinOuterGetTuple(outerNode, hjstate, hashvalue);
+		if (radix->ntuples == 0)
+			return NULL;
+	}
+
+	*hashvalue = radix->hashvalues[radix->next];
+	ExecStoreMinimalTuple(radix->tuples[radix->next], slot, false);
+	radix->next++;
+
+	return slot;
+}
+
+/*
+ * Read ahead outer tuples into the memory the hash table leaves free, and
+ * order them by partition.
+ *
+ * The first time through, the arrays for the tuples are sized from the
+ * planner's estimate of the outer tuples' width, so that they and the tuples
+ * they hold fit in the free memory together.  Both are counted in the hash
+ * table's spaceUsed.  If that memory can't hold a tuple per partition, the
+ * outer tuples are not read ahead at all, as ordering so few of them would
+ * not save any cache misses; maxtuples is left 0 then.
+ */
+static void
+ExecHashJoinRadixReadAhead(PlanState *outerNode, HashJoinState *hjstate)
+{
+	HashJoinTable hashtable = hjstate->hj_HashTable;
+	HashJoinRadixOuter *radix = hashtable->radix_outer;
+	HashState  *hashState = (HashState *) innerPlanState(hjstate);
+	ExprContext *econtext = hjstate->js.ps.ps_ExprContext;
+	bool		keep_nulls = HJ_FILL_OUTER(hjstate) || hjstate->hj_nonequijoin;
+	Size		space_free;
+	Size		space_used = 0;
+	int			ntuples = 0;
+	int			pos;
+
+	if (radix == NULL)
+	{
+		Size		entry_bytes = 2 * (sizeof(MinimalTuple) + sizeof(uint32));
+		Size		tuple_bytes;
+		Size		counts_bytes = hashtable->nradix * sizeof(int);
+		Size		arrays_bytes;
+		Size		maxtuples = 0;
+
+		radix = MemoryContextAllocZero(hashtable->hashCxt,
+									   sizeof(HashJoinRadixOuter));
+		hashtable->radix_outer = radix;
+
+		space_free = hashtable->spaceAllowed -
+			Min(hashtable->spaceUsed, hashtable->spaceAllowed);
+		tuple_bytes = MAXALIGN(SizeofMinimalTupleHeader) +
+			MAXALIGN(outerNode->plan->plan_width) + entry_bytes;
+		if (space_free > counts_bytes)
+			maxtuples = Min((space_free - counts_bytes) / tuple_bytes,
+							MaxAllocSize / sizeof(MinimalTuple));
+		if (hashtable->stats)
+		{
+			hashtable->stats->nradix = hashtable->nradix;
+			if (maxtuples >= hashtable->nradix)
+				hashtable->stats->radixreadahead = maxtuples;
+		}
+		if (maxtuples < hashtable->nradix)
+			return;
+
+		radix->tupleCxt = AllocSetContextCreate(hashtable->hashCxt,
+												"HashJoinRadixOuter",
+												ALLOCSET_DEFAULT_SIZES);
+		radix->maxtuples = maxtuples;
+		radix->tuples = MemoryContextAlloc(hashtable->hashCxt,
+										   maxtuples * sizeof(MinimalTuple));
+		radix->hashvalues = MemoryContextAlloc(hashtable->hashCxt,
+											   maxtuples * sizeof(uint32));
+		radix->readtuples = MemoryContextAlloc(hashtable->hashCxt,
+											   maxtuples * sizeof(MinimalTuple));
+		radix->readhashvalues = MemoryContextAlloc(hashtable->hashCxt,
+												   maxtuples * sizeof(uint32));
+		radix->counts = MemoryContextAlloc(hashtable->hashCxt, counts_bytes);
+
+		arrays_bytes = maxtuples * entry_bytes + counts_bytes;
+		hashtable->spaceUsed += arrays_bytes;
+		if (hashtable->spaceUsed > hashtable->spacePeak)
+			hashtable->spacePeak = hashtable->spaceUsed;
+	}
+
+	/* Forget the previous read-ahead */
+	MemoryContextReset(radix->tupleCxt);
+	hashtable->spaceUsed -= radix->tupleSpace;
+	radix->tupleSpace = 0;
+	memset(radix->counts, 0, hashtable->nradix * sizeof(int));
+
+	space_free = hashtable->spaceAllowed -
+		Min(hashtable->spaceUsed, hashtable->spaceAllowed);
+
+	while (ntuples < radix->maxtuples && space_used < space_free)
+	{
+		TupleTableSlot *slot;
+		uint32		hashvalue;
+		bool		hashkeys_null = false;
+		MemoryContext oldcxt;
+		MinimalTuple tuple;
+
+		/*
+		 * Check to see if first outer tuple was already fetched by
+		 * ExecHashJoin() and not used yet.
+		 */
+		slot = hjstate->hj_FirstOuterTupleSlot;
+		if (!TupIsNull(slot))
+			hjstate->hj_FirstOuterTupleSlot = NULL;
+		else
+			slot = ExecProcNode(outerNode);
+
+		if (TupIsNull(slot))
+		{
+			radix->done = true;
+			break;
+		}
+
+		econtext->ecxt_outertuple = slot;
+		if (!ExecHashGetHashValue(hashState, hashtable, econtext,
+								  hjstate->hj_OuterHashKeys,
+								  true,	/* outer tuple */
+								  keep_nulls,
+								  &hashvalue,
+								  &hashkeys_null))
+		{
+			/*
+			 * That tuple couldn't match because of a NULL, so discard it and
+			 * continue with the next one.
+			 */
+			ResetExprContext(econtext);
+			continue;
+		}
+		ResetExprContext(econtext);
+
+		/* remember outer relation is not empty for possible rescan */
+		hjstate->hj_OuterNotEmpty = true;
+
+		oldcxt = MemoryContextSwitchTo(radix->tupleCxt);
+		tuple = ExecCopySlotMinimalTuple(slot);
+		MemoryContextSwitchTo(oldcxt);
+
+		radix->readtuples[ntuples] = tuple;
+		radix->readhashvalues[ntuples] = hashvalue;
+		radix->counts[HJ_RADIX_PARTITION(hashtable, hashvalue)]++;
+		space_used += tuple->t_len;
+		ntuples++;
+	}
+
+	radix->tupleSpace = space_used;
+	hashtable->spaceUsed += space_used;
+	if (hashtable->spaceUsed > hashtable->spacePeak)
+		hashtable->spacePeak = hashtable->spaceUsed;
+
+	/* Order the tuples by partition, keeping the order within each */
+	pos = 0;
+	for (int partno = 0; partno < hashtable->nradix; partno++)
+	{
+		int			count = radix->counts[partno];
+
+		radix->counts[partno] = pos;
+		pos += count;
+	}
+	for (int i = 0; i < ntuples; i++)
+	{
+		uint32		hashvalue = radix->readhashvalues[i];
+
+		pos = radix->counts[HJ_RADIX_PARTITION(hashtable, hashvalue)]++;
+		radix->tuples[pos] = radix->readtuples[i];
+		radix->hashvalues[pos] = hashvalue;
+	}
+
+	radix->ntuples = ntuples;
+	radix->next = 0;
+}
+
 /*
  * ExecHashJoinOuterGetTuple variant for the parallel case.
  */
@@ -1730,6 +1943,20 @@ ExecReScanHashJoin(HashJoinState *node)
 	node->hj_MatchedOuter = false;
 	node->hj_FirstOuterTupleSlot = NULL;
 
+	/* Forget the outer tuples read ahead for a radix partitioned table */
+	if (node->hj_HashTable != NULL && node->hj_HashTable->radix_outer != NULL &&
+		node->hj_HashTable->radix_outer->maxtuples > 0)
+	{
+		HashJoinRadixOuter *radix = node->hj_HashTable->radix_outer;
+
+		MemoryContextReset(radix->tupleCxt);
+		node->hj_HashTable->spaceUsed -= radix->tupleSpace;
+		radix->tupleSpace = 0;
+		radix->ntuples = 0;
+		radix->next = 0;
+		radix->done = false;
+	}
+
 	/*
 	 * if chgParam of subnode is not null then plan will be re-scanned by
 	 * first ExecProcNode.
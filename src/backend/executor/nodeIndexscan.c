@@ -136,6 +136,9 @@ IndexNext(IndexScanState *node)
 			node->iss_ScanDesc = scandesc;
 		}
 
+		if (node->iss_BatchFetch)
+			index_batch_fetch_begin(scandesc);
+
 		/*
 		 * If no run-time keys to calculate or they are ready, go ahead and
 		 * pass the scankeys to the index AM.
@@ -955,6 +958,14 @@ ExecInitIndexScan(IndexScan *node, EState *estate, int eflags)
 	indexstate->ss.ss_currentRelation = currentRelation;
 	indexstate->ss.ss_currentScanDesc = NULL;	/* no heap scan here */
 
+	/*
+	 * Table tuples may be fetched ahead in batches, unless the scan has to
+	 * support mark/restore or moving backwards, which the index position
+	 * being ahead of the returned tuple would break.
+	 */
+	indexstate->iss_BatchFetch =
+		(eflags & (EXEC_FLAG_MARK | EXEC_FLAG_BACKWARD)) == 0;
+
 	/*
 	 * get the scan type from the relation descriptor.
 	 */
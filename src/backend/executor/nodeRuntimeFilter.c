@@ -3,6 +3,38 @@
  * nodeRuntimeFilter.c
  *	  Routines to handle runtime filter.
  *
+ * A RuntimeFilter node sits on the outer side of a hash join, and discards
+ * the outer rows whose join keys are not in a bloom filter built from the
+ * join's inner rows.
+ *
+ * Cross-slice filters
+ * -------------------
+ *
+ * When the planner pushes the filter down to a scan in a lower slice, the
+ * join's RuntimeFilter publishes its bloom filter, once the hash table is
+ * built, and a second RuntimeFilter over the scan picks it up.  The bloom
+ * filter is copied to a DSM segment, and its handle is advertised in a
+ * shared memory hash table keyed by session, command and filter id, which
+ * works like the one of cross-slice ShareInputScans.  Only processes of the
+ * same segment find each other that way, which is all that is needed: the
+ * planner only pushes down filters of joins whose inner side is replicated,
+ * so the filter of every segment's join is complete.
+ *
+ * The pushed down filter never waits for the join.  Its slice usually runs
+ * ahead of the join's, and the join may not even ask for outer rows before
+ * the lower slice has sent some, so until the filter is published all the
+ * rows pass through.
+ *
+ * Filters in append-optimized scans
+ * ---------------------------------
+ *
+ * When the filter sits right on top of the scan of an append-optimized
+ * table, and the first join key is a column of the table, the filter is
+ * also handed to the scan (see ScanRuntimeFilter).  The range of that key
+ * on the inner side lets the scan skip whole blocks by their zone maps, and
+ * with a single join key the scan tests the bloom filter itself, as one of
+ * its pushed down quals, before reading the other columns of a row.
+ *
  * Portions Copyright (c) 2023-Present, Cloudberry inc
  *
  *
@@ -14,22 +46,118 @@
 
 #include "postgres.h"
 
+#include "access/appendonly_zonemap.h"
 #include "catalog/pg_type.h"
+#include "executor/execExpr.h"
 #include "executor/executor.h"
 #include "executor/hashjoin.h"
 #include "executor/nodeRuntimeFilter.h"
+#include "executor/nodeSeqscan.h"
 #include "lib/bloomfilter.h"
+#include "lib/ilist.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "nodes/pg_list.h"
+#include "parser/parsetree.h"
+#include "port/atomics.h"
+#include "storage/dsm.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/hsearch.h"
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/resowner.h"
 
 #include "cdb/cdbvars.h"
 
-static TupleTableSlot *RuntimeFilterTupleNext(RuntimeFilterState *node);
+/*
+ * The shared memory hash table holds a 'runtimefilter_Xslice_state' for
+ * every filter that is published or looked for on this segment.  The entry
+ * is created by the first process that refers to it, which can be either
+ * side, and removed when the last reference is released.  The hash table
+ * and the entries are protected by RuntimeFilterLock; 'ready' is also read
+ * without the lock, to poll it cheaply.
+ */
+typedef struct runtimefilter_tag
+{
+	int32		session_id;
+	int32		command_count;
+	int32		filter_id;
+} runtimefilter_tag;
+
+typedef struct runtimefilter_Xslice_state
+{
+	runtimefilter_tag tag;		/* hash key */
+
+	int			refcount;		/* reference count of this entry */
+	pg_atomic_uint32 ready;		/* has the filter been published? */
+	dsm_handle	handle;			/* DSM segment holding the filter */
+} runtimefilter_Xslice_state;
+
+/*
+ * Contents of the DSM segment of a published filter.  The tag is repeated,
+ * so that a reader can tell the segment is the one it looked for.
+ */
+#define RUNTIMEFILTER_MAGIC		0x52464c54
+
+typedef struct RuntimeFilterShared
+{
+	uint32		magic;
+	runtimefilter_tag tag;
+	bool		has_range;		/* range of the first key, if kept */
+	Oid			range_typid;
+	int64		range_min;
+	int64		range_max;
+	Size		size;			/* size of the bloom filter */
+	char		data[FLEXIBLE_ARRAY_MEMBER];	/* the bloom filter */
+} RuntimeFilterShared;
+
+static HTAB *runtimefilter_Xslice_hash = NULL;
+
+/*
+ * A reference to an entry of the shared hash table, held by a publishing or
+ * pushed down RuntimeFilter.  Like the references of ShareInputScans, these
+ * are allocated in TopMemoryContext and released on abort by a resource
+ * owner callback.
+ */
+typedef struct runtimefilter_Xslice_reference
+{
+	runtimefilter_Xslice_state *xslice_state;
+	dsm_segment *seg;			/* publisher's segment, or NULL */
+
+	ResourceOwner owner;
+
+	dlist_node	node;
+} runtimefilter_Xslice_reference;
+
+static dlist_head runtimefilter_Xslice_refs = DLIST_STATIC_INIT(runtimefilter_Xslice_refs);
+static bool runtimefilter_resowner_callback_registered = false;
+
+static TupleTableSlot *RuntimeFilterTupleNext(RuntimeFilterState *node,
+											  ExprContext *econtext,
+											  List *hashkeys,
+											  FmgrInfo *hashfunctions,
+											  Oid *hashcollations);
 static void ExecRuntimeFilterExplainEnd(PlanState *planstate,
 										struct StringInfoData *buf);
+static void ExecInitPushedRuntimeFilter(RuntimeFilterState *rfstate,
+										int eflags);
 static void RFFillTupleValues(RuntimeFilterState *rfstate, List *values);
+static void RFPublish(RuntimeFilterState *rfstate);
+static bool RFReceive(RuntimeFilterState *rfstate);
+static void RFPushToScan(RuntimeFilterState *rfstate, List *hashkeys,
+						 FmgrInfo *hashfunctions, Oid *hashcollations);
+static Datum ExecRuntimeFilterScanQual(ExprState *state, ExprContext *econtext,
+									   bool *isnull);
+
+static runtimefilter_Xslice_reference *get_runtimefilter_reference(int filter_id);
+static void release_runtimefilter_reference(runtimefilter_Xslice_reference *ref,
+											bool detach);
+static void runtimefilter_release_callback(ResourceReleasePhase phase,
+										   bool isCommit,
+										   bool isTopLevel,
+										   void *arg);
 
 /* ----------------------------------------------------------------
  *		ExecRuntimeFilter
@@ -40,25 +168,48 @@ ExecRuntimeFilter(PlanState *pstate)
 {
 	RuntimeFilterState *node = castNode(RuntimeFilterState, pstate);
 	PlanState  *outerPlan;
+	HashJoinState *hjstate;
+	HashJoinTable hashtable;
 
 	outerPlan = outerPlanState(node);
+
+	/* A pushed down filter is used once the join has published it */
+	if (node->hashkeys != NIL)
+	{
+		if (node->bf == NULL && !RFReceive(node))
+			return ExecProcNode(outerPlan);
+
+		if (node->scan_filter && node->scan_filter->bloom_in_scan)
+			return ExecProcNode(outerPlan);
+
+		return RuntimeFilterTupleNext(node, node->ps.ps_ExprContext,
+									  node->hashkeys, node->hashfunctions,
+									  node->collations);
+	}
+
 	/* Check whether this filter is ready */
 	if (!node->build_finish || node->build_suspend)
 		return ExecProcNode(outerPlan);
 
-	return RuntimeFilterTupleNext(node);
+	/* The scan below may test the filter itself */
+	if (node->scan_filter && node->scan_filter->bloom_in_scan)
+		return ExecProcNode(outerPlan);
+
+	hjstate = node->hjstate;
+	hashtable = hjstate->hj_HashTable;
+
+	return RuntimeFilterTupleNext(node, hjstate->js.ps.ps_ExprContext,
+								  hjstate->hj_OuterHashKeys,
+								  hashtable->outer_hashfunctions,
+								  hashtable->collations);
 }
 
 static TupleTableSlot *
-RuntimeFilterTupleNext(RuntimeFilterState *node)
+RuntimeFilterTupleNext(RuntimeFilterState *node, ExprContext *econtext,
+					   List *hashkeys, FmgrInfo *hashfunctions,
+					   Oid *hashcollations)
 {
-	ExprContext *econtext;
-	HashJoinState *hjstate;
 	PlanState  *outerPlan;
-	HashJoinTable hashtable;
-	List *hashkeys;
-	FmgrInfo *hashfunctions;
-	Oid *hashcollations;
 	ListCell *hk;
 	MemoryContext oldContext;
 	TupleTableSlot *slot;
@@ -66,12 +217,6 @@ RuntimeFilterTupleNext(RuntimeFilterState *node)
 	CHECK_FOR_INTERRUPTS();
 
 	outerPlan = outerPlanState(node);
-	hjstate = node->hjstate;
-	econtext = hjstate->js.ps.ps_ExprContext;
-	hashkeys = hjstate->hj_OuterHashKeys;
-	hashtable = hjstate->hj_HashTable;
-	hashfunctions = hashtable->outer_hashfunctions;
-	hashcollations = hashtable->collations;
 
 	for (;;)
 	{
@@ -120,6 +265,8 @@ RuntimeFilterTupleNext(RuntimeFilterState *node)
 		if (!bloom_lacks_element(node->bf, (unsigned char *) node->value_buf,
 								hashkeys->length * sizeof(Datum)))
 			return slot;
+
+		node->rows_removed++;
 	}
 	pg_unreachable();
 }
@@ -153,6 +300,18 @@ ExecInitRuntimeFilter(RuntimeFilter *node, EState *estate, int eflags)
 	rfstate->raw_value = NULL;
 	rfstate->bf = NULL;
 
+	rfstate->xslice_ref = NULL;
+	rfstate->hashkeys = NIL;
+	rfstate->hashfunctions = NULL;
+	rfstate->collations = NULL;
+	rfstate->rows_removed = 0;
+
+	rfstate->range_typid = InvalidOid;
+	rfstate->has_range = false;
+	rfstate->range_min = 0;
+	rfstate->range_max = 0;
+	rfstate->scan_filter = NULL;
+
 	/* CDB: Offer extra info for EXPLAIN ANALYZE. */
 	if (estate->es_instrument && (estate->es_instrument & INSTRUMENT_CDB))
 	{
@@ -191,14 +350,72 @@ ExecInitRuntimeFilter(RuntimeFilter *node, EState *estate, int eflags)
 	 */
 	rfstate->ps.ps_ProjInfo = NULL;
 
+	if (node->hashkeys != NIL)
+		ExecInitPushedRuntimeFilter(rfstate, eflags);
+
 	return rfstate;
 }
 
+/*
+ * Set up a filter pushed down from a hash join in an upper slice.  It
+ * evaluates the join's outer hash keys itself, and encodes them the way
+ * ExecHashGetHashValue() does, so that they can be looked up in the join's
+ * bloom filter.
+ */
+static void
+ExecInitPushedRuntimeFilter(RuntimeFilterState *rfstate, int eflags)
+{
+	RuntimeFilter *node = (RuntimeFilter *) rfstate->ps.plan;
+	int			nkeys = list_length(node->hashkeys);
+	ListCell   *lc;
+	ListCell   *lc2;
+	int			i = 0;
+
+	rfstate->hashkeys = ExecInitExprList(node->hashkeys, (PlanState *) rfstate);
+	rfstate->hashfunctions = (FmgrInfo *) palloc(nkeys * sizeof(FmgrInfo));
+	rfstate->collations = (Oid *) palloc(nkeys * sizeof(Oid));
+	rfstate->value_buf = (Datum *) palloc(nkeys * sizeof(Datum));
+	rfstate->raw_value = (bool *) palloc(nkeys * sizeof(bool));
+
+	forboth(lc, node->hashoperators, lc2, node->hashcollations)
+	{
+		Oid			hashop = lfirst_oid(lc);
+		Oid			left_hashfn;
+		Oid			right_hashfn;
+		Oid			outer_typ;
+		Oid			inner_typ;
+
+		if (!get_op_hash_functions(hashop, &left_hashfn, &right_hashfn))
+			elog(ERROR, "could not find hash function for hash operator %u",
+				 hashop);
+		fmgr_info(left_hashfn, &rfstate->hashfunctions[i]);
+		rfstate->collations[i] = lfirst_oid(lc2);
+
+		op_input_types(hashop, &outer_typ, &inner_typ);
+		rfstate->raw_value[i] = IsRawInt8CmpType(outer_typ) &&
+			IsRawInt8CmpType(inner_typ);
+		i++;
+	}
+
+	if (!(eflags & EXEC_FLAG_EXPLAIN_ONLY))
+		rfstate->xslice_ref = get_runtimefilter_reference(node->filter_id);
+}
+
 static void
 ExecRuntimeFilterExplainEnd(PlanState *planstate, struct StringInfoData *buf)
 {
 	RuntimeFilterState *rfstate = (RuntimeFilterState *) planstate;
 
+	if (rfstate->hashkeys != NIL)
+	{
+		if (rfstate->bf == NULL)
+			appendStringInfoString(buf, "Not Received");
+		else
+			appendStringInfo(buf, "Rows Removed: " UINT64_FORMAT,
+							 rfstate->rows_removed);
+		return;
+	}
+
 	if (rfstate->build_suspend)
 	{
 		appendStringInfoString(buf, "Suspend");
@@ -244,13 +461,28 @@ ExecInitRuntimeFilterFinish(RuntimeFilterState *node, double inner_rows)
 		inner_raw = IsRawInt8CmpType(inner_typ);
 
 		/* can we directly compare the i-th value as int8? */
-		node->raw_value[i++] = outer_raw && inner_raw;
+		node->raw_value[i] = outer_raw && inner_raw;
+
+		/*
+		 * Keep the range of the first key for the zone maps, if they can
+		 * tell.  NULL keys never make it to the hash table then, and outer
+		 * rows with a NULL key can't match either.
+		 */
+		if (i == 0 && node->raw_value[0] && op_strict(lfirst_oid(lc)) &&
+			AOZoneMap_TypeIsSupported(inner_typ))
+			node->range_typid = getBaseType(inner_typ);
+		i++;
 	}
 }
 
 void
 ExecEndRuntimeFilter(RuntimeFilterState *node)
 {
+	if (node->xslice_ref != NULL)
+	{
+		release_runtimefilter_reference(node->xslice_ref, true);
+		node->xslice_ref = NULL;
+	}
 	if (node->bf != NULL)
 		bloom_free(node->bf);
 	if (node->value_buf != NULL)
@@ -278,7 +510,27 @@ RFBuildFinishCallback(RuntimeFilterState *rfstate, bool parallel)
 		return;
 
 	rfstate->build_suspend = rfstate->build_suspend || parallel;
-	rfstate->build_finish = true;	
+
+	/*
+	 * A filter pushed down to a lower slice or handed to the scan below is
+	 * only shared from the first build, and only if the inner side can't
+	 * change on a rescan.
+	 */
+	if (!rfstate->build_finish && !rfstate->build_suspend &&
+		bms_is_empty(innerPlan(rfstate->hjstate->js.ps.plan)->extParam))
+	{
+		HashJoinTable hashtable = rfstate->hjstate->hj_HashTable;
+
+		if (((RuntimeFilter *) rfstate->ps.plan)->filter_id != 0)
+			RFPublish(rfstate);
+
+		RFPushToScan(rfstate,
+					 ((HashJoin *) rfstate->hjstate->js.ps.plan)->hashkeys,
+					 hashtable->outer_hashfunctions,
+					 hashtable->collations);
+	}
+
+	rfstate->build_finish = true;
 }
 
 void
@@ -288,6 +540,21 @@ RFAddTupleValues(RuntimeFilterState *rfstate, List *values)
 		return;
 
 	RFFillTupleValues(rfstate, values);
+	if (OidIsValid(rfstate->range_typid))
+	{
+		int64		v = AOZoneMap_DatumToInt64(rfstate->range_typid,
+											   rfstate->value_buf[0]);
+
+		if (!rfstate->has_range)
+		{
+			rfstate->range_min = rfstate->range_max = v;
+			rfstate->has_range = true;
+		}
+		else if (v < rfstate->range_min)
+			rfstate->range_min = v;
+		else if (v > rfstate->range_max)
+			rfstate->range_max = v;
+	}
 	bloom_add_element(rfstate->bf, (unsigned char *) rfstate->value_buf,
 					  sizeof(Datum) * values->length);
 	list_free(values);
@@ -311,4 +578,409 @@ RFFillTupleValues(RuntimeFilterState *rfstate, List *values)
 		rfstate->value_buf[idx] = *dp;
 		idx++;
 	}
-}
\ No newline at end of file
+}
+
+/*
+ * Copy the bloom filter to a DSM segment, and advertise it to the pushed
+ * down filters of this segment.  The segment stays until the node is ended.
+ * If anything is short, the filter is just not published.
+ */
+static void
+RFPublish(RuntimeFilterState *rfstate)
+{
+	RuntimeFilter *node = (RuntimeFilter *) rfstate->ps.plan;
+	runtimefilter_Xslice_reference *ref;
+	RuntimeFilterShared *shared;
+	dsm_segment *seg;
+	Size		size = bloom_size(rfstate->bf);
+
+	seg = dsm_create(offsetof(RuntimeFilterShared, data) + size,
+					 DSM_CREATE_NULL_IF_MAXSEGMENTS);
+	if (seg == NULL)
+		return;
+
+	shared = (RuntimeFilterShared *) dsm_segment_address(seg);
+	shared->magic = RUNTIMEFILTER_MAGIC;
+	shared->tag.session_id = gp_session_id;
+	shared->tag.command_count = gp_command_count;
+	shared->tag.filter_id = node->filter_id;
+	shared->has_range = rfstate->has_range;
+	shared->range_typid = rfstate->range_typid;
+	shared->range_min = rfstate->range_min;
+	shared->range_max = rfstate->range_max;
+	shared->size = size;
+	memcpy(shared->data, rfstate->bf, size);
+
+	ref = get_runtimefilter_reference(node->filter_id);
+	if (ref == NULL)
+	{
+		dsm_detach(seg);
+		return;
+	}
+
+	LWLockAcquire(RuntimeFilterLock, LW_EXCLUSIVE);
+	if (pg_atomic_read_u32(&ref->xslice_state->ready) == 0)
+	{
+		ref->xslice_state->handle = dsm_segment_handle(seg);
+		pg_atomic_write_u32(&ref->xslice_state->ready, 1);
+		ref->seg = seg;
+	}
+	LWLockRelease(RuntimeFilterLock);
+
+	if (ref->seg == NULL)
+	{
+		/* someone else got here first */
+		dsm_detach(seg);
+		release_runtimefilter_reference(ref, true);
+		return;
+	}
+
+	rfstate->xslice_ref = ref;
+}
+
+/*
+ * Look for the bloom filter a pushed down filter stands in for, and copy it
+ * to local memory.  Returns true if the filter is now usable.  Once the
+ * filter has been seen, whether it could be copied or not, the reference is
+ * released and the node stops looking.
+ */
+static bool
+RFReceive(RuntimeFilterState *rfstate)
+{
+	RuntimeFilter *node = (RuntimeFilter *) rfstate->ps.plan;
+	runtimefilter_Xslice_reference *ref = rfstate->xslice_ref;
+	runtimefilter_Xslice_state *state;
+	RuntimeFilterShared *shared;
+	dsm_segment *seg = NULL;
+
+	if (ref == NULL)
+		return false;
+
+	state = ref->xslice_state;
+	if (pg_atomic_read_u32(&state->ready) == 0)
+		return false;
+
+	/* the publisher clears the handle under the lock before it detaches */
+	LWLockAcquire(RuntimeFilterLock, LW_SHARED);
+	if (state->handle != DSM_HANDLE_INVALID)
+		seg = dsm_attach(state->handle);
+	LWLockRelease(RuntimeFilterLock);
+
+	if (seg != NULL)
+	{
+		shared = (RuntimeFilterShared *) dsm_segment_address(seg);
+		if (shared->magic == RUNTIMEFILTER_MAGIC &&
+			shared->tag.session_id == gp_session_id &&
+			shared->tag.command_count == gp_command_count &&
+			shared->tag.filter_id == node->filter_id)
+		{
+			rfstate->bf = (bloom_filter *)
+				MemoryContextAlloc(rfstate->ps.state->es_query_cxt,
+								   shared->size);
+			memcpy(rfstate->bf, shared->data, shared->size);
+			rfstate->has_range = shared->has_range;
+			rfstate->range_typid = shared->range_typid;
+			rfstate->range_min = shared->range_min;
+			rfstate->range_max = shared->range_max;
+		}
+		dsm_detach(seg);
+	}
+
+	release_runtimefilter_reference(ref, true);
+	rfstate->xslice_ref = NULL;
+
+	if (rfstate->bf == NULL)
+		return false;
+
+	RFPushToScan(rfstate, node->hashkeys, rfstate->hashfunctions,
+				 rfstate->collations);
+	return true;
+}
+
+/*
+ * Hand the filter to the scan below, if it scans an append-optimized table
+ * and returns the first join key as a column of it.  hashkeys are the plan
+ * expressions of the outer keys, which refer to the scan's target list.
+ */
+static void
+RFPushToScan(RuntimeFilterState *rfstate, List *hashkeys,
+			 FmgrInfo *hashfunctions, Oid *hashcollations)
+{
+	PlanState  *outerState = outerPlanState(rfstate);
+	Relation	rel;
+	Node	   *key;
+	TargetEntry *tle;
+	ScanRuntimeFilter *filter;
+	MemoryContext oldcxt;
+
+	if (!IsA(outerState, SeqScanState) || hashkeys == NIL)
+		return;
+
+	rel = ((SeqScanState *) outerState)->ss.ss_currentRelation;
+	if (!RelationIsAoRows(rel) && !RelationIsAoCols(rel))
+		return;
+
+	key = (Node *) linitial(hashkeys);
+	while (IsA(key, RelabelType))
+		key = (Node *) ((RelabelType *) key)->arg;
+	if (!IsA(key, Var) || ((Var *) key)->varno != OUTER_VAR)
+		return;
+
+	tle = get_tle_by_resno(outerState->plan->targetlist,
+						   ((Var *) key)->varattno);
+	if (tle == NULL)
+		return;
+	key = (Node *) tle->expr;
+	while (IsA(key, RelabelType))
+		key = (Node *) ((RelabelType *) key)->arg;
+	if (!IsA(key, Var) || ((Var *) key)->varattno <= 0)
+		return;
+
+	/* the filter, and what the scan builds for it, last as long as the query */
+	oldcxt = MemoryContextSwitchTo(rfstate->ps.state->es_query_cxt);
+
+	filter = palloc0(sizeof(ScanRuntimeFilter));
+	filter->attno = ((Var *) key)->varattno - 1;
+
+	if (list_length(hashkeys) == 1)
+	{
+		filter->bf = rfstate->bf;
+		filter->raw_value = rfstate->raw_value[0];
+		fmgr_info_copy(&filter->hashfunction, &hashfunctions[0],
+					   CurrentMemoryContext);
+		filter->collation = hashcollations[0];
+		filter->rows_removed = &rfstate->rows_removed;
+	}
+
+	if (rfstate->has_range)
+	{
+		filter->has_range = true;
+		filter->range_typid = rfstate->range_typid;
+		filter->range_min = rfstate->range_min;
+		filter->range_max = rfstate->range_max;
+	}
+
+	if (filter->bf == NULL && !filter->has_range)
+		pfree(filter);
+	else
+	{
+		rfstate->scan_filter = filter;
+		ExecSeqScanSetRuntimeFilter((SeqScanState *) outerState, filter);
+	}
+
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/* private state of a qual built by ExecInitRuntimeFilterScanQual() */
+typedef struct RFScanQual
+{
+	ScanRuntimeFilter *filter;
+	ExprState  *qual;
+} RFScanQual;
+
+/*
+ * Build the pushed down qual of a scan that tests a value of the join key
+ * column against the bloom filter, and then evaluates qual, the other quals
+ * of the column, if any.  Rows with a NULL key pass, as they do in
+ * RuntimeFilterTupleNext().
+ */
+ExprState *
+ExecInitRuntimeFilterScanQual(ScanRuntimeFilter *filter, ExprState *qual)
+{
+	ExprState  *state = makeNode(ExprState);
+	RFScanQual *scanqual = palloc(sizeof(RFScanQual));
+
+	scanqual->filter = filter;
+	scanqual->qual = qual;
+
+	state->flags = EEO_FLAG_IS_QUAL;
+	state->evalfunc = ExecRuntimeFilterScanQual;
+	state->evalfunc_private = scanqual;
+
+	return state;
+}
+
+static Datum
+ExecRuntimeFilterScanQual(ExprState *state, ExprContext *econtext, bool *isnull)
+{
+	RFScanQual *scanqual = (RFScanQual *) state->evalfunc_private;
+	ScanRuntimeFilter *filter = scanqual->filter;
+	Datum		value;
+	bool		valisnull;
+
+	*isnull = false;
+
+	value = slot_getattr(econtext->ecxt_scantuple, filter->attno + 1,
+						 &valisnull);
+	if (!valisnull)
+	{
+		if (!filter->raw_value)
+			value = DatumGetUInt32(FunctionCall1Coll(&filter->hashfunction,
+													 filter->collation,
+													 value));
+		if (bloom_lacks_element(filter->bf, (unsigned char *) &value,
+								sizeof(Datum)))
+		{
+			(*filter->rows_removed)++;
+			return BoolGetDatum(false);
+		}
+	}
+
+	return BoolGetDatum(ExecQual(scanqual->qual, econtext));
+}
+
+/*
+ * Initialization of the shared hash table of cross-slice filters.  It is
+ * sized like the one of cross-slice ShareInputScans.
+ */
+#define N_RUNTIMEFILTER_SLOTS() (MaxBackends * 5)
+
+Size
+RuntimeFilterShmemSize(void)
+{
+	return hash_estimate_size(N_RUNTIMEFILTER_SLOTS(),
+							  sizeof(runtimefilter_Xslice_state));
+}
+
+void
+RuntimeFilterShmemInit(void)
+{
+	HASHCTL		info;
+
+	info.keysize = sizeof(runtimefilter_tag);
+	info.entrysize = sizeof(runtimefilter_Xslice_state);
+
+	runtimefilter_Xslice_hash = ShmemInitHash("RuntimeFilter notifications",
+											  N_RUNTIMEFILTER_SLOTS(),
+											  N_RUNTIMEFILTER_SLOTS(),
+											  &info,
+											  HASH_ELEM | HASH_BLOBS);
+}
+
+/*
+ * Get a reference to the shared hash table entry of a filter, creating it
+ * in "not ready" state if it doesn't exist yet.  Returns NULL if the hash
+ * table is full; the filter is then just not shared.
+ */
+static runtimefilter_Xslice_reference *
+get_runtimefilter_reference(int filter_id)
+{
+	runtimefilter_tag tag;
+	runtimefilter_Xslice_state *xslice_state;
+	runtimefilter_Xslice_reference *ref;
+	bool		found;
+
+	/* Register our resource owner callback to clean up on first call. */
+	if (!runtimefilter_resowner_callback_registered)
+	{
+		RegisterResourceReleaseCallback(runtimefilter_release_callback, NULL);
+		runtimefilter_resowner_callback_registered = true;
+	}
+
+	ref = MemoryContextAllocZero(TopMemoryContext,
+								 sizeof(runtimefilter_Xslice_reference));
+
+	LWLockAcquire(RuntimeFilterLock, LW_EXCLUSIVE);
+
+	tag.session_id = gp_session_id;
+	tag.command_count = gp_command_count;
+	tag.filter_id = filter_id;
+	xslice_state = hash_search(runtimefilter_Xslice_hash,
+							   &tag,
+							   HASH_ENTER_NULL,
+							   &found);
+	if (xslice_state == NULL)
+	{
+		LWLockRelease(RuntimeFilterLock);
+		pfree(ref);
+		return NULL;
+	}
+	if (!found)
+	{
+		xslice_state->refcount = 0;
+		pg_atomic_init_u32(&xslice_state->ready, 0);
+		xslice_state->handle = DSM_HANDLE_INVALID;
+	}
+
+	xslice_state->refcount++;
+
+	ref->xslice_state = xslice_state;
+	ref->owner = CurrentResourceOwner;
+	dlist_push_head(&runtimefilter_Xslice_refs, &ref->node);
+
+	LWLockRelease(RuntimeFilterLock);
+
+	return ref;
+}
+
+/*
+ * Release a reference.  The publisher withdraws its filter first.  On abort
+ * the publisher's DSM segment has already been detached by its resource
+ * owner, so 'detach' is false then.
+ */
+static void
+release_runtimefilter_reference(runtimefilter_Xslice_reference *ref,
+								bool detach)
+{
+	runtimefilter_Xslice_state *state = ref->xslice_state;
+
+	LWLockAcquire(RuntimeFilterLock, LW_EXCLUSIVE);
+
+	if (ref->seg != NULL)
+	{
+		state->handle = DSM_HANDLE_INVALID;
+		pg_atomic_write_u32(&state->ready, 0);
+	}
+
+	if (state->refcount == 1)
+	{
+		bool		found;
+
+		(void) hash_search(runtimefilter_Xslice_hash,
+						   &state->tag,
+						   HASH_REMOVE,
+						   &found);
+		Assert(found);
+	}
+	else
+		state->refcount--;
+
+	dlist_delete(&ref->node);
+
+	LWLockRelease(RuntimeFilterLock);
+
+	if (ref->seg != NULL && detach)
+		dsm_detach(ref->seg);
+
+	pfree(ref);
+}
+
+/*
+ * Callback to release references on transaction abort.
+ */
+static void
+runtimefilter_release_callback(ResourceReleasePhase phase,
+							   bool isCommit,
+							   bool isTopLevel,
+							   void *arg)
+{
+	dlist_mutable_iter miter;
+
+	if (phase != RESOURCE_RELEASE_BEFORE_LOCKS)
+		return;
+
+	dlist_foreach_modify(miter, &runtimefilter_Xslice_refs)
+	{
+		runtimefilter_Xslice_reference *ref =
+			dlist_container(runtimefilter_Xslice_reference,
+							node,
+							miter.cur);
+
+		if (ref->owner == CurrentResourceOwner)
+		{
+			if (isCommit)
+				elog(WARNING, "runtime filter reference leak: reference %p still referenced", ref);
+			release_runtimefilter_reference(ref, false);
+		}
+	}
+}
@@ -20,6 +20,8 @@
  *		ExecEndSeqScan			releases any storage allocated.
  *		ExecReScanSeqScan		rescans the relation
  *
+ *		ExecSeqScanSetRuntimeFilter	applies a hash join's filter to an AO scan
+ *
  *		ExecSeqScanEstimate		estimates DSM space needed for parallel scan
  *		ExecSeqScanInitializeDSM initialize DSM for parallel scan
  *		ExecSeqScanReInitializeDSM reinitialize DSM for fresh parallel scan
@@ -42,6 +44,7 @@
 #include "cdb/cdbvars.h"
 
 static TupleTableSlot *SeqNext(SeqScanState *node);
+static void SeqPushRuntimeFilter(SeqScanState *node, bool started);
 
 /* ----------------------------------------------------------------
  *						Scan Support
@@ -144,6 +147,10 @@ SeqNext(SeqScanState *node)
 													&node->ss.ps);
 			}
 		}
+
+		/* A runtime filter may have come before the scan began */
+		if (node->runtime_filter)
+			SeqPushRuntimeFilter(node, false);
 	}
 
 	/*
@@ -317,6 +324,36 @@ ExecReScanSeqScan(SeqScanState *node)
 	ExecScanReScan((ScanState *) node);
 }
 
+/* ----------------------------------------------------------------
+ *		ExecSeqScanSetRuntimeFilter
+ *
+ *		Hands the runtime filter of the hash join above to the scan of an
+ *		append-optimized table, see ScanRuntimeFilter.  The filter is
+ *		applied when the scan begins, or right away if it is under way.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSeqScanSetRuntimeFilter(SeqScanState *node, ScanRuntimeFilter *filter)
+{
+	Assert(RelationIsAoRows(node->ss.ss_currentRelation) ||
+		   RelationIsAoCols(node->ss.ss_currentRelation));
+
+	node->runtime_filter = filter;
+	if (node->ss.ss_currentScanDesc != NULL)
+		SeqPushRuntimeFilter(node, true);
+}
+
+static void
+SeqPushRuntimeFilter(SeqScanState *node, bool started)
+{
+	if (RelationIsAoRows(node->ss.ss_currentRelation))
+		appendonly_runtime_filter_pushdown((AppendOnlyScanDesc) node->ss.ss_currentScanDesc,
+										   node->runtime_filter);
+	else if (RelationIsAoCols(node->ss.ss_currentRelation))
+		aocs_runtime_filter_pushdown((AOCSScanDesc) node->ss.ss_currentScanDesc,
+									 node->runtime_filter, started);
+}
+
 /* ----------------------------------------------------------------
  *						Parallel Scan Support
  * ----------------------------------------------------------------
@@ -16,6 +16,7 @@
 extern "C" {
 #include "postgres.h"
 
+#include "cdb/cdbvars.h"
 #include "utils/guc.h"
 }
 
@@ -290,6 +291,10 @@ CConfigParamMapping::SConfigMappingElem CConfigParamMapping::m_elements[] = {
 	 false,	 // m_negate_param
 	 GPOS_WSZ_LIT(
 		 "Explore a nested loop join even if a hash join is possible")},
+	{EopttraceEnableRuntimeFilter, &gp_enable_runtime_filter,
+	 false,	 // m_negate_param
+	 GPOS_WSZ_LIT(
+		 "Place runtime filters on the outer side of selective hash joins")},
 
 };
 
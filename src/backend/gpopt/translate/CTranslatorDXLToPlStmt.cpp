@@ -74,6 +74,7 @@ extern "C" {
 #include "naucrates/dxl/operators/CDXLPhysicalRedistributeMotion.h"
 #include "naucrates/dxl/operators/CDXLPhysicalResult.h"
 #include "naucrates/dxl/operators/CDXLPhysicalRoutedDistributeMotion.h"
+#include "naucrates/dxl/operators/CDXLPhysicalRuntimeFilter.h"
 #include "naucrates/dxl/operators/CDXLPhysicalSort.h"
 #include "naucrates/dxl/operators/CDXLPhysicalSplit.h"
 #include "naucrates/dxl/operators/CDXLPhysicalSubqueryScan.h"
@@ -414,6 +415,12 @@ CTranslatorDXLToPlStmt::TranslateDXLOperatorToPlan(
 										   ctxt_translation_prev_siblings);
 			break;
 		}
+		case EdxlopPhysicalRuntimeFilter:
+		{
+			plan = TranslateDXLRuntimeFilter(dxlnode, output_context,
+											 ctxt_translation_prev_siblings);
+			break;
+		}
 		case EdxlopPhysicalSequence:
 		{
 			plan = TranslateDXLSequence(dxlnode, output_context,
@@ -3718,6 +3725,65 @@ CTranslatorDXLToPlStmt::TranslateDXLMaterialize(
 	return (Plan *) materialize;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CTranslatorDXLToPlStmt::TranslateDXLRuntimeFilter
+//
+//	@doc:
+//		Translate DXL runtime filter node into GPDB RuntimeFilter plan node.
+//		The filter has no keys of its own: the executor links it to the
+//		hash join above, and builds it from the join's hash table.
+//
+//---------------------------------------------------------------------------
+Plan *
+CTranslatorDXLToPlStmt::TranslateDXLRuntimeFilter(
+	const CDXLNode *runtime_filter_dxlnode,
+	CDXLTranslateContext *output_context,
+	CDXLTranslationContextArray *ctxt_translation_prev_siblings)
+{
+	// create runtime filter plan node
+	RuntimeFilter *runtime_filter = MakeNode(RuntimeFilter);
+
+	Plan *plan = &(runtime_filter->plan);
+	plan->plan_node_id = m_dxl_to_plstmt_context->GetNextPlanId();
+
+	// translate operator costs
+	TranslatePlanCosts(runtime_filter_dxlnode, plan);
+
+	// translate runtime filter child
+	CDXLNode *child_dxlnode = (*runtime_filter_dxlnode)[EdxlrfIndexChild];
+
+	CDXLNode *project_list_dxlnode =
+		(*runtime_filter_dxlnode)[EdxlrfIndexProjList];
+	CDXLNode *filter_dxlnode = (*runtime_filter_dxlnode)[EdxlrfIndexFilter];
+
+	CDXLTranslateContext child_context(m_mp, false,
+									   output_context->GetColIdToParamIdMap());
+
+	Plan *child_plan = TranslateDXLOperatorToPlan(
+		child_dxlnode, &child_context, ctxt_translation_prev_siblings);
+
+	CDXLTranslationContextArray *child_contexts =
+		GPOS_NEW(m_mp) CDXLTranslationContextArray(m_mp);
+	child_contexts->Append(&child_context);
+
+	// translate proj list and filter
+	TranslateProjListAndFilter(project_list_dxlnode, filter_dxlnode,
+							   nullptr,	 // translate context for the base table
+							   child_contexts, &plan->targetlist, &plan->qual,
+							   output_context);
+	GPOS_ASSERT(NIL == plan->qual);
+
+	plan->lefttree = child_plan;
+
+	SetParamIds(plan);
+
+	// cleanup
+	child_contexts->Release();
+
+	return (Plan *) runtime_filter;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CTranslatorDXLToPlStmt::TranslateDXLCTEProducerToSharedScan
@@ -232,6 +232,10 @@ public:
 		return ICostModel::EcmtGPDBCalibrated;
 	}
 
+	// is a runtime filter on the outer side of a hash join worth its cost
+	BOOL FUseRuntimeFilter(CDouble dRowsOuter, CDouble dRowsInner,
+						   CDouble dRowsJoin) const override;
+
 };	// class CCostModelGPDB
 
 }  // namespace gpdbcost
@@ -82,6 +82,63 @@ CCostModelGPDB::DRowsPerHost(CDouble dRowsTotal) const
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CCostModelGPDB::FUseRuntimeFilter
+//
+//	@doc:
+//		Decide whether a runtime filter should be placed on the outer side
+//		of a hash join, given the estimated rows of the outer child, the
+//		inner child and the join. This follows the planner's rule: the
+//		bloom filter built from the inner rows must have a low enough false
+//		positive rate, and the filter must remove at least 40% of the outer
+//		rows, and no fewer than 10000 of them on a segment.
+//
+//		The outer and join rows are spread over the segments, while the
+//		inner rows are all counted, since the hash table of a segment may
+//		hold every inner row when the inner side is broadcast.
+//
+//---------------------------------------------------------------------------
+BOOL
+CCostModelGPDB::FUseRuntimeFilter(CDouble dRowsOuter, CDouble dRowsInner,
+								  CDouble dRowsJoin) const
+{
+	// largest bloom filter built by the executor, in bits
+	const DOUBLE dMaxFilterSize = 16 * 1024 * 1024;
+	const DOUBLE dRowsOuterPerHost = DRowsPerHost(dRowsOuter).Get();
+	const DOUBLE dRowsJoinPerHost =
+		std::min(DRowsPerHost(dRowsJoin).Get(), dRowsOuterPerHost);
+
+	// estimated false positive rate of the filter
+	DOUBLE dFalsePositiveRate = 0.1;
+	if (dRowsInner > dMaxFilterSize / 1.6)
+	{
+		dFalsePositiveRate = 1.0;
+	}
+	else if (dRowsInner > dMaxFilterSize / 2)
+	{
+		dFalsePositiveRate = 0.4;
+	}
+	else if (dRowsInner > dMaxFilterSize / 2.5)
+	{
+		dFalsePositiveRate = 0.3;
+	}
+
+	if (dFalsePositiveRate > 0.5 ||
+		dRowsOuterPerHost - dRowsJoinPerHost < 10000)
+	{
+		return false;
+	}
+
+	// outer rows passing the filter: the matching ones and the false positives
+	DOUBLE dRowsPassing =
+		dRowsJoinPerHost +
+		(dRowsOuterPerHost - dRowsJoinPerHost) * dFalsePositiveRate;
+
+	return dRowsPassing < dRowsOuterPerHost * 0.6;
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CCostModelGPDB::~CCostModelGPDB
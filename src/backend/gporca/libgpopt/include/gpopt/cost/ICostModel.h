@@ -351,6 +351,10 @@ public:
 	// cost model type
 	virtual ECostModelType Ecmt() const = 0;
 
+	// is a runtime filter on the outer side of a hash join worth its cost
+	virtual BOOL FUseRuntimeFilter(CDouble dRowsOuter, CDouble dRowsInner,
+								   CDouble dRowsJoin) const = 0;
+
 	// set cost model params
 	void SetParams(ICostModelParamsArray *pdrgpcp) const;
 
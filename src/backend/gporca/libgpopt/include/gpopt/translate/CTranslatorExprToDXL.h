@@ -611,6 +611,12 @@ private:
 	// add a materialize node
 	CDXLNode *PdxlnMaterialize(CDXLNode *dxlnode);
 
+	// add a runtime filter node on the outer side of a hash join
+	CDXLNode *PdxlnRuntimeFilter(CDXLNode *dxlnode);
+
+	// can a runtime filter check the hash join key compared by the operator
+	BOOL FRuntimeFilterKey(IMDId *mdid_scop);
+
 	// add result node if necessary
 	CDXLNode *PdxlnRemapOutputColumns(CExpression *pexpr, CDXLNode *dxlnode,
 									  CColRefArray *pdrgpcrRequired,
@@ -116,6 +116,7 @@
 #include "naucrates/dxl/operators/CDXLPhysicalResult.h"
 #include "naucrates/dxl/operators/CDXLPhysicalRoutedDistributeMotion.h"
 #include "naucrates/dxl/operators/CDXLPhysicalRowTrigger.h"
+#include "naucrates/dxl/operators/CDXLPhysicalRuntimeFilter.h"
 #include "naucrates/dxl/operators/CDXLPhysicalSequence.h"
 #include "naucrates/dxl/operators/CDXLPhysicalSort.h"
 #include "naucrates/dxl/operators/CDXLPhysicalSplit.h"
@@ -4502,6 +4503,12 @@ CTranslatorExprToDXL::PdxlnHashJoin(CExpression *pexprHJ,
 	CDXLNode *pdxlnHashCondList = GPOS_NEW(m_mp)
 		CDXLNode(m_mp, GPOS_NEW(m_mp) CDXLScalarHashCondList(m_mp));
 
+	// a runtime filter drops the outer tuples that can not find a match in
+	// the hash table, so it only fits the joins that drop them too
+	BOOL fRuntimeFilter = GPOS_FTRACE(EopttraceEnableRuntimeFilter) &&
+						  (EdxljtInner == join_type ||
+						   EdxljtRight == join_type || EdxljtIn == join_type);
+
 #ifdef GPOS_DEBUG
 	ULONG ulHashJoinPreds = 0;
 #endif
@@ -4529,12 +4536,15 @@ CTranslatorExprToDXL::PdxlnHashJoin(CExpression *pexprHJ,
 			// create hash join predicate based on conjunct type
 			if (CPredicateUtils::IsEqualityOp(pexprPred))
 			{
+				fRuntimeFilter = fRuntimeFilter && FRuntimeFilterKey(mdid_scop);
 				pexprPred = CUtils::PexprScalarCmp(m_mp, pexprPredOuter,
 												   pexprPredInner, mdid_scop);
 			}
 			else
 			{
+				// NULL keys match each other, which the filter can not tell
 				GPOS_ASSERT(CPredicateUtils::FINDF(pexprPred));
+				fRuntimeFilter = false;
 				pexprPred = CUtils::PexprINDF(m_mp, pexprPredOuter,
 											  pexprPredInner, mdid_scop);
 			}
@@ -4554,6 +4564,14 @@ CTranslatorExprToDXL::PdxlnHashJoin(CExpression *pexprHJ,
 	}
 	GPOS_ASSERT(popHJ->PdrgpexprOuterKeys()->Size() == ulHashJoinPreds);
 
+	if (fRuntimeFilter && 0 < pdxlnHashCondList->Arity() &&
+		COptCtxt::PoctxtFromTLS()->GetCostModel()->FUseRuntimeFilter(
+			pexprOuterChild->Pstats()->Rows(),
+			pexprInnerChild->Pstats()->Rows(), pexprHJ->Pstats()->Rows()))
+	{
+		pdxlnOuterChild = PdxlnRuntimeFilter(pdxlnOuterChild);
+	}
+
 	CDXLNode *dxlnode_join_filter = GPOS_NEW(m_mp)
 		CDXLNode(m_mp, GPOS_NEW(m_mp) CDXLScalarJoinFilter(m_mp));
 	if (0 < pdrgpexprRemainingPredicates->Size())
@@ -7759,6 +7777,73 @@ CTranslatorExprToDXL::PdxlnMaterialize(
 	return pdxlnMaterialize;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CTranslatorExprToDXL::PdxlnRuntimeFilter
+//
+//	@doc:
+//		Add a runtime filter node on top of the outer child of a hash join.
+//		The filter takes its keys from the hash join when the plan is
+//		executed, so it only passes the child's columns through.
+//
+//---------------------------------------------------------------------------
+CDXLNode *
+CTranslatorExprToDXL::PdxlnRuntimeFilter(
+	CDXLNode *dxlnode  // outer child of the hash join
+)
+{
+	GPOS_ASSERT(nullptr != dxlnode);
+	GPOS_ASSERT(nullptr != dxlnode->GetProperties());
+
+	CDXLNode *pdxlnRuntimeFilter = GPOS_NEW(m_mp)
+		CDXLNode(m_mp, GPOS_NEW(m_mp) CDXLPhysicalRuntimeFilter(m_mp));
+	CDXLPhysicalProperties *pdxlpropChild =
+		CDXLPhysicalProperties::PdxlpropConvert(dxlnode->GetProperties());
+	pdxlpropChild->AddRef();
+	pdxlnRuntimeFilter->SetProperties(pdxlpropChild);
+
+	// construct an empty filter node
+	CDXLNode *filter_dxlnode = PdxlnFilter(nullptr /* pdxlnCond */);
+
+	CDXLNode *pdxlnProjListChild = (*dxlnode)[0];
+	CDXLNode *proj_list_dxlnode =
+		CTranslatorExprToDXLUtils::PdxlnProjListFromChildProjList(
+			m_mp, m_pcf, m_phmcrdxln, pdxlnProjListChild);
+
+	// add children
+	pdxlnRuntimeFilter->AddChild(proj_list_dxlnode);
+	pdxlnRuntimeFilter->AddChild(filter_dxlnode);
+	pdxlnRuntimeFilter->AddChild(dxlnode);
+
+#ifdef GPOS_DEBUG
+	pdxlnRuntimeFilter->GetOperator()->AssertValid(
+		pdxlnRuntimeFilter, false /* validate_children */);
+#endif
+
+	return pdxlnRuntimeFilter;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CTranslatorExprToDXL::FRuntimeFilterKey
+//
+//	@doc:
+//		Can the hash join key compared by the given operator be checked by
+//		a runtime filter. Like the planner, only pass-by-value input types
+//		are supported.
+//
+//---------------------------------------------------------------------------
+BOOL
+CTranslatorExprToDXL::FRuntimeFilterKey(IMDId *mdid_scop)
+{
+	const IMDScalarOp *md_scalar_op = m_pmda->RetrieveScOp(mdid_scop);
+
+	return m_pmda->RetrieveType(md_scalar_op->GetLeftMdid())
+			   ->IsPassedByValue() &&
+		   m_pmda->RetrieveType(md_scalar_op->GetRightMdid())
+			   ->IsPassedByValue();
+}
+
 BOOL
 CTranslatorExprToDXL::FNeedsMaterializeUnderResult(CDXLNode *proj_list_dxlnode,
 												   CDXLNode *child_dxlnode)
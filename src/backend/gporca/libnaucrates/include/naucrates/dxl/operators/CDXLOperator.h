@@ -150,6 +150,7 @@ enum Edxlopid
 	EdxlopPhysicalSort,
 	EdxlopPhysicalAppend,
 	EdxlopPhysicalMaterialize,
+	EdxlopPhysicalRuntimeFilter,
 	EdxlopPhysicalSequence,
 	EdxlopPhysicalPartitionSelector,
 	EdxlopPhysicalTVF,
@@ -0,0 +1,78 @@
+//---------------------------------------------------------------------------
+//	Cloudberry Database
+//	Copyright (C) 2023 Cloudberry, Inc.
+//
+//	@filename:
+//		CDXLPhysicalRuntimeFilter.h
+//
+//	@doc:
+//		Class for representing DXL physical runtime filter operators.
+//---------------------------------------------------------------------------
+
+#ifndef GPDXL_CDXLPhysicalRuntimeFilter_H
+#define GPDXL_CDXLPhysicalRuntimeFilter_H
+
+#include "gpos/base.h"
+
+#include "naucrates/dxl/operators/CDXLPhysical.h"
+
+
+namespace gpdxl
+{
+// indices of runtime filter elements in the children array
+enum EdxlRuntimeFilter
+{
+	EdxlrfIndexProjList = 0,
+	EdxlrfIndexFilter,
+	EdxlrfIndexChild,
+	EdxlrfIndexSentinel
+};
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CDXLPhysicalRuntimeFilter
+//
+//	@doc:
+//		Class for representing DXL runtime filter operators. A runtime
+//		filter sits on the outer side of a hash join and drops the outer
+//		tuples whose join keys can not be found in the join's hash table.
+//		The keys are taken from the parent hash join when the plan is
+//		executed, so the operator has no attributes of its own.
+//
+//---------------------------------------------------------------------------
+class CDXLPhysicalRuntimeFilter : public CDXLPhysical
+{
+public:
+	CDXLPhysicalRuntimeFilter(CDXLPhysicalRuntimeFilter &) = delete;
+
+	// ctor
+	explicit CDXLPhysicalRuntimeFilter(CMemoryPool *mp);
+
+	// accessors
+	Edxlopid GetDXLOperator() const override;
+	const CWStringConst *GetOpNameStr() const override;
+
+	// serialize operator in DXL format
+	void SerializeToDXL(CXMLSerializer *xml_serializer,
+						const CDXLNode *node) const override;
+
+	// conversion function
+	static CDXLPhysicalRuntimeFilter *
+	Cast(CDXLOperator *dxl_op)
+	{
+		GPOS_ASSERT(nullptr != dxl_op);
+		GPOS_ASSERT(EdxlopPhysicalRuntimeFilter == dxl_op->GetDXLOperator());
+
+		return dynamic_cast<CDXLPhysicalRuntimeFilter *>(dxl_op);
+	}
+
+#ifdef GPOS_DEBUG
+	// checks whether the operator has valid structure, i.e. number and
+	// types of child nodes
+	void AssertValid(const CDXLNode *, BOOL validate_children) const override;
+#endif	// GPOS_DEBUG
+};
+}  // namespace gpdxl
+#endif	// !GPDXL_CDXLPhysicalRuntimeFilter_H
+
+// EOF
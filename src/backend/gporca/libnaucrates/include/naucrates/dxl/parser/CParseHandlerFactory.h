@@ -311,6 +311,11 @@ private:
 		CMemoryPool *mp, CParseHandlerManager *parse_handler_mgr,
 		CParseHandlerBase *parse_handler_root);
 
+	// construct a runtime filter parse handler
+	static CParseHandlerBase *CreateRuntimeFilterParseHandler(
+		CMemoryPool *mp, CParseHandlerManager *parse_handler_mgr,
+		CParseHandlerBase *parse_handler_root);
+
 	// construct a partition selector parse handler
 	static CParseHandlerBase *CreatePartitionSelectorParseHandler(
 		CMemoryPool *mp, CParseHandlerManager *parse_handler_mgr,
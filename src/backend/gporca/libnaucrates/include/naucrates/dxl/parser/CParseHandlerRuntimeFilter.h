@@ -0,0 +1,69 @@
+//---------------------------------------------------------------------------
+//	Cloudberry Database
+//	Copyright (C) 2023 Cloudberry, Inc.
+//
+//	@filename:
+//		CParseHandlerRuntimeFilter.h
+//
+//	@doc:
+//		SAX parse handler class for parsing runtime filter operator nodes.
+//---------------------------------------------------------------------------
+
+#ifndef GPDXL_CParseHandlerRuntimeFilter_H
+#define GPDXL_CParseHandlerRuntimeFilter_H
+
+#include "gpos/base.h"
+
+#include "naucrates/dxl/operators/CDXLPhysicalRuntimeFilter.h"
+#include "naucrates/dxl/parser/CParseHandlerPhysicalOp.h"
+
+
+namespace gpdxl
+{
+using namespace gpos;
+
+
+XERCES_CPP_NAMESPACE_USE
+
+//---------------------------------------------------------------------------
+//	@class:
+//		CParseHandlerRuntimeFilter
+//
+//	@doc:
+//		Parse handler for parsing a runtime filter operator
+//
+//---------------------------------------------------------------------------
+class CParseHandlerRuntimeFilter : public CParseHandlerPhysicalOp
+{
+private:
+	// the runtime filter operator
+	CDXLPhysicalRuntimeFilter *m_dxl_op;
+
+	// process the start of an element
+	void StartElement(
+		const XMLCh *const element_uri,			// URI of element's namespace
+		const XMLCh *const element_local_name,	// local part of element's name
+		const XMLCh *const element_qname,		// element's qname
+		const Attributes &attr					// element's attributes
+		) override;
+
+	// process the end of an element
+	void EndElement(
+		const XMLCh *const element_uri,			// URI of element's namespace
+		const XMLCh *const element_local_name,	// local part of element's name
+		const XMLCh *const element_qname		// element's qname
+		) override;
+
+public:
+	CParseHandlerRuntimeFilter(const CParseHandlerRuntimeFilter &) = delete;
+
+	// ctor/dtor
+	CParseHandlerRuntimeFilter(CMemoryPool *mp,
+							   CParseHandlerManager *parse_handler_mgr,
+							   CParseHandlerBase *parse_handler_root);
+};
+}  // namespace gpdxl
+
+#endif	// !GPDXL_CParseHandlerRuntimeFilter_H
+
+// EOF
@@ -113,6 +113,7 @@
 #include "naucrates/dxl/parser/CParseHandlerRelStats.h"
 #include "naucrates/dxl/parser/CParseHandlerResult.h"
 #include "naucrates/dxl/parser/CParseHandlerRoutedMotion.h"
+#include "naucrates/dxl/parser/CParseHandlerRuntimeFilter.h"
 #include "naucrates/dxl/parser/CParseHandlerScalarAggref.h"
 #include "naucrates/dxl/parser/CParseHandlerScalarArrayCoerceExpr.h"
 #include "naucrates/dxl/parser/CParseHandlerScalarArrayComp.h"
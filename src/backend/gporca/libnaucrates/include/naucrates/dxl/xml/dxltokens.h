@@ -105,6 +105,7 @@ enum Edxltoken
 	EdxltokenPhysicalAggregate,
 	EdxltokenPhysicalAppend,
 	EdxltokenPhysicalMaterialize,
+	EdxltokenPhysicalRuntimeFilter,
 	EdxltokenPhysicalSequence,
 	EdxltokenPhysicalTVF,
 	EdxltokenPhysicalWindow,
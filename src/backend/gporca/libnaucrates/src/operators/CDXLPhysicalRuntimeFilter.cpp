@@ -0,0 +1,118 @@
+//---------------------------------------------------------------------------
+//	Cloudberry Database
+//	Copyright (C) 2023 Cloudberry, Inc.
+//
+//	@filename:
+//		CDXLPhysicalRuntimeFilter.cpp
+//
+//	@doc:
+//		Implementation of DXL physical runtime filter operator
+//---------------------------------------------------------------------------
+
+
+#include "naucrates/dxl/operators/CDXLPhysicalRuntimeFilter.h"
+
+#include "naucrates/dxl/operators/CDXLNode.h"
+#include "naucrates/dxl/xml/CXMLSerializer.h"
+
+using namespace gpos;
+using namespace gpdxl;
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLPhysicalRuntimeFilter::CDXLPhysicalRuntimeFilter
+//
+//	@doc:
+//		Ctor
+//
+//---------------------------------------------------------------------------
+CDXLPhysicalRuntimeFilter::CDXLPhysicalRuntimeFilter(CMemoryPool *mp)
+	: CDXLPhysical(mp)
+{
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLPhysicalRuntimeFilter::GetDXLOperator
+//
+//	@doc:
+//		Operator type
+//
+//---------------------------------------------------------------------------
+Edxlopid
+CDXLPhysicalRuntimeFilter::GetDXLOperator() const
+{
+	return EdxlopPhysicalRuntimeFilter;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLPhysicalRuntimeFilter::GetOpNameStr
+//
+//	@doc:
+//		Operator name
+//
+//---------------------------------------------------------------------------
+const CWStringConst *
+CDXLPhysicalRuntimeFilter::GetOpNameStr() const
+{
+	return CDXLTokens::GetDXLTokenStr(EdxltokenPhysicalRuntimeFilter);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLPhysicalRuntimeFilter::SerializeToDXL
+//
+//	@doc:
+//		Serialize operator in DXL format
+//
+//---------------------------------------------------------------------------
+void
+CDXLPhysicalRuntimeFilter::SerializeToDXL(CXMLSerializer *xml_serializer,
+										  const CDXLNode *node) const
+{
+	const CWStringConst *element_name = GetOpNameStr();
+
+	xml_serializer->OpenElement(
+		CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix), element_name);
+
+	// serialize properties
+	node->SerializePropertiesToDXL(xml_serializer);
+
+	// serialize children
+	node->SerializeChildrenToDXL(xml_serializer);
+
+	xml_serializer->CloseElement(
+		CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix), element_name);
+}
+
+#ifdef GPOS_DEBUG
+//---------------------------------------------------------------------------
+//	@function:
+//		CDXLPhysicalRuntimeFilter::AssertValid
+//
+//	@doc:
+//		Checks whether operator node is well-structured
+//
+//---------------------------------------------------------------------------
+void
+CDXLPhysicalRuntimeFilter::AssertValid(const CDXLNode *node,
+									   BOOL validate_children) const
+{
+	GPOS_ASSERT(EdxlrfIndexSentinel == node->Arity());
+
+	CDXLNode *child_dxlnode = (*node)[EdxlrfIndexChild];
+	GPOS_ASSERT(EdxloptypePhysical ==
+				child_dxlnode->GetOperator()->GetDXLOperatorType());
+
+	if (validate_children)
+	{
+		child_dxlnode->GetOperator()->AssertValid(child_dxlnode,
+												  validate_children);
+	}
+}
+#endif	// GPOS_DEBUG
+
+// EOF
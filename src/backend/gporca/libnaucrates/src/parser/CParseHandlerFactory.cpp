@@ -106,6 +106,7 @@ CParseHandlerFactory::Init(CMemoryPool *mp)
 		{EdxltokenPhysicalSort, &CreateSortParseHandler},
 		{EdxltokenPhysicalAppend, &CreateAppendParseHandler},
 		{EdxltokenPhysicalMaterialize, &CreateMaterializeParseHandler},
+		{EdxltokenPhysicalRuntimeFilter, &CreateRuntimeFilterParseHandler},
 		{EdxltokenPhysicalPartitionSelector,
 		 &CreatePartitionSelectorParseHandler},
 		{EdxltokenPhysicalSequence, &CreateSequenceParseHandler},
@@ -783,6 +784,16 @@ CParseHandlerFactory::CreateMaterializeParseHandler(
 		CParseHandlerMaterialize(mp, parse_handler_mgr, parse_handler_root);
 }
 
+// creates a parse handler for parsing a runtime filter operator
+CParseHandlerBase *
+CParseHandlerFactory::CreateRuntimeFilterParseHandler(
+	CMemoryPool *mp, CParseHandlerManager *parse_handler_mgr,
+	CParseHandlerBase *parse_handler_root)
+{
+	return GPOS_NEW(mp)
+		CParseHandlerRuntimeFilter(mp, parse_handler_mgr, parse_handler_root);
+}
+
 // creates a parse handler for parsing a partition selector operator
 CParseHandlerBase *
 CParseHandlerFactory::CreatePartitionSelectorParseHandler(
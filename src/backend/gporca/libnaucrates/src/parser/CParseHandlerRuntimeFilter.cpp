@@ -0,0 +1,163 @@
+//---------------------------------------------------------------------------
+//	Cloudberry Database
+//	Copyright (C) 2023 Cloudberry, Inc.
+//
+//	@filename:
+//		CParseHandlerRuntimeFilter.cpp
+//
+//	@doc:
+//		Implementation of the SAX parse handler class for parsing runtime filter operator.
+//---------------------------------------------------------------------------
+
+#include "naucrates/dxl/parser/CParseHandlerRuntimeFilter.h"
+
+#include "naucrates/dxl/parser/CParseHandlerFactory.h"
+#include "naucrates/dxl/parser/CParseHandlerFilter.h"
+#include "naucrates/dxl/parser/CParseHandlerProjList.h"
+#include "naucrates/dxl/parser/CParseHandlerProperties.h"
+#include "naucrates/dxl/parser/CParseHandlerUtils.h"
+
+using namespace gpdxl;
+
+
+XERCES_CPP_NAMESPACE_USE
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CParseHandlerRuntimeFilter::CParseHandlerRuntimeFilter
+//
+//	@doc:
+//		Constructor
+//
+//---------------------------------------------------------------------------
+CParseHandlerRuntimeFilter::CParseHandlerRuntimeFilter(
+	CMemoryPool *mp, CParseHandlerManager *parse_handler_mgr,
+	CParseHandlerBase *parse_handler_root)
+	: CParseHandlerPhysicalOp(mp, parse_handler_mgr, parse_handler_root),
+	  m_dxl_op(nullptr)
+{
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CParseHandlerRuntimeFilter::StartElement
+//
+//	@doc:
+//		Invoked by Xerces to process an opening tag
+//
+//---------------------------------------------------------------------------
+void
+CParseHandlerRuntimeFilter::StartElement(
+	const XMLCh *const,	 //element_uri,
+	const XMLCh *const element_local_name,
+	const XMLCh *const,	 //element_qname,
+	const Attributes &	 //attrs
+)
+{
+	if (0 == XMLString::compareString(
+				 CDXLTokens::XmlstrToken(EdxltokenPhysicalRuntimeFilter),
+				 element_local_name))
+	{
+		GPOS_ASSERT(this->Length() == 0 &&
+					"No handlers should have been added yet");
+
+		m_dxl_op = GPOS_NEW(m_mp) CDXLPhysicalRuntimeFilter(m_mp);
+
+		// parse handler for child node
+		CParseHandlerBase *child_parse_handler =
+			CParseHandlerFactory::GetParseHandler(
+				m_mp, CDXLTokens::XmlstrToken(EdxltokenPhysical),
+				m_parse_handler_mgr, this);
+		m_parse_handler_mgr->ActivateParseHandler(child_parse_handler);
+
+		// parse handler for the filter
+		CParseHandlerBase *filter_parse_handler =
+			CParseHandlerFactory::GetParseHandler(
+				m_mp, CDXLTokens::XmlstrToken(EdxltokenScalarFilter),
+				m_parse_handler_mgr, this);
+		m_parse_handler_mgr->ActivateParseHandler(filter_parse_handler);
+
+		// parse handler for the proj list
+		CParseHandlerBase *proj_list_parse_handler =
+			CParseHandlerFactory::GetParseHandler(
+				m_mp, CDXLTokens::XmlstrToken(EdxltokenScalarProjList),
+				m_parse_handler_mgr, this);
+		m_parse_handler_mgr->ActivateParseHandler(proj_list_parse_handler);
+
+		//parse handler for the properties of the operator
+		CParseHandlerBase *prop_parse_handler =
+			CParseHandlerFactory::GetParseHandler(
+				m_mp, CDXLTokens::XmlstrToken(EdxltokenProperties),
+				m_parse_handler_mgr, this);
+		m_parse_handler_mgr->ActivateParseHandler(prop_parse_handler);
+
+		this->Append(prop_parse_handler);
+		this->Append(proj_list_parse_handler);
+		this->Append(filter_parse_handler);
+		this->Append(child_parse_handler);
+	}
+	else
+	{
+		CWStringDynamic *str = CDXLUtils::CreateDynamicStringFromXMLChArray(
+			m_parse_handler_mgr->GetDXLMemoryManager(), element_local_name);
+		GPOS_RAISE(gpdxl::ExmaDXL, gpdxl::ExmiDXLUnexpectedTag,
+				   str->GetBuffer());
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CParseHandlerRuntimeFilter::EndElement
+//
+//	@doc:
+//		Invoked by Xerces to process a closing tag
+//
+//---------------------------------------------------------------------------
+void
+CParseHandlerRuntimeFilter::EndElement(const XMLCh *const,	 // element_uri,
+									   const XMLCh *const element_local_name,
+									   const XMLCh *const  // element_qname
+)
+{
+	if (0 != XMLString::compareString(
+				 CDXLTokens::XmlstrToken(EdxltokenPhysicalRuntimeFilter),
+				 element_local_name))
+	{
+		CWStringDynamic *str = CDXLUtils::CreateDynamicStringFromXMLChArray(
+			m_parse_handler_mgr->GetDXLMemoryManager(), element_local_name);
+		GPOS_RAISE(gpdxl::ExmaDXL, gpdxl::ExmiDXLUnexpectedTag,
+				   str->GetBuffer());
+	}
+
+	GPOS_ASSERT(4 == this->Length());
+
+	// construct node from the created child nodes
+	CParseHandlerProperties *prop_parse_handler =
+		dynamic_cast<CParseHandlerProperties *>((*this)[0]);
+	CParseHandlerProjList *proj_list_parse_handler =
+		dynamic_cast<CParseHandlerProjList *>((*this)[1]);
+	CParseHandlerFilter *filter_parse_handler =
+		dynamic_cast<CParseHandlerFilter *>((*this)[2]);
+	CParseHandlerPhysicalOp *child_parse_handler =
+		dynamic_cast<CParseHandlerPhysicalOp *>((*this)[3]);
+
+	m_dxl_node = GPOS_NEW(m_mp) CDXLNode(m_mp, m_dxl_op);
+	// set statictics and physical properties
+	CParseHandlerUtils::SetProperties(m_dxl_node, prop_parse_handler);
+
+	// add constructed children
+	AddChildFromParseHandler(proj_list_parse_handler);
+	AddChildFromParseHandler(filter_parse_handler);
+	AddChildFromParseHandler(child_parse_handler);
+
+
+#ifdef GPOS_DEBUG
+	m_dxl_op->AssertValid(m_dxl_node, false /* validate_children */);
+#endif	// GPOS_DEBUG
+
+	// deactivate handler
+	m_parse_handler_mgr->DeactivateHandler();
+}
+
+// EOF
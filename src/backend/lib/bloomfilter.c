@@ -312,6 +312,16 @@ bloom_total_bits(bloom_filter *filter)
 	return filter->m;
 }
 
+/*
+ * Size of the filter in bytes.  A filter is a single chunk of memory, so a
+ * copy of that many bytes is a filter too.
+ */
+Size
+bloom_size(bloom_filter *filter)
+{
+	return offsetof(bloom_filter, bitset) + filter->m / BITS_PER_BYTE;
+}
+
 /*
  * Create Bloom filter in caller's memory context.
  *
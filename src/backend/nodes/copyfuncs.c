@@ -1473,6 +1473,11 @@ _copyRuntimeFilter(const RuntimeFilter *from)
 
 	CopyPlanFields((const Plan *) from, (Plan *) newnode);
 
+	COPY_SCALAR_FIELD(filter_id);
+	COPY_NODE_FIELD(hashkeys);
+	COPY_NODE_FIELD(hashoperators);
+	COPY_NODE_FIELD(hashcollations);
+
 	return newnode;
 }
 
@@ -1036,6 +1036,11 @@ _outRuntimeFilter(StringInfo str, const RuntimeFilter *node)
 	WRITE_NODE_TYPE("RUNTIME_FILTER");
 
 	_outPlanInfo(str, (const Plan *) node);
+
+	WRITE_INT_FIELD(filter_id);
+	WRITE_NODE_FIELD(hashkeys);
+	WRITE_NODE_FIELD(hashoperators);
+	WRITE_NODE_FIELD(hashcollations);
 }
 
 static void
@@ -2397,6 +2402,7 @@ _outPlannerGlobal(StringInfo str, const PlannerGlobal *node)
 	WRITE_UINT_FIELD(lastPHId);
 	WRITE_UINT_FIELD(lastRowMarkId);
 	WRITE_INT_FIELD(lastPlanNodeId);
+	WRITE_INT_FIELD(lastRuntimeFilterId);
 	WRITE_BOOL_FIELD(transientPlan);
 	WRITE_BOOL_FIELD(oneoffPlan);
 	WRITE_NODE_FIELD(share.motStack);
@@ -2549,10 +2549,15 @@ _readLockRows(void)
 static RuntimeFilter *
 _readRuntimeFilter(void)
 {
-	READ_LOCALS_NO_FIELDS(RuntimeFilter);
+	READ_LOCALS(RuntimeFilter);
 
 	ReadCommonPlan(&local_node->plan);
 
+	READ_INT_FIELD(filter_id);
+	READ_NODE_FIELD(hashkeys);
+	READ_NODE_FIELD(hashoperators);
+	READ_NODE_FIELD(hashcollations);
+
 	READ_DONE();
 }
 
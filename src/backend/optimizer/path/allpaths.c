@@ -4610,6 +4610,30 @@ create_partial_bitmap_paths(PlannerInfo *root, RelOptInfo *rel,
 														   bitmapqual, rel->lateral_relids, 1.0, parallel_workers));
 }
 
+/*
+ * Select the number of workers based on the log of the size of the relation or
+ * index.  This probably needs to be a good deal more sophisticated, but we need
+ * something here for now.  Note that the upper limit of the
+ * min_parallel_table_scan_size and min_parallel_index_scan_size GUCs is chosen
+ * to prevent overflow here.
+ */
+static int
+parallel_workers_for_size(double pages, int min_scan_size)
+{
+	int			parallel_threshold = Max(min_scan_size, 1);
+	int			parallel_workers = 1;
+
+	while (pages >= (BlockNumber) (parallel_threshold * 3))
+	{
+		parallel_workers++;
+		parallel_threshold *= 3;
+		if (parallel_threshold > INT_MAX / 3)
+			break;		/* avoid overflow */
+	}
+
+	return parallel_workers;
+}
+
 /*
  * Compute the number of parallel workers that should be used to scan a
  * relation.  We compute the parallel workers based on the size of the heap to
@@ -4658,7 +4682,19 @@ compute_parallel_worker(PlannerInfo *root, RelOptInfo *rel, double heap_pages, d
 
 			aoform = (Form_pg_appendonly) GETSTRUCT(aotup);
 			Assert(aoform->segfilecount >= 0);
-			parallel_workers = Min(aoform->segfilecount, max_workers);
+			parallel_workers = aoform->segfilecount;
+
+			/*
+			 * With a block directory, a parallel scan also splits the segment
+			 * files at their minipages, so that a few large segment files keep
+			 * as many workers busy as a heap table of the same size would.
+			 */
+			if (OidIsValid(aoform->blkdirrelid) &&
+				heap_pages >= min_parallel_table_scan_size)
+				parallel_workers = Max(parallel_workers,
+									   parallel_workers_for_size(heap_pages,
+																 min_parallel_table_scan_size));
+			parallel_workers = Min(parallel_workers, max_workers);
 			ReleaseSysCache(aotup);
 
 			/*
@@ -4685,43 +4721,15 @@ compute_parallel_worker(PlannerInfo *root, RelOptInfo *rel, double heap_pages, d
 				return 0;
 
 			if (heap_pages >= 0)
-			{
-				int			heap_parallel_threshold;
-				int			heap_parallel_workers = 1;
-
-				/*
-				 * Select the number of workers based on the log of the size of
-				 * the relation.  This probably needs to be a good deal more
-				 * sophisticated, but we need something here for now.  Note that
-				 * the upper limit of the min_parallel_table_scan_size GUC is
-				 * chosen to prevent overflow here.
-				 */
-				heap_parallel_threshold = Max(min_parallel_table_scan_size, 1);
-				while (heap_pages >= (BlockNumber) (heap_parallel_threshold * 3))
-				{
-					heap_parallel_workers++;
-					heap_parallel_threshold *= 3;
-					if (heap_parallel_threshold > INT_MAX / 3)
-						break;		/* avoid overflow */
-				}
-
-				parallel_workers = heap_parallel_workers;
-			}
+				parallel_workers = parallel_workers_for_size(heap_pages,
+															 min_parallel_table_scan_size);
 
 			if (index_pages >= 0)
 			{
-				int			index_parallel_workers = 1;
-				int			index_parallel_threshold;
+				int			index_parallel_workers;
 
-				/* same calculation as for heap_pages above */
-				index_parallel_threshold = Max(min_parallel_index_scan_size, 1);
-				while (index_pages >= (BlockNumber) (index_parallel_threshold * 3))
-				{
-					index_parallel_workers++;
-					index_parallel_threshold *= 3;
-					if (index_parallel_threshold > INT_MAX / 3)
-						break;		/* avoid overflow */
-				}
+				index_parallel_workers = parallel_workers_for_size(index_pages,
+																   min_parallel_index_scan_size);
 
 				if (parallel_workers > 0)
 					parallel_workers = Min(parallel_workers, index_parallel_workers);
@@ -148,6 +148,10 @@ static LockRows *create_lockrows_plan(PlannerInfo *root, LockRowsPath *best_path
 static ModifyTable *create_modifytable_plan(PlannerInfo *root, ModifyTablePath *best_path);
 static RuntimeFilter *create_runtime_filter_plan(PlannerInfo *root,
 												 RuntimeFilterPath *best_path);
+static void push_down_runtime_filter(PlannerInfo *root, HashPath *best_path,
+									 HashJoin *join_plan);
+static Plan **find_runtime_filter_scan(Plan **planp, Index varno,
+									   int *nmotions);
 static Limit *create_limit_plan(PlannerInfo *root, LimitPath *best_path,
 								int flags);
 static SeqScan *create_seqscan_plan(PlannerInfo *root, Path *best_path,
@@ -6036,9 +6040,159 @@ create_hashjoin_plan(PlannerInfo *root,
 
 	copy_generic_path_info(&join_plan->join.plan, &best_path->jpath.path);
 
+	push_down_runtime_filter(root, best_path, join_plan);
+
 	return join_plan;
 }
 
+/*
+ * push_down_runtime_filter
+ *	  Apply the runtime filter of a hash join also to the scan that feeds the
+ *	  join's outer side through a Motion, before the rows are moved.
+ *
+ * The bloom filter is built from the inner rows the join sees in its own
+ * process, and handed to the scan through the segment's shared memory, so
+ * it can only stand in for the join if the inner side is complete in every
+ * process running the join, that is, if it is replicated.  A filter built
+ * from a hashed inner side only holds that segment's share of the keys,
+ * while the scan's rows are bound for all segments.
+ *
+ * The pushed down filter is a RuntimeFilter over the scan, with a copy of
+ * the join's outer hash keys, and the same filter_id as the join's own
+ * RuntimeFilter.  The keys must all be columns of the scanned relation, and
+ * the path down to the scan may only go through nodes that pass the scan's
+ * rows on unchanged, or inner joins, so that a row the join would reject
+ * is always one no output row of the subtree could come from.
+ */
+static void
+push_down_runtime_filter(PlannerInfo *root, HashPath *best_path,
+						 HashJoin *join_plan)
+{
+	RuntimeFilter *filter;
+	RuntimeFilter *pushed;
+	CdbPathLocus inner_locus = best_path->jpath.innerjoinpath->locus;
+	Plan	  **scanp;
+	Plan	   *scan;
+	Index		varno = 0;
+	int			nmotions = 0;
+	ListCell   *lc;
+
+	if (!gp_enable_runtime_filter_pushdown ||
+		!IsA(join_plan->join.plan.lefttree, RuntimeFilter))
+		return;
+	filter = (RuntimeFilter *) join_plan->join.plan.lefttree;
+
+	if (!CdbPathLocus_IsReplicated(inner_locus) &&
+		!CdbPathLocus_IsSegmentGeneral(inner_locus) &&
+		!CdbPathLocus_IsGeneral(inner_locus))
+		return;
+
+	/* Each parallel worker would only have its share of the inner rows */
+	if (best_path->jpath.path.parallel_aware ||
+		best_path->jpath.path.locus.parallel_workers > 1)
+		return;
+
+	foreach(lc, join_plan->hashkeys)
+	{
+		Node	   *key = (Node *) lfirst(lc);
+
+		if (IsA(key, RelabelType))
+			key = (Node *) ((RelabelType *) key)->arg;
+		if (!IsA(key, Var) || ((Var *) key)->varlevelsup != 0)
+			return;
+		if (varno != 0 && ((Var *) key)->varno != varno)
+			return;
+		varno = ((Var *) key)->varno;
+	}
+
+	scanp = find_runtime_filter_scan(&filter->plan.lefttree, varno, &nmotions);
+
+	/* Within the join's slice, the join's own filter does the job */
+	if (scanp == NULL || nmotions == 0)
+		return;
+	scan = *scanp;
+
+	/* The keys are evaluated on the scan's output */
+	foreach(lc, join_plan->hashkeys)
+	{
+		Node	   *key = (Node *) lfirst(lc);
+
+		if (IsA(key, RelabelType))
+			key = (Node *) ((RelabelType *) key)->arg;
+		if (!tlist_member((Expr *) key, scan->targetlist))
+			return;
+	}
+
+	pushed = make_runtime_filter(scan);
+	copy_plan_costsize(&pushed->plan, scan);
+	pushed->plan.locustype = scan->locustype;
+	pushed->plan.parallel = scan->parallel;
+	pushed->hashkeys = copyObject(join_plan->hashkeys);
+	pushed->hashoperators = list_copy(join_plan->hashoperators);
+	pushed->hashcollations = list_copy(join_plan->hashcollations);
+
+	filter->filter_id = ++root->glob->lastRuntimeFilterId;
+	pushed->filter_id = filter->filter_id;
+
+	*scanp = (Plan *) pushed;
+}
+
+/*
+ * Find the sequential scan of relation 'varno' below 'planp', and return
+ * the link to it, or NULL if it can't be reached.  *nmotions is increased
+ * by the number of Motions on the way.
+ */
+static Plan **
+find_runtime_filter_scan(Plan **planp, Index varno, int *nmotions)
+{
+	Plan	   *plan = *planp;
+	Plan	  **result = NULL;
+
+	switch (nodeTag(plan))
+	{
+		case T_SeqScan:
+			if (((Scan *) plan)->scanrelid == varno)
+				result = planp;
+			break;
+
+		case T_Motion:
+			result = find_runtime_filter_scan(&plan->lefttree, varno, nmotions);
+			if (result != NULL)
+				(*nmotions)++;
+			break;
+
+		case T_Material:
+		case T_Sort:
+		case T_RuntimeFilter:
+			result = find_runtime_filter_scan(&plan->lefttree, varno, nmotions);
+			break;
+
+		case T_HashJoin:
+		case T_MergeJoin:
+		case T_NestLoop:
+			{
+				JoinType	jointype = ((Join *) plan)->jointype;
+				Plan	  **innerp = &plan->righttree;
+
+				if (jointype == JOIN_INNER || jointype == JOIN_SEMI)
+					result = find_runtime_filter_scan(&plan->lefttree, varno,
+													  nmotions);
+				if (result == NULL && jointype == JOIN_INNER)
+				{
+					if (IsA(*innerp, Hash))
+						innerp = &(*innerp)->lefttree;
+					result = find_runtime_filter_scan(innerp, varno, nmotions);
+				}
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	return result;
+}
+
 
 /*****************************************************************************
  *
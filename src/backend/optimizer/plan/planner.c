@@ -414,6 +414,7 @@ standard_planner(Query *parse, const char *query_string, int cursorOptions,
 	glob->lastPHId = 0;
 	glob->lastRowMarkId = 0;
 	glob->lastPlanNodeId = 0;
+	glob->lastRuntimeFilterId = 0;
 	glob->transientPlan = false;
 	glob->oneoffPlan = false;
 	glob->numSlices = 0;
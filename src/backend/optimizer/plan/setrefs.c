@@ -1116,8 +1116,30 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 			}
 			break;
 		case T_RuntimeFilter:
-			set_dummy_tlist_references(plan, rtoffset);
-			Assert(plan->qual == NIL);
+			{
+				RuntimeFilter *rplan = (RuntimeFilter *) plan;
+
+				/*
+				 * The hash keys of a pushed down filter are evaluated on the
+				 * rows of its subplan, like a Hash node's.
+				 */
+				if (rplan->hashkeys != NIL)
+				{
+					indexed_tlist *subplan_itlist;
+
+					subplan_itlist = build_tlist_index(plan->lefttree->targetlist);
+					rplan->hashkeys = (List *)
+						fix_upper_expr(root,
+									   (Node *) rplan->hashkeys,
+									   subplan_itlist,
+									   OUTER_VAR,
+									   rtoffset,
+									   NUM_EXEC_QUAL(plan));
+					pfree(subplan_itlist);
+				}
+				set_dummy_tlist_references(plan, rtoffset);
+				Assert(plan->qual == NIL);
+			}
 			break;
 		case T_Limit:
 			{
@@ -429,6 +429,8 @@ plan_tree_walker(Node *node,
 
 			if (walk_plan_node_fields((Plan *) node, walker, context))
 				return true;
+			if (walker((Node *) ((RuntimeFilter *) node)->hashkeys, context))
+				return true;
 			/* Other fields are simple items and lists of simple items. */
 			break;
 
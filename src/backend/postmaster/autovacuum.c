@@ -122,6 +122,7 @@
 #include "catalog/catalog.h"
 #include "catalog/dependency.h"
 #include "catalog/namespace.h"
+#include "catalog/pg_am.h"
 #include "catalog/pg_database.h"
 #include "commands/dbcommands.h"
 #include "commands/vacuum.h"
@@ -3055,6 +3056,10 @@ table_recheck_autovac(Oid relid, HTAB *table_toast_map,
 		tab->at_params.is_wraparound = wraparound;
 		tab->at_params.log_min_duration = log_min_duration;
 		tab->at_params.auto_stats = false;
+		tab->at_params.ao_compact_segfiles = 0;
+		tab->at_params.ao_compaction_incomplete = false;
+		tab->at_params.cost_delay = -1;
+		tab->at_params.cost_limit = -1;
 		tab->at_vacuum_cost_limit = vac_cost_limit;
 		tab->at_vacuum_cost_delay = vac_cost_delay;
 		tab->at_relname = NULL;
@@ -3197,6 +3202,7 @@ relation_needs_vacanalyze(Oid relid,
 	float4		vactuples,
 				instuples,
 				anltuples;
+	bool		enough_dead_tuples = false;
 
 	/* freeze parameters */
 	int			freeze_max_age;
@@ -3317,6 +3323,7 @@ relation_needs_vacanalyze(Oid relid,
 				 vactuples, vacthresh, anltuples, anlthresh);
 
 		/* Determine if this table needs vacuum or analyze. */
+		enough_dead_tuples = (vactuples > vacthresh);
 		*dovacuum = force_vacuum || (vactuples > vacthresh) ||
 			(vac_ins_base_thresh >= 0 && instuples > vacinsthresh);
 		*doanalyze = (anltuples > anlthresh);
@@ -3354,9 +3361,21 @@ relation_needs_vacanalyze(Oid relid,
 	/*
 	 * GPDB: Autovacuum VACUUM is only enabled for catalog tables. (But ignore
 	 * if at risk of wrap around and proceed to vacuum)
+	 *
+	 * With gp_autovacuum_appendonly, the coordinator also vacuums
+	 * append-optimized tables that have enough dead tuples, to compact their
+	 * segment files.  The VACUUM is dispatched like a manual one.  Inserts
+	 * alone leave nothing to compact, so the insert threshold doesn't apply.
 	 */
 	if (!IsSystemClass(relid, classForm) && !force_vacuum)
-		*dovacuum = false;
+	{
+		if (Gp_role == GP_ROLE_DISPATCH && gp_autovacuum_appendonly &&
+			(classForm->relam == AO_ROW_TABLE_AM_OID ||
+			 classForm->relam == AO_COLUMN_TABLE_AM_OID))
+			*dovacuum = enough_dead_tuples;
+		else
+			*dovacuum = false;
+	}
 }
 
 /*
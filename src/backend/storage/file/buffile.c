@@ -48,6 +48,9 @@
 #ifdef USE_ZSTD
 #include <zstd.h>
 #endif
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
 
 #include "commands/tablespace.h"
 #include "executor/instrument.h"
@@ -142,6 +145,9 @@ struct BufFile
 		BFS_COMPRESSED_READING
 	} state;
 
+	/* Compression method of a compressed file, see BufFileStartCompression */
+	WorkfileCompressionMethod compression_method;
+
 	/* ZStandard compression support */
 #ifdef USE_ZSTD
 	zstd_context *zstd_context;	/* ZStandard library handles. */
@@ -155,6 +161,18 @@ struct BufFile
 	ZSTD_inBuffer compressed_buffer;
 	bool		decompression_finished;
 #endif
+
+	/*
+	 * LZ4 compression support.  The data is stored in chunks of up to BLCKSZ
+	 * bytes that are compressed independently; the chunk being filled or
+	 * read out is kept uncompressed in 'buffer'.
+	 */
+#ifdef USE_LZ4
+	void	   *lz4_state;		/* LZ4 compression state, while writing */
+	int			lz4_chunk_len;	/* # of valid bytes in the current chunk */
+	int			lz4_chunk_pos;	/* next read position in the current chunk */
+	size_t		lz4_uncompressed_bytes;
+#endif
 };
 
 static BufFile *makeBufFileCommon(int nfiles);
@@ -520,6 +538,10 @@ BufFileClose(BufFile *file)
 	if (file->zstd_context)
 		zstd_free_context(file->zstd_context);
 #endif
+#ifdef USE_LZ4
+	if (file->lz4_state)
+		pfree(file->lz4_state);
+#endif
 
 	pfree(file);
 }
@@ -1164,10 +1186,15 @@ BufFileResume(BufFile *buffile)
 }
 
 /*
- * ZStandard Compression support
+ * Compression support
  */
 
 bool gp_workfile_compression;		/* GUC */
+#if !defined(USE_ZSTD) && defined(USE_LZ4)
+int			gp_workfile_compression_method = WORKFILE_COMPRESSION_LZ4;	/* GUC */
+#else
+int			gp_workfile_compression_method = WORKFILE_COMPRESSION_ZSTD;	/* GUC */
+#endif
 
 /*
  * BufFilePledgeSequential
@@ -1220,7 +1247,7 @@ static char *compression_buffer;
  * Initialize the compressor.
  */
 static void
-BufFileStartCompression(BufFile *file)
+BufFileStartCompressionZstd(BufFile *file)
 {
 	ResourceOwner oldowner;
 	size_t ret;
@@ -1263,7 +1290,7 @@ BufFileStartCompression(BufFile *file)
 }
 
 static void
-BufFileDumpCompressedBuffer(BufFile *file, const void *buffer, Size nbytes)
+BufFileDumpCompressedBufferZstd(BufFile *file, const void *buffer, Size nbytes)
 {
 	ZSTD_inBuffer input;
 	off_t pos = 0;
@@ -1306,7 +1333,7 @@ BufFileDumpCompressedBuffer(BufFile *file, const void *buffer, Size nbytes)
  * End compression stage. Rewind and prepare the BufFile for decompression.
  */
 static void
-BufFileEndCompression(BufFile *file)
+BufFileEndCompressionZstd(BufFile *file)
 {
 	ZSTD_outBuffer output;
 	size_t		ret;
@@ -1356,7 +1383,7 @@ BufFileEndCompression(BufFile *file)
 }
 
 static int
-BufFileLoadCompressedBuffer(BufFile *file, void *buffer, size_t bufsize)
+BufFileLoadCompressedBufferZstd(BufFile *file, void *buffer, size_t bufsize)
 {
 	ZSTD_outBuffer output;
 	size_t		ret;
@@ -1423,34 +1450,295 @@ BufFileLoadCompressedBuffer(BufFile *file, void *buffer, size_t bufsize)
 
 /*
  * Dummy versions of the compression functions, when the server is built
- * without libzstd. gp_workfile_compression cannot be enabled without
- * libzstd - there's a GUC assign hook to check that - so these should
+ * without libzstd. gp_workfile_compression_method cannot be set to zstd
+ * without libzstd - there's a GUC check hook for that - so these should
  * never be called. They exists just to avoid having so many #ifdefs in
  * the code.
  */
 static void
-BufFileStartCompression(BufFile *file)
+BufFileStartCompressionZstd(BufFile *file)
 {
 	elog(ERROR, "zstandard compression not supported by this build");
 }
 static void
-BufFileDumpCompressedBuffer(BufFile *file, const void *buffer, Size nbytes)
+BufFileDumpCompressedBufferZstd(BufFile *file, const void *buffer, Size nbytes)
 {
 	elog(ERROR, "zstandard compression not supported by this build");
 }
 static void
-BufFileEndCompression(BufFile *file)
+BufFileEndCompressionZstd(BufFile *file)
 {
 	elog(ERROR, "zstandard compression not supported by this build");
 }
 static int
-BufFileLoadCompressedBuffer(BufFile *file, void *buffer, size_t bufsize)
+BufFileLoadCompressedBufferZstd(BufFile *file, void *buffer, size_t bufsize)
 {
 	elog(ERROR, "zstandard compression not supported by this build");
 }
 
 #endif		/* HAVE_ZSTD */
 
+#ifdef USE_LZ4
+
+/*
+ * Each LZ4 chunk in the file is preceded by this header.  A chunk that
+ * doesn't compress is stored as is, with compressed_len == raw_len.
+ */
+typedef struct BufFileLz4ChunkHeader
+{
+	int32		compressed_len;
+	int32		raw_len;
+} BufFileLz4ChunkHeader;
+
+#define BUFFILE_LZ4_BUFFER_SIZE \
+	(sizeof(BufFileLz4ChunkHeader) + LZ4_COMPRESSBOUND(BLCKSZ))
+
+/*
+ * Temporary buffer holding one compressed chunk, shared by all files like
+ * compression_buffer above.
+ */
+static char *lz4_compression_buffer;
+
+/*
+ * Initialize the compressor.  Unlike with zstd, the BufFile's own buffer is
+ * kept, to collect the data of the chunk being written.
+ */
+static void
+BufFileStartCompressionLz4(BufFile *file)
+{
+	if (lz4_compression_buffer == NULL)
+		lz4_compression_buffer = MemoryContextAlloc(TopMemoryContext,
+													BUFFILE_LZ4_BUFFER_SIZE);
+
+	file->lz4_state = palloc(LZ4_sizeofState());
+	file->lz4_chunk_len = 0;
+	file->lz4_chunk_pos = 0;
+	file->lz4_uncompressed_bytes = 0;
+
+	file->state = BFS_COMPRESSED_WRITING;
+}
+
+/*
+ * Compress the current chunk and write it out.
+ */
+static void
+BufFileDumpLz4Chunk(BufFile *file)
+{
+	BufFileLz4ChunkHeader *header = (BufFileLz4ChunkHeader *) lz4_compression_buffer;
+	char	   *compressed = lz4_compression_buffer + sizeof(BufFileLz4ChunkHeader);
+	int			compressed_len;
+	int			len;
+	int			wrote;
+
+	Assert(file->lz4_chunk_len > 0);
+
+	compressed_len = LZ4_compress_fast_extState(file->lz4_state,
+												file->buffer.data,
+												compressed,
+												file->lz4_chunk_len,
+												LZ4_COMPRESSBOUND(BLCKSZ),
+												1);
+	if (compressed_len <= 0 || compressed_len >= file->lz4_chunk_len)
+	{
+		memcpy(compressed, file->buffer.data, file->lz4_chunk_len);
+		compressed_len = file->lz4_chunk_len;
+	}
+	header->compressed_len = compressed_len;
+	header->raw_len = file->lz4_chunk_len;
+
+	len = sizeof(BufFileLz4ChunkHeader) + compressed_len;
+	wrote = FileWrite(file->files[0], lz4_compression_buffer, len, file->curOffset, WAIT_EVENT_BUFFILE_WRITE);
+	if (wrote != len)
+		elog(ERROR, "could not write %d bytes to compressed temporary file: %m", len);
+	file->curOffset += wrote;
+
+	file->lz4_chunk_len = 0;
+}
+
+static void
+BufFileDumpCompressedBufferLz4(BufFile *file, const void *buffer, Size nbytes)
+{
+	const char *ptr = buffer;
+
+	file->lz4_uncompressed_bytes += nbytes;
+
+	while (nbytes > 0)
+	{
+		Size		n = Min(nbytes, BLCKSZ - file->lz4_chunk_len);
+
+		memcpy(file->buffer.data + file->lz4_chunk_len, ptr, n);
+		file->lz4_chunk_len += n;
+		ptr += n;
+		nbytes -= n;
+
+		if (file->lz4_chunk_len == BLCKSZ)
+			BufFileDumpLz4Chunk(file);
+	}
+}
+
+/*
+ * End compression stage. Rewind and prepare the BufFile for decompression.
+ */
+static void
+BufFileEndCompressionLz4(BufFile *file)
+{
+	Assert(file->state == BFS_COMPRESSED_WRITING);
+
+	if (file->lz4_chunk_len > 0)
+		BufFileDumpLz4Chunk(file);
+
+	pfree(file->lz4_state);
+	file->lz4_state = NULL;
+
+	elog(DEBUG1, "BufFile compressed from %ld to %ld bytes",
+		 file->lz4_uncompressed_bytes, BufFileSize(file));
+
+	/* Done writing. Initialize for reading */
+	file->lz4_chunk_len = 0;
+	file->lz4_chunk_pos = 0;
+	file->state = BFS_RANDOM_ACCESS;
+
+	if (BufFileSeek(file, 0, 0, SEEK_SET) != 0)
+		elog(ERROR, "could not seek in temporary file: %m");
+
+	file->state = BFS_COMPRESSED_READING;
+}
+
+/*
+ * Read the next chunk and decompress it.  Returns false at end of file.
+ */
+static bool
+BufFileLoadLz4Chunk(BufFile *file)
+{
+	BufFileLz4ChunkHeader header;
+	char	   *compressed = lz4_compression_buffer + sizeof(BufFileLz4ChunkHeader);
+	int			nb;
+
+	nb = FileRead(file->files[0], (char *) &header, sizeof(header), file->curOffset, WAIT_EVENT_BUFFILE_READ);
+	if (nb < 0)
+		elog(ERROR, "could not read from temporary file: %m");
+	if (nb == 0)
+		return false;
+	if (nb != sizeof(header))
+		elog(ERROR, "unexpected end of compressed temporary file");
+
+	if (header.raw_len <= 0 || header.raw_len > BLCKSZ ||
+		header.compressed_len <= 0 || header.compressed_len > header.raw_len)
+		elog(ERROR, "invalid chunk in compressed temporary file (compressed length %d, length %d)",
+			 header.compressed_len, header.raw_len);
+
+	nb = FileRead(file->files[0], compressed, header.compressed_len,
+				  file->curOffset + sizeof(header), WAIT_EVENT_BUFFILE_READ);
+	if (nb < 0)
+		elog(ERROR, "could not read from temporary file: %m");
+	if (nb != header.compressed_len)
+		elog(ERROR, "unexpected end of compressed temporary file");
+
+	if (header.compressed_len == header.raw_len)
+		memcpy(file->buffer.data, compressed, header.raw_len);
+	else if (LZ4_decompress_safe(compressed, file->buffer.data,
+								 header.compressed_len, BLCKSZ) != header.raw_len)
+		elog(ERROR, "lz4 decompression of temporary file failed");
+
+	file->curOffset += sizeof(header) + header.compressed_len;
+	file->lz4_chunk_len = header.raw_len;
+	file->lz4_chunk_pos = 0;
+
+	return true;
+}
+
+static int
+BufFileLoadCompressedBufferLz4(BufFile *file, void *buffer, size_t bufsize)
+{
+	char	   *ptr = buffer;
+	size_t		nread = 0;
+
+	while (nread < bufsize)
+	{
+		size_t		n;
+
+		if (file->lz4_chunk_pos == file->lz4_chunk_len &&
+			!BufFileLoadLz4Chunk(file))
+			break;
+
+		n = Min(bufsize - nread, file->lz4_chunk_len - file->lz4_chunk_pos);
+		memcpy(ptr + nread, file->buffer.data + file->lz4_chunk_pos, n);
+		file->lz4_chunk_pos += n;
+		nread += n;
+	}
+
+	return nread;
+}
+#else		/* USE_LZ4 */
+
+/*
+ * Dummy versions, like the zstd ones above.
+ */
+static void
+BufFileStartCompressionLz4(BufFile *file)
+{
+	elog(ERROR, "lz4 compression not supported by this build");
+}
+static void
+BufFileDumpCompressedBufferLz4(BufFile *file, const void *buffer, Size nbytes)
+{
+	elog(ERROR, "lz4 compression not supported by this build");
+}
+static void
+BufFileEndCompressionLz4(BufFile *file)
+{
+	elog(ERROR, "lz4 compression not supported by this build");
+}
+static int
+BufFileLoadCompressedBufferLz4(BufFile *file, void *buffer, size_t bufsize)
+{
+	elog(ERROR, "lz4 compression not supported by this build");
+}
+
+#endif		/* USE_LZ4 */
+
+/*
+ * Route the compression calls to the method chosen when the file started
+ * compressing.
+ */
+static void
+BufFileStartCompression(BufFile *file)
+{
+	file->compression_method = gp_workfile_compression_method;
+
+	if (file->compression_method == WORKFILE_COMPRESSION_LZ4)
+		BufFileStartCompressionLz4(file);
+	else
+		BufFileStartCompressionZstd(file);
+}
+
+static void
+BufFileDumpCompressedBuffer(BufFile *file, const void *buffer, Size nbytes)
+{
+	if (file->compression_method == WORKFILE_COMPRESSION_LZ4)
+		BufFileDumpCompressedBufferLz4(file, buffer, nbytes);
+	else
+		BufFileDumpCompressedBufferZstd(file, buffer, nbytes);
+}
+
+static void
+BufFileEndCompression(BufFile *file)
+{
+	if (file->compression_method == WORKFILE_COMPRESSION_LZ4)
+		BufFileEndCompressionLz4(file);
+	else
+		BufFileEndCompressionZstd(file);
+}
+
+static int
+BufFileLoadCompressedBuffer(BufFile *file, void *buffer, size_t bufsize)
+{
+	if (file->compression_method == WORKFILE_COMPRESSION_LZ4)
+		return BufFileLoadCompressedBufferLz4(file, buffer, bufsize);
+	else
+		return BufFileLoadCompressedBufferZstd(file, buffer, bufsize);
+}
+
 /*
  * Truncate a BufFile created by BufFileCreateShared up to the given fileno and
  * the offset.
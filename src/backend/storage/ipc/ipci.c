@@ -16,6 +16,7 @@
 
 #include <signal.h>
 
+#include "access/appendonly_visimap_cache.h"
 #include "access/clog.h"
 #include "access/commit_ts.h"
 #include "access/heapam.h"
@@ -26,10 +27,12 @@
 #include "access/syncscan.h"
 #include "access/twophase.h"
 #include "access/distributedlog.h"
+#include "catalog/gp_fastsequence.h"
 #include "cdb/cdblocaldistribxact.h"
 #include "cdb/cdbvars.h"
 #include "commands/async.h"
 #include "crypto/kmgr.h"
+#include "executor/nodeRuntimeFilter.h"
 #include "executor/nodeShareInputScan.h"
 #include "miscadmin.h"
 #include "pgstat.h"
@@ -206,6 +209,9 @@ CreateSharedMemoryAndSemaphores(void)
 		size = add_size(size, CancelBackendMsgShmemSize());
 		size = add_size(size, WorkFileShmemSize());
 		size = add_size(size, ShareInputShmemSize());
+		size = add_size(size, RuntimeFilterShmemSize());
+		size = add_size(size, AppendOnlyVisimapCache_ShmemSize());
+		size = add_size(size, FastSequenceCache_ShmemSize());
 
 #ifdef FAULT_INJECTOR
 		size = add_size(size, FaultInjector_ShmemSize());
@@ -387,6 +393,9 @@ CreateSharedMemoryAndSemaphores(void)
 	BackendCancelShmemInit();
 	WorkFileShmemInit();
 	ShareInputShmemInit();
+	RuntimeFilterShmemInit();
+	AppendOnlyVisimapCache_ShmemInit();
+	FastSequenceCache_ShmemInit();
 
 	/*
 	 * Set up Instrumentation free list
@@ -20,6 +20,7 @@
 #include "postgres.h"
 
 #include "access/aomd.h"
+#include "access/appendonly_visimap_cache.h"
 #include "access/xact.h"
 #include "access/xlogutils.h"
 #include "catalog/catalog.h"
@@ -473,6 +474,12 @@ smgrdounlinkall(SMgrRelation *rels, int nrels, bool isRedo)
 	 * too. But we can't because we don't know the OIDs.
 	 */
 
+	/*
+	 * Entries cached for a visimap relation must not be found by a later
+	 * relation that reuses its relfilenode.
+	 */
+	AppendOnlyVisimapCache_ForgetRelFileNodes(rnodes, nrels);
+
 	/*
 	 * Send a shared-inval message to force other backends to close any
 	 * dangling smgr references they may have for these rels.  We should do
@@ -33,6 +33,7 @@
 #include "crypto/bufenc.h"
 #include "utils/datumstream.h"
 #include "utils/guc.h"
+#include "utils/lsyscache.h"
 #include "catalog/pg_compression.h"
 #include "utils/faultinjector.h"
 
@@ -305,7 +306,15 @@ datumstreamwrite_put(
 					 bool null,
 					 void **toFree)
 {
-	return DatumStreamBlockWrite_Put(&acc->blockWrite, d, null, toFree);
+	int			result;
+
+	result = DatumStreamBlockWrite_Put(&acc->blockWrite, d, null, toFree);
+
+	/* A negative result means the value did not go into this block */
+	if (result >= 0 && acc->zonemap)
+		AOZoneMap_AddValue(acc->zonemap, d, null);
+
+	return result;
 }
 
 int
@@ -452,6 +461,22 @@ init_datumstream_info(
 		*delta_compression = is_deltarange_compression_supported(attr);
 
 	}
+	else if (compName != NULL && pg_strcasecmp(compName, "auto") == 0)
+	{
+		/*
+		 * AUTO uses the RLE_TYPE block format, so that runs and small deltas
+		 * are encoded here, and leaves the choice of BULK compression for
+		 * each block to the "auto" compressor.
+		 */
+		*datumStreamVersion = DatumStreamVersion_Dense_Enhanced;
+		*rle_compression = true;
+		*delta_compression = is_deltarange_compression_supported(attr);
+
+		ao_attr->safeFSWriteSize = safeFSWriteSize;
+		ao_attr->compress = true;
+		ao_attr->compressType = compName;
+		ao_attr->compressLevel = 1;
+	}
 	else if (compName == NULL || pg_strcasecmp(compName, "none") == 0)
 	{
 		/* No bulk compression. */
@@ -631,6 +656,13 @@ create_datumstreamwrite(
 								/* errcontextArg */ (void *) acc,
 								&acc->ao_write.relFileNode.node);
 
+	if (gp_appendonly_enable_zonemap &&
+		AOZoneMap_TypeIsSupported(attr->atttypid))
+	{
+		acc->zonemap = palloc(sizeof(AOZoneMapBuildState));
+		AOZoneMap_InitBuildState(acc->zonemap, getBaseType(attr->atttypid));
+	}
+
 	return acc;
 }
 
@@ -769,6 +801,8 @@ destroy_datumstreamwrite(DatumStreamWrite * ds)
 
 	AppendOnlyStorageWrite_FinishSession(&ds->ao_write);
 
+	if (ds->zonemap)
+		pfree(ds->zonemap);
 	if (ds->title)
 	{
 		pfree(ds->title);
@@ -842,6 +876,10 @@ datumstreamread_open_file(DatumStreamRead * ds, char *fn, int64 eof, int64 eofUn
 		datumstreamread_close_file(ds);
 
 	AppendOnlyStorageRead_OpenFile(&ds->ao_read, fn, version, ds->eof);
+	AppendOnlyStorageRead_SetSegmentFileNum(&ds->ao_read, segmentFileNum);
+
+	/* No block of the new file has been read yet */
+	ds->blockRowCount = 0;
 
 	ds->need_close_file = true;
 }
@@ -1011,6 +1049,15 @@ datumstreamwrite_block(DatumStreamWrite *acc,
 		itemCount,
 		addColAction);
 
+	if (acc->zonemap)
+	{
+		Assert(acc->zonemap->rowCount == itemCount);
+		AppendOnlyBlockDirectory_InsertZoneMapEntry(blockDirectory,
+													columnGroupNo,
+													acc->blockFirstRowNum,
+													acc->zonemap);
+	}
+
 	return writesz;
 }
 
@@ -1352,10 +1399,12 @@ datumstreamread_block_content(DatumStreamRead * acc)
 }
 
 
-int
-datumstreamread_block(DatumStreamRead * acc,
-					  AppendOnlyBlockDirectory *blockDirectory,
-					  int colGroupNo)
+/*
+ * Read the header of the block following the current one, and set up the
+ * block position information from it.  The contents are not read.
+ */
+static bool
+datumstreamread_next_block_info(DatumStreamRead * acc)
 {
 	bool		readOK = false;
 
@@ -1371,7 +1420,7 @@ datumstreamread_block(DatumStreamRead * acc,
 												&acc->getBlockInfo.isLarge,
 											&acc->getBlockInfo.isCompressed);
 	if (!readOK)
-		return -1;
+		return false;
 
 	if (Debug_appendonly_print_datumstream)
 		elog(LOG,
@@ -1413,6 +1462,17 @@ datumstreamread_block(DatumStreamRead * acc,
 			 acc->blockFileOffset,
 			 acc->blockRowCount);
 
+	return true;
+}
+
+int
+datumstreamread_block(DatumStreamRead * acc,
+					  AppendOnlyBlockDirectory *blockDirectory,
+					  int colGroupNo)
+{
+	if (!datumstreamread_next_block_info(acc))
+		return -1;
+
 	datumstreamread_block_content(acc);
 
 	if (blockDirectory)
@@ -1482,6 +1542,50 @@ datumstreamread_find(DatumStreamRead * datumStream,
 	Assert(rowNumInBlock == DatumStreamBlockRead_Nth(&datumStream->blockRead));
 }
 
+/*
+ * Position a sequential scan of the stream so that the next
+ * datumstreamread_advance() returns row rowNum, which must be after the
+ * current row.  Blocks in between are skipped by their headers, without
+ * decompressing or decoding their contents.  Right after the file is opened
+ * there is no current row, and the scan can start at any row.
+ *
+ * Returns false if the segment file ends before rowNum.
+ */
+bool
+datumstreamread_skip_to_row(DatumStreamRead * datumStream, int64 rowNum)
+{
+	int64		rowNumInBlock;
+
+	Assert(datumStream->blockFirstRowNum != INT64CONST(-1));
+
+	rowNumInBlock = rowNum - datumStream->blockFirstRowNum;
+	if (rowNumInBlock >= 0 && rowNumInBlock < datumStream->blockRowCount)
+	{
+		/* Still in the current block */
+		Assert(rowNumInBlock > DatumStreamBlockRead_Nth(&datumStream->blockRead));
+		datumstreamread_find(datumStream, rowNumInBlock - 1);
+		return true;
+	}
+
+	while (true)
+	{
+		if (!datumstreamread_next_block_info(datumStream))
+			return false;
+
+		rowNumInBlock = rowNum - datumStream->blockFirstRowNum;
+		if (rowNumInBlock < datumStream->blockRowCount)
+			break;
+
+		AppendOnlyStorageRead_SkipCurrentBlock(&datumStream->ao_read);
+	}
+
+	datumstreamread_block_content(datumStream);
+	if (rowNumInBlock > 0)
+		datumstreamread_find(datumStream, rowNumInBlock - 1);
+
+	return true;
+}
+
 /*
  * Find the block that contains the given row.
  */
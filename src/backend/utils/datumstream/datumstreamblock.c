@@ -17,10 +17,39 @@
 #include "access/heaptoast.h"
 #include "access/tupmacs.h"
 #include "access/xlog.h"
+#include "common/hashfn.h"
 #include "crypto/bufenc.h"
 #include "utils/datumstreamblock.h"
 #include "utils/guc.h"
 
+/*
+ * Write the variable-length items of Dense_Enhanced blocks with a dictionary
+ * when that is smaller.
+ */
+bool		gp_aocs_dictionary_encoding = true;
+
+/*
+ * Dictionary built by DatumStreamBlockWrite_DictBuild for the block being
+ * written.
+ */
+typedef struct DatumStreamDictItem
+{
+	uint32		hash;
+	int32		offset;			/* offset of the first copy in datum buffer */
+	int32		size;
+}	DatumStreamDictItem;
+
+typedef struct DatumStreamDictWrite
+{
+	int32		count;
+	int32		size;			/* bytes of the items, including padding */
+	int32		code_bits;
+	int32		codes_size;
+
+	DatumStreamDictItem *items;
+	uint16	   *codes;			/* code of each physical datum */
+}	DatumStreamDictWrite;
+
 /*	Forwards. */
 static char *VarlenaInfoToBuffer(char *buffer, uint8 * p);
 
@@ -409,13 +438,20 @@ DatumStreamBlockRead_Init(
 	Assert(dsr->delta_block_was_compressed == false);
 	Assert(dsr->delta_item == false);
 
+	Assert(!dsr->dict_block_was_encoded);
+	Assert(dsr->dict_entries == NULL);
 }
 
 void
 DatumStreamBlockRead_Finish(
 							DatumStreamBlockRead * dsr)
 {
-	/* Place holder. */
+	if (dsr->dict_entries != NULL)
+	{
+		pfree(dsr->dict_entries);
+		dsr->dict_entries = NULL;
+		dsr->dict_entries_maxcount = 0;
+	}
 }
 
 /*
@@ -621,6 +657,89 @@ DatumStreamBlockRead_ResetDense(DatumStreamBlockRead * dsr)
 
 	dsr->delta_block_was_compressed = false;
 	dsr->delta_item = false;
+
+	dsr->dict_block_was_encoded = false;
+	dsr->dict_codesp = NULL;
+	dsr->dict_code_bits = 0;
+	dsr->dict_count = 0;
+	dsr->dict_size = 0;
+}
+
+/*
+ * Set up the dictionary of a dictionary encoded Dense block: find where each
+ * dictionary item begins and position on the first physical datum.
+ */
+static void
+DatumStreamBlockRead_GetReadyDict(DatumStreamBlockRead * dsr)
+{
+	static uint64 lastDictGeneration = 0;
+	uint8	   *p;
+	uint8	   *dictAfterp;
+	int64		codesSize;
+	int32		i;
+
+	codesSize = ((int64) dsr->physical_datum_count * dsr->dict_code_bits + 7) / 8;
+	if ((dsr->dict_code_bits != 1 && dsr->dict_code_bits != 2 &&
+		 dsr->dict_code_bits != 4 && dsr->dict_code_bits != 8 &&
+		 dsr->dict_code_bits != 16) ||
+		dsr->dict_count <= 0 ||
+		dsr->dict_count > (1 << dsr->dict_code_bits) ||
+		dsr->dict_size <= 0 ||
+		dsr->dict_size + codesSize != dsr->physical_data_size)
+	{
+		ereport(ERROR,
+				(errmsg("Bad datum stream Dense block dictionary "
+						"(dictionary count %d, dictionary size %d, code bits %d, "
+						"physical datum count %d, physical data size %d)",
+						dsr->dict_count,
+						dsr->dict_size,
+						dsr->dict_code_bits,
+						dsr->physical_datum_count,
+						dsr->physical_data_size),
+				 errdetail_datumstreamblockread(dsr),
+				 errcontext_datumstreamblockread(dsr)));
+	}
+
+	if (dsr->dict_count > dsr->dict_entries_maxcount)
+	{
+		if (dsr->dict_entries != NULL)
+			pfree(dsr->dict_entries);
+		dsr->dict_entries_maxcount = Max(dsr->dict_count, 256);
+		dsr->dict_entries = MemoryContextAlloc(dsr->memctxt,
+											   dsr->dict_entries_maxcount * sizeof(uint8 *));
+	}
+
+	/*
+	 * The dictionary items are laid out like the items of a block without
+	 * dictionary, see DatumStreamBlockRead_AdvanceDense.
+	 */
+	p = dsr->datum_beginp;
+	dictAfterp = dsr->datum_beginp + dsr->dict_size;
+	for (i = 0; i < dsr->dict_count; i++)
+	{
+		if (i > 0 && *p == 0)
+			p = (uint8 *) att_align_nominal(p, dsr->typeInfo.align);
+		if (p >= dictAfterp || p + VARSIZE_ANY(p) > dictAfterp)
+		{
+			ereport(ERROR,
+					(errmsg("Datum stream block dictionary item %d out of bounds "
+							"(dictionary count %d, dictionary size %d, item offset " INT64_FORMAT ")",
+							i,
+							dsr->dict_count,
+							dsr->dict_size,
+							(int64) (p - dsr->datum_beginp)),
+					 errdetail_datumstreamblockread(dsr),
+					 errcontext_datumstreamblockread(dsr)));
+		}
+		dsr->dict_entries[i] = p;
+		p += VARSIZE_ANY(p);
+	}
+
+	dsr->dict_codesp = dictAfterp;
+	dsr->dict_generation = ++lastDictGeneration;
+
+	if (dsr->physical_datum_count > 0)
+		dsr->datump = dsr->dict_entries[DatumStreamBlockRead_DictCode(dsr, 0)];
 }
 
 void
@@ -643,6 +762,7 @@ DatumStreamBlockRead_GetReadyDense(
 	DatumStreamBlock_Dense *blockDense;
 	DatumStreamBlock_Rle_Extension *rleExtension;
 	DatumStreamBlock_Delta_Extension *deltaExtension;
+	DatumStreamBlock_Dict_Extension *dictExtension;
 
 	/*
 	 * PERFORMANCE EXPERIMENT: Only do integrity and trace checking for DEBUG
@@ -721,6 +841,22 @@ DatumStreamBlockRead_GetReadyDense(
 		deltaExtension = NULL;
 	}
 
+	/* Dictionary */
+	dsr->dict_block_was_encoded = ((blockDense->orig_4_bytes.flags & DSB_HAS_DICTIONARY) != 0);
+	if (dsr->dict_block_was_encoded)
+	{
+		dictExtension = (DatumStreamBlock_Dict_Extension *) p;
+		p += sizeof(DatumStreamBlock_Dict_Extension);
+
+		dsr->dict_count = dictExtension->dict_count;
+		dsr->dict_size = dictExtension->dict_size;
+		dsr->dict_code_bits = dictExtension->code_bits;
+	}
+	else
+	{
+		dictExtension = NULL;
+	}
+
 	/* Set up acc */
 	dsr->nth = -1;				/* put it before first entry.  Caller will
 								 * advance */
@@ -966,6 +1102,167 @@ DatumStreamBlockRead_GetReadyDense(
 										/* errdetailArg */ (void *) dsr,
 		/* errcontextCallback */ errcontext_datumstreamblockread_callback,
 										/* errcontextArg */ (void *) dsr);
+
+	if (dsr->dict_block_was_encoded)
+		DatumStreamBlockRead_GetReadyDict(dsr);
+}
+
+/*
+ * Advance over the next nrows items of the block and get them, the same as
+ * nrows calls of DatumStreamBlockRead_Advance() each followed by
+ * DatumStreamBlockRead_Get().  The block must have that many items left.
+ *
+ * Dense blocks of fixed-width pass-by-value types are decoded a run at a
+ * time: stretches of physically stored values are widened into Datums in
+ * bulk, the copies of an RLE_TYPE repeated item are expanded at once, and
+ * Delta Range values are summed up in a tight loop.  Everything else, and
+ * the items between repeated items, go through the per-item routines.
+ */
+void
+DatumStreamBlockRead_GetBatch(DatumStreamBlockRead * dsr,
+							  Datum *values,
+							  bool *nulls,
+							  int nrows)
+{
+	int32		datumlen = dsr->typeInfo.datumlen;
+	int			i = 0;
+
+	Assert(dsr->nth + nrows < dsr->logical_row_count);
+
+	if (dsr->datumStreamVersion == DatumStreamVersion_Original ||
+		!dsr->typeInfo.byval ||
+		(datumlen != 2 && datumlen != 4 && datumlen != sizeof(Datum)))
+	{
+		for (; i < nrows; i++)
+		{
+			int			advanced PG_USED_FOR_ASSERTS_ONLY;
+
+			advanced = DatumStreamBlockRead_Advance(dsr);
+			Assert(advanced);
+			DatumStreamBlockRead_Get(dsr, &values[i], &nulls[i]);
+		}
+		return;
+	}
+
+	while (i < nrows)
+	{
+		int			n;
+
+		if (dsr->rle_block_was_compressed && dsr->rle_in_repeated_item)
+		{
+			Datum		value = 0;
+			bool		isnull PG_USED_FOR_ASSERTS_ONLY;
+
+			/*
+			 * The remaining copies of the repeated item we are positioned on.
+			 * A repeated item is never NULL.
+			 */
+			DatumStreamBlockRead_Get(dsr, &value, &isnull);
+			Assert(!isnull);
+
+			n = Min(dsr->rle_repeated_item_count, nrows - i);
+			DatumStreamDecode_Fill(&values[i], value, n);
+			memset(&nulls[i], false, n);
+
+			dsr->nth += n;
+			dsr->rle_repeated_item_count -= n;
+			dsr->rle_total_repeat_items_read += n;
+			if (dsr->rle_repeated_item_count <= 0)
+				dsr->rle_in_repeated_item = false;
+		}
+		else if (!dsr->rle_block_was_compressed && !dsr->has_null &&
+				 !dsr->delta_block_was_compressed)
+		{
+			uint8	   *p;
+
+			/*
+			 * Every remaining item is stored physically, one after another.
+			 */
+			n = nrows - i;
+			p = (dsr->physical_datum_index == -1) ?
+				dsr->datump : dsr->datump + datumlen;
+			Assert(p + n * datumlen <= dsr->datum_afterp);
+
+			if (datumlen == 2)
+				DatumStreamDecode_Widen16(&values[i], p, n);
+			else if (datumlen == 4)
+				DatumStreamDecode_Widen32(&values[i], p, n);
+			else
+				memcpy(&values[i], p, n * sizeof(Datum));
+			memset(&nulls[i], false, n);
+
+			dsr->nth += n;
+			dsr->physical_datum_index += n;
+			dsr->datump = p + (n - 1) * datumlen;
+		}
+		else if (!dsr->rle_block_was_compressed && !dsr->has_null &&
+				 datumlen >= 4)
+		{
+			/*
+			 * Every remaining item is either stored physically or as a delta
+			 * from the item before it.
+			 */
+			n = nrows - i;
+			for (int j = i; j < i + n; j++)
+			{
+				DatumStreamBitMapRead_Next(&dsr->delta_bitmap);
+				if (DatumStreamBitMapRead_CurrentIsOn(&dsr->delta_bitmap))
+				{
+					int64		delta;
+					bool		sign;
+					int32		byteLen;
+
+					delta = DatumStreamInt32CompressReserved3_Decode(dsr->delta_deltasp, &byteLen, &sign);
+					dsr->delta_deltasp += byteLen;
+
+					if (datumlen == 4)
+					{
+						if (sign)
+							*(uint32 *) (&dsr->delta_datum_p) += delta;
+						else
+							*(uint32 *) (&dsr->delta_datum_p) -= delta;
+						values[j] = (uint32) dsr->delta_datum_p;
+					}
+					else
+					{
+						if (sign)
+							dsr->delta_datum_p += delta;
+						else
+							dsr->delta_datum_p -= delta;
+						values[j] = dsr->delta_datum_p;
+					}
+					dsr->delta_item = true;
+				}
+				else
+				{
+					if (dsr->physical_datum_index != -1)
+						dsr->datump += datumlen;
+					dsr->physical_datum_index++;
+					Assert(dsr->datump < dsr->datum_afterp);
+
+					memcpy(&dsr->delta_datum_p, dsr->datump, datumlen);
+					if (datumlen == 4)
+						values[j] = *(uint32 *) dsr->datump;
+					else
+						values[j] = *(Datum *) dsr->datump;
+					dsr->delta_item = false;
+				}
+				nulls[j] = false;
+			}
+			dsr->nth += n;
+		}
+		else
+		{
+			int			advanced PG_USED_FOR_ASSERTS_ONLY;
+
+			n = 1;
+			advanced = DatumStreamBlockRead_Advance(dsr);
+			Assert(advanced);
+			DatumStreamBlockRead_Get(dsr, &values[i], &nulls[i]);
+		}
+
+		i += n;
+	}
 }
 
 static int
@@ -3797,6 +4094,173 @@ DatumStreamBlockWrite_BlockOrig(
 	return writesz;
 }
 
+/*
+ * Find the distinct items among the physical datums of the block.  Returns
+ * false if there are too many of them, or a dictionary would not make the
+ * block smaller.
+ *
+ * Items are compared by their stored bytes, so this only relies on equal
+ * values being stored alike, not on the type's equality.
+ */
+static bool
+DatumStreamBlockWrite_DictBuild(
+								DatumStreamBlockWrite * dsw,
+								DatumStreamDictWrite * dict)
+{
+	int32		count = dsw->physical_datum_count;
+	int32		maxItems;
+	int32		slotCount;
+	int32	   *slots;			/* item index + 1, 0 if empty */
+	uint8	   *p;
+	int32		i;
+
+	if (!dsw->dict_want_encoding || count < 2)
+		return false;
+
+	/*
+	 * Give up as soon as more than half of the items are distinct; the
+	 * dictionary would hardly pay for its codes.
+	 */
+	maxItems = Min(count / 2, MAXDICTIONARY_COUNT);
+
+	slotCount = 2;
+	while (slotCount < 2 * maxItems)
+		slotCount <<= 1;
+
+	slots = palloc0(slotCount * sizeof(int32));
+	dict->items = palloc(maxItems * sizeof(DatumStreamDictItem));
+	dict->codes = palloc(count * sizeof(uint16));
+	dict->count = 0;
+	dict->size = 0;
+
+	/*
+	 * Walk the items the way DatumStreamBlockRead_AdvanceDense does.
+	 */
+	p = dsw->datum_buffer;
+	for (i = 0; i < count; i++)
+	{
+		int32		size;
+		uint32		hash;
+		int32		slot;
+
+		if (i > 0 && *p == 0)
+			p = (uint8 *) att_align_nominal(p, dsw->typeInfo->align);
+		Assert(p < dsw->datump);
+
+		size = VARSIZE_ANY(p);
+		hash = hash_bytes(p, size);
+
+		for (slot = hash & (slotCount - 1);; slot = (slot + 1) & (slotCount - 1))
+		{
+			DatumStreamDictItem *item;
+
+			if (slots[slot] == 0)
+			{
+				if (dict->count >= maxItems)
+				{
+					pfree(slots);
+					pfree(dict->items);
+					pfree(dict->codes);
+					return false;
+				}
+
+				item = &dict->items[dict->count];
+				item->hash = hash;
+				item->offset = p - dsw->datum_buffer;
+				item->size = size;
+
+				/* Same alignment as DatumStreamBlockWrite_PutDense */
+				if (!VARATT_IS_SHORT(p))
+					dict->size = att_align_nominal(dict->size, dsw->typeInfo->align);
+				dict->size += size;
+
+				slots[slot] = ++dict->count;
+				break;
+			}
+
+			item = &dict->items[slots[slot] - 1];
+			if (item->hash == hash && item->size == size &&
+				memcmp(dsw->datum_buffer + item->offset, p, size) == 0)
+				break;
+		}
+		dict->codes[i] = slots[slot] - 1;
+
+		p += size;
+	}
+	pfree(slots);
+
+	dict->code_bits = 1;
+	while ((1 << dict->code_bits) < dict->count)
+		dict->code_bits *= 2;
+	dict->codes_size = (count * dict->code_bits + 7) / 8;
+
+	if (sizeof(DatumStreamBlock_Dict_Extension) + dict->size + dict->codes_size >=
+		dsw->datump - dsw->datum_buffer)
+	{
+		pfree(dict->items);
+		pfree(dict->codes);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Write the dictionary and the codes as the datum area of the block.
+ * Returns the size written.
+ */
+static int32
+DatumStreamBlockWrite_DictFormat(
+								 DatumStreamBlockWrite * dsw,
+								 DatumStreamDictWrite * dict,
+								 uint8 * buffer)
+{
+	uint8	   *p = buffer;
+	int32		i;
+
+	for (i = 0; i < dict->count; i++)
+	{
+		DatumStreamDictItem *item = &dict->items[i];
+		uint8	   *itemp = dsw->datum_buffer + item->offset;
+
+		if (!VARATT_IS_SHORT(itemp))
+		{
+			uint8	   *alignedp;
+
+			alignedp = buffer + att_align_nominal(p - buffer, dsw->typeInfo->align);
+			while (p < alignedp)
+				*(p++) = 0;
+		}
+		memcpy(p, itemp, item->size);
+		p += item->size;
+	}
+	Assert(p - buffer == dict->size);
+
+	memset(p, 0, dict->codes_size);
+	for (i = 0; i < dsw->physical_datum_count; i++)
+	{
+		int32		code = dict->codes[i];
+
+		if (dict->code_bits == 16)
+		{
+			p[2 * i] = code & 0xFF;
+			p[2 * i + 1] = code >> 8;
+		}
+		else
+		{
+			int32		bit = i * dict->code_bits;
+
+			p[bit >> 3] |= code << (bit & 7);
+		}
+	}
+	p += dict->codes_size;
+
+	pfree(dict->items);
+	pfree(dict->codes);
+
+	return p - buffer;
+}
+
 static int64
 DatumStreamBlockWrite_BlockDense(
 								 DatumStreamBlockWrite * dsw,
@@ -3808,6 +4272,9 @@ DatumStreamBlockWrite_BlockDense(
 	DatumStreamBlock_Dense dense;
 	DatumStreamBlock_Rle_Extension rle_extension;
 	DatumStreamBlock_Delta_Extension delta_extension;
+	DatumStreamBlock_Dict_Extension dict_extension;
+	DatumStreamDictWrite dict = {0};
+	bool		dict_has_encoding;
 	int32		headerSize;
 	int32		nullSize;
 	int32		rleSize;
@@ -3955,6 +4422,26 @@ DatumStreamBlockWrite_BlockDense(
 		deltaSize = 0;
 	}
 
+	/*
+	 * Replace the variable-length items with a dictionary and codes, if that
+	 * is smaller.
+	 */
+	dict_has_encoding = DatumStreamBlockWrite_DictBuild(dsw, &dict);
+	if (dict_has_encoding)
+	{
+		headerSize += sizeof(DatumStreamBlock_Dict_Extension);
+
+		dense.orig_4_bytes.flags |= DSB_HAS_DICTIONARY;
+
+		dict_extension.dict_count = dict.count;
+		dict_extension.dict_size = dict.size;
+		dict_extension.code_bits = dict.code_bits;
+
+		dsw->savings += dense.physical_data_size -
+			(sizeof(DatumStreamBlock_Dict_Extension) + dict.size + dict.codes_size);
+		dense.physical_data_size = dict.size + dict.codes_size;
+	}
+
 	/*
 	 * Align headers and meta-data (e.g. NULL bit-maps, etc).
 	 */
@@ -3976,6 +4463,12 @@ DatumStreamBlockWrite_BlockDense(
 		p += sizeof(DatumStreamBlock_Delta_Extension);
 	}
 
+	if (dict_has_encoding)
+	{
+		memcpy(p, &dict_extension, sizeof(DatumStreamBlock_Dict_Extension));
+		p += sizeof(DatumStreamBlock_Dict_Extension);
+	}
+
 	if (dsw->has_null)
 	{
 		memcpy(p, dsw->null_bitmap_buffer, DatumStreamBitMapWrite_Size(&dsw->null_bitmap));
@@ -4080,8 +4573,13 @@ DatumStreamBlockWrite_BlockDense(
 				 errcontext_datumstreamblockwrite(dsw)));
 	}
 
-	memcpy(p, dsw->datum_buffer, dense.physical_data_size);
-	p += dense.physical_data_size;
+	if (dict_has_encoding)
+		p += DatumStreamBlockWrite_DictFormat(dsw, &dict, p);
+	else
+	{
+		memcpy(p, dsw->datum_buffer, dense.physical_data_size);
+		p += dense.physical_data_size;
+	}
 
 	/* Calculate write size. */
 	writesz = p - buffer;
@@ -4297,6 +4795,14 @@ DatumStreamBlockWrite_Init(
 	dsw->rle_want_compression = rle_want_compression;
 	dsw->delta_want_compression = delta_want_compression;
 
+	/*
+	 * Only blocks of the version with RLE_TYPE compression can carry a
+	 * dictionary, so that older blocks read the same as before.
+	 */
+	dsw->dict_want_encoding = (gp_aocs_dictionary_encoding &&
+							   datumStreamVersion == DatumStreamVersion_Dense_Enhanced &&
+							   typeInfo->datumlen == -1);
+
 	dsw->initialMaxDatumPerBlock = initialMaxDatumPerBlock;
 	dsw->maxDatumPerBlock = maxDatumPerBlock;
 
@@ -4922,6 +5428,93 @@ DatumStreamBlock_IntegrityCheckDenseDelta(
 	}
 }
 
+/*
+ * Verify the dictionary and the codes of a dictionary encoded Dense block.
+ */
+static void
+DatumStreamBlock_IntegrityCheckDict(
+									DatumStreamBlock_Dict_Extension * dictExtension,
+									uint8 * physicalData,
+									int32 physicalDataSize,
+									int32 physicalDatumCount,
+									DatumStreamVersion datumStreamVersion,
+									DatumStreamTypeInfo * typeInfo,
+							   int (*errdetailCallback) (void *errdetailArg),
+									void *errdetailArg,
+							 int (*errcontextCallback) (void *errcontextArg),
+									void *errcontextArg)
+{
+	int32		codeBits = dictExtension->code_bits;
+	int64		codesSize;
+	int32		dictCount;
+	uint8	   *codesp;
+	int32		i;
+
+	if (codeBits != 1 && codeBits != 2 && codeBits != 4 && codeBits != 8 &&
+		codeBits != 16)
+	{
+		ereport(ERROR,
+				(errmsg("Bad datum stream DICTIONARY code bits %d", codeBits),
+				 errdetailCallback(errdetailArg),
+				 errcontextCallback(errcontextArg)));
+	}
+
+	codesSize = ((int64) physicalDatumCount * codeBits + 7) / 8;
+	if (dictExtension->dict_size <= 0 ||
+		dictExtension->dict_size + codesSize != physicalDataSize)
+	{
+		ereport(ERROR,
+				(errmsg("Bad datum stream DICTIONARY size %d with codes size " INT64_FORMAT " (physical data size %d)",
+						dictExtension->dict_size,
+						codesSize,
+						physicalDataSize),
+				 errdetailCallback(errdetailArg),
+				 errcontextCallback(errcontextArg)));
+	}
+
+	/* Returns the index of the last item */
+	dictCount = 1 + DatumStreamBlock_IntegrityCheckVarlena(
+														   physicalData,
+														   dictExtension->dict_size,
+														   datumStreamVersion,
+														   typeInfo,
+														   errdetailCallback,
+														   errdetailArg,
+														   errcontextCallback,
+														   errcontextArg);
+	if (dictCount != dictExtension->dict_count)
+	{
+		ereport(ERROR,
+				(errmsg("Bad datum stream DICTIONARY count.  Found %d, expected %d",
+						dictCount,
+						dictExtension->dict_count),
+				 errdetailCallback(errdetailArg),
+				 errcontextCallback(errcontextArg)));
+	}
+
+	codesp = physicalData + dictExtension->dict_size;
+	for (i = 0; i < physicalDatumCount; i++)
+	{
+		int32		code;
+
+		if (codeBits == 16)
+			code = codesp[2 * i] | (codesp[2 * i + 1] << 8);
+		else
+			code = (codesp[(i * codeBits) >> 3] >> ((i * codeBits) & 7)) & ((1 << codeBits) - 1);
+
+		if (code >= dictCount)
+		{
+			ereport(ERROR,
+					(errmsg("Bad datum stream DICTIONARY code %d of physical item index #%d (dictionary count %d)",
+							code,
+							i,
+							dictCount),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+	}
+}
+
 static void
 DatumStreamBlock_IntegrityCheckDense(
 									 uint8 * buffer,
@@ -4944,14 +5537,17 @@ DatumStreamBlock_IntegrityCheckDense(
 	bool		hasNull;
 	bool		hasRleCompression;
 	bool		hasDeltaCompression;
+	bool		hasDictionary;
 
 	int32		alignedHeaderSize;
 	int32		deltaOnCount;
 	DatumStreamBlock_Delta_Extension *deltaExtension;
 	DatumStreamBlock_Rle_Extension *rleExtension;
+	DatumStreamBlock_Dict_Extension *dictExtension;
 
 	deltaExtension = NULL;
 	rleExtension = NULL;
+	dictExtension = NULL;
 
 	alignedHeaderSize = 0;
 
@@ -4990,6 +5586,16 @@ DatumStreamBlock_IntegrityCheckDense(
 	hasNull = ((blockDense->orig_4_bytes.flags & DSB_HAS_NULLBITMAP) != 0);
 	hasRleCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_RLE_COMPRESSION) != 0);
 	hasDeltaCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_DELTA_COMPRESSION) != 0);
+	hasDictionary = ((blockDense->orig_4_bytes.flags & DSB_HAS_DICTIONARY) != 0);
+
+	if (hasDictionary && typeInfo->datumlen != -1)
+	{
+		ereport(ERROR,
+				(errmsg("Datum stream Dense block has a dictionary but the items are not variable-length (length %d)",
+						typeInfo->datumlen),
+				 errdetailCallback(errdetailArg),
+				 errcontextCallback(errcontextArg)));
+	}
 
 	/*
 	 * Verify logical row count.
@@ -5066,8 +5672,10 @@ DatumStreamBlock_IntegrityCheckDense(
 
 		/*
 		 * This check will make it safer to do multiplication of datum count and datum length.
+		 * Dictionary codes can take less than a byte per item.
 		 */
-		if (blockDense->physical_datum_count > blockDense->physical_data_size)
+		if (!hasDictionary &&
+			blockDense->physical_datum_count > blockDense->physical_data_size)
 		{
 			ereport(ERROR,
 					(errmsg("More physical items %d than physical bytes %d",
@@ -5139,6 +5747,24 @@ DatumStreamBlock_IntegrityCheckDense(
 		{
 			deltaOnCount = 0;
 		}
+
+		if (hasDictionary)
+		{
+			headerSize += sizeof(DatumStreamBlock_Dict_Extension);
+
+			if (bufferSize < headerSize)
+			{
+				ereport(ERROR,
+						(errmsg("Bad datum stream DICTIONARY block header extension size. Found %d and expected the size to be at least %d",
+								bufferSize,
+								headerSize),
+						 errdetailCallback(errdetailArg),
+						 errcontextCallback(errcontextArg)));
+			}
+
+			dictExtension = (DatumStreamBlock_Dict_Extension *) p;
+			p += sizeof(DatumStreamBlock_Dict_Extension);
+		}
 		total_datum_count = blockDense->physical_datum_count + deltaOnCount;
 
 		if (!hasNull)
@@ -5314,6 +5940,24 @@ DatumStreamBlock_IntegrityCheckDense(
 			p += sizeof(DatumStreamBlock_Delta_Extension);
 		}
 
+		if (hasDictionary)
+		{
+			headerSize += sizeof(DatumStreamBlock_Dict_Extension);
+
+			if (bufferSize < headerSize)
+			{
+				ereport(ERROR,
+						(errmsg("Bad datum stream RLE_TYPE DICTIONARY block header extension size. Found %d and expected the size to be at least %d",
+								bufferSize,
+								headerSize),
+						 errdetailCallback(errdetailArg),
+						 errcontextCallback(errcontextArg)));
+			}
+
+			dictExtension = (DatumStreamBlock_Dict_Extension *) p;
+			p += sizeof(DatumStreamBlock_Dict_Extension);
+		}
+
 		if (!hasNull)
 		{
 			actualNullOnCount = 0;
@@ -5478,7 +6122,21 @@ DatumStreamBlock_IntegrityCheckDense(
 												  errcontextArg);
 	}
 
-	if (typeInfo->datumlen == -1)
+	if (hasDictionary)
+	{
+		DatumStreamBlock_IntegrityCheckDict(
+											dictExtension,
+											buffer + alignedHeaderSize,
+											blockDense->physical_data_size,
+											blockDense->physical_datum_count,
+											blockDense->orig_4_bytes.version,
+											typeInfo,
+											errdetailCallback,
+											errdetailArg,
+											errcontextCallback,
+											errcontextArg);
+	}
+	else if (typeInfo->datumlen == -1)
 	{
 		/*
 		 * Variable-length items.
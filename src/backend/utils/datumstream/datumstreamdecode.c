@@ -0,0 +1,271 @@
+/*-------------------------------------------------------------------------
+ *
+ * datumstreamdecode.c
+ *	  Bulk decoding kernels for fixed-width datum stream values.
+ *
+ * DatumStreamBlockRead_GetBatch() hands runs of fixed-width values to the
+ * routines here: a stretch of physically stored int2/int4 values is widened
+ * into Datums, and an RLE_TYPE repeated item is expanded into a run of equal
+ * Datums.  On x86_64 the AVX2 or SSE4.2 implementation is chosen at runtime
+ * with the cpuid instruction, like pg_comp_crc32c; everywhere else, and on
+ * CPUs without these extensions, plain C loops are used.
+ *
+ * Portions Copyright (c) 2023-Present, Cloudberry inc
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/utils/datumstream/datumstreamdecode.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#if defined(__x86_64__) && defined(__GNUC__) && defined(HAVE__GET_CPUID)
+#define USE_DATUMSTREAM_SIMD 1
+#endif
+
+#ifdef USE_DATUMSTREAM_SIMD
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#include "utils/datumstreamblock.h"
+
+static void DatumStreamDecode_Widen16_scalar(Datum *dst, const uint8 *src, int count);
+static void DatumStreamDecode_Widen32_scalar(Datum *dst, const uint8 *src, int count);
+static void DatumStreamDecode_Fill_scalar(Datum *dst, Datum value, int count);
+
+#ifdef USE_DATUMSTREAM_SIMD
+static void DatumStreamDecode_Widen16_choose(Datum *dst, const uint8 *src, int count);
+static void DatumStreamDecode_Widen32_choose(Datum *dst, const uint8 *src, int count);
+static void DatumStreamDecode_Fill_choose(Datum *dst, Datum value, int count);
+
+void		(*DatumStreamDecode_Widen16) (Datum *dst, const uint8 *src, int count) = DatumStreamDecode_Widen16_choose;
+void		(*DatumStreamDecode_Widen32) (Datum *dst, const uint8 *src, int count) = DatumStreamDecode_Widen32_choose;
+void		(*DatumStreamDecode_Fill) (Datum *dst, Datum value, int count) = DatumStreamDecode_Fill_choose;
+#else
+void		(*DatumStreamDecode_Widen16) (Datum *dst, const uint8 *src, int count) = DatumStreamDecode_Widen16_scalar;
+void		(*DatumStreamDecode_Widen32) (Datum *dst, const uint8 *src, int count) = DatumStreamDecode_Widen32_scalar;
+void		(*DatumStreamDecode_Fill) (Datum *dst, Datum value, int count) = DatumStreamDecode_Fill_scalar;
+#endif							/* USE_DATUMSTREAM_SIMD */
+
+/*
+ * The values are zero extended, the same as DatumStreamBlockRead_Get() does.
+ * The source is only guaranteed to be aligned to the width of the values.
+ */
+static void
+DatumStreamDecode_Widen16_scalar(Datum *dst, const uint8 *src, int count)
+{
+	const uint16 *s = (const uint16 *) src;
+
+	for (int i = 0; i < count; i++)
+		dst[i] = (Datum) s[i];
+}
+
+static void
+DatumStreamDecode_Widen32_scalar(Datum *dst, const uint8 *src, int count)
+{
+	const uint32 *s = (const uint32 *) src;
+
+	for (int i = 0; i < count; i++)
+		dst[i] = (Datum) s[i];
+}
+
+static void
+DatumStreamDecode_Fill_scalar(Datum *dst, Datum value, int count)
+{
+	for (int i = 0; i < count; i++)
+		dst[i] = value;
+}
+
+#ifdef USE_DATUMSTREAM_SIMD
+
+/*
+ * AVX2 versions, four Datums per instruction.
+ */
+__attribute__((target("avx2")))
+static void
+DatumStreamDecode_Widen16_avx2(Datum *dst, const uint8 *src, int count)
+{
+	int			i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i		v = _mm_loadl_epi64((const __m128i *) (src + i * sizeof(uint16)));
+
+		_mm256_storeu_si256((__m256i *) (dst + i), _mm256_cvtepu16_epi64(v));
+	}
+	DatumStreamDecode_Widen16_scalar(dst + i, src + i * sizeof(uint16), count - i);
+}
+
+__attribute__((target("avx2")))
+static void
+DatumStreamDecode_Widen32_avx2(Datum *dst, const uint8 *src, int count)
+{
+	int			i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i		lo = _mm_loadu_si128((const __m128i *) (src + i * sizeof(uint32)));
+		__m128i		hi = _mm_loadu_si128((const __m128i *) (src + (i + 4) * sizeof(uint32)));
+
+		_mm256_storeu_si256((__m256i *) (dst + i), _mm256_cvtepu32_epi64(lo));
+		_mm256_storeu_si256((__m256i *) (dst + i + 4), _mm256_cvtepu32_epi64(hi));
+	}
+	DatumStreamDecode_Widen32_scalar(dst + i, src + i * sizeof(uint32), count - i);
+}
+
+__attribute__((target("avx2")))
+static void
+DatumStreamDecode_Fill_avx2(Datum *dst, Datum value, int count)
+{
+	__m256i		v = _mm256_set1_epi64x((int64) value);
+	int			i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_si256((__m256i *) (dst + i), v);
+		_mm256_storeu_si256((__m256i *) (dst + i + 4), v);
+	}
+	DatumStreamDecode_Fill_scalar(dst + i, value, count - i);
+}
+
+/*
+ * SSE4.2 versions, two Datums per instruction.  (The zero extending loads
+ * are SSE4.1, which every SSE4.2 CPU has.)
+ */
+__attribute__((target("sse4.2")))
+static void
+DatumStreamDecode_Widen16_sse42(Datum *dst, const uint8 *src, int count)
+{
+	int			i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i		v = _mm_loadl_epi64((const __m128i *) (src + i * sizeof(uint16)));
+
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_cvtepu16_epi64(v));
+		_mm_storeu_si128((__m128i *) (dst + i + 2), _mm_cvtepu16_epi64(_mm_srli_si128(v, 4)));
+	}
+	DatumStreamDecode_Widen16_scalar(dst + i, src + i * sizeof(uint16), count - i);
+}
+
+__attribute__((target("sse4.2")))
+static void
+DatumStreamDecode_Widen32_sse42(Datum *dst, const uint8 *src, int count)
+{
+	int			i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i		v = _mm_loadu_si128((const __m128i *) (src + i * sizeof(uint32)));
+
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_cvtepu32_epi64(v));
+		_mm_storeu_si128((__m128i *) (dst + i + 2), _mm_cvtepu32_epi64(_mm_srli_si128(v, 8)));
+	}
+	DatumStreamDecode_Widen32_scalar(dst + i, src + i * sizeof(uint32), count - i);
+}
+
+__attribute__((target("sse4.2")))
+static void
+DatumStreamDecode_Fill_sse42(Datum *dst, Datum value, int count)
+{
+	__m128i		v = _mm_set1_epi64x((int64) value);
+	int			i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_si128((__m128i *) (dst + i), v);
+		_mm_storeu_si128((__m128i *) (dst + i + 2), v);
+	}
+	DatumStreamDecode_Fill_scalar(dst + i, value, count - i);
+}
+
+/*
+ * Return true if both the CPU and the OS support AVX2.  The OS has to save
+ * the YMM registers on context switches, which XGETBV tells.
+ */
+static bool
+DatumStreamDecode_avx2_available(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+	uint32		xcr0_lo;
+	uint32		xcr0_hi;
+
+	__get_cpuid(1, &exx[0], &exx[1], &exx[2], &exx[3]);
+	if ((exx[2] & (1 << 27)) == 0)	/* OSXSAVE */
+		return false;
+
+	__asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+	if ((xcr0_lo & 0x6) != 0x6)		/* XMM and YMM state */
+		return false;
+
+	if (__get_cpuid_max(0, NULL) < 7)
+		return false;
+	__cpuid_count(7, 0, exx[0], exx[1], exx[2], exx[3]);
+
+	return (exx[1] & (1 << 5)) != 0;	/* AVX2 */
+}
+
+static bool
+DatumStreamDecode_sse42_available(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+
+	__get_cpuid(1, &exx[0], &exx[1], &exx[2], &exx[3]);
+
+	return (exx[2] & (1 << 20)) != 0;	/* SSE 4.2 */
+}
+
+/*
+ * Pick the implementations for this CPU and replace the function pointers,
+ * so that subsequent calls are routed directly to the chosen implementation.
+ */
+static void
+DatumStreamDecode_Choose(void)
+{
+	if (DatumStreamDecode_avx2_available())
+	{
+		DatumStreamDecode_Widen16 = DatumStreamDecode_Widen16_avx2;
+		DatumStreamDecode_Widen32 = DatumStreamDecode_Widen32_avx2;
+		DatumStreamDecode_Fill = DatumStreamDecode_Fill_avx2;
+	}
+	else if (DatumStreamDecode_sse42_available())
+	{
+		DatumStreamDecode_Widen16 = DatumStreamDecode_Widen16_sse42;
+		DatumStreamDecode_Widen32 = DatumStreamDecode_Widen32_sse42;
+		DatumStreamDecode_Fill = DatumStreamDecode_Fill_sse42;
+	}
+	else
+	{
+		DatumStreamDecode_Widen16 = DatumStreamDecode_Widen16_scalar;
+		DatumStreamDecode_Widen32 = DatumStreamDecode_Widen32_scalar;
+		DatumStreamDecode_Fill = DatumStreamDecode_Fill_scalar;
+	}
+}
+
+/*
+ * These get called on the first call to the corresponding routine.
+ */
+static void
+DatumStreamDecode_Widen16_choose(Datum *dst, const uint8 *src, int count)
+{
+	DatumStreamDecode_Choose();
+	DatumStreamDecode_Widen16(dst, src, count);
+}
+
+static void
+DatumStreamDecode_Widen32_choose(Datum *dst, const uint8 *src, int count)
+{
+	DatumStreamDecode_Choose();
+	DatumStreamDecode_Widen32(dst, src, count);
+}
+
+static void
+DatumStreamDecode_Fill_choose(Datum *dst, Datum value, int count)
+{
+	DatumStreamDecode_Choose();
+	DatumStreamDecode_Fill(dst, value, count);
+}
+
+#endif							/* USE_DATUMSTREAM_SIMD */
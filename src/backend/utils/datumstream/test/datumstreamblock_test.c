@@ -5,6 +5,9 @@
 
 #include "../datumstreamblock.c"
 
+#include "catalog/pg_type.h"
+#include "utils/memutils.h"
+
 /* 
  * Unit test function to test the routines added for
  * Delta Compression
@@ -166,13 +169,159 @@ test__DeltaCompression__Core(void **state)
 	free(dsw);
 }
 
+#define DICT_TEST_ROWS 800
+
+/*
+ * Text value of row i, one of ndistinct values.  Every third value is too
+ * long for a short varlena header, so it is stored aligned.
+ */
+static text *
+dict_test_value(int i, int ndistinct, bool *isnull)
+{
+	int			k = (i * 7) % ndistinct;
+	int			len = (k % 3 == 0) ? 130 + k % 20 : 4 + k % 5;
+	text	   *t = palloc(VARHDRSZ + len);
+
+	*isnull = (i % 17 == 5);
+
+	SET_VARSIZE(t, VARHDRSZ + len);
+	VARDATA(t)[0] = '0' + k / 1000;
+	VARDATA(t)[1] = '0' + k / 100 % 10;
+	VARDATA(t)[2] = '0' + k / 10 % 10;
+	VARDATA(t)[3] = '0' + k % 10;
+	for (int j = 4; j < len; j++)
+		VARDATA(t)[j] = 'a' + (k + j) % 26;
+
+	return t;
+}
+
+/*
+ * Write a block of dict_test_value()s and read it back.  Variable-length
+ * items of a block get a dictionary if that is smaller, and read back the
+ * same as without one.
+ */
+static void
+check_dictionary(int ndistinct, bool expectDictionary, int expectCodeBits)
+{
+	DatumStreamTypeInfo typeInfo;
+	DatumStreamBlockWrite dsw;
+	DatumStreamBlockRead dsr;
+	RelFileNode node = {0, 0, 0};
+	uint8	   *buffer;
+	int64		size;
+	bool		hadToAdjustRowCount;
+	int32		adjustedRowCount;
+	int32	   *codes;
+
+	memset(&typeInfo, 0, sizeof(typeInfo));
+	typeInfo.datumlen = -1;
+	typeInfo.typid = TEXTOID;
+	typeInfo.align = 'i';
+	typeInfo.byval = false;
+
+	memset(&dsw, 0, sizeof(dsw));
+	DatumStreamBlockWrite_Init(&dsw, &typeInfo, DatumStreamVersion_Dense_Enhanced,
+							   true, false,
+							   DICT_TEST_ROWS + 1, DICT_TEST_ROWS + 1, 131072,
+							   NULL, NULL, NULL, NULL, &node);
+	DatumStreamBlockWrite_GetReady(&dsw);
+
+	for (int i = 0; i < DICT_TEST_ROWS; i++)
+	{
+		bool		isnull;
+		text	   *t = dict_test_value(i, ndistinct, &isnull);
+		void	   *toFree = NULL;
+
+		assert_true(DatumStreamBlockWrite_Put(&dsw, PointerGetDatum(t), isnull, &toFree) >= 0);
+	}
+
+	buffer = palloc0(131072);
+	size = DatumStreamBlockWrite_Block(&dsw, buffer, &node);
+	DatumStreamBlockWrite_Finish(&dsw);
+
+	assert_int_equal((((DatumStreamBlock_Dense *) buffer)->orig_4_bytes.flags & DSB_HAS_DICTIONARY) != 0,
+					 expectDictionary);
+
+	memset(&dsr, 0, sizeof(dsr));
+	DatumStreamBlockRead_Init(&dsr, &typeInfo, DatumStreamVersion_Dense_Enhanced,
+							  true, NULL, NULL, NULL, NULL);
+	DatumStreamBlockRead_Reset(&dsr);
+	DatumStreamBlockRead_GetReady(&dsr, buffer, size, 1, DICT_TEST_ROWS,
+								  &hadToAdjustRowCount, &adjustedRowCount,
+								  &node);
+	assert_int_equal(dsr.dict_block_was_encoded, expectDictionary);
+	if (expectDictionary)
+		assert_int_equal(dsr.dict_code_bits, expectCodeBits);
+
+	/* equal values must have the same code */
+	codes = palloc(ndistinct * sizeof(int32));
+	for (int k = 0; k < ndistinct; k++)
+		codes[k] = -1;
+
+	for (int i = 0; i < DICT_TEST_ROWS; i++)
+	{
+		bool		expectedNull;
+		text	   *expected = dict_test_value(i, ndistinct, &expectedNull);
+		Datum		d;
+		bool		isnull;
+
+		assert_int_equal(DatumStreamBlockRead_Advance(&dsr), 1);
+		DatumStreamBlockRead_Get(&dsr, &d, &isnull);
+
+		assert_int_equal(isnull, expectedNull);
+		if (isnull)
+			continue;
+		assert_int_equal(VARSIZE_ANY_EXHDR(DatumGetPointer(d)), VARSIZE_ANY_EXHDR(expected));
+		assert_memory_equal(VARDATA_ANY(DatumGetPointer(d)), VARDATA_ANY(expected),
+							VARSIZE_ANY_EXHDR(expected));
+
+		if (expectDictionary)
+		{
+			int			k = (i * 7) % ndistinct;
+			int32		code = DatumStreamBlockRead_DictCode(&dsr, dsr.physical_datum_index);
+
+			assert_true(code >= 0 && code < dsr.dict_count);
+			if (codes[k] == -1)
+				codes[k] = code;
+			assert_int_equal(code, codes[k]);
+		}
+	}
+	assert_int_equal(DatumStreamBlockRead_Advance(&dsr), 0);
+
+	DatumStreamBlockRead_Finish(&dsr);
+}
+
+static void
+test__DatumStreamBlock__Dictionary(void **state)
+{
+	Debug_datumstream_block_write_check_integrity = true;
+	Debug_datumstream_block_read_check_integrity = true;
+
+	check_dictionary(1, true, 1);
+	check_dictionary(2, true, 1);
+	check_dictionary(3, true, 2);
+	check_dictionary(13, true, 4);
+	check_dictionary(200, true, 8);
+	check_dictionary(300, true, 16);
+	/* too many distinct values */
+	check_dictionary(DICT_TEST_ROWS, false, 0);
+
+	gp_aocs_dictionary_encoding = false;
+	check_dictionary(13, false, 0);
+	gp_aocs_dictionary_encoding = true;
+}
+
 int 
 main(int argc, char* argv[]) 
 {
 	cmockery_parse_arguments(argc, argv);
 
 	const UnitTest tests[] = {
-			unit_test(test__DeltaCompression__Core)
+			unit_test(test__DeltaCompression__Core),
+			unit_test(test__DatumStreamBlock__Dictionary)
 	};
+
+	MemoryContextInit();
+
 	return run_tests(tests);
 }
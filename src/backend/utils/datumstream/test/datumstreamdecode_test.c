@@ -0,0 +1,394 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include "cmockery.h"
+
+#include "../datumstreamdecode.c"
+
+#include "catalog/pg_type.h"
+#include "portability/instr_time.h"
+#include "utils/memutils.h"
+
+#define NUM_TEST_ROWS 2000
+
+typedef void (*WidenFunc) (Datum *dst, const uint8 *src, int count);
+typedef void (*FillFunc) (Datum *dst, Datum value, int count);
+
+static int
+test_errcallback(void *arg)
+{
+	return 0;
+}
+
+/*
+ * Compare a kernel against the scalar version for every count up to a few
+ * vector widths, and for a misaligned source.
+ */
+static void
+check_widen(WidenFunc widen, WidenFunc reference, int width)
+{
+	uint8		src[128 * sizeof(uint32) + sizeof(uint32)];
+	Datum		expected[128];
+	Datum		result[128];
+
+	for (int i = 0; i < sizeof(src); i++)
+		src[i] = (uint8) (i * 37 + 255);
+
+	for (int offset = 0; offset <= width; offset += width)
+	{
+		for (int count = 0; count <= 128; count++)
+		{
+			memset(expected, 0x7f, sizeof(expected));
+			memset(result, 0x7f, sizeof(result));
+			reference(expected, src + offset, count);
+			widen(result, src + offset, count);
+			assert_memory_equal(result, expected, sizeof(expected));
+		}
+	}
+}
+
+static void
+check_fill(FillFunc fill)
+{
+	Datum		result[128];
+
+	for (int count = 0; count <= 127; count++)
+	{
+		memset(result, 0, sizeof(result));
+		fill(result, (Datum) INT64CONST(-2), count);
+		for (int i = 0; i < count; i++)
+			assert_true(result[i] == (Datum) INT64CONST(-2));
+		assert_true(result[count] == 0);
+	}
+}
+
+static void
+test__DatumStreamDecode__Kernels(void **state)
+{
+	/* whatever was chosen for this CPU */
+	check_widen(DatumStreamDecode_Widen16, DatumStreamDecode_Widen16_scalar, 2);
+	check_widen(DatumStreamDecode_Widen32, DatumStreamDecode_Widen32_scalar, 4);
+	check_fill(DatumStreamDecode_Fill);
+
+#ifdef USE_DATUMSTREAM_SIMD
+	if (DatumStreamDecode_sse42_available())
+	{
+		check_widen(DatumStreamDecode_Widen16_sse42, DatumStreamDecode_Widen16_scalar, 2);
+		check_widen(DatumStreamDecode_Widen32_sse42, DatumStreamDecode_Widen32_scalar, 4);
+		check_fill(DatumStreamDecode_Fill_sse42);
+	}
+	if (DatumStreamDecode_avx2_available())
+	{
+		check_widen(DatumStreamDecode_Widen16_avx2, DatumStreamDecode_Widen16_scalar, 2);
+		check_widen(DatumStreamDecode_Widen32_avx2, DatumStreamDecode_Widen32_scalar, 4);
+		check_fill(DatumStreamDecode_Fill_avx2);
+	}
+#endif
+}
+
+/*
+ * Value of row i of the test block: repeated values, small steps that delta
+ * compression picks up, values without a pattern, and some NULLs.
+ */
+static int64
+test_value(int i, bool withNulls, bool *isnull)
+{
+	*isnull = withNulls && (i % 101 == 7);
+
+	if (i < 500)
+		return i / 37;
+	else if (i < 1000)
+		return i * 3;
+	else if (i < 1500)
+		return (int64) ((i * UINT64CONST(2654435761)) % 1000003);
+	else
+		return (i / 5) * 100 - 80000;
+}
+
+static void
+init_type_info(DatumStreamTypeInfo *typeInfo, int32 datumlen)
+{
+	memset(typeInfo, 0, sizeof(DatumStreamTypeInfo));
+	typeInfo->datumlen = datumlen;
+	typeInfo->typid = (datumlen == 2) ? INT2OID : (datumlen == 4) ? INT4OID : INT8OID;
+	typeInfo->align = (datumlen == 2) ? 's' : (datumlen == 4) ? 'i' : 'd';
+	typeInfo->byval = true;
+}
+
+/*
+ * Write NUM_TEST_ROWS rows into one block, return the block and its size.
+ */
+static uint8 *
+make_test_block(DatumStreamTypeInfo *typeInfo, DatumStreamVersion version,
+				bool rle, bool withNulls, int64 *size)
+{
+	DatumStreamBlockWrite dsw;
+	RelFileNode node = {0, 0, 0};
+	uint8	   *buffer;
+
+	memset(&dsw, 0, sizeof(dsw));
+	DatumStreamBlockWrite_Init(&dsw, typeInfo, version,
+							   rle,
+							   version == DatumStreamVersion_Dense_Enhanced &&
+							   typeInfo->datumlen >= 4,
+							   NUM_TEST_ROWS + 1, NUM_TEST_ROWS + 1, 65536,
+							   test_errcallback, NULL,
+							   test_errcallback, NULL,
+							   &node);
+	DatumStreamBlockWrite_GetReady(&dsw);
+
+	for (int i = 0; i < NUM_TEST_ROWS; i++)
+	{
+		bool		isnull;
+		int64		value = test_value(i, withNulls, &isnull);
+		Datum		d;
+		void	   *toFree = NULL;
+
+		if (typeInfo->datumlen == 2)
+			d = Int16GetDatum((int16) value);
+		else if (typeInfo->datumlen == 4)
+			d = Int32GetDatum((int32) value);
+		else
+			d = Int64GetDatum(value);
+
+		assert_true(DatumStreamBlockWrite_Put(&dsw, d, isnull, &toFree) >= 0);
+	}
+
+	buffer = palloc0(65536);
+	*size = DatumStreamBlockWrite_Block(&dsw, buffer, &node);
+	DatumStreamBlockWrite_Finish(&dsw);
+
+	return buffer;
+}
+
+/*
+ * Prepare a reader positioned before the first item of a copy of the block,
+ * and return the copy.
+ */
+static uint8 *
+open_test_block(DatumStreamBlockRead *dsr, DatumStreamTypeInfo *typeInfo,
+				DatumStreamVersion version, bool rle,
+				uint8 *block, int64 size)
+{
+	RelFileNode node = {0, 0, 0};
+	bool		hadToAdjustRowCount;
+	int32		adjustedRowCount;
+	uint8	   *buffer;
+
+	/* reading may modify the buffer in place, work on a copy */
+	buffer = palloc(size);
+	memcpy(buffer, block, size);
+
+	memset(dsr, 0, sizeof(DatumStreamBlockRead));
+	DatumStreamBlockRead_Init(dsr, typeInfo, version, rle,
+							  test_errcallback, NULL,
+							  test_errcallback, NULL);
+	DatumStreamBlockRead_Reset(dsr);
+	DatumStreamBlockRead_GetReady(dsr, buffer, size, 1, NUM_TEST_ROWS,
+								  &hadToAdjustRowCount, &adjustedRowCount,
+								  &node);
+
+	return buffer;
+}
+
+/*
+ * DatumStreamBlockRead_GetBatch() must return the same as advancing over the
+ * items one by one, whatever the batch sizes, and leave the reader on the
+ * same item.
+ */
+static void
+check_getbatch(int32 datumlen, DatumStreamVersion version, bool rle,
+			   bool withNulls)
+{
+	static const int batchSizes[] = {1, 7, 64, 3, 300, 2};
+	DatumStreamTypeInfo typeInfo;
+	DatumStreamBlockRead byItem;
+	DatumStreamBlockRead byBatch;
+	Datum		values[NUM_TEST_ROWS];
+	bool		nulls[NUM_TEST_ROWS];
+	int			row = 0;
+	int			batchNo = 0;
+	uint8	   *block;
+	int64		size;
+
+	init_type_info(&typeInfo, datumlen);
+	block = make_test_block(&typeInfo, version, rle, withNulls, &size);
+	open_test_block(&byItem, &typeInfo, version, rle, block, size);
+	open_test_block(&byBatch, &typeInfo, version, rle, block, size);
+	assert_int_equal(byBatch.logical_row_count, NUM_TEST_ROWS);
+
+	while (row < NUM_TEST_ROWS)
+	{
+		int			n = Min(batchSizes[batchNo++ % lengthof(batchSizes)],
+							NUM_TEST_ROWS - row);
+
+		DatumStreamBlockRead_GetBatch(&byBatch, values, nulls, n);
+
+		for (int i = 0; i < n; i++)
+		{
+			Datum		d;
+			bool		isnull;
+			bool		expectedNull;
+			int64		expected = test_value(row + i, withNulls, &expectedNull);
+
+			assert_int_equal(DatumStreamBlockRead_Advance(&byItem), 1);
+			DatumStreamBlockRead_Get(&byItem, &d, &isnull);
+
+			assert_int_equal(nulls[i], isnull);
+			assert_int_equal(nulls[i], expectedNull);
+			if (isnull)
+				continue;
+			assert_true(values[i] == d);
+			if (datumlen == 2)
+				assert_int_equal(DatumGetInt16(values[i]), (int16) expected);
+			else if (datumlen == 4)
+				assert_int_equal(DatumGetInt32(values[i]), (int32) expected);
+			else
+				assert_true(DatumGetInt64(values[i]) == expected);
+		}
+		row += n;
+
+		assert_int_equal(byBatch.nth, byItem.nth);
+		assert_int_equal(byBatch.physical_datum_index, byItem.physical_datum_index);
+		assert_true(byBatch.datump - byBatch.datum_beginp ==
+					byItem.datump - byItem.datum_beginp);
+	}
+
+	assert_int_equal(DatumStreamBlockRead_Advance(&byBatch), 0);
+}
+
+static void
+test__DatumStreamBlockRead_GetBatch(void **state)
+{
+	for (int32 datumlen = 2; datumlen <= 8; datumlen *= 2)
+	{
+		check_getbatch(datumlen, DatumStreamVersion_Original, false, false);
+		check_getbatch(datumlen, DatumStreamVersion_Original, false, true);
+		check_getbatch(datumlen, DatumStreamVersion_Dense, false, false);
+		check_getbatch(datumlen, DatumStreamVersion_Dense, false, true);
+		check_getbatch(datumlen, DatumStreamVersion_Dense, true, false);
+		check_getbatch(datumlen, DatumStreamVersion_Dense, true, true);
+		check_getbatch(datumlen, DatumStreamVersion_Dense_Enhanced, true, false);
+		check_getbatch(datumlen, DatumStreamVersion_Dense_Enhanced, true, true);
+	}
+}
+
+/*
+ * Microbenchmark: decode the test block item by item and in batches, and
+ * time the kernels against their scalar versions.  Only prints the numbers,
+ * timings are too noisy to assert on.
+ */
+static double
+time_decode(int32 datumlen, DatumStreamVersion version, bool rle,
+			bool batch, int loops)
+{
+	DatumStreamTypeInfo typeInfo;
+	DatumStreamBlockRead dsr;
+	Datum		values[NUM_TEST_ROWS];
+	bool		nulls[NUM_TEST_ROWS];
+	uint8	   *block;
+	uint8	   *copy;
+	int64		size;
+	instr_time	start;
+	instr_time	duration;
+	double		elapsed = 0;
+
+	init_type_info(&typeInfo, datumlen);
+	block = make_test_block(&typeInfo, version, rle, false, &size);
+
+	for (int loop = 0; loop < loops; loop++)
+	{
+		copy = open_test_block(&dsr, &typeInfo, version, rle, block, size);
+
+		INSTR_TIME_SET_CURRENT(start);
+		if (batch)
+			DatumStreamBlockRead_GetBatch(&dsr, values, nulls, NUM_TEST_ROWS);
+		else
+		{
+			for (int i = 0; i < NUM_TEST_ROWS; i++)
+			{
+				DatumStreamBlockRead_Advance(&dsr);
+				DatumStreamBlockRead_Get(&dsr, &values[i], &nulls[i]);
+			}
+		}
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, start);
+		elapsed += INSTR_TIME_GET_DOUBLE(duration);
+
+		pfree(copy);
+	}
+	pfree(block);
+
+	return elapsed * 1e9 / ((double) loops * NUM_TEST_ROWS);
+}
+
+static double
+time_widen(WidenFunc widen, int loops)
+{
+	uint32		src[NUM_TEST_ROWS];
+	Datum		dst[NUM_TEST_ROWS];
+	instr_time	start;
+	instr_time	duration;
+
+	memset(src, 1, sizeof(src));
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (int loop = 0; loop < loops; loop++)
+		widen(dst, (uint8 *) src, NUM_TEST_ROWS);
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, start);
+
+	return INSTR_TIME_GET_DOUBLE(duration) * 1e9 / ((double) loops * NUM_TEST_ROWS);
+}
+
+static void
+test__DatumStreamDecode__Benchmark(void **state)
+{
+	static const struct
+	{
+		const char *name;
+		DatumStreamVersion version;
+		bool		rle;
+	}			formats[] =
+	{
+		{"plain", DatumStreamVersion_Dense, false},
+		{"rle_type", DatumStreamVersion_Dense, true},
+		{"rle_type+delta", DatumStreamVersion_Dense_Enhanced, true},
+	};
+
+	printf("datumstream decode, ns per value (by item / by batch):\n");
+	for (int f = 0; f < lengthof(formats); f++)
+	{
+		for (int32 datumlen = 2; datumlen <= 8; datumlen *= 2)
+		{
+			double		byItem = time_decode(datumlen, formats[f].version,
+											 formats[f].rle, false, 200);
+			double		byBatch = time_decode(datumlen, formats[f].version,
+											  formats[f].rle, true, 200);
+
+			printf("  %-15s int%d: %6.2f / %6.2f (%.1fx)\n",
+				   formats[f].name, datumlen, byItem, byBatch,
+				   byBatch > 0 ? byItem / byBatch : 0);
+		}
+	}
+
+	printf("int4 widening kernel, ns per value: scalar %.3f, chosen %.3f\n",
+		   time_widen(DatumStreamDecode_Widen32_scalar, 2000),
+		   time_widen(DatumStreamDecode_Widen32, 2000));
+}
+
+int
+main(int argc, char *argv[])
+{
+	cmockery_parse_arguments(argc, argv);
+
+	const UnitTest tests[] = {
+		unit_test(test__DatumStreamDecode__Kernels),
+		unit_test(test__DatumStreamBlockRead_GetBatch),
+		unit_test(test__DatumStreamDecode__Benchmark)
+	};
+
+	MemoryContextInit();
+
+	return run_tests(tests);
+}
@@ -23,8 +23,15 @@
 #include "access/reloptions.h"
 #include "access/transam.h"
 #include "access/url.h"
+#include "access/appendonly_zonemap.h"
+#include "access/appendonly_visimap_cache.h"
+#include "access/appendonlywriter.h"
 #include "access/xlog_internal.h"
+#include "catalog/gp_fastsequence.h"
+#include "cdb/cdbaocsam.h"
 #include "cdb/cdbappendonlyam.h"
+#include "cdb/cdbappendonlyblockcache.h"
+#include "cdb/cdbbufferedread.h"
 #include "cdb/cdbendpoint.h"
 #include "cdb/cdbdisp.h"
 #include "cdb/cdbdisp_query.h"
@@ -45,6 +52,7 @@
 #include "postmaster/fts.h"
 #include "postmaster/postmaster.h"
 #include "replication/walsender.h"
+#include "storage/buffile.h"
 #include "storage/proc.h"
 #include "task/pg_cron.h"
 #include "tcop/idle_resource_cleaner.h"
@@ -85,6 +93,7 @@ static bool check_verify_gpfdists_cert(bool *newval, void **extra, GucSource sou
 static bool check_dispatch_log_stats(bool *newval, void **extra, GucSource source);
 static bool check_gp_hashagg_default_nbatches(int *newval, void **extra, GucSource source);
 static bool check_gp_workfile_compression(bool *newval, void **extra, GucSource source);
+static bool check_gp_workfile_compression_method(int *newval, void **extra, GucSource source);
 
 /* Helper function for guc setter */
 bool gpvars_check_gp_resqueue_priority_default_value(char **newval,
@@ -141,6 +150,9 @@ bool		gp_appendonly_verify_block_checksums = true;
 bool		gp_appendonly_verify_write_block = false;
 bool		gp_appendonly_compaction = true;
 int			gp_appendonly_compaction_threshold = 0;
+int			gp_appendonly_compaction_segfiles_per_xact = 0;
+bool		gp_autovacuum_appendonly = false;
+int			gp_index_fetch_batch_size = 1024;
 bool		enable_parallel = false;
 int			gp_appendonly_insert_files = 0;
 int			gp_appendonly_insert_files_tuples_range = 0;
@@ -527,6 +539,12 @@ static const struct config_enum_entry gp_log_verbosity[] = {
 	{NULL, 0}
 };
 
+static const struct config_enum_entry gp_workfile_compression_methods[] = {
+	{"zstd", WORKFILE_COMPRESSION_ZSTD},
+	{"lz4", WORKFILE_COMPRESSION_LZ4},
+	{NULL, 0}
+};
+
 static const struct config_enum_entry gp_resqueue_memory_policies[] = {
 	{"none", RESMANAGER_MEMORY_POLICY_NONE},
 	{"auto", RESMANAGER_MEMORY_POLICY_AUTO},
@@ -903,6 +921,30 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_enable_zonemap", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Maintain and use per-block zone maps to skip append-optimized blocks during scans."),
+			gettext_noop("Zone maps are kept for integer, date and timestamp columns of tables "
+						 "that have a block directory."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_appendonly_enable_zonemap,
+		true,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_aocs_dictionary_encoding", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Dictionary encode variable-length columns of append-optimized column-oriented tables."),
+			gettext_noop("Applies to blocks of columns with RLE_TYPE or auto compression that "
+						 "get smaller by storing each distinct value once."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_aocs_dictionary_encoding,
+		true,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_appendonly_compaction", PGC_SUSET, APPENDONLY_TABLES,
 			gettext_noop("Perform append-only compaction instead of eof truncation on vacuum."),
@@ -914,6 +956,17 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_autovacuum_appendonly", PGC_SIGHUP, AUTOVACUUM,
+			gettext_noop("Lets autovacuum on the coordinator vacuum append-optimized tables."),
+			gettext_noop("Append-optimized tables whose dead tuples exceed the autovacuum "
+						 "vacuum threshold get their segment files compacted.")
+		},
+		&gp_autovacuum_appendonly,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_heap_require_relhasoids_match", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Issue an error on discovery of a mismatch between relhasoids and a tuple header."),
@@ -2799,6 +2852,15 @@ struct config_bool ConfigureNamesBool_gp[] =
 		false, NULL, NULL
 	},
 
+	{
+		{"gp_enable_runtime_filter_pushdown", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Allows runtime filters of hash joins with a replicated inner side to be applied below Motions."),
+			NULL
+		},
+		&gp_enable_runtime_filter_pushdown,
+		true, NULL, NULL
+	},
+
 	{
 		{"gp_resource_group_bypass", PGC_USERSET, RESOURCES,
 			gettext_noop("If the value is true, the query in this session will not be limited by resource group."),
@@ -3169,6 +3231,30 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_index_fetch_batch_size", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the most index entries whose table rows an index scan fetches at once."),
+			gettext_noop("Fetching a batch lets append-optimized column tables read the rows "
+						 "in storage order. Values below 2 disable batching."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_index_fetch_batch_size,
+		1024, 0, 65536,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_compaction_segfiles_per_xact", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Maximum number of segment files of an append-optimized table that"
+						 " vacuum compacts in one transaction."),
+			gettext_noop("Vacuum compacts the rest in further transactions. 0 compacts all"
+						 " segment files in one transaction.")
+		},
+		&gp_appendonly_compaction_segfiles_per_xact,
+		0, 0, MAX_AOREL_CONCURRENCY,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_appendonly_insert_files", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Number of segment files to insert for appendonly table within a transaction."
@@ -3202,6 +3288,50 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_visimap_cache_size", PGC_POSTMASTER, APPENDONLY_TABLES,
+			gettext_noop("Sets the number of append-optimized visibility map entries cached in shared memory."),
+			gettext_noop("Zero disables the cache."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_appendonly_visimap_cache_size,
+		1024, 0, 1024 * 1024,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_block_cache_size", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Sets the amount of decompressed append-optimized blocks a backend keeps for random access within a transaction."),
+			gettext_noop("Zero disables the cache."),
+			GUC_UNIT_KB | GUC_NOT_IN_SAMPLE
+		},
+		&gp_appendonly_block_cache_size,
+		8192, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_fastsequence_cache_size", PGC_POSTMASTER, APPENDONLY_TABLES,
+			gettext_noop("Sets the number of append-optimized row number sequences cached in shared memory."),
+			gettext_noop("Zero disables the cache."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_fastsequence_cache_size,
+		1024, 0, 1024 * 1024,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_fastsequence_cache_max_range", PGC_SUSET, APPENDONLY_TABLES,
+			gettext_noop("Sets the most append-optimized row numbers reserved at once for the shared memory cache."),
+			gettext_noop("Zero disables the cache."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_fastsequence_cache_max_range,
+		32768, 0, INT_MAX / 2,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_workfile_limit_files_per_query", PGC_USERSET, RESOURCES,
 			gettext_noop("Maximum number of workfiles allowed per query per segment."),
@@ -3769,6 +3899,19 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_hashjoin_radix_partition_size", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Target size of the partitions of a radix partitioned in-memory hash join table."),
+			gettext_noop("Hash tables that fit in memory but not in this size are split into partitions of about this size, "
+						 "and the outer side is probed a partition at a time. Should be about the size of the CPU cache. "
+						 "0 disables partitioning."),
+			GUC_UNIT_KB | GUC_NOT_IN_SAMPLE
+		},
+		&gp_hashjoin_radix_partition_size,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_hashagg_groups_per_bucket", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Target density of hashtable used by Hashagg during execution"),
@@ -3791,6 +3934,18 @@ struct config_int ConfigureNamesInt_gp[] =
 		check_gp_hashagg_default_nbatches, NULL, NULL
 	},
 
+	{
+		{"gp_hashagg_batch_size", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the number of input tuples hashed aggregation hashes before looking them up."),
+			gettext_noop("The hash table buckets of a batch are prefetched while the batch "
+						 "is hashed. Values below 2 disable batching."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_hashagg_batch_size,
+		32, 0, 1024,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_motion_slice_noop", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Make motion nodes in certain slices noop"),
@@ -3912,6 +4067,32 @@ struct config_int ConfigureNamesInt_gp[] =
 		0, 0, INT_MAX,
 		NULL, NULL, NULL
 	},
+	{
+		{"gp_aocs_scan_batch_size", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Sets the number of rows a sequential scan of an append-optimized column-oriented table decodes at a time."),
+			gettext_noop("Columns are decoded one at a time for the whole batch. Zero decodes row by row."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_aocs_scan_batch_size,
+		1024, 0, MAX_AOCS_SCAN_BATCH_SIZE,
+		NULL, NULL, NULL
+	},
+	{
+		{"gp_appendonly_read_ahead_distance", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Sets the number of large reads to prefetch ahead of a scan of an append-optimized segment file."),
+			gettext_noop("The kernel reads them into the OS cache while the current one is processed. Zero disables read-ahead."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_appendonly_read_ahead_distance,
+#ifdef USE_PREFETCH
+		4,
+#else
+		0,
+#endif
+		0, MAX_APPENDONLY_READ_AHEAD_DISTANCE,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_blockdirectory_entry_min_range", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Minimal range in bytes one block directory entry covers."),
@@ -4658,6 +4839,21 @@ struct config_enum ConfigureNamesEnum_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_workfile_compression_method", PGC_USERSET, RESOURCES_DISK,
+			gettext_noop("Sets the method used to compress temporary files."),
+			gettext_noop("Valid values are ZSTD and LZ4. LZ4 compresses less, but uses less CPU."),
+		},
+		&gp_workfile_compression_method,
+#if !defined(USE_ZSTD) && defined(USE_LZ4)
+		WORKFILE_COMPRESSION_LZ4,
+#else
+		WORKFILE_COMPRESSION_ZSTD,
+#endif
+		gp_workfile_compression_methods,
+		check_gp_workfile_compression_method, NULL, NULL
+	},
+
 	{
 		{"gp_sessionstate_loglevel", PGC_SUSET, DEVELOPER_OPTIONS,
 			gettext_noop("Sets the logging level for session state debugging messages"),
@@ -5215,7 +5411,7 @@ lookup_autostats_mode_by_value(GpAutoStatsModeValue val)
 static bool
 check_gp_workfile_compression(bool *newval, void **extra, GucSource source)
 {
-#ifndef USE_ZSTD
+#if !defined(USE_ZSTD) && !defined(USE_LZ4)
 	if (*newval)
 	{
 		GUC_check_errmsg("workfile compresssion is not supported by this build");
@@ -5225,6 +5421,33 @@ check_gp_workfile_compression(bool *newval, void **extra, GucSource source)
 	return true;
 }
 
+static bool
+check_gp_workfile_compression_method(int *newval, void **extra, GucSource source)
+{
+	/*
+	 * Accept the boot value even if this build has no workfile compression
+	 * at all, gp_workfile_compression can't be enabled then.
+	 */
+	if (source == PGC_S_DEFAULT)
+		return true;
+
+#ifndef USE_ZSTD
+	if (*newval == WORKFILE_COMPRESSION_ZSTD)
+	{
+		GUC_check_errmsg("zstd workfile compression is not supported by this build");
+		return false;
+	}
+#endif
+#ifndef USE_LZ4
+	if (*newval == WORKFILE_COMPRESSION_LZ4)
+	{
+		GUC_check_errmsg("lz4 workfile compression is not supported by this build");
+		return false;
+	}
+#endif
+	return true;
+}
+
 void
 DispatchSyncPGVariable(struct config_generic * gconfig)
 {
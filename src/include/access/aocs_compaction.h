@@ -19,7 +19,7 @@
 struct AOCSVPInfo;
 extern void AOCSSegmentFileTruncateToEOF(Relation aorel, int segno, struct AOCSVPInfo *vpinfo);
 extern void AOCSCompaction_DropSegmentFile(Relation aorel, int segno);
-extern void AOCSCompact(Relation aorel,
+extern bool AOCSCompact(Relation aorel,
 						int compaction_segno,
 						int *insert_segno,
 						bool isFull,
@@ -22,7 +22,7 @@
 #define APPENDONLY_COMPACTION_SEGNO_INVALID (-1)
 
 extern void AppendOptimizedRecycleDeadSegments(Relation aorel);
-extern void AppendOnlyCompact(Relation aorel,
+extern bool AppendOnlyCompact(Relation aorel,
 							  int compaction_segno,
 							  int *insert_segno,
 							  bool isFull,
@@ -0,0 +1,65 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_sortkey.h
+ *   ordering of the rows of a bulk load by a declared sort key.
+ *
+ * An append-optimized table may declare a sort key with the "sortkey"
+ * storage option, a list of columns, and the "sortmethod" option, "linear"
+ * or "zorder".  Each batch of rows handed to the table's multi_insert
+ * callback is then written in that order, so that the rows of a storage
+ * block have close values in the key columns and the block's zone map
+ * entries have narrow ranges.  Only the rows of one batch are sorted
+ * together; a COPY passes at most 1000 rows per batch, and rows inserted
+ * one at a time are not sorted at all.
+ *
+ * A linear sort orders the batch by the key columns, first column first.
+ * A Z-order sort interleaves the bits of each row's rank in every key
+ * column, so that no key column dominates the order and filters on any of
+ * them narrow the blocks read.
+ *
+ * Portions Copyright (c) 2023-Present, Cloudberry inc
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/access/appendonly_sortkey.h
+ *
+ *------------------------------------------------------------------------------
+ */
+#ifndef APPENDONLY_SORTKEY_H
+#define APPENDONLY_SORTKEY_H
+
+#include "access/attnum.h"
+#include "executor/tuptable.h"
+#include "utils/relcache.h"
+#include "utils/sortsupport.h"
+
+#define AO_SORTMETHOD_LINEAR	"linear"
+#define AO_SORTMETHOD_ZORDER	"zorder"
+
+typedef enum AppendOnlySortMethod
+{
+	AOSortMethodLinear,
+	AOSortMethodZOrder
+} AppendOnlySortMethod;
+
+typedef struct AppendOnlySortKey
+{
+	AppendOnlySortMethod method;
+	int			nkeys;
+	AttrNumber *attnums;		/* one based */
+	AttrNumber	maxattnum;
+	SortSupport ssup;			/* nkeys entries */
+} AppendOnlySortKey;
+
+extern void appendonly_sortkey_validate_columns(const char *value);
+extern void appendonly_sortkey_validate_method(const char *value);
+
+extern AppendOnlySortKey *appendonly_sortkey_create(Relation rel);
+extern bool appendonly_sortkey_has_column(Relation rel, const char *colname);
+extern void appendonly_sortkey_rename_column(Relation rel, const char *oldname,
+											 const char *newname);
+extern void appendonly_sortkey_order(AppendOnlySortKey *sortkey,
+									 TupleTableSlot **slots, int nslots,
+									 int *order);
+
+#endif							/* APPENDONLY_SORTKEY_H */
@@ -0,0 +1,43 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_visimap_cache
+ *   shared memory cache of decoded visimap entries.
+ *
+ * Portions Copyright (c) 2023-Present, Cloudberry inc
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/access/appendonly_visimap_cache.h
+ *
+ *------------------------------------------------------------------------------
+ */
+#ifndef APPENDONLY_VISIMAP_CACHE_H
+#define APPENDONLY_VISIMAP_CACHE_H
+
+#include "access/appendonly_visimap_entry.h"
+#include "access/htup.h"
+#include "storage/relfilenode.h"
+#include "utils/rel.h"
+
+extern int	gp_appendonly_visimap_cache_size;
+
+extern Size AppendOnlyVisimapCache_ShmemSize(void);
+extern void AppendOnlyVisimapCache_ShmemInit(void);
+
+extern bool AppendOnlyVisimapCache_Lookup(Relation visimapRelation,
+										  int32 segmentFileNum,
+										  int64 firstRowNum,
+										  AppendOnlyVisimapEntry *visiMapEntry);
+extern uint64 AppendOnlyVisimapCache_GetGeneration(void);
+extern bool AppendOnlyVisimapCache_IsCacheable(Relation visimapRelation,
+											   HeapTuple tuple);
+extern void AppendOnlyVisimapCache_Insert(Relation visimapRelation,
+										  uint64 generation,
+										  AppendOnlyVisimapEntry *visiMapEntry);
+extern void AppendOnlyVisimapCache_Invalidate(Relation visimapRelation,
+											  int32 segmentFileNum,
+											  int64 firstRowNum);
+extern void AppendOnlyVisimapCache_ForgetRelFileNodes(RelFileNodeBackend *rnodes,
+													  int nnodes);
+
+#endif							/* APPENDONLY_VISIMAP_CACHE_H */
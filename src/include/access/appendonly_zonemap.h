@@ -0,0 +1,138 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_zonemap.h
+ *   per-block min/max summaries ("zone maps") for append-optimized tables.
+ *
+ * A zone map entry summarizes one storage block of one column: its row
+ * range, the number of NULLs in it and the smallest and largest non-NULL
+ * value.  Entries are accumulated by the inserting backend and stored in
+ * the block directory relation, next to the minipages, in pages keyed by
+ * a negative column group number (see AOZoneMapColumnGroupNo).  A scan with
+ * simple range predicates consults them to skip blocks that can not contain
+ * a qualifying row without reading or decompressing them.
+ *
+ * Only types whose values map order-preservingly onto an int64 are
+ * summarized: the integer types, date, timestamp and timestamptz.
+ *
+ * Portions Copyright (c) 2023-Present, Cloudberry inc
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/access/appendonly_zonemap.h
+ *
+ *------------------------------------------------------------------------------
+ */
+#ifndef APPENDONLY_ZONEMAP_H
+#define APPENDONLY_ZONEMAP_H
+
+#include "access/attnum.h"
+#include "access/htup_details.h"
+#include "access/tupdesc.h"
+#include "nodes/pg_list.h"
+#include "utils/relcache.h"
+#include "utils/snapshot.h"
+
+extern bool gp_appendonly_enable_zonemap;
+
+/*
+ * Zone map pages live in the block directory relation under a negative
+ * column group number, so that they never collide with the minipages of a
+ * real column group.  attno is zero based.
+ */
+#define AOZoneMapColumnGroupNo(attno)	(-1 - (int) (attno))
+
+/*
+ * The summary of one block of one column.
+ */
+typedef struct AOZoneMapEntry
+{
+	int64		firstRowNum;
+	int64		rowCount;
+	int64		nullCount;
+	int64		minValue;		/* valid only if nullCount < rowCount */
+	int64		maxValue;
+} AOZoneMapEntry;
+
+/*
+ * Varlena representation of a zone map page, stored in the minipage column
+ * of the block directory relation.
+ */
+typedef struct AOZoneMapPage
+{
+	int32		_len;			/* varlena header, must be first */
+	int32		version;
+	uint32		nEntry;
+
+	AOZoneMapEntry entry[FLEXIBLE_ARRAY_MEMBER];
+} AOZoneMapPage;
+
+#define AOZoneMapPage_CurrentVersion 1
+
+/*
+ * Keep a zone map page about as large as a full minipage.
+ */
+#define NUM_ZONEMAP_ENTRIES (((MaxHeapTupleSize)/8 - sizeof(HeapTupleHeaderData) - 64 * 3)\
+							 / sizeof(AOZoneMapEntry))
+
+static inline Size
+AOZoneMapPage_Size(uint32 nEntry)
+{
+	return offsetof(AOZoneMapPage, entry) + sizeof(AOZoneMapEntry) * nEntry;
+}
+
+/*
+ * Accumulator for the block of one column currently being written.
+ */
+typedef struct AOZoneMapBuildState
+{
+	Oid			typid;			/* type of the column */
+	int64		rowCount;
+	int64		nullCount;
+	int64		minValue;
+	int64		maxValue;
+} AOZoneMapBuildState;
+
+/*
+ * Opaque state of a scan that uses zone maps to skip blocks.
+ */
+typedef struct AOZoneMapScanData *AOZoneMapScan;
+
+extern bool AOZoneMap_TypeIsSupported(Oid typid);
+extern int64 AOZoneMap_DatumToInt64(Oid typid, Datum value);
+
+/* write side */
+extern AOZoneMapBuildState *AOZoneMap_CreateBuildStates(TupleDesc tupdesc,
+														int *nsummarized);
+extern void AOZoneMap_InitBuildState(AOZoneMapBuildState *state, Oid typid);
+extern void AOZoneMap_ResetBuildState(AOZoneMapBuildState *state);
+
+static inline void
+AOZoneMap_AddValue(AOZoneMapBuildState *state, Datum value, bool isnull)
+{
+	state->rowCount++;
+	if (isnull)
+		state->nullCount++;
+	else
+	{
+		int64		v = AOZoneMap_DatumToInt64(state->typid, value);
+
+		if (state->rowCount - state->nullCount == 1)
+			state->minValue = state->maxValue = v;
+		else if (v < state->minValue)
+			state->minValue = v;
+		else if (v > state->maxValue)
+			state->maxValue = v;
+	}
+}
+
+/* read side */
+extern AOZoneMapScan AOZoneMap_BeginScan(Relation rel, Snapshot snapshot,
+										 List *qual);
+extern AOZoneMapScan AOZoneMap_AddRange(AOZoneMapScan zmscan, Relation rel,
+										Snapshot snapshot, AttrNumber attno,
+										Oid typid, int64 lower, int64 upper);
+extern int64 AOZoneMap_NextCandidateRow(AOZoneMapScan zmscan, int segno,
+										int64 rowNum);
+extern void AOZoneMap_EndScan(AOZoneMapScan zmscan);
+
+#endif							/* APPENDONLY_ZONEMAP_H */
@@ -156,6 +156,7 @@ typedef struct IndexScanDescData
 	bool		xs_heap_continue;	/* T if must keep walking, potential
 									 * further results */
 	IndexFetchTableData *xs_heapfetch;
+	struct IndexFetchBatch *xs_fetch_batch;	/* see index_batch_fetch_begin */
 
 	bool		xs_recheck;		/* T means scan keys must be rechecked */
 
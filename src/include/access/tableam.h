@@ -457,6 +457,18 @@ typedef struct TableAmRoutine
 									  TupleTableSlot *slot,
 									  bool *call_again, bool *all_dead);
 
+	/*
+	 * Optional callback, for AMs that never return more than one tuple per
+	 * tid: fetch the tuples at `ntids` tids at once, in whatever order suits
+	 * the AM, after doing a visibility test according to `snapshot`.
+	 * tuples[i] is set to a copy of the tuple at tids[i], allocated in the
+	 * current memory context, or NULL if there is no visible tuple there.
+	 */
+	void		(*index_fetch_batch) (struct IndexFetchTableData *scan,
+									  ItemPointer tids, int ntids,
+									  Snapshot snapshot,
+									  MinimalTuple *tuples);
+
 
 	/* ------------------------------------------------------------------------
 	 * Callbacks for non-modifying operations on individual tuples
@@ -1313,6 +1325,23 @@ table_index_fetch_tuple(struct IndexFetchTableData *scan,
 													all_dead);
 }
 
+/*
+ * Fetches, as part of an index scan, the tuples at a batch of tids at once.
+ * Only AMs that provide the index_fetch_batch callback support it; see
+ * there for the details.
+ */
+static inline void
+table_index_fetch_batch(struct IndexFetchTableData *scan,
+						ItemPointer tids, int ntids,
+						Snapshot snapshot,
+						MinimalTuple *tuples)
+{
+	Assert(scan->rel->rd_tableam->index_fetch_batch != NULL);
+
+	scan->rel->rd_tableam->index_fetch_batch(scan, tids, ntids, snapshot,
+											 tuples);
+}
+
 /*
  * This is a convenience wrapper around table_index_fetch_tuple() which
  * returns whether there are table tuple items corresponding to an index
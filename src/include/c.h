@@ -275,6 +275,17 @@
 #define unlikely(x) ((x) != 0)
 #endif
 
+/*
+ * Hint to the CPU to bring the cache line holding the given address into
+ * cache ahead of its use.  Only worth it where the hardware can't predict
+ * the accesses itself, like probes of a large hash table.
+ */
+#if __GNUC__ >= 3
+#define pg_prefetch_mem(a)	__builtin_prefetch(a)
+#else
+#define pg_prefetch_mem(a)	((void) (a))
+#endif
+
 /*
  * CppAsString
  *		Convert the argument to a string, using the C preprocessor.
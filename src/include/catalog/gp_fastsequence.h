@@ -58,11 +58,9 @@ extern void InsertInitialFastSequenceEntries(Oid objid);
  * number is the maximal value between 'lastsequence' + 1 and minSequence.
  * The length of the list is given.
  *
- * If there is not such an entry for objid in the table, create
- * one here.
- *
- * The existing entry for objid in the table is updated with a new
- * lastsequence value.
+ * The numbers come from a range cached in shared memory when it has enough
+ * of them left, otherwise a new range is reserved from the table, creating
+ * the entry for objid if there is not one, and the rest of it is cached.
  */
 extern int64 GetFastSequences(Oid objid, int64 objmod,
 							  int64 minSequence, int64 numSequences);
@@ -82,4 +80,13 @@ extern int64 ReadLastSequence(Oid objid, int64 objmod);
  */
 extern void RemoveFastSequenceEntry(Oid objid);
 
+extern int	gp_fastsequence_cache_size;
+extern int	gp_fastsequence_cache_max_range;
+
+extern Size FastSequenceCache_ShmemSize(void);
+extern void FastSequenceCache_ShmemInit(void);
+extern void FastSequenceCache_ForgetDatabase(Oid dbid);
+extern void AtEOXact_FastSequence(bool isCommit, bool isPrepare);
+extern void AtSubAbort_FastSequence(void);
+
 #endif
@@ -44,6 +44,10 @@
 struct DatumStream;
 struct AOCSFileSegInfo;
 
+extern int	gp_aocs_scan_batch_size;
+
+#define MAX_AOCS_SCAN_BATCH_SIZE 32768
+
 typedef struct AOCSInsertDescData
 {
 	Relation	aoi_rel;
@@ -104,6 +108,61 @@ enum AOCSScanDescIdentifier
 	AOCSBITMAPSCANDATA		/* am private */
 };
 
+/*
+ * A batch of rows read by aocs_getnextbatch(), stored column by column.
+ *
+ * Only the projected columns are filled in, their arrays are allocated on
+ * first use; values[attno] and isnull[attno] hold nrows entries each.
+ * Pass-by-reference values point into the read buffers of the scan, or into
+ * copycxt, and stay valid until the next batch is read.
+ */
+typedef struct AOCSBatchData
+{
+	MemoryContext mcxt;			/* where the column arrays are allocated */
+	MemoryContext copycxt;		/* values copied out of replaced buffers */
+	TupleDesc	tupdesc;		/* descriptor the batch was created for */
+	int			maxrows;		/* capacity of the arrays below */
+	int			nrows;			/* number of rows in the batch */
+	int			next;			/* next row for aoco_getnextslot() */
+
+	Datum	  **values;			/* values[attno][row] */
+	bool	  **isnull;			/* isnull[attno][row] */
+	AOTupleId  *tids;			/* tids[row] */
+
+	bool	   *visible;		/* scratch: visibility of each row read */
+	bool	   *selected;		/* scratch: rows read that pass the quals */
+} AOCSBatchData;
+
+typedef AOCSBatchData *AOCSBatch;
+
+/*
+ * Results of a pushed down qual for the values of a dictionary encoded
+ * block.  A qual that only looks at the value of its column gives the same
+ * result for every row with the same dictionary code, so it is evaluated
+ * once per code of the block.
+ */
+typedef struct AOCSDictQualCache
+{
+	uint64		dict_generation;	/* dictionary the results are for */
+	char	   *results;		/* per code: 0 unknown, 1 false, 2 true;
+								 * NULL if the qual can't be cached */
+} AOCSDictQualCache;
+
+/*
+ * A column added by ALTER TABLE ADD COLUMN with a constant default, without
+ * writing the default for the rows already in the table.  Such a column has
+ * no data in a segment file before the first row inserted after it was
+ * added, those rows read as the column's missing value (attmissingval).
+ * See aocs_added_columns().
+ */
+typedef struct AOCSAddedColumn
+{
+	bool		lacksRows;		/* may have no data for some rows */
+	int64		firstRowNum;	/* scans: first row with data in the current
+								 * segment file */
+	Datum		missingValue;	/* never null */
+} AOCSAddedColumn;
+
 /*
  * Used for scan of appendoptimized column oriented relations, should be used in
  * the tableam api related code and under it.
@@ -172,6 +231,13 @@ typedef struct AOCSScanDescData
 		AttrNumber			num_proj_atts;
 
 		struct DatumStreamRead **ds;
+
+		/*
+		 * By attno, or NULL if all projected columns have all rows.  If not
+		 * NULL, proj_atts[0] is a column that has all rows, which tells the
+		 * row number of each row read.
+		 */
+		AOCSAddedColumn	   *added;
 	} columnScanInfo;
 
 	struct AOCSFileSegInfo **seginfo;
@@ -201,6 +267,25 @@ typedef struct AOCSScanDescData
 	int				aos_sample_rows;
 	int				aos_scaned_rows;
 	int				*aos_qual_rows;
+	AOCSDictQualCache *aos_dict_qual;	/* by attno */
+
+	/* used to skip blocks that can not satisfy the pushed down qual */
+	AOZoneMapScan	aos_zonemap;
+
+	/* rows read ahead by aocs_getnextbatch() for aoco_getnextslot() */
+	AOCSBatch		batch;
+
+	/*
+	 * Parts of the segment files handed out to the participants of a
+	 * parallel scan, split at the minipages of column part_attno, or NULL to
+	 * hand out whole segment files.  partBlockDirectory tells where the
+	 * other columns of a part begin.
+	 */
+	AppendOnlyScanPart *parts;
+	int				nparts;
+	AttrNumber		part_attno;
+	int64			cur_part_after_row;	/* -1 if the part runs to the end */
+	AppendOnlyBlockDirectory *partBlockDirectory;
 
 } AOCSScanDescData;
 
@@ -248,6 +333,15 @@ typedef struct AOCSFetchDescData
 
 	DatumStreamFetchDesc *datumStreamFetchDesc;
 
+	/*
+	 * The columns to fetch, in the order they are fetched: columns that may
+	 * lack rows come last, once the row is known to exist.  added is by
+	 * attno, or NULL if all columns to fetch have all rows.
+	 */
+	AttrNumber	   *fetchAtts;
+	AttrNumber		numFetchAtts;
+	AOCSAddedColumn *added;
+
 	int64	skipBlockCount;
 
 	AppendOnlyVisimap visibilityMap;
@@ -270,6 +364,8 @@ typedef struct IndexFetchAOCOData
 	AOCSFetchDesc       aocofetch;
 
 	bool                *proj;
+
+	TupleTableSlot      *batchslot;	/* for aoco_index_fetch_batch */
 } IndexFetchAOCOData;
 
 /*
@@ -324,6 +420,11 @@ extern void aocs_rescan(AOCSScanDesc scan);
 extern void aocs_endscan(AOCSScanDesc scan);
 
 extern bool aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot);
+extern AOCSBatch aocs_create_batch(TupleDesc tupdesc, int maxrows);
+extern void aocs_free_batch(AOCSBatch batch);
+extern bool aocs_can_getnextbatch(AOCSScanDesc scan, TupleDesc tupdesc);
+extern int aocs_getnextbatch(AOCSScanDesc scan, ScanDirection direction,
+							 AOCSBatch batch, TupleTableSlot *slot);
 extern AOCSInsertDesc aocs_insert_init(Relation rel, int segno);
 extern void aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupleId);
 static inline void aocs_insert(AOCSInsertDesc idesc, TupleTableSlot *slot)
@@ -382,4 +483,8 @@ extern ExprState * aocs_predicate_pushdown_prepare(AOCSScanDesc scan,
 								ExprState *state,
 								ExprContext *ecxt,
 								PlanState *ps);
+struct ScanRuntimeFilter;
+extern void aocs_runtime_filter_pushdown(AOCSScanDesc scan,
+										 struct ScanRuntimeFilter *filter,
+										 bool started);
 #endif   /* AOCSAM_H */
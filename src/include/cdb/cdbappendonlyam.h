@@ -27,6 +27,7 @@
 #include "access/xlogutils.h"
 #include "access/xlog.h"
 #include "access/appendonly_visimap.h"
+#include "access/appendonly_zonemap.h"
 #include "executor/tuptable.h"
 #include "nodes/execnodes.h"
 #include "nodes/primnodes.h"
@@ -109,6 +110,12 @@ typedef struct AppendOnlyInsertDescData
 	/* The block directory for the appendonly relation. */
 	AppendOnlyBlockDirectory blockDirectory;
 
+	/*
+	 * Zone map accumulators for the block being filled, one per attribute.
+	 * NULL if no zone maps are kept for this insert.
+	 */
+	AOZoneMapBuildState *zonemapBuild;
+
 	/*
 	 * For multiple segment files insertion.
 	 */
@@ -195,6 +202,13 @@ typedef struct AppendOnlyScanDescData
 	FileSegInfo **aos_segfile_arr;	/* array of all segfiles information */
 	bool		aos_need_new_segfile;
 	bool		aos_done_all_segfiles;
+
+	/*
+	 * Parts of the segment files handed out to the participants of a
+	 * parallel scan, or NULL to hand out whole segment files.
+	 */
+	AppendOnlyScanPart *aos_parts;
+	int			aos_nparts;
 	
 	MemoryContext	aoScanInitContext; /* mem context at init time */
 
@@ -257,6 +271,9 @@ typedef struct AppendOnlyScanDescData
 	ExprContext		*aos_pushdown_econtext;
 	ExprState		*aos_pushdown_qual;
 
+	/* used to skip blocks that can not satisfy the pushed down qual */
+	AOZoneMapScan	aos_zonemap;
+
 }	AppendOnlyScanDescData;
 
 typedef AppendOnlyScanDescData *AppendOnlyScanDesc;
@@ -415,6 +432,11 @@ extern void appendonly_insert(
 		AppendOnlyInsertDesc aoInsertDesc, 
 		MemTuple instup, 
 		AOTupleId *aoTupleId);
+extern void appendonly_insert_multi(
+		AppendOnlyInsertDesc aoInsertDesc,
+		MemTuple *tuples,
+		AOTupleId *aoTupleIds,
+		int ntuples);
 extern void appendonly_insert_finish(AppendOnlyInsertDesc aoInsertDesc, dlist_head *head);
 extern void appendonly_dml_finish(Relation relation, CmdType operation);
 
@@ -430,5 +452,8 @@ void finishWriteBlock(AppendOnlyInsertDesc aoInsertDesc);
 extern ExprState* appendonly_predicate_pushdown_prepare(AppendOnlyScanDesc scan,
 												   ExprState *qual,
 												   ExprContext *ecxt);
+struct ScanRuntimeFilter;
+extern void appendonly_runtime_filter_pushdown(AppendOnlyScanDesc scan,
+											   struct ScanRuntimeFilter *filter);
 
 #endif   /* CDBAPPENDONLYAM_H */
@@ -0,0 +1,36 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbappendonlyblockcache.h
+ *	  backend-local cache of decompressed append-only storage blocks.
+ *
+ * Portions Copyright (c) 2023-Present, Cloudberry inc
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/cdb/cdbappendonlyblockcache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef CDBAPPENDONLYBLOCKCACHE_H
+#define CDBAPPENDONLYBLOCKCACHE_H
+
+#include "storage/relfilenode.h"
+
+/* GUC: size of the cache in kilobytes, 0 disables it */
+extern int	gp_appendonly_block_cache_size;
+
+extern bool AppendOnlyBlockCache_Lookup(RelFileNode *relFileNode,
+										int32 segmentFileNum,
+										int64 headerOffsetInFile,
+										int32 compressedLen,
+										int32 uncompressedLen,
+										uint8 *contentOut);
+extern void AppendOnlyBlockCache_Insert(RelFileNode *relFileNode,
+										int32 segmentFileNum,
+										int64 headerOffsetInFile,
+										int32 compressedLen,
+										int32 uncompressedLen,
+										uint8 *content);
+extern void AppendOnlyBlockCache_ForgetRelFileNode(RelFileNode *relFileNode);
+
+#endif							/* CDBAPPENDONLYBLOCKCACHE_H */
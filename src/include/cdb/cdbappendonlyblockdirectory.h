@@ -16,6 +16,7 @@
 
 #include "access/aosegfiles.h"
 #include "access/aocssegfiles.h"
+#include "access/appendonly_zonemap.h"
 #include "access/appendonlytid.h"
 #include "access/skey.h"
 #include "catalog/indexing.h"
@@ -111,6 +112,14 @@ typedef struct AppendOnlyBlockDirectory
 	 */
 	MinipagePerColumnGroup *minipages;
 
+	/*
+	 * Copies of recently read minipages, MINIPAGE_CACHE_WAYS per column
+	 * group, that are searched before the block directory index when the
+	 * last minipage does not cover a row.  Only kept for lookups.
+	 */
+	struct MinipageCacheEntry *minipageCache;
+	uint64		minipageCacheClock;
+
 	/*
 	 * Some temporary space to help form tuples to be inserted into
 	 * the block directory, and to help the index scan.
@@ -121,6 +130,13 @@ typedef struct AppendOnlyBlockDirectory
 	ScanKey scanKeys;
 	StrategyNumber *strategyNumbers;
 
+	/*
+	 * Zone map pages being filled for the current segment file, indexed by
+	 * attribute number (zero based).  Allocated on first use.
+	 */
+	AOZoneMapPage **zonemapPages;
+	int			numZonemapPages;
+
 }	AppendOnlyBlockDirectory;
 
 
@@ -152,6 +168,20 @@ typedef struct CurrentSegmentFile
 	int64 logicalEof;
 } CurrentSegmentFile;
 
+/*
+ * A part of a segment file that a participant of a parallel scan reads on
+ * its own, see AppendOnlyBlockDirectory_SplitSegmentFile().  The offsets are
+ * into the file of the column group the segment file was split by.
+ */
+typedef struct AppendOnlyScanPart
+{
+	int			segfileIndex;	/* index into the scan's segment file array */
+	int64		firstRowNum;	/* first row of the part, 0 at file start */
+	int64		fileOffset;		/* offset of the block holding firstRowNum */
+	int64		afterRowNum;	/* first row of the next part, -1 at the end */
+	int64		afterFileOffset;	/* offset of the next part, or the eof */
+} AppendOnlyScanPart;
+
 extern void AppendOnlyBlockDirectoryEntry_GetBeginRange(
 	AppendOnlyBlockDirectoryEntry	*directoryEntry,
 	int64							*fileOffset,
@@ -207,6 +237,11 @@ extern bool AppendOnlyBlockDirectory_addCol_InsertEntry(
 	int64 firstRowNum,
 	int64 fileOffset,
 	int64 rowCount);
+extern void AppendOnlyBlockDirectory_InsertZoneMapEntry(
+	AppendOnlyBlockDirectory *blockDirectory,
+	AttrNumber attno,
+	int64 firstRowNum,
+	AOZoneMapBuildState *buildState);
 extern bool AppendOnlyBlockDirectory_DeleteEntry(
 	AppendOnlyBlockDirectory *blockDirectory,
 	AOTupleId *aoTupleId);
@@ -220,6 +255,21 @@ extern void AppendOnlyBlockDirectory_End_forSearch(
 	AppendOnlyBlockDirectory *blockDirectory);
 extern void AppendOnlyBlockDirectory_End_addCol(
 	AppendOnlyBlockDirectory *blockDirectory);
+extern AppendOnlyScanPart *AppendOnlyBlockDirectory_SplitSegmentFile(
+	Relation aoRel,
+	Snapshot snapshot,
+	int segno,
+	int columnGroupNo,
+	int64 eof,
+	int segfileIndex,
+	int *nparts);
+extern MinipageEntry *AppendOnlyBlockDirectory_GetSegmentFileEntries(
+	Relation aoRel,
+	Snapshot snapshot,
+	int segno,
+	int columnGroupNo,
+	int64 eof,
+	int *nentries);
 extern void AppendOnlyBlockDirectory_DeleteSegmentFile(
 	Relation aoRel,
 		Snapshot snapshot,
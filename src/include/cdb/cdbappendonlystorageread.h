@@ -174,6 +174,15 @@ typedef struct AppendOnlyStorageRead
 
 	RelFileNode relFileNode;
 
+	/*
+	 * Keep decompressed blocks in the backend's block cache?  Only set for
+	 * fetch descriptors, which jump between blocks.  segmentFileNum is the
+	 * physical segment file number of the open file, as given by the caller
+	 * for the cache key, or -1 if not known.
+	 */
+	bool		useBlockCache;
+	int32		segmentFileNum;
+
 	/*
 	 * The number of blocks read since the beginning of the segment file.
 	 */
@@ -210,6 +219,9 @@ extern bool AppendOnlyStorageRead_TryOpenFile(AppendOnlyStorageRead *storageRead
 								  char *filePathName, int version, int64 logicalEof);
 extern void AppendOnlyStorageRead_SetTemporaryRange(AppendOnlyStorageRead *storageRead,
 							   int64 beginFileOffset, int64 afterFileOffset);
+extern void AppendOnlyStorageRead_EnableBlockCache(AppendOnlyStorageRead *storageRead);
+extern void AppendOnlyStorageRead_SetSegmentFileNum(AppendOnlyStorageRead *storageRead,
+							   int32 segmentFileNum);
 extern void AppendOnlyStorageRead_CloseFile(AppendOnlyStorageRead *storageRead);
 
 extern bool AppendOnlyStorageRead_GetBlockInfo(AppendOnlyStorageRead *storageRead,
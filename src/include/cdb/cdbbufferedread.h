@@ -20,6 +20,15 @@
 
 #include "storage/fd.h"
 #include "storage/relfilenode.h"
+
+/*
+ * Number of large reads ahead of the current one to ask the kernel to
+ * prefetch, zero disables read-ahead.
+ */
+extern int	gp_appendonly_read_ahead_distance;
+
+#define MAX_APPENDONLY_READ_AHEAD_DISTANCE 64
+
 typedef struct BufferedRead
 {
 	/*
@@ -50,6 +59,12 @@ typedef struct BufferedRead
 							 * The position within the current file of the current read
 							 * and the number of bytes read into in largeReadMemory.
 							 */
+
+	int64				 prefetchPosition;
+							/*
+							 * The file position up to which read-ahead has been
+							 * requested, see BufferedReadPrefetch.
+							 */
 	
 	/*
 	 * Buffer level members.
@@ -519,6 +519,12 @@ extern bool gp_adjust_selectivity_for_outerjoins;
 extern int gp_hashjoin_tuples_per_bucket;
 extern int gp_hashagg_groups_per_bucket;
 
+/*
+ * Target size, in kilobytes, of the partitions of a radix partitioned
+ * in-memory Hashjoin table.  0 disables radix partitioning.
+ */
+extern int gp_hashjoin_radix_partition_size;
+
 /*
  * Damping of selectivities of clauses which pertain to the same base
  * relation; compensates for undetected correlation
@@ -537,6 +543,12 @@ extern double gp_selectivity_damping_factor;
 
 extern bool gp_enable_runtime_filter;
 
+/*
+ * Let the scan of a hash join's probe side, in a lower slice, use the
+ * runtime filter of the join when its build side is replicated.
+ */
+extern bool gp_enable_runtime_filter_pushdown;
+
 /*
  * Sort selectivities by significance before applying
  * damping (ON by default)
@@ -643,6 +655,11 @@ extern int gp_max_plan_size;
  */
 extern int gp_hashagg_default_nbatches;
 
+/* The number of input tuples hashed aggregation hashes before looking them
+ * up in the hash table, to overlap the cache misses of the lookups.
+ */
+extern int gp_hashagg_batch_size;
+
 /* Get statistics for partitioned parent from a child */
 extern bool 	gp_statistics_pullup_from_child_partition;
 
@@ -21,7 +21,9 @@
 #include "catalog/pg_type.h"
 #include "parser/parse_node.h"
 #include "storage/buf.h"
+#include "storage/dsm.h"
 #include "storage/lock.h"
+#include "storage/shm_toc.h"
 #include "utils/relcache.h"
 #include "utils/snapshot.h"
 
@@ -255,6 +257,12 @@ typedef struct VPgClassStats
 	BlockNumber rel_pages;
 	double		rel_tuples;
 	BlockNumber relallvisible;
+
+	/*
+	 * Only sent by the AO compaction phase: true if some segment files were
+	 * left to be compacted by another transaction.
+	 */
+	bool		ao_compaction_incomplete;
 } VPgClassStats;
 
 /*
@@ -286,6 +294,22 @@ typedef struct VacuumParams
 	 */
 	int			nworkers;
 	bool auto_stats;      /* invoked via automatic statistic collection */
+
+	/*
+	 * GPDB: the AO compaction phase compacts at most ao_compact_segfiles
+	 * segment files per transaction, 0 means no limit.  It sets
+	 * ao_compaction_incomplete if it stopped at that limit, to have the
+	 * caller run it again in a new transaction.
+	 */
+	int			ao_compact_segfiles;
+	bool		ao_compaction_incomplete;
+
+	/*
+	 * GPDB: cost-based delay dispatched to the segments by autovacuum on the
+	 * coordinator, -1 to use the segment's own settings.
+	 */
+	double		cost_delay;
+	int			cost_limit;
 } VacuumParams;
 
 typedef struct
@@ -346,6 +370,7 @@ extern void vac_send_relstats_to_qd(Relation relation,
 						BlockNumber num_pages,
 						double num_tuples,
 						BlockNumber num_all_visible_pages);
+extern void vac_send_ao_compaction_incomplete_to_qd(Relation relation);
 extern void vac_update_relstats(Relation relation,
 								BlockNumber num_pages,
 								double num_tuples,
@@ -395,6 +420,7 @@ extern void ao_vacuum_rel_post_cleanup(Relation onerel, int options, VacuumParam
 									   BufferAccessStrategy bstrategy);
 
 extern void ao_vacuum_rel(Relation rel, VacuumParams *params, BufferAccessStrategy bstrategy);
+extern void parallel_vacuum_ao_main(dsm_segment *seg, shm_toc *toc);
 
 extern bool std_typanalyze(VacAttrStats *stats);
 
@@ -64,6 +64,17 @@ struct StringInfoData;                  /* #include "lib/stringinfo.h" */
  * inner batch file.  Subsequently, while reading either inner or outer batch
  * files, we might find tuples that no longer belong to the current batch;
  * if so, we just dump them out to the correct batch file.
+ *
+ * A single-batch table much larger than the CPU cache may instead be radix
+ * partitioned in memory (nradix > 0).  The top bits of the hash value pick
+ * the partition, and are used as the top bits of the bucket number, so that
+ * each partition's buckets are a contiguous range of the bucket array; its
+ * tuples are packed in chunks of its own.  The outer relation is then read
+ * ahead into as much memory as the hash table leaves free, and each batch of
+ * read-ahead tuples is probed a partition at a time, so that the probes of a
+ * partition find its buckets and tuples in cache.  If the table turns out
+ * not to fit in memory after all, partitioning is given up when nbatch is
+ * first increased, and the join proceeds as described above.
  * ----------------------------------------------------------------
  */
 
@@ -117,6 +128,29 @@ typedef struct HashSkewBucket
 #define SKEW_HASH_MEM_PERCENT  2
 #define SKEW_MIN_OUTER_FRACTION  0.01
 
+/* radix partition of a hash value, see above */
+#define HJ_RADIX_PARTITION(hashtable, hashvalue) \
+	((hashvalue) >> (32 - (hashtable)->log2_nradix))
+
+/*
+ * Outer tuples read ahead for probing a radix partitioned hash table, in
+ * partition order.
+ */
+typedef struct HashJoinRadixOuter
+{
+	MemoryContext tupleCxt;		/* the tuples, reset at each read-ahead */
+	Size		tupleSpace;		/* their size, counted in spaceUsed */
+	int			maxtuples;		/* size of the arrays, 0 if not reading ahead */
+	int			ntuples;		/* number of tuples read ahead */
+	int			next;			/* next tuple to probe */
+	bool		done;			/* outer relation exhausted */
+	MinimalTuple *tuples;		/* by partition */
+	uint32	   *hashvalues;
+	MinimalTuple *readtuples;	/* in the order read */
+	uint32	   *readhashvalues;
+	int		   *counts;			/* tuples per partition */
+} HashJoinRadixOuter;
+
 /*
  * To reduce palloc overhead, the HashJoinTuples for the current batch are
  * packed in 32kB buffers instead of pallocing each tuple individually.
@@ -175,6 +209,10 @@ typedef struct HashJoinTableStats
     int                     nonemptybatches;    /* num of nontrivial batches */
     Size                    workmem_max;        /* work_mem high water mark */
     CdbExplain_Agg          chainlength;        /* hash chain length stats */
+
+    /* Radix partitioning, if the outer tuples were probed a partition at a time */
+    int                     nradix;             /* num of radix partitions */
+    int                     radixreadahead;     /* max outer tuples read ahead */
 } HashJoinTableStats;
 
 
@@ -401,6 +439,12 @@ typedef struct HashJoinTableData
 	/* used for dense allocation of tuples (into linked chunks) */
 	HashMemoryChunk chunks;		/* one list for the whole batch */
 
+	/* radix partitioning of a single-batch table, if nradix > 0 */
+	int			nradix;			/* # partitions (a power of 2) */
+	int			log2_nradix;	/* its log2 */
+	HashMemoryChunk *radix_chunks;	/* current chunk of each partition */
+	HashJoinRadixOuter *radix_outer;	/* outer read-ahead, or NULL */
+
 	/* Shared and private state for Parallel Hash. */
 	HashMemoryChunk current_chunk;	/* this backend's current chunk */
 	dsa_area   *area;			/* DSA area to allocate memory from */
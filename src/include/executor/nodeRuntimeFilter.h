@@ -12,16 +12,51 @@
 #define NODERUNTIMEFILTER_H
 
 #include "access/parallel.h"
+#include "fmgr.h"
+#include "lib/bloomfilter.h"
 #include "nodes/execnodes.h"
 
+/*
+ * A runtime filter handed to the scan of an append-optimized table right
+ * below the RuntimeFilter node.  The scan skips the blocks whose zone maps
+ * show no value of the join key column within the range of the join's inner
+ * keys, and may test the bloom filter itself, as a pushed down qual of the
+ * key column.  It sets bloom_in_scan then, and the RuntimeFilter node stops
+ * testing the rows it returns.
+ */
+typedef struct ScanRuntimeFilter
+{
+	AttrNumber	attno;			/* zero based column of the join key */
+
+	/* bloom filter of a single key join, or NULL */
+	bloom_filter *bf;
+	bool		raw_value;		/* look up the value rather than its hash */
+	FmgrInfo	hashfunction;
+	Oid			collation;
+	uint64	   *rows_removed;
+
+	/* range of the inner keys, mapped with AOZoneMap_DatumToInt64() */
+	bool		has_range;
+	Oid			range_typid;
+	int64		range_min;
+	int64		range_max;
+
+	bool		bloom_in_scan;
+} ScanRuntimeFilter;
+
 extern RuntimeFilterState *ExecInitRuntimeFilter(RuntimeFilter *node,
                                                  EState *estate, int eflags);
 extern void ExecEndRuntimeFilter(RuntimeFilterState *node);
 extern void ExecReScanRuntimeFilter(RuntimeFilterState *node);
 extern void RFBuildFinishCallback(RuntimeFilterState *rfstate, bool parallel);
 extern void RFAddTupleValues(RuntimeFilterState *rfstate, List *vals);
+extern ExprState *ExecInitRuntimeFilterScanQual(ScanRuntimeFilter *filter,
+												ExprState *qual);
 
 extern void ExecInitRuntimeFilterFinish(RuntimeFilterState *node,
                                         double inner_rows);
 
+extern Size RuntimeFilterShmemSize(void);
+extern void RuntimeFilterShmemInit(void);
+
 #endif							/* NODERUNTIMEFILTER_H */
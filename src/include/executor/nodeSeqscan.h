@@ -15,6 +15,7 @@
 #define NODESEQSCAN_H
 
 #include "access/parallel.h"
+#include "executor/nodeRuntimeFilter.h"
 #include "nodes/execnodes.h"
 
 extern SeqScanState *ExecInitSeqScan(SeqScan *node, EState *estate, int eflags);
@@ -22,6 +23,8 @@ extern SeqScanState *ExecInitSeqScanForPartition(SeqScan *node, EState *estate,
 							Relation currentRelation);
 extern void ExecEndSeqScan(SeqScanState *node);
 extern void ExecReScanSeqScan(SeqScanState *node);
+extern void ExecSeqScanSetRuntimeFilter(SeqScanState *node,
+										ScanRuntimeFilter *filter);
 
 /* parallel scan support */
 extern void ExecSeqScanEstimate(SeqScanState *node, ParallelContext *pcxt);
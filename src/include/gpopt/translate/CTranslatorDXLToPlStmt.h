@@ -319,6 +319,13 @@ private:
 			ctxt_translation_prev_siblings	// translation contexts of previous siblings
 	);
 
+	Plan *TranslateDXLRuntimeFilter(
+		const CDXLNode *runtime_filter_dxlnode,
+		CDXLTranslateContext *output_context,
+		CDXLTranslationContextArray *
+			ctxt_translation_prev_siblings	// translation contexts of previous siblings
+	);
+
 	Plan *TranslateDXLSharedScan(
 		const CDXLNode *shared_scan_dxlnode,
 		CDXLTranslateContext *output_context,
@@ -25,6 +25,7 @@ extern bool bloom_lacks_element(bloom_filter *filter, unsigned char *elem,
 extern double bloom_prop_bits_set(bloom_filter *filter);
 extern double bloom_false_positive_rate(bloom_filter *filter);
 extern uint64 bloom_total_bits(bloom_filter *filter);
+extern Size bloom_size(bloom_filter *filter);
 extern bloom_filter *bloom_create_aggresive(int64 total_elems,
 											int work_mem, uint64 seed);
 
@@ -1532,6 +1532,7 @@ typedef struct SeqScanState
 {
 	ScanState	ss;				/* its first field is NodeTag */
 	Size		pscan_len;		/* size of parallel heap scan descriptor */
+	struct ScanRuntimeFilter *runtime_filter;	/* for an AO scan, or NULL */
 } SeqScanState;
 
 /* ----------------
@@ -1592,6 +1593,7 @@ typedef struct
  *		RuntimeContext	   expr context for evaling runtime Skeys
  *		RelationDesc	   index relation descriptor
  *		ScanDesc		   index scan descriptor
+ *		BatchFetch		   may table tuples be fetched in batches?
  *
  *		ReorderQueue	   tuples that need reordering due to re-check
  *		ReachedEnd		   have we fetched all tuples from index already?
@@ -1618,6 +1620,7 @@ typedef struct IndexScanState
 	ExprContext *iss_RuntimeContext;
 	Relation	iss_RelationDesc;
 	struct IndexScanDescData *iss_ScanDesc;
+	bool		iss_BatchFetch;
 
 	/* These are needed for re-checking ORDER BY expr ordering */
 	pairingheap *iss_ReorderQueue;
@@ -2613,6 +2616,8 @@ typedef struct AggState
 	SharedAggInfo *shared_info; /* one entry per worker */
 	Bitmapset	*aggs_used;	/* which aggs are used in this query */
 
+	/* input read in batches by agg_fill_hash_table(), or NULL */
+	struct HashAggInputBatch *hash_input_batch;
 } AggState;
 
 typedef struct TupleSplitState
@@ -2859,6 +2864,20 @@ typedef struct RuntimeFilterState
 	bool  *raw_value;
 
 	bloom_filter *bf;
+
+	/* fields for a filter shared with, or pushed down from, another slice */
+	struct runtimefilter_Xslice_reference *xslice_ref;
+	List	   *hashkeys;		/* pushed down filter only */
+	FmgrInfo   *hashfunctions;	/* pushed down filter only */
+	Oid		   *collations;		/* pushed down filter only */
+	uint64		rows_removed;	/* pushed down filter only */
+
+	/* range of the first join key, kept for the zone maps of AO scans */
+	Oid			range_typid;	/* InvalidOid if the range is not kept */
+	bool		has_range;
+	int64		range_min;
+	int64		range_max;
+	struct ScanRuntimeFilter *scan_filter;	/* handed to the outer scan */
 } RuntimeFilterState;
 
 /* ----------------
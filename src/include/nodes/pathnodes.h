@@ -182,6 +182,8 @@ typedef struct PlannerGlobal
 
 	int			lastPlanNodeId; /* highest plan node ID assigned */
 
+	int			lastRuntimeFilterId;	/* highest RuntimeFilter filter_id assigned */
+
 	bool		transientPlan;	/* redo plan when TransactionXmin changes? */
 	bool		oneoffPlan;		/* redo plan on every execution? */
 	Oid			simplyUpdatableRel; /* if valid, query can be used with CURRENT OF for this rel */
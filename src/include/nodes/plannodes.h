@@ -1382,9 +1382,22 @@ typedef struct Hash
  *		runtime filter node
  * ----------------
  */
+/*
+ * A RuntimeFilter over the outer plan of a hash join discards the rows the
+ * bloom filter of the join's inner side rules out.  If it has a non-zero
+ * filter_id, it also publishes its bloom filter in shared memory, and a
+ * RuntimeFilter with the same filter_id and non-NIL hashkeys, in a lower
+ * slice, applies it to the rows of a scan before they are sent through a
+ * Motion.  Such a pushed down filter has its own copy of the join's outer
+ * hash keys and operators, since its parent is not the join.
+ */
 typedef struct RuntimeFilter
 {
 	Plan		plan;
+	int			filter_id;		/* shared filter id, or 0 if local only */
+	List	   *hashkeys;		/* outer hash keys, if pushed down */
+	List	   *hashoperators;	/* hash join operators, if pushed down */
+	List	   *hashcollations;
 } RuntimeFilter;
 
 /* ----------------
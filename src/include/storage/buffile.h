@@ -66,7 +66,17 @@ extern const char *BufFileGetFilename(BufFile *buffile);
 extern void BufFileSuspend(BufFile *buffile);
 extern void BufFileResume(BufFile *buffile);
 
+/*
+ * Compression methods for gp_workfile_compression_method.
+ */
+typedef enum WorkfileCompressionMethod
+{
+	WORKFILE_COMPRESSION_ZSTD,
+	WORKFILE_COMPRESSION_LZ4
+} WorkfileCompressionMethod;
+
 extern bool gp_workfile_compression;
+extern int	gp_workfile_compression_method;
 extern void BufFilePledgeSequential(BufFile *buffile);
 extern void BufFileSetIsTempFile(BufFile *file, bool isTempFile);
 
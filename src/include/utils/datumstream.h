@@ -65,6 +65,12 @@ typedef struct DatumStreamWrite
 
 	DatumStreamBlockWrite blockWrite;
 
+	/*
+	 * Zone map accumulator for the current block, NULL if the column is not
+	 * summarized.
+	 */
+	AOZoneMapBuildState *zonemap;
+
 	/*
 	 * EOFs of current segment file.
 	 */
@@ -242,6 +248,65 @@ datumstreamread_nth(DatumStreamRead * acc)
 	}
 }
 
+/*
+ * Advance over the next nrows values of the current block and get them.  The
+ * block must have that many values left, see datumstreamread_remaining.
+ */
+inline static void
+datumstreamread_get_batch(DatumStreamRead * acc, Datum *values, bool *nulls,
+						  int nrows)
+{
+	if (acc->largeObjectState == DatumStreamLargeObjectState_None)
+	{
+		DatumStreamBlockRead_GetBatch(&acc->blockRead, values, nulls, nrows);
+	}
+	else
+	{
+		int			len PG_USED_FOR_ASSERTS_ONLY;
+
+		Assert(nrows == 1);
+		len = datumstreamread_advancelarge(acc);
+		Assert(len > 0);
+		datumstreamread_getlarge(acc, values, nulls);
+	}
+}
+
+/*
+ * Number of values in the current block that have not been advanced over
+ * yet.  Zero means the next block has to be read first.
+ */
+inline static int
+datumstreamread_remaining(DatumStreamRead * acc)
+{
+	if (acc->largeObjectState == DatumStreamLargeObjectState_None)
+		return Max(acc->blockRead.logical_row_count - acc->blockRead.nth - 1, 0);
+	else if (acc->largeObjectState == DatumStreamLargeObjectState_HaveAoContent)
+		return 1;
+	else
+		return 0;
+}
+
+/*
+ * Dictionary code of the current value, or -1 if it is NULL or the current
+ * block is not dictionary encoded.  Values of a block with the same code are
+ * equal.  The codes of different blocks are unrelated; the block's
+ * dictionary is identified by blockRead.dict_generation.
+ */
+inline static int32
+datumstreamread_dict_code(DatumStreamRead * acc)
+{
+	DatumStreamBlockRead *dsr = &acc->blockRead;
+
+	if (acc->largeObjectState != DatumStreamLargeObjectState_None ||
+		!dsr->dict_block_was_encoded)
+		return -1;
+
+	if (dsr->has_null && DatumStreamBitMapRead_CurrentIsOn(&dsr->null_bitmap))
+		return -1;
+
+	return DatumStreamBlockRead_DictCode(dsr, dsr->physical_datum_index);
+}
+
 /* ------------------------------------------------------------------------------ */
 
 extern int datumstreamwrite_put(
@@ -314,6 +379,8 @@ extern int	datumstreamread_block(DatumStreamRead * ds,
 extern void datumstreamread_find(DatumStreamRead * datumStream,
 					 int32 rowNumInBlock);
 extern void datumstreamread_rewind_block(DatumStreamRead * datumStream);
+extern bool datumstreamread_skip_to_row(DatumStreamRead * datumStream,
+										int64 rowNum);
 extern bool datumstreamread_find_block(DatumStreamRead * datumStream,
 						   DatumStreamFetchDesc datumStreamFetchDesc,
 						   int64 rowNum);
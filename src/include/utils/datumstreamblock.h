@@ -197,6 +197,34 @@ typedef struct DatumStreamBlock_Delta_Extension
 	 */
 }	DatumStreamBlock_Delta_Extension;
 
+/*
+ * Datum Stream Block extension to DatumStreamBlock_Dense with dictionary
+ * encoding of variable-length items.  12 bytes more.
+ *
+ * The datum area then holds every distinct item of the block once, laid
+ * out like ordinary items, followed by one code per physical datum.  A code
+ * is the index of the item in the dictionary, packed code_bits to the code
+ * starting at the least significant bit of the first byte.
+ */
+typedef struct DatumStreamBlock_Dict_Extension
+{
+	int32		dict_count;
+	/*
+	 * Number of distinct items in the dictionary.
+	 */
+
+	int32		dict_size;
+	/*
+	 * Byte size of the dictionary items, including zero padding.  The codes
+	 * start right after them.
+	 */
+
+	int32		code_bits;
+	/*
+	 * Width of a code in bits: 1, 2, 4, 8 or 16.
+	 */
+}	DatumStreamBlock_Dict_Extension;
+
 
 /* Flags */
 enum
@@ -205,6 +233,7 @@ enum
 	DSB_HAS_RLE_COMPRESSION = 0x2,
 	DSB_HAS_DELTA_COMPRESSION = 0x4,
 	DSB_HAS_ENCRYPTION = 0x8,
+	DSB_HAS_DICTIONARY = 0x10,
 };
 
 typedef struct DatumStreamBitMapWrite
@@ -990,6 +1019,14 @@ typedef struct DatumStreamTypeInfo
 
 #define MAXREPEAT_COUNT 0x3FFFFFFF
 
+/*
+ * Most distinct items a dictionary encoded block holds.  Blocks with more
+ * are written without a dictionary.
+ */
+#define MAXDICTIONARY_COUNT 4096
+
+extern bool gp_aocs_dictionary_encoding;
+
 #define DatumStreamBlockWrite_Eyecatcher "DBW"
 #define DatumStreamBlockWrite_EyecatcherLen 4
 
@@ -1010,6 +1047,7 @@ typedef struct DatumStreamBlockWrite
 
 	bool		rle_want_compression;
 	bool		delta_want_compression;
+	bool		dict_want_encoding;
 
 	int32		initialMaxDatumPerBlock;
 	int32		maxDatumPerBlock;
@@ -1166,6 +1204,21 @@ typedef struct DatumStreamBlockRead
 	bool		delta_block_was_compressed;
 	DatumStreamBitMapRead delta_bitmap;
 
+	/* Dictionary variables */
+	bool		dict_block_was_encoded;
+	uint8	  **dict_entries;	/* item pointer of each dictionary code */
+	uint8	   *dict_codesp;
+	int32		dict_code_bits;
+	int32		dict_count;
+	int32		dict_size;
+
+	/*
+	 * Identifies the dictionary of the current block.  Every dictionary
+	 * encoded block read gets a new one, so that callers can tell whether
+	 * codes they remembered are still meaningful.
+	 */
+	uint64		dict_generation;
+
 	/*
 	 * Keep less frequently accessed fields down here for possible better CPU data cache
 	 * performance.
@@ -1188,6 +1241,8 @@ typedef struct DatumStreamBlockRead
 
 	MemoryContext memctxt;
 
+	int32		dict_entries_maxcount;
+
 }	DatumStreamBlockRead;
 
 extern char *DatumStreamVersion_String(DatumStreamVersion datumStreamVersion);
@@ -1620,6 +1675,23 @@ typedef enum Delta_Compression_status
 
 }	Delta_Compression_status;
 
+/*
+ * Get the dictionary code of the index'th physical datum of a dictionary
+ * encoded block.
+ */
+inline static int32
+DatumStreamBlockRead_DictCode(DatumStreamBlockRead * dsr, int32 index)
+{
+	uint8	   *codesp = dsr->dict_codesp;
+	int32		bit;
+
+	if (dsr->dict_code_bits == 16)
+		return codesp[2 * index] | (codesp[2 * index + 1] << 8);
+
+	bit = index * dsr->dict_code_bits;
+	return (codesp[bit >> 3] >> (bit & 7)) & ((1 << dsr->dict_code_bits) - 1);
+}
+
 inline static Delta_Compression_status
 DatumStreamBlockRead_AdvanceDenseDelta(DatumStreamBlockRead * dsr)
 {
@@ -1964,7 +2036,14 @@ DatumStreamBlockRead_AdvanceDense(DatumStreamBlockRead * dsr)
 		/*
 		 * Advance the item pointer.
 		 */
-		if (dsr->typeInfo.datumlen == -1)
+		if (dsr->dict_block_was_encoded)
+		{
+			/*
+			 * The item is looked up in the dictionary.
+			 */
+			dsr->datump = dsr->dict_entries[DatumStreamBlockRead_DictCode(dsr, dsr->physical_datum_index)];
+		}
+		else if (dsr->typeInfo.datumlen == -1)
 		{
 			struct varlena *s;
 
@@ -2064,6 +2143,19 @@ DatumStreamBlockRead_Nth(DatumStreamBlockRead * dsr)
 	return dsr->nth;
 }
 
+extern void DatumStreamBlockRead_GetBatch(
+							  DatumStreamBlockRead * dsr,
+							  Datum *values,
+							  bool *nulls,
+							  int nrows);
+
+/*
+ * Bulk decoding kernels, see datumstreamdecode.c.
+ */
+extern void (*DatumStreamDecode_Widen16) (Datum *dst, const uint8 *src, int count);
+extern void (*DatumStreamDecode_Widen32) (Datum *dst, const uint8 *src, int count);
+extern void (*DatumStreamDecode_Fill) (Datum *dst, Datum value, int count);
+
 extern void DatumStreamBlockRead_GetReadyOrig(
 								  DatumStreamBlockRead * dsr,
 								  uint8 * buffer,
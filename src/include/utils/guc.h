@@ -315,6 +315,9 @@ extern bool gp_enable_multiphase_limit;
  * 10% of the tuples are hidden.
  */
 extern int  gp_appendonly_compaction_threshold;
+extern int	gp_appendonly_compaction_segfiles_per_xact;
+extern bool gp_autovacuum_appendonly;
+extern int	gp_index_fetch_batch_size;
 extern bool gp_heap_require_relhasoids_match;
 extern bool	debug_xlog_record_read;
 extern bool Debug_cancel_print;
@@ -640,6 +643,8 @@ extern IndexCheckType gp_indexcheck_insert;
 #define SOPT_COMPTYPE      "compresstype"
 #define SOPT_COMPLEVEL     "compresslevel"
 #define SOPT_CHECKSUM      "checksum"
+#define SOPT_SORTKEY       "sortkey"
+#define SOPT_SORTMETHOD    "sortmethod"
 
 /*
  * Functions exported by guc.c
@@ -339,6 +339,8 @@ typedef struct StdRdOptions
 	int			compresslevel;  /* compression level (AO rels only) */
 	char		compresstype[NAMEDATALEN]; /* compression type (AO rels only) */
 	bool		checksum;		/* checksum (AO rels only) */
+	int			sortkey;		/* offset of the sort key column list (AO rels only) */
+	int			sortmethod;		/* offset of the sort method (AO rels only) */
 } StdRdOptions;
 
 #define HEAP_MIN_FILLFACTOR			10
@@ -16,18 +16,28 @@
 		"force_parallel_mode",
 		"gin_fuzzy_search_limit",
 		"gin_pending_list_limit",
+		"gp_aocs_dictionary_encoding",
+		"gp_aocs_scan_batch_size",
+		"gp_appendonly_block_cache_size",
+		"gp_appendonly_enable_zonemap",
+		"gp_appendonly_read_ahead_distance",
 		"gp_blockdirectory_entry_min_range",
 		"gp_blockdirectory_minipage_size",
 		"gp_debug_linger",
 		"gp_default_storage_options",
 		"gp_disable_tuple_hints",
 		"gp_enable_runtime_filter",
+		"gp_enable_runtime_filter_pushdown",
 		"gp_enable_segment_copy_checking",
 		"gp_external_enable_filter_pushdown",
+		"gp_fastsequence_cache_max_range",
+		"gp_hashagg_batch_size",
 		"gp_hashagg_default_nbatches",
 		"gp_hashagg_groups_per_bucket",
+		"gp_hashjoin_radix_partition_size",
 		"gp_hashjoin_tuples_per_bucket",
 		"gp_ignore_error_table",
+		"gp_index_fetch_batch_size",
 		"gp_indexcheck_insert",
 		"gp_initial_bad_row_limit",
 		"gp_interconnect_debug_retry_interval",
@@ -70,6 +80,7 @@
 		"gp_vmem_idle_resource_timeout",
 		"gp_workfile_caching_loglevel",
 		"gp_workfile_compression",
+		"gp_workfile_compression_method",
 		"gp_workfile_limit_files_per_query",
 		"gp_workfile_limit_per_query",
 		"hash_mem_multiplier",
@@ -155,14 +155,17 @@
 		"gp_adjust_selectivity_for_outerjoins",
 		"gp_allow_non_uniform_partitioning_ddl",
 		"gp_appendonly_compaction",
+		"gp_appendonly_compaction_segfiles_per_xact",
 		"gp_appendonly_compaction_threshold",
 		"gp_appendonly_verify_block_checksums",
 		"gp_appendonly_verify_write_block",
+		"gp_appendonly_visimap_cache_size",
 		"gp_auth_time_override",
 		"gp_autostats_mode",
 		"gp_autostats_mode_in_functions",
 		"gp_autostats_on_change_threshold",
 		"gp_autostats_allow_nonowner",
+		"gp_autovacuum_appendonly",
 		"gp_cached_segworkers_threshold",
 		"gp_command_count",
 		"gp_connection_send_timeout",
@@ -208,6 +211,7 @@
 		"gp_encoding_check_locale_compatibility",
 		"gp_external_enable_exec",
 		"gp_external_max_segs",
+		"gp_fastsequence_cache_size",
 		"gp_fts_mark_mirror_down_grace_period",
 		"gp_fts_replication_attempt_count",
 #ifdef USE_INTERNAL_FTS
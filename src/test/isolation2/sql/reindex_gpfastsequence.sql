@@ -1,5 +1,10 @@
 -- Test concurrent reindex gp_fastsequence and insert on an AO table
 
+-- Reserving ahead for the shared memory cache would make last_sequence
+-- depend on timing.
+set gp_fastsequence_cache_max_range = 0;
+2: set gp_fastsequence_cache_max_range = 0;
+
 create table test_fastseqence ( a int, b char(20)) with (appendonly = true, orientation=column);
 create index test_fastseqence_idx on test_fastseqence(b);
 insert into test_fastseqence select i , 'aa'||i from generate_series(1,100) i;
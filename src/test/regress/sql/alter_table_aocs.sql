@@ -173,6 +173,9 @@ select * from addcol5 where a > 25 order by a,b;
 -- firstRowNum of the first block starts with a value greater than 1
 -- (first insert was aborted).
 
+-- Reserving ahead for the shared memory cache would make last_sequence
+-- depend on timing.
+set gp_fastsequence_cache_max_range = 0;
 create table addcol6 (a int, b int)
    with (appendonly=true, orientation=column) distributed by (a);
 
@@ -202,6 +205,8 @@ last_sequence, gp_segment_id from gp_dist_random('gp_fastsequence') WHERE objid
 IN (SELECT segrelid FROM pg_appendonly WHERE relid IN (SELECT oid FROM pg_class
 WHERE relname='addcol6'));
 
+reset gp_fastsequence_cache_max_range;
+
 -- add column with default value as sequence
 alter table addcol6 add column d serial;
 
@@ -0,0 +1,34 @@
+--
+-- Block directory lookups keep copies of the last few minipages of each
+-- column group.  Look rows up in index order, one at a time, in tables with
+-- many small minipages spread over several segment files, and check that
+-- the answers match those of a sequential scan.
+--
+set gp_blockdirectory_minipage_size = 2;
+create table ao_blkdir_cache (a int, b int, c text)
+  using ao_row with (blocksize = 8192) distributed by (a);
+create index ao_blkdir_cache_b on ao_blkdir_cache (b);
+insert into ao_blkdir_cache select i, (i * 7919) % 10007, repeat('y', i % 30) from generate_series(1, 5000) i;
+insert into ao_blkdir_cache select i, (i * 7919) % 10007, repeat('y', i % 30) from generate_series(5001, 10007) i;
+delete from ao_blkdir_cache where a % 7 = 0;
+create table aocs_blkdir_cache (a int, b int, c text)
+  using ao_column with (blocksize = 8192) distributed by (a);
+create index aocs_blkdir_cache_b on aocs_blkdir_cache (b);
+insert into aocs_blkdir_cache select i, (i * 7919) % 10007, repeat('y', i % 30) from generate_series(1, 5000) i;
+insert into aocs_blkdir_cache select i, (i * 7919) % 10007, repeat('y', i % 30) from generate_series(5001, 10007) i;
+delete from aocs_blkdir_cache where a % 7 = 0;
+reset gp_blockdirectory_minipage_size;
+select count(*), sum(a), sum(length(c)) from ao_blkdir_cache where b between 100 and 5000;
+select count(*), sum(a), sum(length(c)) from aocs_blkdir_cache where b between 100 and 5000;
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+set gp_index_fetch_batch_size = 0;
+select count(*), sum(a), sum(length(c)) from ao_blkdir_cache where b between 100 and 5000;
+select b, a, length(c) from ao_blkdir_cache where b < 30 order by b;
+select count(*), sum(a), sum(length(c)) from aocs_blkdir_cache where b between 100 and 5000;
+select b, a, length(c) from aocs_blkdir_cache where b < 30 order by b;
+reset gp_index_fetch_batch_size;
+reset enable_seqscan;
+reset enable_bitmapscan;
+drop table ao_blkdir_cache;
+drop table aocs_blkdir_cache;
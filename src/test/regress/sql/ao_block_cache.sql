@@ -0,0 +1,53 @@
+--
+-- Fetches from compressed append-optimized tables keep the blocks they have
+-- decompressed in a backend-local cache until the end of the transaction,
+-- see gp_appendonly_block_cache_size.  Check that the answers are the same
+-- with and without the cache.
+--
+create table ao_block_cache (a int, b int, c text)
+  using ao_row with (compresstype = zlib, compresslevel = 1, blocksize = 8192) distributed by (a);
+create index ao_block_cache_b on ao_block_cache (b);
+insert into ao_block_cache select i, (i * 7919) % 10007, repeat('y', i % 30) from generate_series(1, 10007) i;
+delete from ao_block_cache where a % 5 = 0;
+create table aocs_block_cache (a int, b int, c text)
+  using ao_column with (compresstype = zlib, compresslevel = 1, blocksize = 8192) distributed by (a);
+create index aocs_block_cache_b on aocs_block_cache (b);
+insert into aocs_block_cache select i, (i * 7919) % 10007, repeat('y', i % 30) from generate_series(1, 10007) i;
+delete from aocs_block_cache where a % 5 = 0;
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+begin;
+set local gp_appendonly_block_cache_size = 0;
+select count(*), sum(a), sum(length(c)) from ao_block_cache where b between 100 and 5000;
+commit;
+begin;
+select count(*), sum(a), sum(length(c)) from ao_block_cache where b between 100 and 5000;
+select count(*), sum(a), sum(length(c)) from ao_block_cache where b between 100 and 5000;
+select b, a, length(c) from ao_block_cache where b < 40 order by b;
+commit;
+begin;
+set local gp_appendonly_block_cache_size = 0;
+select count(*), sum(a), sum(length(c)) from aocs_block_cache where b between 100 and 5000;
+commit;
+begin;
+select count(*), sum(a), sum(length(c)) from aocs_block_cache where b between 100 and 5000;
+select count(*), sum(a), sum(length(c)) from aocs_block_cache where b between 100 and 5000;
+select b, a, length(c) from aocs_block_cache where b < 40 order by b;
+commit;
+-- A table truncated in the transaction that created it is written anew
+begin;
+create table ao_block_cache_trunc (a int, b int, c text)
+  using ao_column with (compresstype = zlib, compresslevel = 1, blocksize = 8192) distributed by (a);
+create index ao_block_cache_trunc_b on ao_block_cache_trunc (b);
+insert into ao_block_cache_trunc select i, i, repeat('x', i % 30) from generate_series(1, 2000) i;
+select count(*) from ao_block_cache_trunc where b < 1000 and c like 'x%';
+truncate ao_block_cache_trunc;
+insert into ao_block_cache_trunc select i, i, repeat('z', i % 30) from generate_series(1, 2000) i;
+select count(*) from ao_block_cache_trunc where b < 1000 and c like 'x%';
+select count(*) from ao_block_cache_trunc where b < 1000 and c like 'z%';
+commit;
+reset enable_seqscan;
+reset enable_bitmapscan;
+drop table ao_block_cache;
+drop table aocs_block_cache;
+drop table ao_block_cache_trunc;
@@ -0,0 +1,35 @@
+--
+-- Tests for compresstype=auto, which picks the block compression of each
+-- column by itself. Which codec it picks depends on the libraries the server
+-- was built with, so only check that the data survives, and that it was
+-- compressed.
+--
+SELECT * FROM pg_compression WHERE compname = 'auto';
+
+CREATE TABLE aocs_auto (a int ENCODING (compresstype=auto), b text ENCODING (compresstype=auto), c float8 ENCODING (compresstype=auto), d text ENCODING (compresstype=auto)) WITH (appendonly=true, orientation=column) DISTRIBUTED BY (a);
+INSERT INTO aocs_auto SELECT g, 'value ' || (g % 100), g * 0.5, md5(g::text) FROM generate_series(1, 100000) g;
+
+SELECT get_ao_compression_ratio('aocs_auto') > 1;
+SELECT count(*), sum(a), sum(length(b)), count(DISTINCT b), sum(c), count(DISTINCT d) FROM aocs_auto;
+SELECT * FROM aocs_auto WHERE a = 4242;
+
+-- Blocks written later may pick a different codec than the first ones.
+INSERT INTO aocs_auto SELECT g, repeat('x', g % 1000), 0, '' FROM generate_series(100001, 110000) g;
+SELECT count(*), sum(length(b)), sum(c) FROM aocs_auto WHERE a > 100000;
+
+-- New columns can use it too
+ALTER TABLE aocs_auto ADD COLUMN e int DEFAULT 7 ENCODING (compresstype=auto);
+SELECT count(*), sum(e) FROM aocs_auto;
+
+-- As a table level option
+CREATE TABLE aocs_auto_tab (a int, b text) WITH (appendonly=true, orientation=column, compresstype=auto) DISTRIBUTED BY (a);
+INSERT INTO aocs_auto_tab SELECT g, 'value ' || (g % 100) FROM generate_series(1, 100000) g;
+SELECT get_ao_compression_ratio('aocs_auto_tab') > 1;
+SELECT count(*), sum(a), sum(length(b)) FROM aocs_auto_tab;
+
+-- Invalid uses
+CREATE TABLE aocs_auto_invalid (a int ENCODING (compresstype=auto, compresslevel=2)) WITH (appendonly=true, orientation=column) DISTRIBUTED BY (a);
+CREATE TABLE ao_auto_row (a int) WITH (appendonly=true, compresstype=auto) DISTRIBUTED BY (a);
+
+DROP TABLE aocs_auto;
+DROP TABLE aocs_auto_tab;
@@ -0,0 +1,43 @@
+--
+-- Scans of append-optimized segment files ask the kernel to read ahead of
+-- them, see gp_appendonly_read_ahead_distance.  Check that sequential scans,
+-- and bitmap scans fetching through the block directory, which read ahead
+-- only up to the end of each block directory range, return the same rows
+-- whether nothing, one large read or more than the whole file is read ahead.
+--
+create table ao_read_ahead (a int, b int, c text)
+  using ao_row with (blocksize = 8192) distributed by (a);
+create table aocs_read_ahead (a int, b int, c text)
+  using ao_column with (blocksize = 8192) distributed by (a);
+create index ao_read_ahead_b on ao_read_ahead (b);
+create index aocs_read_ahead_b on aocs_read_ahead (b);
+insert into ao_read_ahead select i, (i * 7919) % 10007, repeat('x', i % 50) from generate_series(1, 50000) i;
+insert into aocs_read_ahead select * from ao_read_ahead;
+
+set gp_appendonly_read_ahead_distance = 0;
+select count(*), sum(a), sum(length(c)) from ao_read_ahead;
+select count(*), sum(a), sum(length(c)) from aocs_read_ahead;
+set enable_seqscan = off;
+select count(*), sum(a), sum(length(c)) from ao_read_ahead where b between 100 and 5000;
+select count(*), sum(a), sum(length(c)) from aocs_read_ahead where b between 100 and 5000;
+reset enable_seqscan;
+
+set gp_appendonly_read_ahead_distance = 1;
+select count(*), sum(a), sum(length(c)) from ao_read_ahead;
+select count(*), sum(a), sum(length(c)) from aocs_read_ahead;
+set enable_seqscan = off;
+select count(*), sum(a), sum(length(c)) from ao_read_ahead where b between 100 and 5000;
+select count(*), sum(a), sum(length(c)) from aocs_read_ahead where b between 100 and 5000;
+reset enable_seqscan;
+
+set gp_appendonly_read_ahead_distance = 64;
+select count(*), sum(a), sum(length(c)) from ao_read_ahead;
+select count(*), sum(a), sum(length(c)) from aocs_read_ahead;
+set enable_seqscan = off;
+select count(*), sum(a), sum(length(c)) from ao_read_ahead where b between 100 and 5000;
+select count(*), sum(a), sum(length(c)) from aocs_read_ahead where b between 100 and 5000;
+reset enable_seqscan;
+
+reset gp_appendonly_read_ahead_distance;
+drop table ao_read_ahead;
+drop table aocs_read_ahead;
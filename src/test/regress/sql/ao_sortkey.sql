@@ -0,0 +1,87 @@
+--
+-- Sorting bulk loads of append-optimized tables by a declared sort key
+--
+-- All rows have the same distribution key, so they are all loaded into one
+-- segment file and their storage order shows in ctid order.
+--
+create table sk_ao (d int, a int, b int) using ao_row
+  with (sortkey='a') distributed by (d);
+create index sk_ao_a on sk_ao (a);
+copy sk_ao from stdin;
+1	5	1
+1	3	2
+1	8	3
+1	1	4
+1	\N	5
+1	3	6
+\.
+select a, b from sk_ao order by ctid;
+-- the tuple ids of the sorted rows are the ones the index points to
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+select a, b from sk_ao where a = 3 order by b;
+reset enable_seqscan;
+reset enable_bitmapscan;
+
+-- Z-order interleaves the ranks of both columns
+create table sk_aocs (d int, a int, b int) using ao_column
+  with (sortkey='a,b', sortmethod='zorder') distributed by (d);
+select reloptions from pg_class where oid = 'sk_aocs'::regclass;
+copy sk_aocs from stdin;
+1	3	3
+1	3	2
+1	3	1
+1	3	0
+1	2	3
+1	2	2
+1	2	1
+1	2	0
+1	1	3
+1	1	2
+1	1	1
+1	1	0
+1	0	3
+1	0	2
+1	0	1
+1	0	0
+\.
+select a, b from sk_aocs order by ctid;
+
+-- the sort key applies to the loads after it is changed
+alter table sk_aocs set (sortkey='b, a', sortmethod='linear');
+truncate sk_aocs;
+copy sk_aocs from stdin;
+1	1	1
+1	0	1
+1	1	0
+1	0	0
+\.
+select a, b from sk_aocs order by ctid;
+
+-- rows inserted one at a time are not sorted
+insert into sk_aocs values (1, 9, 9), (1, 8, 8);
+select a, b from sk_aocs order by ctid;
+
+-- renaming a sort key column renames it in the option too, and sort key
+-- columns can not be dropped
+alter table sk_aocs rename column b to bb;
+select reloptions from pg_class where oid = 'sk_aocs'::regclass;
+truncate sk_aocs;
+copy sk_aocs from stdin;
+1	1	1
+1	0	1
+1	1	0
+1	0	0
+\.
+select a, bb from sk_aocs order by ctid;
+alter table sk_aocs drop column bb;
+alter table sk_aocs reset (sortkey);
+alter table sk_aocs drop column bb;
+
+-- invalid options
+create table sk_bad (a int) using ao_row with (sortmethod='hilbert');
+create table sk_bad (a int) using ao_row with (sortkey='a,');
+create table sk_bad (a int) using heap with (sortkey='a');
+
+drop table sk_ao;
+drop table sk_aocs;
@@ -0,0 +1,68 @@
+--
+-- Zone maps on append-optimized tables
+--
+-- Scans that skip blocks using the per-block min/max summaries must return
+-- the same rows as full scans.  Zone maps are kept in the block directory,
+-- so every table gets an index first.
+--
+create table zm_ao (a int, b bigint, d date, t text) using ao_row distributed by (a);
+create index zm_ao_t on zm_ao (t);
+insert into zm_ao select i, i * 10, date '2020-01-01' + i, 'row ' || i from generate_series(1, 20000) i;
+insert into zm_ao select i, null, null, 'null ' || i from generate_series(20001, 21000) i;
+delete from zm_ao where a between 150 and 159;
+update zm_ao set b = -1 where a = 42;
+
+create table zm_aocs (a int, b bigint, d date, t text) using ao_column distributed by (a);
+create index zm_aocs_t on zm_aocs (t);
+insert into zm_aocs select i, i * 10, date '2020-01-01' + i, 'row ' || i from generate_series(1, 20000) i;
+insert into zm_aocs select i, null, null, 'null ' || i from generate_series(20001, 21000) i;
+delete from zm_aocs where a between 150 and 159;
+update zm_aocs set b = -1 where a = 42;
+alter table zm_aocs add column c int default 7;
+
+set gp_appendonly_enable_zonemap = on;
+
+select count(*) from zm_ao where a between 100 and 199;
+select count(*) from zm_ao where a < 50;
+select count(*) from zm_ao where 19990 < a;
+select count(*) from zm_ao where a = 20500::int8;
+select count(*) from zm_ao where a > 5 and a < 3;
+select count(*) from zm_ao where b = 12340;
+select count(*) from zm_ao where b in (10, 150000, 199990);
+select count(*) from zm_ao where b < 0;
+select count(*) from zm_ao where b is null;
+select count(*) from zm_ao where d >= date '2020-01-01' + 19995;
+select a, b, t from zm_ao where a between 140 and 160 and b is not null order by a;
+
+select count(*) from zm_aocs where a between 100 and 199;
+select count(*) from zm_aocs where a < 50;
+select count(*) from zm_aocs where 19990 < a;
+select count(*) from zm_aocs where a = 20500::int8;
+select count(*) from zm_aocs where a > 5 and a < 3;
+select count(*) from zm_aocs where b = 12340;
+select count(*) from zm_aocs where b in (10, 150000, 199990);
+select count(*) from zm_aocs where b < 0;
+select count(*) from zm_aocs where b is null;
+select count(*) from zm_aocs where d >= date '2020-01-01' + 19995;
+select count(*) from zm_aocs where c = 7 and a > 20990;
+select a, b, t from zm_aocs where a between 140 and 160 and b is not null order by a;
+
+-- Blocks written while zone maps are disabled are never skipped
+set gp_appendonly_enable_zonemap = off;
+insert into zm_ao select i, i * 10, date '2020-01-01' + i, 'late ' || i from generate_series(30001, 31000) i;
+insert into zm_aocs select i, i * 10, date '2020-01-01' + i, 'late ' || i, 7 from generate_series(30001, 31000) i;
+set gp_appendonly_enable_zonemap = on;
+select count(*) from zm_ao where a > 30500;
+select count(*) from zm_aocs where a > 30500;
+
+-- Rows loaded by COPY are inserted in batches
+copy (select i, i * 10, date '2020-01-01' + i, 'copy ' || i from generate_series(40001, 45000) i) to '/tmp/ao_zonemap_copy.csv' csv;
+copy zm_ao from '/tmp/ao_zonemap_copy.csv' csv;
+copy zm_aocs (a, b, d, t) from '/tmp/ao_zonemap_copy.csv' csv;
+select count(*) from zm_ao where a > 44500;
+select count(*) from zm_ao where b between 400100 and 400190;
+select count(*) from zm_aocs where a > 44500;
+select count(*) from zm_aocs where c = 7 and a > 44990;
+
+drop table zm_ao;
+drop table zm_aocs;
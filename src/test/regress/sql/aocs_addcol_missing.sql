@@ -0,0 +1,44 @@
+--
+-- ALTER TABLE ADD COLUMN with a constant default doesn't write the new
+-- columns of an AOCS table for the rows already in it.  Those rows read as
+-- the default, by sequential scans and by index lookups alike.
+--
+create table aocs_addcol_missing (a int, b int)
+  using ao_column distributed by (a);
+create index aocs_addcol_missing_b on aocs_addcol_missing (b);
+-- leave a hole in the row numbers
+begin;
+insert into aocs_addcol_missing select i, i from generate_series(1, 100) i;
+abort;
+insert into aocs_addcol_missing select i, i from generate_series(1, 1000) i;
+alter table aocs_addcol_missing add column c int default 42, add column d text default 'foo';
+select column_num, sum(eof) > 0 as has_data from gp_toolkit.__gp_aocsseg('aocs_addcol_missing')
+  group by column_num order by column_num;
+select c, d, count(*) from aocs_addcol_missing group by c, d;
+insert into aocs_addcol_missing select i, i, 7, 'bar' from generate_series(1001, 1100) i;
+select column_num, sum(eof) > 0 as has_data from gp_toolkit.__gp_aocsseg('aocs_addcol_missing')
+  group by column_num order by column_num;
+select c, d, count(*) from aocs_addcol_missing group by c, d order by c;
+select count(*), sum(c) from aocs_addcol_missing;
+select count(*) from aocs_addcol_missing where c = 42;
+select d, count(*) from aocs_addcol_missing where b > 990 group by d order by d;
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+select a, c, d from aocs_addcol_missing where b in (10, 1010) order by a;
+set enable_indexscan = off;
+set enable_bitmapscan = on;
+select a, c, d from aocs_addcol_missing where b in (10, 1010) order by a;
+reset enable_indexscan;
+reset enable_bitmapscan;
+reset enable_seqscan;
+-- a default that is not constant is written for all rows
+alter table aocs_addcol_missing add column e float8 default random();
+select count(*) from aocs_addcol_missing where e is not null;
+update aocs_addcol_missing set b = b + 10000 where a = 20;
+select a, b, c, d from aocs_addcol_missing where a = 20;
+delete from aocs_addcol_missing where a <= 500;
+vacuum aocs_addcol_missing;
+select c, d, count(*) from aocs_addcol_missing group by c, d order by c;
+alter table aocs_addcol_missing alter column b type bigint;
+select c, d, count(*), sum(b) from aocs_addcol_missing group by c, d order by c;
+drop table aocs_addcol_missing;
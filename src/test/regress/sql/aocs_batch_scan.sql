@@ -0,0 +1,45 @@
+--
+-- Sequential scans of AOCS tables decode the columns a batch of rows at a
+-- time, see gp_aocs_scan_batch_size.  Check that the batches give the same
+-- answers as the row by row path across block boundaries and deleted rows.
+--
+create table aocs_batch (a int, b text, c bigint)
+  using ao_column with (blocksize = 8192) distributed by (a);
+insert into aocs_batch select i, repeat('x', i % 50), i::bigint * i from generate_series(1, 20000) i;
+delete from aocs_batch where a % 7 = 0;
+
+set gp_aocs_scan_batch_size = 0;
+select count(*), sum(a), sum(length(b)), sum(c) from aocs_batch;
+select sum(c) from aocs_batch;
+
+set gp_aocs_scan_batch_size = 7;
+select count(*), sum(a), sum(length(b)), sum(c) from aocs_batch;
+select sum(c) from aocs_batch;
+
+reset gp_aocs_scan_batch_size;
+select count(*), sum(a), sum(length(b)), sum(c) from aocs_batch;
+select sum(c) from aocs_batch;
+
+drop table aocs_batch;
+
+--
+-- With pushed down quals, the batches read the qual columns first, and the
+-- other columns only for the rows that pass.  Use long values so that the
+-- rows of a batch span several blocks of those columns.
+--
+create table aocs_batch_late (a int, b int, c text, d bigint, e text)
+  using ao_column with (blocksize = 8192) distributed by (a);
+insert into aocs_batch_late select i, i % 100, repeat('y', i % 300), i::bigint * 3, 'row ' || i from generate_series(1, 20000) i;
+delete from aocs_batch_late where a % 13 = 0;
+
+set gp_aocs_scan_batch_size = 0;
+select count(*), sum(d), sum(length(c)), min(a), max(a), sum(length(e)) from aocs_batch_late where b = 42;
+select count(*), sum(d), sum(length(c)) from aocs_batch_late where b < 3 and a > 15000;
+select a, length(c), e from aocs_batch_late where a between 9990 and 10010 and b % 2 = 0 order by a;
+
+reset gp_aocs_scan_batch_size;
+select count(*), sum(d), sum(length(c)), min(a), max(a), sum(length(e)) from aocs_batch_late where b = 42;
+select count(*), sum(d), sum(length(c)) from aocs_batch_late where b < 3 and a > 15000;
+select a, length(c), e from aocs_batch_late where a between 9990 and 10010 and b % 2 = 0 order by a;
+
+drop table aocs_batch_late;
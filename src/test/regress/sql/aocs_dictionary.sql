@@ -0,0 +1,38 @@
+--
+-- Blocks of variable-length rle_type columns are dictionary encoded when
+-- they have few distinct values, see gp_aocs_dictionary_encoding.  Check
+-- that the encoding makes the table smaller, and that pushed down quals,
+-- which are evaluated once per distinct value of a block, give the same
+-- answers as without a dictionary.
+--
+create table aocs_dict (a int,
+  b text encoding (compresstype = rle_type),
+  c varchar(20) encoding (compresstype = rle_type))
+  using ao_column distributed by (a);
+create table aocs_nodict (a int,
+  b text encoding (compresstype = rle_type),
+  c varchar(20) encoding (compresstype = rle_type))
+  using ao_column distributed by (a);
+
+insert into aocs_dict
+  select i, case when i % 11 = 0 then null else 'color_' || i % 5 end, 'city ' || i * 3 % 7
+  from generate_series(1, 20000) i;
+set gp_aocs_dictionary_encoding = off;
+insert into aocs_nodict select * from aocs_dict;
+reset gp_aocs_dictionary_encoding;
+
+select pg_relation_size('aocs_dict') < pg_relation_size('aocs_nodict');
+
+set gp_enable_predicate_pushdown = on;
+select count(*) from aocs_dict where b = 'color_3';
+select count(*) from aocs_nodict where b = 'color_3';
+select count(*) from aocs_dict where b in ('color_1', 'color_4');
+select count(*) from aocs_dict where b is null;
+select count(*) from aocs_dict where c like 'city 2%';
+select count(*), count(distinct b) from aocs_dict where b > 'color_2' and c <> 'city 0';
+-- volatile quals are not cached
+select count(*) from aocs_dict where b || (random() * 0)::int = 'color_20';
+
+reset gp_enable_predicate_pushdown;
+drop table aocs_dict;
+drop table aocs_nodict;
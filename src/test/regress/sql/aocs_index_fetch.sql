@@ -0,0 +1,25 @@
+--
+-- Index scans of AOCS tables fetch the rows of a batch of index entries at
+-- once, in storage order, see gp_index_fetch_batch_size.  Check that the
+-- rows still come back in index order, with the same answers as fetching
+-- them one at a time.
+--
+create table aocs_idx_fetch (a int, b int, c text)
+  using ao_column with (blocksize = 8192) distributed by (a);
+create index aocs_idx_fetch_b on aocs_idx_fetch (b);
+insert into aocs_idx_fetch select i, (i * 7919) % 10007, repeat('y', i % 30) from generate_series(1, 10007) i;
+delete from aocs_idx_fetch where a % 5 = 0;
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+set gp_index_fetch_batch_size = 0;
+select count(*), sum(a), sum(length(c)) from aocs_idx_fetch where b between 100 and 5000;
+reset gp_index_fetch_batch_size;
+select count(*), sum(a), sum(length(c)) from aocs_idx_fetch where b between 100 and 5000;
+select b, a from aocs_idx_fetch where b < 40 order by b;
+select b, a from aocs_idx_fetch where b > 9000 order by b desc limit 5;
+update aocs_idx_fetch set c = 'z' where b between 10 and 19;
+select count(*) from aocs_idx_fetch where c = 'z';
+select b, c from aocs_idx_fetch where b between 8 and 21 order by b;
+reset enable_seqscan;
+reset enable_bitmapscan;
+drop table aocs_idx_fetch;
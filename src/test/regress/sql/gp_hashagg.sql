@@ -140,3 +140,113 @@ HAVING max(c) = '31'
 $$ AS qry \gset
 EXPLAIN (COSTS OFF, VERBOSE) :qry;
 :qry;
+
+-- Test reading the input of hash aggregation in batches, with the transitions
+-- done by the loops in nodeAgg.c (count, sum and avg of int2, int4, float4 and
+-- float8) and by the transition expression (numeric sum, and the combining
+-- stage). All three batch sizes must give the same answer.
+create table hashagg_batch (g int4, i2 int2, i4 int4, f4 float4, f8 float8, n numeric) distributed by (i4);
+insert into hashagg_batch
+select i % 1000,
+       case when i % 7 = 0 then null else i % 100 end,
+       i, (i % 100) / 4.0,
+       case when i % 11 = 0 then null else i / 4.0 end,
+       i
+from generate_series(1, 10000) i;
+analyze hashagg_batch;
+
+SELECT $$
+SELECT count(*) AS groups, sum(cnt) AS cnt, sum(cnt2) AS cnt2, sum(s2) AS s2,
+       sum(s4) AS s4, sum(sf4) AS sf4, sum(sf8) AS sf8, sum(a2) AS a2,
+       sum(a4) AS a4, sum(sn) AS sn
+FROM (SELECT g, count(*) AS cnt, count(i2) AS cnt2, sum(i2) AS s2,
+             sum(i4) AS s4, sum(f4) AS sf4, sum(f8) AS sf8,
+             avg(i2)::numeric(12,4) AS a2, avg(i4)::numeric(12,4) AS a4,
+             sum(n) AS sn
+      FROM hashagg_batch GROUP BY g) s
+$$ AS qry \gset
+set gp_hashagg_batch_size = 0;
+:qry;
+set gp_hashagg_batch_size = 3;
+:qry;
+reset gp_hashagg_batch_size;
+:qry;
+
+-- The same without the numeric sum, so that all the transitions are done by
+-- hashagg_batch_advance().
+SELECT $$
+SELECT count(*) AS groups, sum(cnt) AS cnt, sum(cnt2) AS cnt2, sum(s2) AS s2,
+       sum(s4) AS s4, sum(sf4) AS sf4, sum(sf8) AS sf8, sum(a2) AS a2,
+       sum(a4) AS a4
+FROM (SELECT g, count(*) AS cnt, count(i2) AS cnt2, sum(i2) AS s2,
+             sum(i4) AS s4, sum(f4) AS sf4, sum(f8) AS sf8,
+             avg(i2)::numeric(12,4) AS a2, avg(i4)::numeric(12,4) AS a4
+      FROM hashagg_batch GROUP BY g) s
+$$ AS qry \gset
+set gp_hashagg_batch_size = 0;
+:qry;
+set gp_hashagg_batch_size = 3;
+:qry;
+reset gp_hashagg_batch_size;
+:qry;
+
+-- With many more groups than fit in memory, so that the hash table fills up,
+-- and the groups after it are spilled, in the middle of a batch.
+create table hashagg_batch_spill (g int4, i2 int2, i4 int4, f8 float8) distributed by (i4);
+insert into hashagg_batch_spill
+select i % 50000, i % 100, i, i / 4.0
+from generate_series(1, 100000) i;
+analyze hashagg_batch_spill;
+SELECT $$
+SELECT count(*) AS groups, sum(cnt) AS cnt, sum(s2) AS s2, sum(s4) AS s4,
+       sum(sf8) AS sf8, sum(a4) AS a4
+FROM (SELECT g, count(*) AS cnt, sum(i2) AS s2, sum(i4) AS s4,
+             sum(f8) AS sf8, avg(i4)::numeric(12,4) AS a4
+      FROM hashagg_batch_spill GROUP BY g) s
+$$ AS qry \gset
+SELECT $$
+SELECT g, count(*) AS cnt, sum(i2) AS s2, sum(i4) AS s4, sum(f8) AS sf8,
+       avg(i4) AS a4
+FROM hashagg_batch_spill GROUP BY g
+$$ AS grpqry \gset
+
+-- Check that the hash table filled up, from the EXPLAIN ANALYZE workfile
+-- counters.
+create function hashagg_batch_spilled(query text) returns bool
+language plpgsql as
+$$
+declare
+    ln text;
+    m text[];
+begin
+    for ln in
+        execute format('explain (analyze, verbose, costs off, timing off, summary off) %s',
+                       query)
+    loop
+        m := regexp_match(ln, 'Workfile: \((\d+) spilling\)');
+        if m is not null and m[1]::int > 0 then
+            return true;
+        end if;
+    end loop;
+    return false;
+end;
+$$;
+
+set statement_mem = '1000kB';
+set gp_hashagg_batch_size = 0;
+:qry;
+create temp table hashagg_batch_spill_unbatched as :grpqry distributed by (g);
+set gp_hashagg_batch_size = 3;
+:qry;
+select hashagg_batch_spilled(:'grpqry');
+-- The groups must be the same as without batching.
+select count(*) from ((:grpqry except all
+                       select * from hashagg_batch_spill_unbatched)
+                      union all
+                      (select * from hashagg_batch_spill_unbatched
+                       except all :grpqry)) s;
+reset gp_hashagg_batch_size;
+:qry;
+reset statement_mem;
+drop table hashagg_batch_spill_unbatched;
+drop function hashagg_batch_spilled(text);
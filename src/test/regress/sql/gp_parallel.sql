@@ -461,6 +461,20 @@ alter table aocs set (parallel_workers = 2);
 explain(costs off) select count(*) from aocs;
 select count(*) from aocs;
 alter table aocs reset (parallel_workers);
+-- ao/aocs tables with a block directory split the segment files among workers
+set local gp_blockdirectory_minipage_size = 2;
+create table ao_split (a int, b int) using ao_row with (blocksize = 8192);
+insert into ao_split select i, i from generate_series(1, 100000) i;
+create index on ao_split (b);
+alter table ao_split set (parallel_workers = 2);
+select count(*), sum(b) from ao_split;
+select count(*), sum(b) from ao_split where b % 7 = 0;
+create table aocs_split (a int, b int, c text) using ao_column with (blocksize = 8192);
+insert into aocs_split select i, i, repeat('x', i % 10) from generate_series(1, 100000) i;
+create index on aocs_split (b);
+alter table aocs_split set (parallel_workers = 2);
+select count(*), sum(b), sum(length(c)) from aocs_split;
+select count(*), sum(b) from aocs_split where b % 7 = 0;
 abort;
 
 -- start_ignore
@@ -75,6 +75,78 @@ SELECT COUNT(*) FROM fact_rf
 SELECT COUNT(*) FROM dim_rf
     WHERE dim_rf.did IN (SELECT did FROM fact_rf) AND proj_id < 2;
 
+-- Test Suit 2: runtime filter pushed down below a Motion
+CREATE TABLE fact2_rf (did int, x int) DISTRIBUTED BY (x);
+CREATE TABLE dim2_rf (vid int, flag int) DISTRIBUTED REPLICATED;
+INSERT INTO fact2_rf SELECT i, i FROM generate_series(1, 50000) s(i);
+INSERT INTO dim2_rf SELECT i, i % 10 FROM generate_series(1, 1000) s(i);
+ANALYZE fact2_rf, dim2_rf;
+
+-- fact_rf is redistributed to join fact2_rf, and the filter of the
+-- replicated dim2_rf is applied before that
+SET join_collapse_limit TO 1;
+SET gp_enable_runtime_filter TO on;
+EXPLAIN (COSTS OFF) SELECT COUNT(*) FROM
+    (fact_rf JOIN fact2_rf ON fact_rf.did = fact2_rf.did)
+    JOIN dim2_rf ON fact_rf.val = dim2_rf.vid
+    WHERE flag = 0;
+
+SELECT COUNT(*) FROM
+    (fact_rf JOIN fact2_rf ON fact_rf.did = fact2_rf.did)
+    JOIN dim2_rf ON fact_rf.val = dim2_rf.vid
+    WHERE flag = 0;
+
+SET gp_enable_runtime_filter_pushdown TO off;
+EXPLAIN (COSTS OFF) SELECT COUNT(*) FROM
+    (fact_rf JOIN fact2_rf ON fact_rf.did = fact2_rf.did)
+    JOIN dim2_rf ON fact_rf.val = dim2_rf.vid
+    WHERE flag = 0;
+
+RESET gp_enable_runtime_filter_pushdown;
+RESET join_collapse_limit;
+DROP TABLE fact2_rf, dim2_rf;
+
+-- Test Suit 3: runtime filter applied in the scans of AO tables
+CREATE TABLE fact3_rf (did int, val int)
+    WITH (appendonly=true, orientation=column) DISTRIBUTED BY (did);
+CREATE TABLE fact3_ao_rf (did int, val int)
+    WITH (appendonly=true) DISTRIBUTED BY (did);
+CREATE TABLE dim3_rf (did int, flag int) DISTRIBUTED BY (did);
+INSERT INTO fact3_rf SELECT i / 100, i FROM generate_series(0, 99999) i;
+INSERT INTO fact3_ao_rf SELECT * FROM fact3_rf;
+INSERT INTO dim3_rf SELECT i, i % 10 FROM generate_series(1, 1000) i;
+ANALYZE fact3_rf, fact3_ao_rf, dim3_rf;
+SELECT COUNT(*) FROM fact3_rf JOIN dim3_rf USING (did) WHERE flag = 0;
+SELECT COUNT(*) FROM fact3_rf JOIN dim3_rf USING (did)
+    WHERE flag = 0 AND val % 2 = 0;
+SELECT COUNT(*) FROM fact3_rf JOIN dim3_rf USING (did)
+    WHERE dim3_rf.did BETWEEN 100 AND 199 AND flag = 0;
+SELECT COUNT(*) FROM fact3_ao_rf JOIN dim3_rf USING (did) WHERE flag = 0;
+SELECT COUNT(*) FROM fact3_ao_rf JOIN dim3_rf USING (did)
+    WHERE dim3_rf.did BETWEEN 100 AND 199 AND flag = 0;
+DROP TABLE fact3_rf, fact3_ao_rf, dim3_rf;
+
+-- Test Suit 4: runtime filters in plans made by GPORCA
+SET optimizer TO on;
+CREATE TABLE fact4_rf (did int, val int) DISTRIBUTED BY (val);
+CREATE TABLE dim4_rf (did int, flag int) DISTRIBUTED BY (did);
+INSERT INTO fact4_rf SELECT i / 100, i FROM generate_series(0, 99999) i;
+INSERT INTO dim4_rf SELECT i, i % 10 FROM generate_series(1, 1000) i;
+ANALYZE fact4_rf, dim4_rf;
+SELECT COUNT(*) FROM fact4_rf JOIN dim4_rf USING (did) WHERE flag = 0;
+SELECT COUNT(*) FROM fact4_rf JOIN dim4_rf USING (did)
+    WHERE flag = 0 AND val % 2 = 0;
+SELECT COUNT(*) FROM fact4_rf
+    WHERE did IN (SELECT did FROM dim4_rf WHERE flag = 0);
+SELECT COUNT(*) FROM fact4_rf JOIN dim4_rf
+    ON fact4_rf.did IS NOT DISTINCT FROM dim4_rf.did WHERE flag = 0;
+EXPLAIN (COSTS OFF) SELECT COUNT(*) FROM fact4_rf JOIN dim4_rf USING (did)
+    WHERE flag = 0;
+-- not placed when the join is on IS NOT DISTINCT FROM, whose NULL keys match
+EXPLAIN (COSTS OFF) SELECT COUNT(*) FROM fact4_rf JOIN dim4_rf
+    ON fact4_rf.did IS NOT DISTINCT FROM dim4_rf.did WHERE flag = 0;
+SET optimizer TO off;
+DROP TABLE fact4_rf, dim4_rf;
 
 -- Clean up: reset guc
 SET gp_enable_runtime_filter TO off;
@@ -768,3 +768,49 @@ full join ( select r.id1, r.id2 from t_issue_10315 r group by r.id1, r.id2 ) tq_
 on (coalesce(t.id1) = tq_all.id1  and t.id2 = tq_all.id2) ;
 
 drop table t_issue_10315;
+
+--
+-- Test radix partitioned hash tables. The inner tables are much larger than
+-- the partitions, so each is split into several of them.
+--
+create table radix_outer (a int, b int) distributed by (a);
+create table radix_inner (a int, b int) distributed by (a);
+insert into radix_outer select i, i % 30000 from generate_series(1, 60000) i;
+insert into radix_inner select i, i from generate_series(1, 40000) i;
+analyze radix_outer;
+analyze radix_inner;
+
+-- Show how the hash joins were radix partitioned, on any segment.
+create function radix_explain(query text) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in
+        execute format('explain (analyze, costs off, timing off, summary off) %s',
+                       query)
+    loop
+        if ln like '%radix partition%' then
+            ln := regexp_replace(ln, '^.*\(seg\d+\)\s+', '');
+            return next regexp_replace(ln, '\d+', 'N', 'g');
+        end if;
+    end loop;
+end;
+$$;
+
+set gp_hashjoin_radix_partition_size = 64;
+set enable_mergejoin = off;
+set enable_nestloop = off;
+
+select count(*), sum(o.a) from radix_outer o join radix_inner i on o.b = i.b;
+select distinct radix_explain('select count(*), sum(o.a) from radix_outer o join radix_inner i on o.b = i.b');
+select count(*), count(o.a), count(i.a) from radix_outer o left join radix_inner i on o.b = i.b;
+select count(*), count(o.a), count(i.a) from radix_outer o full join radix_inner i on o.b = i.b;
+
+reset gp_hashjoin_radix_partition_size;
+reset enable_mergejoin;
+reset enable_nestloop;
+drop table radix_outer;
+drop table radix_inner;
+drop function radix_explain(text);
@@ -0,0 +1,27 @@
+-- @Description Tests that (lazy) vacuum compacts every segfile that needs it
+-- when gp_appendonly_compaction_segfiles_per_xact bounds how many segfiles
+-- each transaction compacts.
+CREATE TABLE uao_segfiles_per_xact (a INT, b INT) WITH (appendonly=true) DISTRIBUTED BY (b);
+
+-- Ten rows in each of four segfiles of one segment.
+BEGIN;
+SET LOCAL enable_parallel = on;
+SET LOCAL gp_appendonly_insert_files = 4;
+SET LOCAL gp_appendonly_insert_files_tuples_range = 10;
+INSERT INTO uao_segfiles_per_xact SELECT i, 1 FROM generate_series(1, 40) AS i;
+COMMIT;
+SELECT segno, tupcount, state FROM gp_toolkit.__gp_aoseg('uao_segfiles_per_xact') ORDER BY segno;
+
+-- Half the rows of every segfile are dead, and only one segfile is
+-- compacted per transaction.
+DELETE FROM uao_segfiles_per_xact WHERE a % 10 < 5;
+SET gp_appendonly_compaction_segfiles_per_xact = 1;
+VACUUM uao_segfiles_per_xact;
+
+-- All four were compacted and dropped, leaving only the live rows.
+SELECT state, sum(tupcount) AS tupcount FROM gp_toolkit.__gp_aoseg('uao_segfiles_per_xact') GROUP BY state;
+SELECT count(*) FROM gp_toolkit.__gp_aovisimap('uao_segfiles_per_xact');
+SELECT count(*), sum(a) FROM uao_segfiles_per_xact;
+
+RESET gp_appendonly_compaction_segfiles_per_xact;
+DROP TABLE uao_segfiles_per_xact;
@@ -180,6 +180,33 @@ update ao_t1 set b = b + 1;
 vacuum full ao_t1;
 drop table ao_t1;
 
+-- Index vacuum of AO/CO tables collects the dead rows from the block
+-- directory and the visimap up front: rows of an aborted insert, deleted
+-- rows, and rows moved by compaction.
+create table ao_idx_vac(a int, b int) with (appendonly=true) distributed by(a);
+create table co_idx_vac(a int, b int) with (appendonly=true, orientation=column) distributed by(a);
+create index ao_idx_vac_b on ao_idx_vac(b);
+create index co_idx_vac_b on co_idx_vac(b);
+insert into ao_idx_vac select i, i from generate_series(1, 1000) i;
+insert into co_idx_vac select i, i from generate_series(1, 1000) i;
+begin;
+insert into ao_idx_vac select i, i from generate_series(1001, 2000) i;
+insert into co_idx_vac select i, i from generate_series(1001, 2000) i;
+abort;
+insert into ao_idx_vac select i, i from generate_series(2001, 3000) i;
+insert into co_idx_vac select i, i from generate_series(2001, 3000) i;
+delete from ao_idx_vac where b % 4 = 0;
+delete from co_idx_vac where b % 4 = 0;
+vacuum ao_idx_vac;
+vacuum co_idx_vac;
+set enable_seqscan = false;
+select count(*) from ao_idx_vac where b > 0;
+select count(*) from co_idx_vac where b > 0;
+select count(*) from ao_idx_vac where b % 4 = 0 or b between 1001 and 2000;
+select count(*) from co_idx_vac where b % 4 = 0 or b between 1001 and 2000;
+drop table ao_idx_vac;
+drop table co_idx_vac;
+
 -- superuser must be able to vacuum analyze the table
 CREATE ROLE r_priv_test;
 CREATE SCHEMA s_priv_test;
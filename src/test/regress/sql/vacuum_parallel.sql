@@ -42,5 +42,32 @@ INSERT INTO parallel_vacuum_table SELECT i FROM generate_series(1, 10000) i;
 RESET max_parallel_maintenance_workers;
 RESET min_parallel_index_scan_size;
 
+-- Parallel VACUUM of the indexes of append-optimized tables. The segments
+-- use their own max_parallel_maintenance_workers and
+-- min_parallel_index_scan_size, so make the indexes large enough. The
+-- bitmap index is left to the leader. Only the number of workers the
+-- segments launched is of interest in the VERBOSE output.
+CREATE TABLE parallel_vacuum_ao (a int, b int) USING ao_row DISTRIBUTED BY (a);
+INSERT INTO parallel_vacuum_ao SELECT i, i % 10 FROM generate_series(1, 300000) i;
+CREATE INDEX parallel_vacuum_ao_a1 ON parallel_vacuum_ao(a);
+CREATE INDEX parallel_vacuum_ao_a2 ON parallel_vacuum_ao(a);
+CREATE INDEX parallel_vacuum_ao_b ON parallel_vacuum_ao USING bitmap(b);
+DELETE FROM parallel_vacuum_ao WHERE a % 3 = 0;
+-- start_matchignore
+-- m/^INFO:  (?!launched \d+ parallel vacuum worker)/
+-- m/^DETAIL:  /
+-- m/^CONTEXT:  parallel worker/
+-- m/^\d+ index pages have been deleted/
+-- m/^CPU: /
+-- end_matchignore
+SET client_min_messages TO info;
+VACUUM (PARALLEL 2, VERBOSE) parallel_vacuum_ao;
+RESET client_min_messages;
+SET enable_seqscan TO off;
+SELECT count(*) FROM parallel_vacuum_ao WHERE a > 0;
+SELECT count(*) FROM parallel_vacuum_ao WHERE b = 1;
+RESET enable_seqscan;
+DROP TABLE parallel_vacuum_ao;
+
 -- Deliberately don't drop table, to get further coverage from tools like
 -- pg_amcheck in some testing scenarios